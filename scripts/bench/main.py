@@ -0,0 +1,192 @@
+#
+#  This file is part of Permafrost Engine. 
+#  Copyright (C) 2018-2023 Eduard Permyakov 
+#
+#  Permafrost Engine is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  Permafrost Engine is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+# 
+#  Linking this software statically or dynamically with other modules is making 
+#  a combined work based on this software. Thus, the terms and conditions of 
+#  the GNU General Public License cover the whole combination. 
+#  
+#  As a special exception, the copyright holders of Permafrost Engine give 
+#  you permission to link Permafrost Engine with independent modules to produce 
+#  an executable, regardless of the license terms of these independent 
+#  modules, and to copy and distribute the resulting executable under 
+#  terms of your choice, provided that you also meet, for each linked 
+#  independent module, the terms and conditions of the license of that 
+#  module. An independent module is a module which is not derived from 
+#  or based on Permafrost Engine. If you modify Permafrost Engine, you may 
+#  extend this exception to your version of Permafrost Engine, but you are not 
+#  obliged to do so. If you do not wish to do so, delete this exception 
+#  statement from your version.
+#
+
+import pf
+import sys
+import timeit
+import traceback
+
+import bench.scenarios as scenarios
+
+############################################################
+# Headless benchmark driver                                #
+############################################################
+
+# Runs a single benchmark scenario and writes one JSON record per tick to
+# the output file. The records are aggregated and checked against the
+# stored baselines by 'tools/benchmark/run_benchmarks.py'. Usage:
+#
+#   ./bin/pf ./ scripts/bench/main.py --headless --seed=1 \
+#       --scenario=<name> --bench_out=<path> [--bench_frame_only=1]
+#
+# The frame time is measured with the wall clock, so it is valid in any 
+# build. The per-system timings and the allocated bytes need a debug build: 
+# release builds compile out the PERF spans and don't keep allocator stats. 
+# A run without them fails, unless '--bench_frame_only=1' is passed, in 
+# which case only the frame times are recorded.
+#
+# The first WARMUP_TICKS ticks (which still carry the cost of the setup) 
+# are not recorded. The perf call graphs lag a few ticks behind the frame
+# times, which doesn't matter once averaged over the run.
+
+WARMUP_TICKS = 30
+FLUSH_TICKS = 60
+# Per-system timings are taken from the main thread call graph down to this
+# depth, and from the roots of all the other threads' call graphs.
+MAIN_THREAD_DEPTH = 2
+
+scenario = None
+out_path = None
+marker_path = None
+frame_only = False
+tick = 0
+last_ts = None
+pending = []
+
+def json_str(s):
+    return '"' + s.replace('\\', '\\\\').replace('"', '\\"') + '"'
+
+def system_timings():
+    """ Returns {system name: ms} """
+    ret = {}
+    for perfinfo in pf.prev_frame_perfstats():
+        maxdepth = MAIN_THREAD_DEPTH if perfinfo.threadname == "main" else 0
+        depths = []
+        for i in range(perfinfo.nentries):
+            parent = perfinfo.parent_idx(i)
+            depth = 0 if parent < 0 else depths[parent] + 1
+            depths += [depth]
+            if depth > maxdepth:
+                continue
+            name = perfinfo.funcname(i)
+            ms = perfinfo.ms_delta(i)
+            ret[name] = ret.get(name, 0.0) + ms
+    return ret
+
+def flush():
+    global pending
+    if len(pending) == 0:
+        return
+    with open(out_path, "a") as f:
+        f.write("\n".join(pending) + "\n")
+    pending = []
+
+def record(frame_ms):
+    if frame_only:
+        pending.append('{"tick":%d,"frame_ms":%.4f}' % (tick, frame_ms))
+    else:
+        timings = system_timings()
+        if len(timings) == 0:
+            raise RuntimeError("No per-system timings were reported. They need a debug build "
+                "(NDEBUG compiles out the PERF spans) - pass --bench_frame_only=1 to only "
+                "record the frame times.")
+        systems = ",".join("%s:%.4f" % (json_str(name), ms) 
+            for name, ms in sorted(timings.items()))
+        pending.append('{"tick":%d,"frame_ms":%.4f,"allocd_bytes":%d,"systems":{%s}}' 
+            % (tick, frame_ms, pf.prev_frame_allocd_bytes(), systems))
+    if len(pending) >= FLUSH_TICKS:
+        flush()
+
+def marker_exists():
+    try:
+        open(marker_path, "r").close()
+        return True
+    except IOError:
+        return False
+
+def on_tick(user, event):
+    global tick, last_ts
+    tick += 1
+
+    # The time between the starts of two updates is the previous frame
+    now = timeit.default_timer()
+    frame_ms = None if last_ts is None else (now - last_ts) * 1000.0
+    last_ts = now
+
+    if tick <= WARMUP_TICKS:
+        return
+
+    try:
+        if frame_ms is not None:
+            record(frame_ms)
+        scenario_tick = tick - WARMUP_TICKS
+        scenario.on_tick(scenario_tick)
+
+        # The script state (including this module) is restored by the load, 
+        # rewinding the tick counter to the save point. The marker file keeps 
+        # the load from happening again once the run gets back to it. The 
+        # save is taken at the end of the frame, without a frame timestamp, 
+        # so the tick after the load doesn't measure all the time since it.
+        if scenario_tick == getattr(scenario, "save_tick", None):
+            flush()
+            last_ts = None
+            pf.save_session(out_path + ".pfsave")
+        if scenario_tick == getattr(scenario, "load_tick", None) and not marker_exists():
+            flush()
+            open(marker_path, "w").close()
+            pf.load_session(out_path + ".pfsave")
+
+        if scenario_tick >= scenario.ticks:
+            flush()
+            pf.quit(0)
+    except:
+        traceback.print_exc()
+        pf.quit(2)
+
+def main():
+    global scenario, out_path, marker_path, frame_only
+
+    name = pf.get_engine_arg("scenario")
+    cls = scenarios.by_name(name) if name else None
+    if cls is None:
+        print("Unknown benchmark scenario: %s (expected one of: %s)" 
+            % (name, ", ".join(s.name for s in scenarios.SCENARIOS)))
+        pf.quit(2)
+        return
+
+    out_path = pf.get_engine_arg("bench_out") or (pf.get_basedir() + "/bench_" + cls.name + ".jsonl")
+    marker_path = out_path + ".loaded"
+    frame_only = (pf.get_engine_arg("bench_frame_only") == "1")
+    open(out_path, "w").close()
+
+    scenario = cls()
+    scenario.setup()
+    pf.register_event_handler(pf.EVENT_UPDATE_START, on_tick, None)
+    print("Running benchmark scenario '%s' for %d ticks" % (cls.name, cls.ticks))
+
+try:
+    main()
+except:
+    traceback.print_exc()
+    pf.quit(2)
@@ -0,0 +1,276 @@
+#
+#  This file is part of Permafrost Engine. 
+#  Copyright (C) 2018-2023 Eduard Permyakov 
+#
+#  Permafrost Engine is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  Permafrost Engine is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+# 
+#  Linking this software statically or dynamically with other modules is making 
+#  a combined work based on this software. Thus, the terms and conditions of 
+#  the GNU General Public License cover the whole combination. 
+#  
+#  As a special exception, the copyright holders of Permafrost Engine give 
+#  you permission to link Permafrost Engine with independent modules to produce 
+#  an executable, regardless of the license terms of these independent 
+#  modules, and to copy and distribute the resulting executable under 
+#  terms of your choice, provided that you also meet, for each linked 
+#  independent module, the terms and conditions of the license of that 
+#  module. An independent module is a module which is not derived from 
+#  or based on Permafrost Engine. If you modify Permafrost Engine, you may 
+#  extend this exception to your version of Permafrost Engine, but you are not 
+#  obliged to do so. If you do not wish to do so, delete this exception 
+#  statement from your version.
+#
+
+import pf
+import math
+
+import rts.units.knight
+import rts.units.berzerker
+
+############################################################
+# Benchmark scenarios                                      #
+############################################################
+
+# Each scenario sets up a session on the 'plain' map and then drives it 
+# for a fixed number of ticks. All randomness goes through 'pf.rand' so
+# that runs with the same '--seed' give the same simulation.
+
+MAP_HEIGHT = 4 * pf.TILES_PER_CHUNK_HEIGHT * pf.Z_COORDS_PER_TILE
+MAP_WIDTH = 4 * pf.TILES_PER_CHUNK_WIDTH * pf.X_COORDS_PER_TILE
+
+ARROW_DESC = ("assets/models/arrow", "arrow-red.pfobj", (1.0, 1.0, 1.0), 150.0)
+NULL_UID = 0xffffffff
+
+class BenchHarvester(pf.AnimEntity, pf.MovableEntity, pf.HarvesterEntity):
+    pass
+
+class BenchTree(pf.ResourceEntity):
+    pass
+
+class BenchStorage(pf.StorageSiteEntity):
+    pass
+
+class BenchTower(pf.BuildableEntity, pf.CombatableEntity):
+    pass
+
+def rand_pos(margin=32):
+    x = pf.rand(MAP_WIDTH - 2 * margin) - (MAP_WIDTH // 2 - margin)
+    z = pf.rand(MAP_HEIGHT - 2 * margin) - (MAP_HEIGHT // 2 - margin)
+    return (float(x), float(z))
+
+def grid(n, center, spacing):
+    ncols = int(math.ceil(math.sqrt(n)))
+    for i in range(n):
+        r, c = divmod(i, ncols)
+        x = center[0] + (c - ncols / 2.0) * spacing
+        z = center[1] + (r - ncols / 2.0) * spacing
+        yield (x, z)
+
+def pos3(xz):
+    return (xz[0], pf.map_height_at_point(xz[0], xz[1]), xz[1])
+
+def spawn_knights(n, faction_id, center, spacing=8.0):
+    ret = []
+    for xz in grid(n, center, spacing):
+        knight = rts.units.knight.Knight("assets/models/knight", "knight.pfobj", "Knight")
+        knight.pos = pos3(xz)
+        knight.faction_id = faction_id
+        knight.selection_radius = 3.25
+        knight.vision_range = 35.0
+        knight.hold_position()
+        ret += [knight]
+    return ret
+
+def spawn_berzerkers(n, faction_id, center, spacing=8.0):
+    ret = []
+    for xz in grid(n, center, spacing):
+        berz = rts.units.berzerker.Berzerker("assets/models/berzerker", "berzerker.pfobj", "Berzerker")
+        berz.pos = pos3(xz)
+        berz.faction_id = faction_id
+        berz.selection_radius = 3.00
+        berz.vision_range = 35.0
+        berz.hold_position()
+        ret += [berz]
+    return ret
+
+class Scenario(object):
+
+    name = None
+    ticks = 1200
+
+    def __init__(self):
+        self.units = []
+
+    def setup_map(self, nfactions=2):
+        pf.load_map("assets/maps", "plain.pfmap")
+        pf.disable_fog_of_war()
+        colors = [(255, 0, 0, 255), (0, 0, 255, 255), (0, 255, 0, 255), (255, 255, 0, 255)]
+        for i in range(nfactions):
+            pf.add_faction("FACTION_%d" % i, colors[i])
+            pf.set_faction_controllable(i, False)
+        for i in range(nfactions):
+            for j in range(i + 1, nfactions):
+                pf.set_diplomacy_state(i, j, pf.DIPLOMACY_STATE_WAR)
+
+    def setup(self):
+        raise NotImplementedError
+
+    def on_tick(self, tick):
+        pass
+
+    def on_finish(self):
+        pass
+
+class MassMove(Scenario):
+    """ 1024 units crossing the map as one group and then back again """
+
+    name = "mass_move"
+
+    def setup(self):
+        self.setup_map()
+        self.units = spawn_knights(1024, 0, (-MAP_WIDTH / 4.0, 0.0))
+
+    def on_tick(self, tick):
+        if tick % 600 == 1:
+            sign = 1.0 if (tick // 600) % 2 == 0 else -1.0
+            for unit in self.units:
+                unit.move((sign * MAP_WIDTH / 4.0, 0.0))
+
+class Siege(Scenario):
+    """ 512 attackers against a cluster of 64 completed towers """
+
+    name = "siege"
+
+    def setup(self):
+        self.setup_map()
+        self.towers = []
+        for xz in grid(64, (MAP_WIDTH / 4.0, 0.0), 24.0):
+            tower = BenchTower("assets/models/tower", "tower.pfobj", "Tower",
+                pos=pos3(xz), max_hp=100000, base_dmg=0, base_armour=0.5)
+            tower.faction_id = 1
+            tower.mark()
+            tower.found(blocking=True, force=True)
+            tower.supply()
+            tower.complete()
+            self.towers += [tower]
+        self.units = spawn_knights(512, 0, (-MAP_WIDTH / 4.0, 0.0))
+
+    def on_tick(self, tick):
+        if tick == 1:
+            for unit in self.units:
+                unit.attack((MAP_WIDTH / 4.0, 0.0))
+
+class Harvest(Scenario):
+    """ 2048 harvesters on automatic transport between trees and storage sites """
+
+    name = "harvest"
+
+    def setup(self):
+        self.setup_map()
+        self.trees = []
+        for i in range(256):
+            tree = BenchTree("assets/models/oak_tree", "oak_tree.pfobj", "Oak Tree",
+                pos=pos3(rand_pos()), resource_name="wood", resource_amount=1000000)
+            self.trees += [tree]
+
+        self.sites = []
+        for xz in grid(16, (0.0, 0.0), 96.0):
+            site = BenchStorage("assets/models/well", "well.pfobj", "Storage", pos=pos3(xz))
+            site.faction_id = 0
+            site.set_capacity("wood", 10000000)
+            site.set_desired("wood", 10000000)
+            self.sites += [site]
+
+        for i, xz in enumerate(grid(2048, (0.0, 0.0), 6.0)):
+            harvester = BenchHarvester("assets/models/knight", "knight.pfobj", "Harvester",
+                pos=pos3(xz), idle_clip="Idle")
+            harvester.faction_id = 0
+            harvester.set_max_carry("wood", 10)
+            harvester.set_gather_speed("wood", 5.0)
+            harvester.automatic_transport = True
+            self.units += [harvester]
+
+    def on_tick(self, tick):
+        if tick == 1:
+            for i, unit in enumerate(self.units):
+                unit.gather(self.trees[i % len(self.trees)])
+
+class FogExploration(Scenario):
+    """ 4 factions of 256 scouts wandering the map with the fog of war on """
+
+    name = "fog"
+
+    def setup(self):
+        self.setup_map(nfactions=4)
+        pf.enable_fog_of_war()
+        corners = [(-1, -1), (-1, 1), (1, -1), (1, 1)]
+        for i, (sx, sz) in enumerate(corners):
+            center = (sx * MAP_WIDTH / 4.0, sz * MAP_HEIGHT / 4.0)
+            for unit in spawn_knights(256, i, center):
+                unit.vision_range = 50.0
+                self.units += [unit]
+
+    def on_tick(self, tick):
+        # Re-target one unit in every 120 per tick
+        for unit in self.units[tick % 120::120]:
+            unit.move(rand_pos())
+
+class ProjectileStorm(Scenario):
+    """ Two held armies under a constant rain of 64 projectiles per tick """
+
+    name = "projectiles"
+
+    def setup(self):
+        self.setup_map()
+        self.units = spawn_knights(256, 0, (-MAP_WIDTH / 8.0, 0.0))
+        self.units += spawn_berzerkers(256, 1, (MAP_WIDTH / 8.0, 0.0))
+        for unit in self.units:
+            unit.max_hp = 1000000
+            unit.hp = 1000000
+
+    def on_tick(self, tick):
+        for i in range(64):
+            faction_id = i % 2
+            sign = 1.0 if faction_id == 0 else -1.0
+            x, z = rand_pos()
+            origin = (-sign * MAP_WIDTH / 4.0, 20.0, z)
+            velocity = (sign * 150.0, 0.0, 0.0)
+            pf.spawn_projectile(origin, velocity, NULL_UID, faction_id, 0,
+                pf.PROJ_ONLY_HIT_ENEMIES, ARROW_DESC)
+
+class SaveLoad(Scenario):
+    """ A 512v512 battle that is saved and then loaded back mid-fight """
+
+    name = "save_load"
+    save_tick = 300
+    load_tick = 600
+
+    def setup(self):
+        self.setup_map()
+        self.units = spawn_knights(512, 0, (-35.0 - MAP_WIDTH / 8.0, 0.0))
+        self.units += spawn_berzerkers(512, 1, (35.0 + MAP_WIDTH / 8.0, 0.0))
+
+    def on_tick(self, tick):
+        if tick == 1:
+            for unit in self.units:
+                unit.attack((0.0, 0.0))
+
+SCENARIOS = [MassMove, Siege, Harvest, FogExploration, ProjectileStorm, SaveLoad]
+
+def by_name(name):
+    for scenario in SCENARIOS:
+        if scenario.name == name:
+            return scenario
+    return None
+
@@ -175,9 +175,9 @@ class PerfStatsWindow(pf.Window):
             (0, 255, 0))
 
         self.layout_row_dynamic(20, 1)
-        self.label_colored_wrap("[Flow Field Cache]   Used: {used:04d}/{cap:04d}   Hit Rate: {hr:02.03f} Invalidated: {inv:04d}" \
+        self.label_colored_wrap("[Flow Field Cache]   Used: {used:04d}/{cap:04d}   Hit Rate: {hr:02.03f} Invalidated: {inv:04d} Repaired: {rep:04d}" \
             .format(used=nav_stats["flow_used"], cap=nav_stats["flow_max"], 
-            hr=nav_stats["flow_hit_rate"], inv=nav_stats["flow_invalidated"]), \
+            hr=nav_stats["flow_hit_rate"], inv=nav_stats["flow_invalidated"], rep=nav_stats["flow_repaired"]), \
             (0, 255, 0))
 
         self.layout_row_dynamic(20, 1)
@@ -45,6 +45,7 @@
 #include "../event.h"
 #include "../perf.h"
 #include "../asset_load.h"
+#include "../game/public/game.h"
 #include "../lib/public/attr.h"
 #include "../lib/public/pf_string.h"
 #include "../render/public/render.h"
@@ -198,14 +199,14 @@ void A_SetActiveClip(uint32_t uid, const char *name,
     ctx->mode = mode;
     ctx->key_fps = key_fps;
     ctx->curr_frame = 0;
-    ctx->curr_frame_start_ticks = SDL_GetTicks();
+    ctx->curr_frame_start_ticks = G_Timer_Ticks();
 }
 
 void A_Update(void)
 {
     PERF_ENTER();
 
-    uint32_t curr_ticks = SDL_GetTicks();
+    uint32_t curr_ticks = G_Timer_Ticks();
     uint32_t uid;
 
     kh_foreach(s_anim_ctx, uid, (struct anim_ctx){0}, {
@@ -446,7 +447,7 @@ bool A_SaveState(struct SDL_RWops *stream, uint32_t uid)
 
     struct attr curr_frame_ticks_elapsed = (struct attr){
         .type = TYPE_INT,
-        .val.as_int = SDL_GetTicks() - ctx->curr_frame_start_ticks
+        .val.as_int = G_Timer_Ticks() - ctx->curr_frame_start_ticks
     };
     CHK_TRUE_RET(Attr_Write(stream, &curr_frame_ticks_elapsed, "curr_frame_ticks_elapsed"));
 
@@ -485,7 +486,7 @@ bool A_LoadState(struct SDL_RWops *stream, uint32_t uid)
 
     CHK_TRUE_RET(Attr_Parse(stream, &attr, true));
     CHK_TRUE_RET(attr.type == TYPE_INT);
-    ctx->curr_frame_start_ticks = SDL_GetTicks() - attr.val.as_int;
+    ctx->curr_frame_start_ticks = G_Timer_Ticks() - attr.val.as_int;
 
     return true;
 }
@@ -64,6 +64,8 @@
 #define TEXREF_MAGIC        "PFTR"
 #define TEXBLOB_MAGIC       "PFTB"
 #define TEXTURE_VERSION     (1)
+#define NAV_MAGIC           "PFNV"
+#define NAV_VERSION         (1)
 #define MAX_PATH_LEN        (512)
 #define MAX_REL_PATH_LEN    (256)
 
@@ -114,6 +116,14 @@ struct texblob_hdr{
     uint32_t channels;
 };
 
+/* Followed on disk by the contents of all the spans, back to back. */
+struct nav_hdr{
+    char     magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint64_t size;
+};
+
 /*****************************************************************************/
 /* STATIC FUNCTIONS                                                          */
 /*****************************************************************************/
@@ -175,13 +185,7 @@ static void hash_to_hex(char out[17], uint64_t hash)
 
 static uint64_t content_hash(const void *data, size_t len)
 {
-    const uint8_t *p = data;
-    uint64_t h = 14695981039346656037ull; /* FNV-1a 64-bit */
-    for(size_t i = 0; i < len; i++) {
-        h ^= p[i];
-        h *= 1099511628211ull;
-    }
-    return h;
+    return AssetCache_HashBytes(ASSET_CACHE_HASH_SEED, data, len);
 }
 
 /* The source-path-keyed ref (size+mtime tagged) that points at a shared blob. */
@@ -209,6 +213,21 @@ static void texblob_path(char *out, size_t size, uint64_t hash)
     pf_snprintf(out, size, "%s/cache/textures/%s.tex", g_basepath, hex);
 }
 
+static void nav_path(char *out, size_t size, uint64_t key)
+{
+    char hex[17];
+    hash_to_hex(hex, key);
+    pf_snprintf(out, size, "%s/cache/nav/%s.pfnav", g_basepath, hex);
+}
+
+static uint64_t spans_size(const struct nav_cache_span *spans, size_t nspans)
+{
+    uint64_t ret = 0;
+    for(size_t i = 0; i < nspans; i++)
+        ret += spans[i].size;
+    return ret;
+}
+
 /*****************************************************************************/
 /* PUBLIC FUNCTIONS                                                          */
 /*****************************************************************************/
@@ -233,6 +252,10 @@ bool AssetCache_Init(void)
     if(!make_directory(path))
         return false;
 
+    pf_snprintf(path, sizeof(path), "%s/cache/nav", g_basepath);
+    if(!make_directory(path))
+        return false;
+
     return true;
 }
 
@@ -598,3 +621,82 @@ void AssetCache_TextureRelease(struct texture_cache *cache)
         PF_FREE(cache->pixels);
 }
 
+
+uint64_t AssetCache_HashBytes(uint64_t hash, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    uint64_t h = hash; /* FNV-1a 64-bit */
+    for(size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+bool AssetCache_NavLoad(uint64_t key, const struct nav_cache_span *spans, size_t nspans)
+{
+    char path[MAX_PATH_LEN];
+    nav_path(path, sizeof(path), key);
+
+    SDL_RWops *stream = SDL_RWFromFile(path, "rb");
+    if(!stream)
+        return false;
+
+    bool ret = false;
+    struct nav_hdr hdr;
+    uint64_t size = spans_size(spans, nspans);
+
+    if(SDL_RWread(stream, &hdr, sizeof(hdr), 1) != 1)
+        goto out;
+    if(memcmp(hdr.magic, NAV_MAGIC, sizeof(hdr.magic)) != 0)
+        goto out;
+    if(hdr.version != NAV_VERSION)
+        goto out;
+    if(hdr.key != key || hdr.size != size)
+        goto out;
+
+    /* Reject a truncated entry before anything is copied into the spans */
+    if(SDL_RWsize(stream) != (Sint64)(sizeof(hdr) + size))
+        goto out;
+
+    for(size_t i = 0; i < nspans; i++) {
+        if(spans[i].size == 0)
+            continue;
+        if(SDL_RWread(stream, spans[i].data, spans[i].size, 1) != 1)
+            goto out;
+    }
+    ret = true;
+
+out:
+    SDL_RWclose(stream);
+    return ret;
+}
+
+bool AssetCache_NavStore(uint64_t key, const struct nav_cache_span *spans, size_t nspans)
+{
+    char path[MAX_PATH_LEN];
+    nav_path(path, sizeof(path), key);
+
+    SDL_RWops *stream = SDL_RWFromFile(path, "wb");
+    if(!stream)
+        return false;
+
+    struct nav_hdr hdr;
+    memcpy(hdr.magic, NAV_MAGIC, sizeof(hdr.magic));
+    hdr.version = NAV_VERSION;
+    hdr.key = key;
+    hdr.size = spans_size(spans, nspans);
+
+    bool ret = (SDL_RWwrite(stream, &hdr, sizeof(hdr), 1) == 1);
+    for(size_t i = 0; ret && i < nspans; i++) {
+        if(spans[i].size == 0)
+            continue;
+        ret = (SDL_RWwrite(stream, spans[i].data, spans[i].size, 1) == 1);
+    }
+    SDL_RWclose(stream);
+
+    /* Don't leave a truncated file behind to be mistaken for a valid entry */
+    if(!ret)
+        remove(path);
+    return ret;
+}
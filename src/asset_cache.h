@@ -98,6 +98,17 @@ struct texture_cache{
     void *pixels;
 };
 
+/* A baked navigation state is not a single blob: it is gathered from (and
+ * restored straight into) the spans of engine memory holding it, in order.
+ * The entry is keyed by a hash of the content that the bake was derived from.
+ */
+struct nav_cache_span{
+    void   *data;
+    size_t  size;
+};
+
+#define ASSET_CACHE_HASH_SEED (14695981039346656037ull)
+
 bool AssetCache_Init(void);
 void AssetCache_Shutdown(void);
 
@@ -127,4 +138,14 @@ bool AssetCache_TextureLoad(const char *src_name, uint64_t tag, struct texture_c
 bool AssetCache_TextureStore(const char *src_name, uint64_t tag, const struct texture_cache *in);
 void AssetCache_TextureRelease(struct texture_cache *cache);
 
+/* Accumulate 'len' bytes into a 64-bit content hash. Start from ASSET_CACHE_HASH_SEED. */
+uint64_t AssetCache_HashBytes(uint64_t hash, const void *data, size_t len);
+
+/* A Load succeeds only if an entry for 'key' exists and its size matches the 
+ * total size of the spans exactly. The spans may be partially overwritten when 
+ * it fails, so the caller must then re-bake their contents.
+ */
+bool AssetCache_NavLoad(uint64_t key, const struct nav_cache_span *spans, size_t nspans);
+bool AssetCache_NavStore(uint64_t key, const struct nav_cache_span *spans, size_t nspans);
+
 #endif
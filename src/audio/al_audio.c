@@ -59,6 +59,7 @@
 
 #include <AL/al.h>
 #include <AL/alc.h>
+#include <AL/alext.h>
 #include <SDL.h>
 
 #undef PF_MALLOC
@@ -105,10 +106,37 @@ static ALfloat                s_master_volume = 0.5f;
 static ALfloat                s_music_volume = 0.5f;
 static enum playback_mode     s_music_mode = MUSIC_MODE_PLAYLIST;
 
+/* Attributes for the headless loopback device */
+static const ALCint           s_loopback_attrs[] = {
+    ALC_FORMAT_CHANNELS_SOFT,   ALC_STEREO_SOFT,
+    ALC_FORMAT_TYPE_SOFT,       ALC_SHORT_SOFT,
+    ALC_FREQUENCY,              44100,
+    0
+};
+
 /*****************************************************************************/
 /* STATIC FUNCTIONS                                                          */
 /*****************************************************************************/
 
+static ALCdevice *audio_open_device(void)
+{
+    if(!Engine_Headless())
+        return alcOpenDevice(NULL);
+
+    /* A loopback device only mixes when it is explicitly asked to render 
+     * samples, which we never do. This gives us a sink that keeps all the
+     * audio state valid without touching any output hardware. 
+     */
+    if(!alcIsExtensionPresent(NULL, "ALC_SOFT_loopback"))
+        return NULL;
+
+    LPALCLOOPBACKOPENDEVICESOFT open_loopback = 
+        (LPALCLOOPBACKOPENDEVICESOFT)alcGetProcAddress(NULL, "alcLoopbackOpenDeviceSOFT");
+    if(!open_loopback)
+        return NULL;
+    return open_loopback(NULL);
+}
+
 static bool audio_load_wav(const char *path, struct al_buffer *out)
 {
     struct SDL_AudioSpec spec;
@@ -515,10 +543,11 @@ static void on_render_3d(void *user, void *event)
 
 bool Audio_Init(void)
 {
-    if(NULL == (s_device = alcOpenDevice(NULL)))
+    if(NULL == (s_device = audio_open_device()))
         goto fail_open;
 
-    if(NULL == (s_context = alcCreateContext(s_device, NULL)))
+    const ALCint *attrs = Engine_Headless() ? s_loopback_attrs : NULL;
+    if(NULL == (s_context = alcCreateContext(s_device, attrs)))
         goto fail_context;
     alcMakeContextCurrent(s_context);
 
@@ -61,10 +61,14 @@
 
 #define CONFIG_SETTINGS_FILENAME    "pf.conf"
 
-#define CONFIG_LOS_CACHE_SZ         (2048)
-#define CONFIG_FLOW_CACHE_SZ        (2048)
+/* The flow and LOS field caches are sized in bytes of field data, so that 
+ * denser field encodings translate to more resident fields. 
+ */
+#define CONFIG_LOS_CACHE_BYTES      (8 * 1024 * 1024)
+#define CONFIG_FLOW_CACHE_BYTES     (8 * 1024 * 1024)
 #define CONFIG_MAPPING_CACHE_SZ     (4096)
 #define CONFIG_GRID_PATH_CACHE_SZ   (8192)
+#define CONFIG_INTEGRATION_CACHE_SZ (256)
 
 #define CONFIG_FRAME_STEP_HOTKEY    (SDL_SCANCODE_SPACE)
 
@@ -107,6 +107,8 @@ static mp_strbuff_t      s_stringpool;
 static kh_ents_t        *s_tag_ent_map;
 static kh_tags_t        *s_ent_tag_map;
 static kh_trans_t       *s_ent_trans_map;
+/* Bumped on every write to the transforms table */
+static uint32_t          s_trans_version;
 static kh_icons_t       *s_ent_icons_map;
 
 /*****************************************************************************/
@@ -267,12 +269,12 @@ static struct result disappear_task(void *arg)
 
     const float duration = 2500.0f;
     uint32_t elapsed = 0;
-    uint32_t start = SDL_GetTicks();
+    uint32_t start = G_Timer_Ticks();
 
     while(elapsed < duration) {
     
         Task_AwaitEvent(EVENT_UPDATE_START, &(int){0});
-        uint32_t curr = SDL_GetTicks();
+        uint32_t curr = G_Timer_Ticks();
 
         /* The entity can theoretically be forecefully removed during the 
          * disappearing animation. Make sure we don't crap out if this happens
@@ -287,8 +289,8 @@ static struct result disappear_task(void *arg)
         /* Add a slight shake */
         if(curr_long != prev_long) {
             prev_shift = curr_shift;
-            curr_shift.x = ((float)rand()) / RAND_MAX * 2.5f;
-            curr_shift.y = ((float)rand()) / RAND_MAX * 2.5f;
+            curr_shift.x = G_RandFloat() * 2.5f;
+            curr_shift.y = G_RandFloat() * 2.5f;
         }
 
         float pc = (elapsed - (prev_long * 250)) / 250;
@@ -622,6 +624,7 @@ void Entity_ClearState(void)
 {
     kh_clear(icons, s_ent_icons_map);
     kh_clear(trans, s_ent_trans_map);
+    s_trans_version++;
     kh_clear(tags, s_ent_tag_map);
     kh_clear(ents, s_tag_ent_map);
     si_clear(&s_stringpool, s_stridx);
@@ -643,6 +646,7 @@ void Entity_SetRot(uint32_t uid, quat_t rot)
         assert(status != -1);
     }
     kh_value(s_ent_trans_map, k).rotation = rot;
+    s_trans_version++;
     G_UpdateBounds(uid);
 }
 
@@ -662,6 +666,7 @@ void Entity_SetScale(uint32_t uid, vec3_t scale)
         assert(status != -1);
     }
     kh_value(s_ent_trans_map, k).scale = scale;
+    s_trans_version++;
     G_UpdateBounds(uid);
 }
 
@@ -670,6 +675,7 @@ void Entity_Remove(uint32_t uid)
     khiter_t k = kh_get(trans, s_ent_trans_map, uid);
     if(k != kh_end(s_ent_trans_map)) {
         kh_del(trans, s_ent_trans_map, k);
+        s_trans_version++;
     }
 
     Entity_ClearTags(uid);
@@ -684,6 +690,11 @@ khash_t(trans) *Entity_CopyTransforms(void)
     return kh_copy_trans(s_ent_trans_map);
 }
 
+uint32_t Entity_TransformsVersion(void)
+{
+    return s_trans_version;
+}
+
 quat_t Entity_GetRotFrom(khash_t(trans) *table, uint32_t uid)
 {
     khiter_t k = kh_get(trans, table, uid);
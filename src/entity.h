@@ -162,6 +162,7 @@ void     Entity_SetScale(uint32_t uid, vec3_t scale);
 void     Entity_Remove(uint32_t uid);
 
 khash_t(trans) *Entity_CopyTransforms(void);
+uint32_t        Entity_TransformsVersion(void);
 quat_t          Entity_GetRotFrom(khash_t(trans) *table, uint32_t uid);
 vec3_t          Entity_GetScaleFrom(khash_t(trans) *table, uint32_t uid);
 void            Entity_ModelMatrixFrom(vec3_t pos, quat_t rot, vec3_t scale, mat4x4_t *out);
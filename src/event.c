@@ -465,7 +465,7 @@ void E_Shutdown(void)
 void E_ServiceQueue(void)
 {
     PERF_ENTER();
-    uint32_t ticks = SDL_GetTicks();
+    uint32_t ticks = G_Timer_Ticks();
 
     queue_event_t *queue = &s_event_queues[s_front_queue_idx];
     s_front_queue_idx = (s_front_queue_idx + 1) % 2;
@@ -619,7 +619,7 @@ size_t E_GetScriptHandlers(size_t max_out, struct script_handler *out)
 
 void E_Global_Notify(enum eventtype event, void *event_arg, enum event_source source)
 {
-    struct event e = (struct event){event, event_arg, source, GLOBAL_ID, SDL_GetTicks()};
+    struct event e = (struct event){event, event_arg, source, GLOBAL_ID, G_Timer_Ticks()};
     queue_event_push(&s_event_queues[s_front_queue_idx], &e);
 }
 
@@ -630,7 +630,7 @@ bool E_Global_Register(enum eventtype event, handler_t handler, void *user_arg,
     hd.handler.as_function = handler;
     hd.user_arg = user_arg;
     hd.simmask = simmask;
-    hd.register_tick = SDL_GetTicks();
+    hd.register_tick = G_Timer_Ticks();
 
     return e_register_handler(e_key(GLOBAL_ID, event), &hd);
 }
@@ -652,7 +652,7 @@ bool E_Global_ScriptRegister(enum eventtype event, script_opaque_t handler,
     hd.handler.as_script_callable = handler;
     hd.user_arg = user_arg;
     hd.simmask = simmask;
-    hd.register_tick = SDL_GetTicks();
+    hd.register_tick = G_Timer_Ticks();
 
     return e_register_handler(e_key(GLOBAL_ID, event), &hd);
 }
@@ -668,7 +668,7 @@ bool E_Global_ScriptUnregister(enum eventtype event, script_opaque_t handler)
 
 void E_Global_NotifyImmediate(enum eventtype event, void *event_arg, enum event_source source)
 {
-    struct event e = (struct event){event, event_arg, source, GLOBAL_ID, SDL_GetTicks()};
+    struct event e = (struct event){event, event_arg, source, GLOBAL_ID, G_Timer_Ticks()};
     e_handle_event(e, true);
 }
 
@@ -684,7 +684,7 @@ bool E_Entity_Register(enum eventtype event, uint32_t ent_uid, handler_t handler
     hd.handler.as_function = handler;
     hd.user_arg = user_arg;
     hd.simmask = simmask;
-    hd.register_tick = SDL_GetTicks();
+    hd.register_tick = G_Timer_Ticks();
 
     return e_register_handler(e_key(ent_uid, event), &hd);
 }
@@ -706,7 +706,7 @@ bool E_Entity_ScriptRegister(enum eventtype event, uint32_t ent_uid,
     hd.handler.as_script_callable = handler;
     hd.user_arg = user_arg;
     hd.simmask = simmask;
-    hd.register_tick = SDL_GetTicks();
+    hd.register_tick = G_Timer_Ticks();
 
     return e_register_handler(e_key(ent_uid, event), &hd);
 }
@@ -724,14 +724,14 @@ bool E_Entity_ScriptUnregister(enum eventtype event, uint32_t ent_uid,
 void E_Entity_Notify(enum eventtype event, uint32_t ent_uid, void *event_arg, 
                      enum event_source source)
 {
-    struct event e = (struct event){event, event_arg, source, ent_uid, SDL_GetTicks()};
+    struct event e = (struct event){event, event_arg, source, ent_uid, G_Timer_Ticks()};
     queue_event_push(&s_event_queues[s_front_queue_idx], &e);
 }
 
 void E_Entity_NotifyImmediate(enum eventtype event, uint32_t ent_uid, void *event_arg, 
                               enum event_source source)
 {
-    struct event e = (struct event){event, event_arg, source, ent_uid, SDL_GetTicks()};
+    struct event e = (struct event){event, event_arg, source, ent_uid, G_Timer_Ticks()};
     e_handle_event(e, true);
 }
 
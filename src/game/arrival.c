@@ -74,14 +74,11 @@
 #define ARRIVAL_SLOT_SPACING      (1.85f)  /* Inter-slot spacing, x unit radius */
 #define ARRIVAL_ZONE_PAD          (3)      /* Tiles of open border around the packed ball */
 
-/*****************************************************************************/
-/* STATIC VARIABLES                                                          */
-/*****************************************************************************/
-
-static vec2_t s_slot_sort_ref;
-static vec2_t s_slot_sort_axis;
-static vec2_t s_slot_sort_perp;
-static float  s_slot_sort_band;
+struct slot_key{
+    float primary;
+    float secondary;
+    int   idx;
+};
 
 /*****************************************************************************/
 /* STATIC FUNCTIONS                                                          */
@@ -115,30 +112,64 @@ static void unit_arm(struct arrival_unit_state *us)
         us->substate = ARRIVAL_SUBSTATE_SEEK_ARMED;
 }
 
-static int slot_cmp_near_ref(const void *a, const void *b)
+/* The sort keys are computed up-front instead of in the comparator so that 
+ * flocks can be updated from several threads at once. Ties fall back to the 
+ * original index, keeping the slot order independent of the qsort in use.
+ */
+static int slot_key_cmp(const void *a, const void *b)
+{
+    const struct slot_key *ka = a, *kb = b;
+    if(ka->primary != kb->primary)
+        return (ka->primary > kb->primary) - (ka->primary < kb->primary);
+    if(ka->secondary != kb->secondary)
+        return (ka->secondary > kb->secondary) - (ka->secondary < kb->secondary);
+    return (ka->idx > kb->idx) - (ka->idx < kb->idx);
+}
+
+static void arrival_sort_slots(struct arrival_state *as, struct slot_key *keys)
 {
-    vec2_t da, db;
-    PFM_Vec2_Sub((vec2_t*)a, &s_slot_sort_ref, &da);
-    PFM_Vec2_Sub((vec2_t*)b, &s_slot_sort_ref, &db);
-    float la = PFM_Vec2_Dot(&da, &da), lb = PFM_Vec2_Dot(&db, &db);
-    return (la > lb) - (la < lb);
+    int n = as->num_slots;
+    qsort(keys, n, sizeof(struct slot_key), slot_key_cmp);
+
+    STALLOC(vec2_t, sorted, n);
+    for(int i = 0; i < n; i++)
+        sorted[i] = as->slots[keys[i].idx];
+    memcpy(as->slots, sorted, sizeof(vec2_t) * n);
+    STFREE(sorted);
+}
+
+static void arrival_sort_slots_near_ref(struct arrival_state *as, vec2_t ref)
+{
+    STALLOC(struct slot_key, keys, as->num_slots);
+    for(int i = 0; i < as->num_slots; i++) {
+        vec2_t d;
+        PFM_Vec2_Sub(&as->slots[i], &ref, &d);
+        keys[i] = (struct slot_key){PFM_Vec2_Dot(&d, &d), 0.0f, i};
+    }
+    arrival_sort_slots(as, keys);
+    STFREE(keys);
 }
 
 /* Prioritize further bands over closer ones. This makes units tend to 
  * the opposite end of the goal region and "filling up the container".
  */
-static int slot_cmp_far_banded(const void *a, const void *b)
+static void arrival_sort_slots_far_banded(struct arrival_state *as, vec2_t ref, vec2_t axis,
+                                          float band)
 {
-    vec2_t ra, rb;
-    PFM_Vec2_Sub((vec2_t*)a, &s_slot_sort_ref, &ra);
-    PFM_Vec2_Sub((vec2_t*)b, &s_slot_sort_ref, &rb);
-    int ba = (int)floorf(PFM_Vec2_Dot(&ra, &s_slot_sort_axis) / s_slot_sort_band);
-    int bb = (int)floorf(PFM_Vec2_Dot(&rb, &s_slot_sort_axis) / s_slot_sort_band);
-    if(ba != bb)
-        return (ba < bb) - (ba > bb);   /* deeper band first */
-    float la = PFM_Vec2_Dot(&ra, &s_slot_sort_perp);
-    float lb = PFM_Vec2_Dot(&rb, &s_slot_sort_perp);
-    return (la > lb) - (la < lb);        /* lateral within the band */
+    vec2_t perp = (vec2_t){-axis.z, axis.x};
+    STALLOC(struct slot_key, keys, as->num_slots);
+    for(int i = 0; i < as->num_slots; i++) {
+        vec2_t r;
+        PFM_Vec2_Sub(&as->slots[i], &ref, &r);
+        int b = (int)floorf(PFM_Vec2_Dot(&r, &axis) / band);
+        keys[i] = (struct slot_key){
+            -(float)b,              /* deeper band first */
+            PFM_Vec2_Dot(&r, &perp), /* lateral within the band */
+            i
+        };
+    }
+    arrival_sort_slots(as, keys);
+    STFREE(keys);
 }
 
 /* The tile budget (area) to hold the entire flock. If blockers take up some
@@ -203,11 +234,10 @@ static void arrival_thin_centered_slots(struct arrival_state *as, const struct m
     M_NavGetResolution(map, &res);
     float tile_dim = (TILES_PER_CHUNK_WIDTH * X_COORDS_PER_TILE) / (float)res.tile_w;
     float fwd = (ARRIVAL_ZONE_PAD - 1) * tile_dim;
-    s_slot_sort_ref = (vec2_t){
+    arrival_sort_slots_near_ref(as, (vec2_t){
         as->centre.x + as->axis.x * fwd,
         as->centre.z + as->axis.z * fwd
-    };
-    qsort(as->slots, as->num_slots, sizeof(vec2_t), slot_cmp_near_ref);
+    });
 
     float sp2 = spacing * spacing;
     int kept = 0;
@@ -228,11 +258,6 @@ static void arrival_thin_centered_slots(struct arrival_state *as, const struct m
     as->num_slots = kept;
 }
 
-static void arrival_order_slots_far_near(struct arrival_state *as)
-{
-    qsort(as->slots, as->num_slots, sizeof(vec2_t), slot_cmp_far_banded);
-}
-
 static vec2_t arrival_approach_axis(const struct arrival_member *members, int n, vec2_t target_xz)
 {
     vec2_t centroid = (vec2_t){0.0f, 0.0f};
@@ -764,6 +789,17 @@ void G_Arrival_InitUnit(struct arrival_unit_state *us, vec2_t order_pos)
     us->order_pos = order_pos;
 }
 
+/* The flock update only ever commits a unit and (re)assigns its slot. Fold 
+ * those changes from a working copy back into the live unit state.
+ */
+void G_Arrival_MergeUnit(struct arrival_unit_state *dst, const struct arrival_unit_state *src)
+{
+    if(unit_committed(src))
+        unit_commit(dst);
+    dst->sink = src->sink;
+    dst->sink_valid = src->sink_valid;
+}
+
 void G_Arrival_UpdateFlock(struct arrival_state *as, const struct map *map, vec2_t target_xz,
                            enum nav_layer layer, float unit_radius, int total_members,
                            const struct arrival_member *members, int nmembers)
@@ -829,13 +865,8 @@ void G_Arrival_UpdateFlock(struct arrival_state *as, const struct map *map, vec2
         as->com = M_NavClosestPathable(map, layer, com, &com_snapped) ? com_snapped : com;
         as->com_dest_id = M_NavDestIDForPos(map, as->com, layer);
 
-        /* Sort frame for the far->near + lateral ordering. */
-        s_slot_sort_ref  = as->centre;
-        s_slot_sort_axis = as->axis;
-        s_slot_sort_perp = (vec2_t){-as->axis.z, as->axis.x};
-        s_slot_sort_band = ARRIVAL_SLOT_SPACING * unit_radius;
-
-        arrival_order_slots_far_near(as);
+        /* Far->near + lateral ordering about the centre. */
+        arrival_sort_slots_far_banded(as, as->centre, as->axis, ARRIVAL_SLOT_SPACING * unit_radius);
         as->row_height = ARRIVAL_SLOT_SPACING * unit_radius;
         arrival_compute_geodesic_rings(as, map, members, nmembers);
 
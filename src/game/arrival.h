@@ -138,6 +138,7 @@ struct arrival_member{
 void G_Arrival_InitFlock(struct arrival_state *as);
 void G_Arrival_Deactivate(struct arrival_state *as);
 void G_Arrival_InitUnit(struct arrival_unit_state *us, vec2_t order_pos);
+void G_Arrival_MergeUnit(struct arrival_unit_state *dst, const struct arrival_unit_state *src);
 bool G_Arrival_IsActive(const struct arrival_state *as);
 
 void G_Arrival_UpdateFlock(struct arrival_state *as, const struct map *map, vec2_t target_xz,
@@ -314,6 +314,7 @@ static void on_mousedown(void *user, void *event)
 
     if(nbuilding) {
         Entity_Ping(target);
+        G_Journal_NoteUnjournaled("build");
     }
 }
 
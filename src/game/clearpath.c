@@ -59,11 +59,13 @@
 #include "../render/public/render_ctrl.h"
 #include "../map/public/map.h"
 #include "../lib/public/pf_string.h"
+#include "../lib/public/simd.h"
 #include "../mem.h"
 
 #include <assert.h>
 #include <stdbool.h>
 #include <string.h>
+#include <math.h>
 
 #undef PF_MALLOC
 #undef PF_CALLOC
@@ -75,6 +77,11 @@
 
 #define EPSILON         (1.0/1024)
 #define MAX_SAVED_VOS   (512)
+/* The SoA ray arrays are padded to a multiple of the widest SIMD tier */
+#define CP_LANES        (16)
+#define LANES_CEIL(n)   ((((n) + CP_LANES - 1) / CP_LANES) * CP_LANES)
+#define ARR_SIZE(a)     (sizeof(a)/sizeof(a[0]))
+#define MAX(a, b)       ((a) > (b) ? (a) : (b))
 
 VEC_TYPE(vec2, vec2_t)
 VEC_IMPL(static inline, vec2, vec2_t)
@@ -97,6 +104,35 @@ struct HRVO{
     vec2_t xz_right_side;
 };
 
+/* The combined velocity obstacle in SoA form. The pair arrays hold one entry 
+ * per VO: the shared apex and the left and right edge directions. The ray 
+ * arrays hold the same edges as individual rays, (left, right) per VO. All 
+ * arrays are padded with NaNs up to a multiple of CP_LANES.
+ */
+struct cp_rays{
+    size_t n_pairs;
+    size_t n_rays;
+    float *apex_x,  *apex_z;
+    float *left_x,  *left_z;
+    float *right_x, *right_z;
+    float *ray_px,  *ray_pz;
+    float *ray_dx,  *ray_dz;
+};
+
+/* Buffers shared by all the agents of a batch, sized for the agent with 
+ * the most neighbours.
+ */
+struct cp_scratch{
+    struct HRVO   *hrvos;
+    struct VO     *vos;
+    struct cp_rays rays;
+    vec2_t        *isec;
+    vec_vec2_t     xpoints;
+};
+
+typedef bool   (*cp_inside_pcr_fn)(const struct cp_rays*, vec2_t);
+typedef size_t (*cp_ray_xpoints_fn)(const struct cp_rays*, size_t, vec2_t*);
+
 struct saved_ctx{
     struct cp_ent cpent;
     vec2_t        ent_des_v;
@@ -114,7 +150,10 @@ struct saved_ctx{
 /* STATIC VARIABLES                                                          */
 /*****************************************************************************/
 
-static struct saved_ctx s_debug_saved;
+static struct saved_ctx  s_debug_saved;
+/* Selected once at init, based on the widest SIMD tier the CPU supports */
+static cp_inside_pcr_fn  s_inside_pcr = NULL;
+static cp_ray_xpoints_fn s_ray_xpoints = NULL;
 
 /*****************************************************************************/
 /* STATIC FUNCTIONS                                                          */
@@ -245,123 +284,333 @@ static size_t compute_all_hrvos(struct cp_ent ent, vec_cp_ent_t dyn_neighbs,
     return ret;
 }
 
-/* Points exactly 'on' the boundary will be considered as 'not inside' of the PCR for our purposes. */
-static bool inside_pcr(const struct line_2d *vo_lr_pairs, size_t n_rays, vec2_t test)
+/* Points exactly 'on' the boundary will be considered as 'not inside' of the PCR for our purposes. 
+ * The apex-to-point vector is not normalized; instead the determinants are compared against 
+ * an epsilon scaled by its' length, which is equivalent and keeps the test free of divisions.
+ */
+static bool inside_pcr_scalar(const struct cp_rays *rays, vec2_t test)
 {
-    assert(n_rays % 2 == 0);
-    for(int i = 0; i < n_rays; i+=2) {
-
-        assert(fabs(PFM_Vec2_Len(&vo_lr_pairs[i + 0].dir) - 1.0f) < EPSILON);
-        const float left_dir_x = vo_lr_pairs[i + 0].dir.x;
-        const float left_dir_z = vo_lr_pairs[i + 0].dir.z;
+    for(size_t i = 0; i < rays->n_pairs; i++) {
 
-        vec2_t point_to_test;
-        PFM_Vec2_Sub(&test, (vec2_t*)&vo_lr_pairs[i + 0].point, &point_to_test);
-        if(PFM_Vec2_Len(&point_to_test) < EPSILON)
+        const float px = test.x - rays->apex_x[i];
+        const float pz = test.z - rays->apex_z[i];
+        const float len = sqrtf(px * px + pz * pz);
+        if(!(len >= (float)EPSILON))
             continue;
-        PFM_Vec2_Normal(&point_to_test, &point_to_test);
 
-        float left_det = (point_to_test.z * left_dir_x) - (point_to_test.x * left_dir_z);
-        bool left_of_vo = (left_det < EPSILON);
+        const float lim = (float)EPSILON * len;
+        const float left_det = (pz * rays->left_x[i]) - (px * rays->left_z[i]);
+        const float right_det = (pz * rays->right_x[i]) - (px * rays->right_z[i]);
+
+        if(left_det >= lim && right_det <= -lim)
+            return true;
+    }
+    return false;
+}
+
+/* Intersects ray 'i' with all the other rays, writing the intersection points 
+ * to 'out' in the order of the rays. Parallel rays do not intersect.
+ */
+static size_t ray_xpoints_scalar(const struct cp_rays *rays, size_t i, vec2_t *out)
+{
+    const float p1x = rays->ray_px[i], p1z = rays->ray_pz[i];
+    const float d1x = rays->ray_dx[i], d1z = rays->ray_dz[i];
+    size_t ret = 0;
+
+    for(size_t j = 0; j < rays->n_rays; j++) {
 
-        if(left_of_vo)
+        if(j == i)
             continue;
 
-        assert(fabs(PFM_Vec2_Len(&vo_lr_pairs[i + 1].dir) - 1.0f) < EPSILON);
-        const float right_dir_x = vo_lr_pairs[i + 1].dir.x;
-        const float right_dir_z = vo_lr_pairs[i + 1].dir.z;
+        const float denom = (d1x * rays->ray_dz[j]) - (d1z * rays->ray_dx[j]);
+        if(!(fabsf(denom) >= (float)EPSILON))
+            continue;
 
-        PFM_Vec2_Sub(&test, (vec2_t*)&vo_lr_pairs[i + 1].point, &point_to_test);
-        if(PFM_Vec2_Len(&point_to_test) < EPSILON)
+        const float wx = rays->ray_px[j] - p1x;
+        const float wz = rays->ray_pz[j] - p1z;
+        const float t = ((wx * rays->ray_dz[j]) - (wz * rays->ray_dx[j])) / denom;
+        const float s = ((wx * d1z) - (wz * d1x)) / denom;
+        if(!(t >= 0.0f && s >= 0.0f))
             continue;
-        PFM_Vec2_Normal(&point_to_test, &point_to_test);
 
-        float right_det = (point_to_test.z * right_dir_x) - (point_to_test.x * right_dir_z);
-        bool right_of_vo = (right_det > -EPSILON);
+        out[ret++] = (vec2_t){p1x + t * d1x, p1z + t * d1z};
+    }
+    return ret;
+}
+
+SIMD_TARGET_AVX2
+static bool inside_pcr_avx2(const struct cp_rays *rays, vec2_t test)
+{
+    const __m256 tx = _mm256_set1_ps(test.x);
+    const __m256 tz = _mm256_set1_ps(test.z);
+    const __m256 eps = _mm256_set1_ps((float)EPSILON);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+
+    for(size_t i = 0; i < rays->n_pairs; i += 8) {
+
+        __m256 px = _mm256_sub_ps(tx, _mm256_loadu_ps(rays->apex_x + i));
+        __m256 pz = _mm256_sub_ps(tz, _mm256_loadu_ps(rays->apex_z + i));
+        __m256 len = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(px, px), _mm256_mul_ps(pz, pz)));
+        __m256 lim = _mm256_mul_ps(eps, len);
+
+        __m256 left_det = _mm256_sub_ps(
+            _mm256_mul_ps(pz, _mm256_loadu_ps(rays->left_x + i)),
+            _mm256_mul_ps(px, _mm256_loadu_ps(rays->left_z + i)));
+        __m256 right_det = _mm256_sub_ps(
+            _mm256_mul_ps(pz, _mm256_loadu_ps(rays->right_x + i)),
+            _mm256_mul_ps(px, _mm256_loadu_ps(rays->right_z + i)));
+
+        __m256 inside = _mm256_and_ps(_mm256_cmp_ps(len, eps, _CMP_GE_OQ),
+            _mm256_and_ps(_mm256_cmp_ps(left_det, lim, _CMP_GE_OQ),
+                          _mm256_cmp_ps(right_det, _mm256_xor_ps(lim, sign), _CMP_LE_OQ)));
+        if(_mm256_movemask_ps(inside))
+            return true;
+    }
+    return false;
+}
+
+SIMD_TARGET_AVX2
+static size_t ray_xpoints_avx2(const struct cp_rays *rays, size_t i, vec2_t *out)
+{
+    const __m256 p1x = _mm256_set1_ps(rays->ray_px[i]);
+    const __m256 p1z = _mm256_set1_ps(rays->ray_pz[i]);
+    const __m256 d1x = _mm256_set1_ps(rays->ray_dx[i]);
+    const __m256 d1z = _mm256_set1_ps(rays->ray_dz[i]);
+    const __m256 eps = _mm256_set1_ps((float)EPSILON);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    size_t ret = 0;
+
+    for(size_t j = 0; j < rays->n_rays; j += 8) {
+
+        __m256 d2x = _mm256_loadu_ps(rays->ray_dx + j);
+        __m256 d2z = _mm256_loadu_ps(rays->ray_dz + j);
+        __m256 wx = _mm256_sub_ps(_mm256_loadu_ps(rays->ray_px + j), p1x);
+        __m256 wz = _mm256_sub_ps(_mm256_loadu_ps(rays->ray_pz + j), p1z);
 
-        if(right_of_vo)
+        __m256 denom = _mm256_sub_ps(_mm256_mul_ps(d1x, d2z), _mm256_mul_ps(d1z, d2x));
+        __m256 t = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(wx, d2z), _mm256_mul_ps(wz, d2x)), denom);
+        __m256 s = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(wx, d1z), _mm256_mul_ps(wz, d1x)), denom);
+
+        __m256 hit = _mm256_and_ps(_mm256_cmp_ps(_mm256_and_ps(denom, abs_mask), eps, _CMP_GE_OQ),
+            _mm256_and_ps(_mm256_cmp_ps(t, zero, _CMP_GE_OQ), _mm256_cmp_ps(s, zero, _CMP_GE_OQ)));
+
+        unsigned mask = (unsigned)_mm256_movemask_ps(hit);
+        if(i >= j && i - j < 8)
+            mask &= ~(1u << (i - j));
+        if(!mask)
             continue;
 
-        assert(!left_of_vo && !right_of_vo);
-        return true;
+        float xs[8], zs[8];
+        _mm256_storeu_ps(xs, _mm256_add_ps(p1x, _mm256_mul_ps(t, d1x)));
+        _mm256_storeu_ps(zs, _mm256_add_ps(p1z, _mm256_mul_ps(t, d1z)));
+        while(mask) {
+            unsigned b = SIMD_CTZ32(mask);
+            mask &= mask - 1u;
+            out[ret++] = (vec2_t){xs[b], zs[b]};
+        }
     }
+    return ret;
+}
 
+SIMD_TARGET_AVX512F
+static bool inside_pcr_avx512(const struct cp_rays *rays, vec2_t test)
+{
+    const __m512 tx = _mm512_set1_ps(test.x);
+    const __m512 tz = _mm512_set1_ps(test.z);
+    const __m512 eps = _mm512_set1_ps((float)EPSILON);
+
+    for(size_t i = 0; i < rays->n_pairs; i += 16) {
+
+        __m512 px = _mm512_sub_ps(tx, _mm512_loadu_ps(rays->apex_x + i));
+        __m512 pz = _mm512_sub_ps(tz, _mm512_loadu_ps(rays->apex_z + i));
+        __m512 len = _mm512_sqrt_ps(_mm512_add_ps(_mm512_mul_ps(px, px), _mm512_mul_ps(pz, pz)));
+        __m512 lim = _mm512_mul_ps(eps, len);
+
+        __m512 left_det = _mm512_sub_ps(
+            _mm512_mul_ps(pz, _mm512_loadu_ps(rays->left_x + i)),
+            _mm512_mul_ps(px, _mm512_loadu_ps(rays->left_z + i)));
+        __m512 right_det = _mm512_sub_ps(
+            _mm512_mul_ps(pz, _mm512_loadu_ps(rays->right_x + i)),
+            _mm512_mul_ps(px, _mm512_loadu_ps(rays->right_z + i)));
+
+        __mmask16 inside = _mm512_cmp_ps_mask(len, eps, _CMP_GE_OQ)
+                         & _mm512_cmp_ps_mask(left_det, lim, _CMP_GE_OQ)
+                         & _mm512_cmp_ps_mask(right_det, _mm512_sub_ps(_mm512_setzero_ps(), lim), _CMP_LE_OQ);
+        if(inside)
+            return true;
+    }
     return false;
 }
 
+SIMD_TARGET_AVX512F
+static size_t ray_xpoints_avx512(const struct cp_rays *rays, size_t i, vec2_t *out)
+{
+    const __m512 p1x = _mm512_set1_ps(rays->ray_px[i]);
+    const __m512 p1z = _mm512_set1_ps(rays->ray_pz[i]);
+    const __m512 d1x = _mm512_set1_ps(rays->ray_dx[i]);
+    const __m512 d1z = _mm512_set1_ps(rays->ray_dz[i]);
+    const __m512 eps = _mm512_set1_ps((float)EPSILON);
+    const __m512 zero = _mm512_setzero_ps();
+    size_t ret = 0;
+
+    for(size_t j = 0; j < rays->n_rays; j += 16) {
+
+        __m512 d2x = _mm512_loadu_ps(rays->ray_dx + j);
+        __m512 d2z = _mm512_loadu_ps(rays->ray_dz + j);
+        __m512 wx = _mm512_sub_ps(_mm512_loadu_ps(rays->ray_px + j), p1x);
+        __m512 wz = _mm512_sub_ps(_mm512_loadu_ps(rays->ray_pz + j), p1z);
+
+        __m512 denom = _mm512_sub_ps(_mm512_mul_ps(d1x, d2z), _mm512_mul_ps(d1z, d2x));
+        __m512 t = _mm512_div_ps(_mm512_sub_ps(_mm512_mul_ps(wx, d2z), _mm512_mul_ps(wz, d2x)), denom);
+        __m512 s = _mm512_div_ps(_mm512_sub_ps(_mm512_mul_ps(wx, d1z), _mm512_mul_ps(wz, d1x)), denom);
+
+        unsigned mask = (unsigned)(_mm512_cmp_ps_mask(_mm512_abs_ps(denom), eps, _CMP_GE_OQ)
+                                 & _mm512_cmp_ps_mask(t, zero, _CMP_GE_OQ)
+                                 & _mm512_cmp_ps_mask(s, zero, _CMP_GE_OQ));
+        if(i >= j && i - j < 16)
+            mask &= ~(1u << (i - j));
+        if(!mask)
+            continue;
+
+        float xs[16], zs[16];
+        _mm512_storeu_ps(xs, _mm512_add_ps(p1x, _mm512_mul_ps(t, d1x)));
+        _mm512_storeu_ps(zs, _mm512_add_ps(p1z, _mm512_mul_ps(t, d1z)));
+        while(mask) {
+            unsigned b = SIMD_CTZ32(mask);
+            mask &= mask - 1u;
+            out[ret++] = (vec2_t){xs[b], zs[b]};
+        }
+    }
+    return ret;
+}
+
+/* The edge tests are short and run O(n^3) times per agent in a dense crowd, 
+ * so the widest tier the CPU supports is used for both of them.
+ */
+static void init_simd(void)
+{
+    if(s_inside_pcr != NULL)
+        return;
+
+    if(SIMD_HAS_TARGET_AVX512F && simd_avx512_supported()) {
+        s_inside_pcr = inside_pcr_avx512;
+        s_ray_xpoints = ray_xpoints_avx512;
+    }else if(SIMD_HAS_TARGET_AVX2 && simd_avx2_supported()) {
+        s_inside_pcr = inside_pcr_avx2;
+        s_ray_xpoints = ray_xpoints_avx2;
+    }else{
+        s_inside_pcr = inside_pcr_scalar;
+        s_ray_xpoints = ray_xpoints_scalar;
+    }
+}
+
+static void pad_lanes(float *arr, size_t begin, size_t end)
+{
+    for(size_t i = begin; i < end; i++)
+        arr[i] = NAN;
+}
+
 static void rays_repr(const struct HRVO *hrvos, size_t n_hrvos,
                       const struct VO *vos, size_t n_vos,
-                      struct line_2d *out)
+                      struct cp_rays *out)
 {
-    size_t rays_idx  = 0;
+    size_t pair_idx = 0;
 
     for(int i = 0; i < n_hrvos; i++) {
-         
-        out[rays_idx + 0].point = hrvos[i].xz_apex;
-        out[rays_idx + 0].dir = hrvos[i].xz_left_side;
 
-        out[rays_idx + 1].point = hrvos[i].xz_apex;
-        out[rays_idx + 1].dir = hrvos[i].xz_right_side;
-
-        rays_idx += 2;
+        out->apex_x[pair_idx] = hrvos[i].xz_apex.x;
+        out->apex_z[pair_idx] = hrvos[i].xz_apex.z;
+        out->left_x[pair_idx] = hrvos[i].xz_left_side.x;
+        out->left_z[pair_idx] = hrvos[i].xz_left_side.z;
+        out->right_x[pair_idx] = hrvos[i].xz_right_side.x;
+        out->right_z[pair_idx] = hrvos[i].xz_right_side.z;
+        pair_idx++;
     }
 
     for(int i = 0; i < n_vos; i++) {
-    
-        out[rays_idx + 0].point = vos[i].xz_apex;
-        out[rays_idx + 0].dir = vos[i].xz_left_side;
 
-        out[rays_idx + 1].point = vos[i].xz_apex;
-        out[rays_idx + 1].dir = vos[i].xz_right_side;
+        out->apex_x[pair_idx] = vos[i].xz_apex.x;
+        out->apex_z[pair_idx] = vos[i].xz_apex.z;
+        out->left_x[pair_idx] = vos[i].xz_left_side.x;
+        out->left_z[pair_idx] = vos[i].xz_left_side.z;
+        out->right_x[pair_idx] = vos[i].xz_right_side.x;
+        out->right_z[pair_idx] = vos[i].xz_right_side.z;
+        pair_idx++;
+    }
+
+    out->n_pairs = pair_idx;
+    out->n_rays = pair_idx * 2;
+
+    for(size_t i = 0; i < out->n_pairs; i++) {
+
+        assert(fabs(sqrtf(out->left_x[i] * out->left_x[i] 
+                        + out->left_z[i] * out->left_z[i]) - 1.0f) < EPSILON);
+        assert(fabs(sqrtf(out->right_x[i] * out->right_x[i] 
+                        + out->right_z[i] * out->right_z[i]) - 1.0f) < EPSILON);
+
+        out->ray_px[2 * i + 0] = out->apex_x[i];
+        out->ray_pz[2 * i + 0] = out->apex_z[i];
+        out->ray_dx[2 * i + 0] = out->left_x[i];
+        out->ray_dz[2 * i + 0] = out->left_z[i];
 
-        rays_idx += 2;
+        out->ray_px[2 * i + 1] = out->apex_x[i];
+        out->ray_pz[2 * i + 1] = out->apex_z[i];
+        out->ray_dx[2 * i + 1] = out->right_x[i];
+        out->ray_dz[2 * i + 1] = out->right_z[i];
     }
+
+    /* NaN lanes fail every comparison, so the padding never tests as 
+     * inside the PCR or as an intersection.
+     */
+    const size_t pairs_end = LANES_CEIL(out->n_pairs);
+    const size_t rays_end = LANES_CEIL(out->n_rays);
+    float *pair_arrs[] = {out->apex_x, out->apex_z, out->left_x, out->left_z, out->right_x, out->right_z};
+    float *ray_arrs[] = {out->ray_px, out->ray_pz, out->ray_dx, out->ray_dz};
+
+    for(int i = 0; i < ARR_SIZE(pair_arrs); i++)
+        pad_lanes(pair_arrs[i], out->n_pairs, pairs_end);
+    for(int i = 0; i < ARR_SIZE(ray_arrs); i++)
+        pad_lanes(ray_arrs[i], out->n_rays, rays_end);
 }
 
-static size_t compute_vo_xpoints(struct line_2d *rays, size_t n_rays, vec_vec2_t *inout)
+static size_t compute_vo_xpoints(const struct cp_rays *rays, vec2_t *isec_buff, vec_vec2_t *inout)
 {
     size_t ret = 0;
-    for(int i = 0; i < n_rays; i++) {
-    for(int j = 0; j < n_rays; j++) {
-
-        if(i == j) 
-            continue;
+    for(size_t i = 0; i < rays->n_rays; i++) {
 
-        vec2_t isec_point;
-        if(!C_RayRayIntersection2D(rays[i], rays[j], &isec_point))
-            continue;
-
-        if(inside_pcr(rays, n_rays, isec_point))
-            continue;
+        size_t nisec = s_ray_xpoints(rays, i, isec_buff);
+        for(size_t j = 0; j < nisec; j++) {
 
-        vec_vec2_push(inout, isec_point);
-        ret++;
-    }}
+            if(s_inside_pcr(rays, isec_buff[j]))
+                continue;
 
+            vec_vec2_push(inout, isec_buff[j]);
+            ret++;
+        }
+    }
     return ret;
 }
 
-static size_t compute_vdes_proj_points(struct line_2d *rays, size_t n_rays,
+static size_t compute_vdes_proj_points(const struct cp_rays *rays,
                                        vec2_t des_v, vec_vec2_t *inout)
 {
-    vec2_t proj;
     size_t ret = 0;
 
-    for(int i = 0; i < n_rays; i++) {
-    
-        assert(fabs(PFM_Vec2_Len(&rays[i].dir) - 1.0f) < EPSILON);
+    for(size_t i = 0; i < rays->n_rays; i++) {
 
-        float len = PFM_Vec2_Dot(&rays[i].dir, &des_v);
-        PFM_Vec2_Scale(&rays[i].dir, len, &proj);
-        PFM_Vec2_Add(&rays[i].point, &proj, &proj);
+        const float len = rays->ray_dx[i] * des_v.x + rays->ray_dz[i] * des_v.z;
+        vec2_t proj = (vec2_t){
+            rays->ray_px[i] + rays->ray_dx[i] * len,
+            rays->ray_pz[i] + rays->ray_dz[i] * len
+        };
+
+        if(!s_inside_pcr(rays, proj)) {
 
-        if(!inside_pcr(rays, n_rays, proj)) {
-        
             vec_vec2_push(inout, proj);
             ret++;
         }
     }
-
     return ret;
 }
 
@@ -550,19 +799,19 @@ static void on_render_3d(void *user, void *event)
 }
 
 static bool clearpath_new_velocity(struct cp_ent cpent,
-                                   uint32_t ent_uid,
                                    vec2_t ent_des_v,
                                    const vec_cp_ent_t dyn_neighbs,
                                    const vec_cp_ent_t stat_neighbs,
                                    bool save_debug,
+                                   struct cp_scratch *scratch,
                                    vec2_t *out)
 {
-    bool status = false;
-    STALLOC(struct HRVO, dyn_hrvos, vec_size(&dyn_neighbs));
-    STALLOC(struct VO, stat_vos, vec_size(&stat_neighbs));
+    struct HRVO *dyn_hrvos = scratch->hrvos;
+    struct VO *stat_vos = scratch->vos;
+    struct cp_rays *rays = &scratch->rays;
 
     size_t n_hrvos = compute_all_hrvos(cpent, dyn_neighbs, dyn_hrvos);
-    size_t n_vos = compute_all_vos(cpent, stat_neighbs, (struct VO*)stat_vos);
+    size_t n_vos = compute_all_vos(cpent, stat_neighbs, stat_vos);
 
     /* We may have skipped the neighbours that are at the exact same 
      * or nearly same position as the entity.
@@ -574,8 +823,6 @@ static bool clearpath_new_velocity(struct cp_ent cpent,
      * of velocity obstacles, we represent the combined hybrid reciprocal velocity 
      * obstacle as a union of line segments. 
      */
-    const size_t n_rays = (n_hrvos + n_vos) * 2;
-    STALLOC(struct line_2d, rays, n_rays);
     rays_repr(dyn_hrvos, n_hrvos, stat_vos, n_vos, rays);
 
     if(save_debug) {
@@ -599,54 +846,44 @@ static bool clearpath_new_velocity(struct cp_ent cpent,
     vec2_t des_v_ws;
     PFM_Vec2_Add(&cpent.xz_pos, &ent_des_v, &des_v_ws);
 
-    if(!inside_pcr(rays, n_rays, des_v_ws)) {
+    if(!s_inside_pcr(rays, des_v_ws)) {
 
         s_debug_saved.des_v_in_pcr = false;
         *out = ent_des_v;
-        status = true;
-        goto out;
+        return true;
     }
 
-    vec_vec2_t xpoints;
-    vec_vec2_init(&xpoints);
+    vec_vec2_t *xpoints = &scratch->xpoints;
+    vec_vec2_reset(xpoints);
 
     /* The line segments are intersected pairwise and the intersection points 
      * inside the combined hybrid reciprocal velocity obstacle are discarded. 
      * The remaining intersection points are permissible new velocities on the 
      * boundary of the combined hybrid reciprocal velocity obstacle.
      */
-    compute_vo_xpoints(rays, n_rays, &xpoints); 
+    compute_vo_xpoints(rays, scratch->isec, xpoints); 
 
     /* In addition we project the preferred velocity (des_v) on to the line 
      * segments (xz_left_side and xz_right_side of each hrvo) and also retain 
      * those points that are outside the combined hybrid reciprocal velocity 
      * obstacle.
      */
-    compute_vdes_proj_points(rays, n_rays, ent_des_v, &xpoints);
+    compute_vdes_proj_points(rays, ent_des_v, xpoints);
 
-    if(vec_size(&xpoints) == 0) {
-        vec_vec2_destroy(&xpoints);
-        goto out;    
-    }
+    if(vec_size(xpoints) == 0)
+        return false;
 
-    vec2_t ret = compute_vnew(&xpoints, ent_des_v, cpent.xz_pos);
+    vec2_t ret = compute_vnew(xpoints, ent_des_v, cpent.xz_pos);
 
     if(save_debug) {
     
-        vec_vec2_copy(&s_debug_saved.xpoints, &xpoints);
+        vec_vec2_copy(&s_debug_saved.xpoints, xpoints);
         s_debug_saved.v_new = ret;
         s_debug_saved.des_v_in_pcr = true;
     }
 
-    vec_vec2_destroy(&xpoints);
     *out = ret;
-    status = true;
-
-out:
-    STFREE(dyn_hrvos);
-    STFREE(stat_vos);
-    STFREE(rays);
-    return status;
+    return true;
 }
 
 static bool entities_equal(uint32_t *a, uint32_t *b)
@@ -683,6 +920,7 @@ void G_ClearPath_Init(const struct map *map)
     E_Global_Register(EVENT_RENDER_3D_POST, on_render_3d, (struct map*)map, 
         G_RUNNING | G_PAUSED_FULL | G_PAUSED_UI_RUNNING);
     vec_vec2_init(&s_debug_saved.xpoints);
+    init_simd();
 }
 
 void G_ClearPath_Shutdown(void)
@@ -691,26 +929,84 @@ void G_ClearPath_Shutdown(void)
     vec_vec2_destroy(&s_debug_saved.xpoints);
 }
 
-vec2_t G_ClearPath_NewVelocity(struct cp_ent cpent,
-                               uint32_t ent_uid,
-                               vec2_t ent_des_v,
-                               vec_cp_ent_t dyn_neighbs,
-                               vec_cp_ent_t stat_neighbs,
-                               bool save_debug)
+void G_ClearPath_NewVelocities(const struct cp_batch *batch, vec2_t *out)
 {
     PERF_ENTER();
 
-    do{
-        vec2_t ret;
-        bool found = clearpath_new_velocity(cpent, ent_uid, ent_des_v, 
-            dyn_neighbs, stat_neighbs, save_debug, &ret);
-        if(found)
-            PERF_RETURN(ret);
+    size_t max_dyn = 0, max_stat = 0;
+    for(size_t i = 0; i < batch->nagents; i++) {
+        max_dyn = MAX(max_dyn, vec_size(&batch->dyn_neighbs[i]));
+        max_stat = MAX(max_stat, vec_size(&batch->stat_neighbs[i]));
+    }
+
+    /* All the agents of the batch share the same scratch buffers */
+    const size_t pairs_cap = MAX(LANES_CEIL(max_dyn + max_stat), CP_LANES);
+    const size_t rays_cap = pairs_cap * 2;
+
+    STALLOC(struct HRVO, hrvos, max_dyn + 1);
+    STALLOC(struct VO, vos, max_stat + 1);
+    STALLOC(float, soa, pairs_cap * 6 + rays_cap * 4);
+    STALLOC(vec2_t, isec, rays_cap);
+
+    struct cp_scratch scratch = (struct cp_scratch){
+        .hrvos = hrvos,
+        .vos = vos,
+        .rays = (struct cp_rays){
+            .apex_x  = soa + pairs_cap * 0,
+            .apex_z  = soa + pairs_cap * 1,
+            .left_x  = soa + pairs_cap * 2,
+            .left_z  = soa + pairs_cap * 3,
+            .right_x = soa + pairs_cap * 4,
+            .right_z = soa + pairs_cap * 5,
+            .ray_px  = soa + pairs_cap * 6 + rays_cap * 0,
+            .ray_pz  = soa + pairs_cap * 6 + rays_cap * 1,
+            .ray_dx  = soa + pairs_cap * 6 + rays_cap * 2,
+            .ray_dz  = soa + pairs_cap * 6 + rays_cap * 3,
+        },
+        .isec = isec,
+    };
+    vec_vec2_init(&scratch.xpoints);
 
-        remove_furthest(cpent.xz_pos, &dyn_neighbs, &stat_neighbs);
+    for(size_t i = 0; i < batch->nagents; i++) {
 
-    }while(vec_size(&dyn_neighbs) > 0 && vec_size(&stat_neighbs) > 0);
+        vec_cp_ent_t dyn_neighbs = batch->dyn_neighbs[i];
+        vec_cp_ent_t stat_neighbs = batch->stat_neighbs[i];
+        out[i] = (vec2_t){0.0f, 0.0f};
 
-    PERF_RETURN((vec2_t){0.0f, 0.0f});
+        do{
+            bool found = clearpath_new_velocity(batch->ents[i], batch->des_vs[i], 
+                dyn_neighbs, stat_neighbs, batch->save_debug[i], &scratch, &out[i]);
+            if(found)
+                break;
+
+            remove_furthest(batch->ents[i].xz_pos, &dyn_neighbs, &stat_neighbs);
+
+        }while(vec_size(&dyn_neighbs) > 0 && vec_size(&stat_neighbs) > 0);
+    }
+
+    vec_vec2_destroy(&scratch.xpoints);
+    STFREE(hrvos);
+    STFREE(vos);
+    STFREE(soa);
+    STFREE(isec);
+    PERF_RETURN_VOID();
 }
 
+vec2_t G_ClearPath_NewVelocity(struct cp_ent cpent,
+                               uint32_t ent_uid,
+                               vec2_t ent_des_v,
+                               vec_cp_ent_t dyn_neighbs,
+                               vec_cp_ent_t stat_neighbs,
+                               bool save_debug)
+{
+    vec2_t ret;
+    G_ClearPath_NewVelocities(&(struct cp_batch){
+        .nagents = 1,
+        .ents = &cpent,
+        .des_vs = &ent_des_v,
+        .dyn_neighbs = &dyn_neighbs,
+        .stat_neighbs = &stat_neighbs,
+        .save_debug = &save_debug,
+    }, &ret);
+    return ret;
+}
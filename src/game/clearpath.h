@@ -59,6 +59,19 @@ struct cp_ent{
 VEC_TYPE(cp_ent, struct cp_ent)
 VEC_IMPL(static inline, cp_ent, struct cp_ent)
 
+/* A block of agents whose new velocities are computed together. All the 
+ * arrays hold 'nagents' entries. The neighbour vectors are borrowed and 
+ * their contents may be reordered by the solver.
+ */
+struct cp_batch{
+    size_t               nagents;
+    const struct cp_ent *ents;
+    const vec2_t        *des_vs;
+    const vec_cp_ent_t  *dyn_neighbs;
+    const vec_cp_ent_t  *stat_neighbs;
+    const bool          *save_debug;
+};
+
 void G_ClearPath_Init(const struct map *map);
 void G_ClearPath_Shutdown(void);
 bool G_ClearPath_ShouldSaveDebug(uint32_t ent_uid);
@@ -69,6 +82,7 @@ vec2_t G_ClearPath_NewVelocity(struct cp_ent ent,
                                vec_cp_ent_t dyn_neighbs,
                                vec_cp_ent_t stat_neighbs,
                                bool save_debug);
+void   G_ClearPath_NewVelocities(const struct cp_batch *batch, vec2_t *out);
 
 #endif
 
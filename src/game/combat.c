@@ -44,6 +44,8 @@
 #include "fog_of_war.h"
 #include "position.h"
 #include "garrison.h"
+#include "snapshot.h"
+#include "journal.h"
 #include "public/game.h"
 #include "../ui.h"
 #include "../event.h"
@@ -83,12 +85,11 @@
 #define EPSILON                      (1.0f/1024)
 #define DEFAULT_ATTACK_PERIOD        (4.0f/3.0f)
 #define COMBAT_FIRE_FACING_TOLERANCE (15.0f)
+#define ARR_SIZE(a)                  (sizeof(a)/sizeof(a[0]))
 #define MAX(a, b)                    ((a) > (b) ? (a) : (b))
 #define MIN(a, b)                    ((a) < (b) ? (a) : (b))
-#define ARR_SIZE(a)                  (sizeof(a)/sizeof(a[0]))
 #define X_BINS_PER_CHUNK             (8)
 #define Z_BINS_PER_CHUNK             (8)
-#define MAX_COMBAT_TASKS             (64)
 #define DEFAULT_CORPSE_DURATION_SECS (30)
 
 #define CHK_TRUE_RET(_pred)         \
@@ -158,6 +159,9 @@ struct combatstate{
      */
     bool               attack_notified;
     bool               sticky;
+    /* Set once the entity is zombified, until the snapshot flags catch up. 
+     * The snapshot tables are shared and must not be written to. */
+    bool               zombie;
     uint32_t           target_uid;
     /* If the target gained a target while moving, save and restore
      * its' intial move command once it finishes combat. */
@@ -199,16 +203,12 @@ struct combat_work_out{
     struct attr        action_args[2];
 };
 
-struct combat_task_arg{
-    size_t begin_idx;
-    size_t end_idx;
-};
-
 /* The substet of the gamestate necessary
  * for deriving the next combat state for 
  * each entity.
  */
 struct combat_gamestate{
+    struct gs_snapshot    *snapshot;
     uint16_t               factions;
     uint16_t               player_factions;
     bool                   fog_enabled;
@@ -218,6 +218,7 @@ struct combat_gamestate{
     void                  *transforms;
     khash_t(range)        *sel_radiuses;
     khash_t(id)           *faction_ids;
+    const struct gs_columns *columns;
     enum diplomacy_state (*diptable)[MAX_FACTIONS];
     void                  *buildstate;
     khash_t(aabb)         *aabbs;
@@ -230,9 +231,6 @@ struct combat_work{
     struct combat_work_in  *in;
     struct combat_work_out *out;
     size_t                  nwork;
-    size_t                  ntasks;
-    uint32_t                tids[MAX_COMBAT_TASKS];
-    struct future           futures[MAX_COMBAT_TASKS];
 };
 
 enum combat_cmd_type{
@@ -388,11 +386,62 @@ static struct proj_fire_desc combat_default_fire(void)
     };
 }
 
-static bool enemies(uint32_t a, uint32_t b)
+struct hot_state{
+    uint32_t flags;
+    vec2_t   xz_pos;
+    float    radius;
+    int      faction_id;
+};
+
+/* The columns only hold the entities that had a position when the snapshot 
+ * was built. Anything else is read from the tables. 
+ */
+static inline uint32_t combat_column_index(uint32_t uid)
+{
+    const struct gs_columns *cols = s_combat_work.gamestate.columns;
+    return cols ? G_Columns_Index(cols, uid) : PF_SSET_NONE;
+}
+
+static struct hot_state combat_hot_state(uint32_t uid)
+{
+    struct combat_gamestate *gs = &s_combat_work.gamestate;
+    uint32_t idx = combat_column_index(uid);
+
+    if(idx != PF_SSET_NONE) {
+        return (struct hot_state){
+            .flags = gs->columns->flags[idx],
+            .xz_pos = gs->columns->xz_pos[idx],
+            .radius = gs->columns->sel_radius[idx],
+            .faction_id = gs->columns->faction_id[idx]
+        };
+    }
+    return (struct hot_state){
+        .flags = G_FlagsGetFrom(gs->flags, uid),
+        .xz_pos = G_Pos_GetXZFrom(gs->positions, uid),
+        .radius = G_GetSelectionRadiusFrom(gs->sel_radiuses, uid),
+        .faction_id = G_GetFactionIDFrom(gs->faction_ids, uid)
+    };
+}
+
+static inline vec2_t combat_xz_pos(uint32_t uid)
+{
+    uint32_t idx = combat_column_index(uid);
+    if(idx != PF_SSET_NONE)
+        return s_combat_work.gamestate.columns->xz_pos[idx];
+    return G_Pos_GetXZFrom(s_combat_work.gamestate.positions, uid);
+}
+
+static inline int combat_faction_id(uint32_t uid)
+{
+    uint32_t idx = combat_column_index(uid);
+    if(idx != PF_SSET_NONE)
+        return s_combat_work.gamestate.columns->faction_id[idx];
+    return G_GetFactionIDFrom(s_combat_work.gamestate.faction_ids, uid);
+}
+
+static bool enemy_factions(int faction_a, int faction_b)
 {
     struct combat_gamestate *gs = &s_combat_work.gamestate;
-    int faction_a = G_GetFactionIDFrom(gs->faction_ids, a);
-    int faction_b = G_GetFactionIDFrom(gs->faction_ids, b);
     if(faction_a == faction_b)
         return false;
 
@@ -403,6 +452,11 @@ static bool enemies(uint32_t a, uint32_t b)
     return (ds == DIPLOMACY_STATE_WAR);
 }
 
+static bool enemies(uint32_t a, uint32_t b)
+{
+    return enemy_factions(combat_faction_id(a), combat_faction_id(b));
+}
+
 static bool enemies_in_bin(int faction_id, struct map_resolution binres, struct tile_desc td)
 {
     struct combat_gamestate *gs = &s_combat_work.gamestate;
@@ -433,9 +487,8 @@ static bool enemies_in_bin(int faction_id, struct map_resolution binres, struct
 static bool maybe_enemy_near(uint32_t uid)
 {
     PERF_ENTER();
-    struct combat_gamestate *gs = &s_combat_work.gamestate;
     const struct combatstate *cs = combatstate_get(uid);
-    vec2_t pos = G_Pos_GetXZFrom(gs->positions, uid);
+    vec2_t pos = combat_xz_pos(uid);
     float range = MAX(TARGET_ACQUISITION_RANGE, cs->stats.attack_range);
     int binlen = MAX(
         (float)(X_COORDS_PER_TILE * TILES_PER_CHUNK_WIDTH)  / X_BINS_PER_CHUNK,
@@ -465,7 +518,7 @@ static bool maybe_enemy_near(uint32_t uid)
         struct tile_desc bin = td;
         if(!M_Tile_RelativeDesc(binres, &bin, dc, dr))
             continue;
-        int faction_id = G_GetFactionIDFrom(gs->faction_ids, uid);
+        int faction_id = combat_faction_id(uid);
         if(enemies_in_bin(faction_id, binres, bin))
             PERF_RETURN(true);
     }}
@@ -476,7 +529,6 @@ static void entity_move_in_range(uint32_t uid, uint32_t target)
 {
     ASSERT_IN_MAIN_THREAD();
 
-    struct combat_gamestate *gs = &s_combat_work.gamestate;
     const struct combatstate *cs = combatstate_get(uid);
     assert(cs->stance != COMBAT_STANCE_HOLD_POSITION);
 
@@ -484,7 +536,7 @@ static void entity_move_in_range(uint32_t uid, uint32_t target)
         G_Move_SetSurroundEntity(uid, target);
     }else{
         if(M_NavLocationsReachable(s_map, Entity_NavLayer(uid), 
-            G_Pos_GetXZFrom(gs->positions, uid), G_Pos_GetXZFrom(gs->positions, target))) {
+            combat_xz_pos(uid), combat_xz_pos(target))) {
 
             G_Move_SetSurroundEntity(uid, target);
         }else{
@@ -513,28 +565,18 @@ static void current_obb_from_gamestate(uint32_t uid, struct obb *out)
 
 static bool entities_adjacent(uint32_t ent, uint32_t target)
 {
-    struct combat_gamestate *gs = &s_combat_work.gamestate;
-    uint32_t flags = G_FlagsGetFrom(gs->flags, target);
-
-    if(flags & ENTITY_FLAG_MOVABLE) {
+    struct hot_state ent_state = combat_hot_state(ent);
+    struct hot_state target_state = combat_hot_state(target);
 
-        vec2_t ent_pos = G_Pos_GetXZFrom(gs->positions, ent);
-        vec2_t target_pos = G_Pos_GetXZFrom(gs->positions, target);
+    if(target_state.flags & ENTITY_FLAG_MOVABLE) {
 
-        float ent_radius = G_GetSelectionRadiusFrom(gs->sel_radiuses, ent);
-        float target_radius = G_GetSelectionRadiusFrom(gs->sel_radiuses, target);
-
-        return M_NavObjAdjacentToDynamicWith(s_map, ent_pos, ent_radius, 
-            target_pos, target_radius);
+        return M_NavObjAdjacentToDynamicWith(s_map, ent_state.xz_pos, ent_state.radius, 
+            target_state.xz_pos, target_state.radius);
     }else{
 
         struct obb obb;
         current_obb_from_gamestate(target, &obb);
-
-        vec2_t ent_pos = G_Pos_GetXZFrom(gs->positions, ent);
-        float ent_radius = G_GetSelectionRadiusFrom(gs->sel_radiuses, ent);
-
-        return M_NavObjAdjacentToStaticWith(s_map, ent_pos, ent_radius, &obb);
+        return M_NavObjAdjacentToStaticWith(s_map, ent_state.xz_pos, ent_state.radius, &obb);
     }
 }
 
@@ -545,14 +587,13 @@ static bool entity_can_attack_melee(uint32_t uid, uint32_t target)
 
 static bool entity_can_attack(uint32_t uid, uint32_t target)
 {
-    struct combat_gamestate *gs = &s_combat_work.gamestate;
     const struct combatstate *cs = combatstate_get(uid);
     if(cs->stats.attack_range == 0.0f) {
         return entity_can_attack_melee(uid, target);
     }
 
-    vec2_t xz_src = G_Pos_GetXZFrom(gs->positions, uid);
-    vec2_t xz_dst = G_Pos_GetXZFrom(gs->positions, target);
+    vec2_t xz_src = combat_hot_state(uid).xz_pos;
+    vec2_t xz_dst = combat_hot_state(target).xz_pos;
 
     vec2_t delta;
     PFM_Vec2_Sub(&xz_src, &xz_dst, &delta);
@@ -563,8 +604,10 @@ static bool valid_enemy(uint32_t curr, void *arg)
 {
     struct combat_gamestate *gs = &s_combat_work.gamestate;
     uint32_t ent = (uintptr_t)arg;
-    uint32_t ent_flags = G_FlagsGetFrom(gs->flags, ent);
-    uint32_t curr_flags = G_FlagsGetFrom(gs->flags, curr);
+    struct hot_state ent_state = combat_hot_state(ent);
+    struct hot_state curr_state = combat_hot_state(curr);
+    uint32_t ent_flags = ent_state.flags;
+    uint32_t curr_flags = curr_state.flags;
 
     struct combatstate *ent_cs = combatstate_get(ent);
     assert(ent_cs);
@@ -576,7 +619,7 @@ static bool valid_enemy(uint32_t curr, void *arg)
     if((curr_flags & ENTITY_FLAG_BUILDING) 
     && !G_Building_IsFoundedFrom(gs->buildstate, curr))
         return false;
-    if(!enemies(ent, curr))
+    if(!enemy_factions(ent_state.faction_id, curr_state.faction_id))
         return false;
     if(!(ent_flags & ENTITY_FLAG_AIR)
     && (curr_flags & ENTITY_FLAG_AIR)
@@ -614,8 +657,8 @@ static quat_t quat_from_vec(vec2_t dir)
 static quat_t entity_turn_dir(uint32_t uid, uint32_t target)
 {
     struct combat_gamestate *gs = &s_combat_work.gamestate;
-    vec2_t ent_pos_xz = G_Pos_GetXZFrom(gs->positions, uid);
-    vec2_t tar_pos_xz = G_Pos_GetXZFrom(gs->positions, target);
+    vec2_t ent_pos_xz = combat_xz_pos(uid);
+    vec2_t tar_pos_xz = combat_xz_pos(target);
 
     vec2_t ent_to_target;
     PFM_Vec2_Sub(&tar_pos_xz, &ent_pos_xz, &ent_to_target);
@@ -755,11 +798,9 @@ static void entity_die(uint32_t uid)
 
     }else{
 
-        khash_t(id) *flags = s_combat_work.gamestate.flags;
-        khiter_t k = kh_get(id, flags, uid);
-        assert(k != kh_end(flags));
-        kh_value(flags, k) = kh_value(flags, k) | ENTITY_FLAG_ZOMBIE;
-
+        if(cs) {
+            cs->zombie = true;
+        }
         G_Zombiefy(uid, false);
         Entity_DisappearAnimated(uid, s_map, on_disappear_finish, (void*)((uintptr_t)uid));
     }
@@ -787,7 +828,6 @@ static void entity_ranged_attack(uint32_t uid, uint32_t target, vec3_t proj_pos)
 {
     ASSERT_IN_MAIN_THREAD();
 
-    struct combat_gamestate *gs = &s_combat_work.gamestate;
     struct combatstate *cs = combatstate_get(uid);
     assert(cs);
 
@@ -811,7 +851,7 @@ static void entity_ranged_attack(uint32_t uid, uint32_t target, vec3_t proj_pos)
         return; /* Degenerate: the target is right on top of the muzzle. */
     }
 
-    P_Projectile_Add(proj_pos, vel, uid, G_GetFactionIDFrom(gs->faction_ids, uid),
+    P_Projectile_Add(proj_pos, vel, uid, combat_faction_id(uid),
         ent_dmg, PROJ_ONLY_HIT_COMBATABLE | PROJ_ONLY_HIT_ENEMIES, cs->pd);
 }
 
@@ -838,12 +878,12 @@ static struct result corpse_disappear_task(void *arg)
 
     const float duration = 1000.0f;
     uint32_t elapsed = 0;
-    uint32_t start = SDL_GetTicks();
+    uint32_t start = G_Timer_Ticks();
 
     while(elapsed < duration) {
     
         Task_AwaitEvent(EVENT_UPDATE_START, &(int){0});
-        uint32_t curr = SDL_GetTicks();
+        uint32_t curr = G_Timer_Ticks();
 
         /* The entity can theoretically be forecefully removed during the 
          * disappearing animation. Make sure we don't crap out if this happens
@@ -891,11 +931,7 @@ static void on_death_anim_finish(void *user, void *event)
     struct combatstate *cs = combatstate_get(self);
     assert(cs);
 
-    khash_t(id) *flags = s_combat_work.gamestate.flags;
-    khiter_t k = kh_get(id, flags, self);
-    assert(k != kh_end(flags));
-    kh_value(flags, k) = kh_value(flags, k) | ENTITY_FLAG_ZOMBIE;
-
+    cs->zombie = true;
     E_Entity_Unregister(EVENT_ANIM_CYCLE_FINISHED, self, on_death_anim_finish);
     G_Zombiefy(self, true);
 
@@ -920,6 +956,7 @@ static void do_add_entity(uint32_t uid, enum combat_stance initial)
         .stance = initial,
         .state = STATE_NOT_IN_COMBAT,
         .sticky = false,
+        .zombie = false,
         .move_cmd_interrupted = false,
         .pd = combat_default_proj(),
         .fd = combat_default_fire(),
@@ -1343,7 +1380,7 @@ static void on_attack_anim_tick(void *user, void *event)
 static bool entity_dead(uint32_t uid)
 {
     struct combatstate *cs = combatstate_get(uid);
-    if(!cs || (cs->state == STATE_DEATH_ANIM_PLAYING)
+    if(!cs || (cs->state == STATE_DEATH_ANIM_PLAYING) || cs->zombie
     || (G_FlagsGetFrom(s_combat_work.gamestate.flags, uid) & ENTITY_FLAG_ZOMBIE))
         return true;
 
@@ -1413,7 +1450,7 @@ uint32_t closest_eligible_entity(uint32_t uid)
 {
     struct combat_gamestate *gs = &s_combat_work.gamestate;
     struct combatstate *cs = combatstate_get(uid);
-    vec2_t pos = G_Pos_GetXZFrom(gs->positions, uid);
+    vec2_t pos = combat_xz_pos(uid);
     float range = MAX(TARGET_ACQUISITION_RANGE, cs->stats.attack_range);
 
     return G_Pos_NearestWithPredFrom(gs->postree, gs->positions, gs->flags,
@@ -1642,7 +1679,7 @@ static void entity_compute_update(uint32_t uid, struct combat_work_out *out)
             };
         }else{
             curr->state = STATE_ATTACKING;
-            curr->attack_start_tick = SDL_GetTicks();
+            curr->attack_start_tick = G_Timer_Ticks();
         }
 
         break;
@@ -1674,7 +1711,7 @@ static void entity_compute_update(uint32_t uid, struct combat_work_out *out)
     }
     case STATE_ATTACKING: {
 
-        uint32_t ticks = SDL_GetTicks();
+        uint32_t ticks = G_Timer_Ticks();
         uint32_t period = DEFAULT_ATTACK_PERIOD * 1000.0f;
         if(!SDL_TICKS_PASSED(ticks, curr->attack_start_tick + period))
             break;
@@ -1888,10 +1925,234 @@ static void combat_handle_hz_update(enum eventtype curr)
     register_callback_for_hz(next_hz);
 }
 
-static void combat_process_cmds(void)
+static void free_proj_desc(struct proj_desc *pd)
+{
+    PF_FREE(pd->basedir);
+    PF_FREE(pd->pfobj);
+    if(pd->flags & PROJ_HAS_IMPACT_SPRITE) {
+        PF_FREE(pd->impact_sprite.filename);
+    }
+    if(pd->flags & PROJ_HAS_TRAIL_SPRITE) {
+        PF_FREE(pd->trail_sprite.filename);
+    }
+    PF_FREE(pd);
+}
+
+static void combat_free_cmd(struct combat_cmd *cmd)
+{
+    switch(cmd->type) {
+    case COMBAT_CMD_SET_PROJ_DESC:
+        free_proj_desc(cmd->args[1].val.as_pointer);
+        break;
+    case COMBAT_CMD_SET_PROJ_FIRE_DESC:
+        PF_FREE(cmd->args[1].val.as_pointer);
+        break;
+    case COMBAT_CMD_PROJ_HIT:
+        PF_FREE(cmd->args[0].val.as_pointer);
+        break;
+    default:
+        break;
+    }
+}
+
+static void combat_discard_cmds(void)
 {
     struct combat_cmd cmd;
     while(queue_cmd_pop(&s_combat_commands, &cmd)) {
+        combat_free_cmd(&cmd);
+    }
+}
+
+static void put_u64(struct journal_blob *blob, uint64_t val)
+{
+    G_Journal_BlobPut(blob, &val, sizeof(val));
+}
+
+static uint64_t get_u64(struct journal_blob *blob)
+{
+    uint64_t ret = 0;
+    G_Journal_BlobGet(blob, &ret, sizeof(ret));
+    return ret;
+}
+
+static void put_sprite_desc(struct journal_blob *blob, const struct sprite_sheet_desc *desc, bool used)
+{
+    G_Journal_BlobPutString(blob, used ? desc->filename : NULL);
+    put_u64(blob, desc->nrows);
+    put_u64(blob, desc->ncols);
+    put_u64(blob, desc->nframes);
+}
+
+static void get_sprite_desc(struct journal_blob *blob, struct sprite_sheet_desc *out)
+{
+    char *filename = NULL;
+    G_Journal_BlobGetString(blob, &filename);
+    out->filename = filename;
+    out->nrows = get_u64(blob);
+    out->ncols = get_u64(blob);
+    out->nframes = get_u64(blob);
+}
+
+static void put_proj_desc(struct journal_blob *blob, const struct proj_desc *pd)
+{
+    G_Journal_BlobPutString(blob, pd->basedir);
+    G_Journal_BlobPutString(blob, pd->pfobj);
+    G_Journal_BlobPut(blob, &pd->scale, sizeof(pd->scale));
+    G_Journal_BlobPut(blob, &pd->speed, sizeof(pd->speed));
+    put_u64(blob, pd->flags);
+    put_sprite_desc(blob, &pd->impact_sprite, pd->flags & PROJ_HAS_IMPACT_SPRITE);
+    G_Journal_BlobPut(blob, &pd->impact_size, sizeof(pd->impact_size));
+    put_sprite_desc(blob, &pd->trail_sprite, pd->flags & PROJ_HAS_TRAIL_SPRITE);
+    G_Journal_BlobPut(blob, &pd->trail_size, sizeof(pd->trail_size));
+    G_Journal_BlobPut(blob, &pd->trail_freq, sizeof(pd->trail_freq));
+    put_u64(blob, pd->trail_fps);
+}
+
+static struct proj_desc *get_proj_desc(struct journal_blob *blob)
+{
+    struct proj_desc *ret = PF_CALLOC(1, sizeof(struct proj_desc));
+    if(!ret)
+        return NULL;
+
+    char *basedir = NULL, *pfobj = NULL;
+    G_Journal_BlobGetString(blob, &basedir);
+    G_Journal_BlobGetString(blob, &pfobj);
+    ret->basedir = basedir;
+    ret->pfobj = pfobj;
+    G_Journal_BlobGet(blob, &ret->scale, sizeof(ret->scale));
+    G_Journal_BlobGet(blob, &ret->speed, sizeof(ret->speed));
+    ret->flags = get_u64(blob);
+    get_sprite_desc(blob, &ret->impact_sprite);
+    G_Journal_BlobGet(blob, &ret->impact_size, sizeof(ret->impact_size));
+    get_sprite_desc(blob, &ret->trail_sprite);
+    G_Journal_BlobGet(blob, &ret->trail_size, sizeof(ret->trail_size));
+    G_Journal_BlobGet(blob, &ret->trail_freq, sizeof(ret->trail_freq));
+    ret->trail_fps = get_u64(blob);
+    return ret;
+}
+
+static void put_proj_fire_desc(struct journal_blob *blob, const struct proj_fire_desc *fd)
+{
+    put_u64(blob, fd->frame_offset);
+    put_u64(blob, fd->fire_mode);
+    G_Journal_BlobPut(blob, fd->bone_name, sizeof(fd->bone_name));
+    G_Journal_BlobPut(blob, &fd->offset, sizeof(fd->offset));
+}
+
+static struct proj_fire_desc *get_proj_fire_desc(struct journal_blob *blob)
+{
+    struct proj_fire_desc *ret = PF_CALLOC(1, sizeof(struct proj_fire_desc));
+    if(!ret)
+        return NULL;
+
+    ret->frame_offset = get_u64(blob);
+    ret->fire_mode = get_u64(blob);
+    G_Journal_BlobGet(blob, ret->bone_name, sizeof(ret->bone_name));
+    ret->bone_name[sizeof(ret->bone_name) - 1] = '\0';
+    G_Journal_BlobGet(blob, &ret->offset, sizeof(ret->offset));
+    return ret;
+}
+
+static void put_proj_hit(struct journal_blob *blob, const struct proj_hit *hit)
+{
+    const uint32_t fields[] = {hit->ent_uid, hit->proj_uid, hit->parent_uid, hit->cookie};
+    G_Journal_BlobPut(blob, fields, sizeof(fields));
+}
+
+static struct proj_hit *get_proj_hit(struct journal_blob *blob)
+{
+    uint32_t fields[4] = {0};
+    G_Journal_BlobGet(blob, fields, sizeof(fields));
+
+    struct proj_hit *ret = PF_MALLOC(sizeof(struct proj_hit));
+    if(!ret)
+        return NULL;
+    *ret = (struct proj_hit){fields[0], fields[1], fields[2], fields[3]};
+    return ret;
+}
+
+static void combat_journal_cmd(const struct combat_cmd *cmd)
+{
+    struct journal_blob blob;
+    G_Journal_BlobInit(&blob);
+
+    switch(cmd->type) {
+    case COMBAT_CMD_SET_PROJ_DESC:
+        put_proj_desc(&blob, cmd->args[1].val.as_pointer);
+        break;
+    case COMBAT_CMD_SET_PROJ_FIRE_DESC:
+        put_proj_fire_desc(&blob, cmd->args[1].val.as_pointer);
+        break;
+    case COMBAT_CMD_PROJ_HIT:
+        put_proj_hit(&blob, cmd->args[0].val.as_pointer);
+        break;
+    default:
+        break;
+    }
+    G_Journal_Write(JOURNAL_STREAM_COMBAT, cmd->type, ARR_SIZE(cmd->args), cmd->args, &blob);
+    G_Journal_BlobDestroy(&blob);
+}
+
+/* Queue up the recorded commands for the current epoch. Returns 
+ * the number of commands queued. 
+ */
+static size_t combat_replay_cmds(void)
+{
+    size_t ret = 0;
+    struct combat_cmd cmd = {0};
+    int type;
+    struct journal_blob *blob;
+
+    while(G_Journal_Read(JOURNAL_STREAM_COMBAT, &type, ARR_SIZE(cmd.args), cmd.args, &blob)) {
+
+        cmd.type = type;
+        switch(cmd.type) {
+        case COMBAT_CMD_SET_PROJ_DESC:
+            cmd.args[1].val.as_pointer = get_proj_desc(blob);
+            if(!cmd.args[1].val.as_pointer)
+                continue;
+            break;
+        case COMBAT_CMD_SET_PROJ_FIRE_DESC:
+            cmd.args[1].val.as_pointer = get_proj_fire_desc(blob);
+            if(!cmd.args[1].val.as_pointer)
+                continue;
+            break;
+        case COMBAT_CMD_PROJ_HIT:
+            cmd.args[0].val.as_pointer = get_proj_hit(blob);
+            if(!cmd.args[0].val.as_pointer)
+                continue;
+            break;
+        default:
+            break;
+        }
+        combat_push_cmd(cmd);
+        ret++;
+    }
+    return ret;
+}
+
+static void combat_process_cmds(void)
+{
+    /* When replaying, the commands that were issued this time around
+     * are thrown away and the recorded ones are processed instead. Any 
+     * commands issued while processing them were already recorded,
+     * so those are thrown away as well. 
+     */
+    size_t limit = SIZE_MAX;
+    bool replay = G_Journal_Replaying();
+    if(replay) {
+        combat_discard_cmds();
+        limit = combat_replay_cmds();
+    }
+
+    struct combat_cmd cmd;
+    while(limit > 0 && queue_cmd_pop(&s_combat_commands, &cmd)) {
+
+        limit--;
+        if(G_Journal_Recording()) {
+            combat_journal_cmd(&cmd);
+        }
+
         switch(cmd.type) {
         case COMBAT_CMD_ADD: {
             uint32_t uid = cmd.args[0].val.as_int;
@@ -2021,11 +2282,16 @@ static void combat_process_cmds(void)
             assert(0);
         }
     }
+
+    if(replay) {
+        combat_discard_cmds();
+    }
+    G_Journal_EndEpoch(JOURNAL_STREAM_COMBAT);
 }
 
-static void combat_work(int begin_idx, int end_idx)
+static void combat_work(int begin_idx, int end_idx, void *arg)
 {
-    for(int i = begin_idx; i <= end_idx; i++) {
+    for(int i = begin_idx; i < end_idx; i++) {
     
         struct combat_work_in *in = &s_combat_work.in[i];
         struct combat_work_out *out = &s_combat_work.out[i];
@@ -2035,117 +2301,72 @@ static void combat_work(int begin_idx, int end_idx)
 
 static struct result combat_task(void *arg)
 {
-    struct combat_task_arg *combat_arg = arg;
-    size_t ncomputed = 0;
-
-    for(int i = combat_arg->begin_idx; i <= combat_arg->end_idx; i++) {
-
-        combat_work(i, i);
-        ncomputed++;
-
-        if(ncomputed % 16 == 0)
-            Task_Yield();
-    }
+    Sched_ParallelFor(0, s_combat_work.nwork, 16, combat_work, NULL, TASK_BIG_STACK);
     return NULL_RESULT;
 }
 
 static void combat_complete_work(void)
 {
-    for(int i = 0; i < s_combat_work.ntasks; i++) {
-        while(!Sched_FutureIsReady(&s_combat_work.futures[i])) {
-            Sched_RunSync(s_combat_work.tids[i]);
-        }
-    }
+    Sched_GraphWait(SCHED_RES_COMBAT);
 }
 
-static khash_t(aabb) *combat_copy_aabbs(void)
+static void combat_copy_gamestate(struct gs_snapshot *gs)
 {
     PERF_ENTER();
-    khash_t(aabb) *aabbs = kh_init(aabb);
-    if(!aabbs)
-        PERF_RETURN(NULL);
-
-    const khash_t(entity) *ents = G_GetAllEntsSet();
-
-    uint32_t uid;
-    kh_foreach_key(ents, uid, {
-        int ret;
-        khiter_t k = kh_put(aabb, aabbs, uid, &ret);
-        assert(ret != -1);
-        kh_value(aabbs, k) = AL_EntityGet(uid)->identity_aabb;
-    });
-    PERF_RETURN(aabbs);
-}
-
-static void combat_copy_gamestate(void)
-{
-    PERF_ENTER();
-    s_combat_work.gamestate.factions = G_GetFactions(NULL, NULL, NULL);
-    s_combat_work.gamestate.player_factions = G_GetPlayerControlledFactions();
-    s_combat_work.gamestate.fog_enabled = G_Fog_Enabled();
-    s_combat_work.gamestate.flags = G_FlagsCopyTable();
-    s_combat_work.gamestate.positions = G_Pos_CopyTable();
-    s_combat_work.gamestate.postree = G_Pos_CopyBitmapGrid();
-    s_combat_work.gamestate.transforms = Entity_CopyTransforms();
-    s_combat_work.gamestate.sel_radiuses = G_SelectionRadiusCopyTable();
-    s_combat_work.gamestate.faction_ids = G_FactionIDCopyTable();
-    s_combat_work.gamestate.diptable = G_CopyDiplomacyTable();
+    s_combat_work.gamestate.snapshot = gs;
+    s_combat_work.gamestate.factions = gs->factions;
+    s_combat_work.gamestate.player_factions = gs->player_controllable;
+    s_combat_work.gamestate.fog_enabled = gs->fog_enabled;
+    s_combat_work.gamestate.flags = gs->flags;
+    s_combat_work.gamestate.positions = gs->positions;
+    s_combat_work.gamestate.postree = gs->postree;
+    s_combat_work.gamestate.transforms = gs->transforms;
+    s_combat_work.gamestate.sel_radiuses = gs->sel_radiuses;
+    s_combat_work.gamestate.faction_ids = gs->faction_ids;
+    s_combat_work.gamestate.columns = gs->columns;
+    s_combat_work.gamestate.diptable = gs->diptable;
     s_combat_work.gamestate.buildstate = G_Building_CopyState();
-    s_combat_work.gamestate.aabbs = combat_copy_aabbs();
-    s_combat_work.gamestate.fog_state = G_Fog_CopyState();
+    s_combat_work.gamestate.aabbs = gs->aabbs;
+    s_combat_work.gamestate.fog_state = gs->fog_state;
     PERF_RETURN_VOID();
 }
 
 static void combat_release_gamestate(void)
 {
     PERF_ENTER();
-    if(s_combat_work.gamestate.flags) {
-        kh_destroy(id, s_combat_work.gamestate.flags);
-        s_combat_work.gamestate.flags = NULL;
-    }
-    if(s_combat_work.gamestate.positions) {
-        kh_destroy(pos, s_combat_work.gamestate.positions);
-        s_combat_work.gamestate.positions = NULL;
-    }
-    if(s_combat_work.gamestate.postree) {
-        G_Pos_DestroyBitmapGrid(s_combat_work.gamestate.postree);
-        s_combat_work.gamestate.postree = NULL;
-    }
-    if(s_combat_work.gamestate.transforms) {
-        kh_destroy(trans, s_combat_work.gamestate.transforms);
-        s_combat_work.gamestate.transforms = NULL;
-    }
-    if(s_combat_work.gamestate.sel_radiuses) {
-        kh_destroy(range, s_combat_work.gamestate.sel_radiuses);
-        s_combat_work.gamestate.sel_radiuses = NULL;
-    }
-    if(s_combat_work.gamestate.faction_ids) {
-        kh_destroy(id, s_combat_work.gamestate.faction_ids);
-        s_combat_work.gamestate.faction_ids = NULL;
-    }
-    if(s_combat_work.gamestate.diptable) {
-        PF_FREE(s_combat_work.gamestate.diptable);
-        s_combat_work.gamestate.diptable = NULL;
-    }
     if(s_combat_work.gamestate.buildstate) {
         kh_destroy(state, s_combat_work.gamestate.buildstate);
         s_combat_work.gamestate.buildstate = NULL;
     }
-    if(s_combat_work.gamestate.aabbs) {
-        kh_destroy(aabb, s_combat_work.gamestate.aabbs);
-        s_combat_work.gamestate.aabbs = NULL;
-    }
-    if(s_combat_work.gamestate.fog_state) {
-        PF_FREE(s_combat_work.gamestate.fog_state);
-        s_combat_work.gamestate.fog_state = NULL;
+    s_combat_work.gamestate.flags = NULL;
+    s_combat_work.gamestate.positions = NULL;
+    s_combat_work.gamestate.postree = NULL;
+    s_combat_work.gamestate.transforms = NULL;
+    s_combat_work.gamestate.sel_radiuses = NULL;
+    s_combat_work.gamestate.faction_ids = NULL;
+    s_combat_work.gamestate.columns = NULL;
+    s_combat_work.gamestate.diptable = NULL;
+    s_combat_work.gamestate.aabbs = NULL;
+    s_combat_work.gamestate.fog_state = NULL;
+    if(s_combat_work.gamestate.snapshot) {
+        G_Snapshot_Release(s_combat_work.gamestate.snapshot);
+        s_combat_work.gamestate.snapshot = NULL;
     }
     PERF_RETURN_VOID();
 }
 
-static void combat_update_gamestate(void)
+static bool combat_update_gamestate(void)
 {
+    /* Acquire the new snapshot before dropping the old one, so that 
+     * a failed allocation leaves the previous gamestate in place. 
+     */
+    struct gs_snapshot *gs = G_Snapshot_Acquire();
+    if(!gs)
+        return false;
+
     combat_release_gamestate();
-    combat_copy_gamestate();
+    combat_copy_gamestate(gs);
+    return true;
 }
 
 static void combat_prepare_work(void)
@@ -2175,7 +2396,6 @@ static void combat_finish_work(void)
     s_combat_work.in = NULL;
     s_combat_work.out = NULL;
     s_combat_work.nwork = 0;
-    s_combat_work.ntasks = 0;
 
     PERF_RETURN_VOID();
 }
@@ -2190,29 +2410,9 @@ static void combat_submit_work(void)
     if(s_combat_work.nwork == 0)
         return;
 
-    size_t ntasks = SDL_GetCPUCount();
-    if(s_combat_work.nwork < 64)
-        ntasks = 1;
-    ntasks = MIN(ntasks, MAX_COMBAT_TASKS);
-
-    for(int i = 0; i < ntasks; i++) {
-
-        struct combat_task_arg *arg = stalloc(&s_combat_work.mem, sizeof(struct combat_task_arg));
-        size_t nitems = ceil((float)s_combat_work.nwork / ntasks);
-
-        arg->begin_idx = nitems * i;
-        arg->end_idx = MIN(nitems * (i + 1) - 1, s_combat_work.nwork-1);
-
-        SDL_AtomicSet(&s_combat_work.futures[s_combat_work.ntasks].status, FUTURE_INCOMPLETE);
-        s_combat_work.tids[s_combat_work.ntasks] = Sched_Create(4, combat_task, arg, 
-            "combat_task", &s_combat_work.futures[s_combat_work.ntasks], TASK_BIG_STACK);
-
-        if(s_combat_work.tids[s_combat_work.ntasks] == NULL_TID) {
-            combat_work(arg->begin_idx, arg->end_idx);
-        }else{
-            s_combat_work.ntasks++;
-        }
-    }
+    /* The work reads the navigation grid in place */
+    Sched_GraphSubmit(4, combat_task, NULL, "combat_task", TASK_BIG_STACK,
+        SCHED_RES_NAV, SCHED_RES_COMBAT);
 }
 
 static void combat_tick(void *user, void *event)
@@ -2226,10 +2426,14 @@ static void combat_tick(void *user, void *event)
     combat_finish_work();
     combat_handle_hz_update(curr_event);
     combat_process_cmds();
-    combat_release_gamestate();
 
+    if(!combat_update_gamestate()) {
+        /* No snapshot to hand the workers - skip this tick's work */
+        s_last_tick = g_frame_idx;
+        PERF_POP();
+        return;
+    }
     combat_prepare_work();
-    combat_copy_gamestate();
 
     uint32_t uid;
     kh_foreach_key(s_entity_state_table, uid, {
@@ -2331,7 +2535,7 @@ static void combat_render_targets(void)
         if(!G_EntityExists(key))
             continue;
 
-        vec2_t ent_pos = G_Pos_GetXZFrom(gs->positions, key);
+        vec2_t ent_pos = combat_xz_pos(key);
         mat4x4_t ident;
         PFM_Mat4x4_Identity(&ident);
 
@@ -2349,7 +2553,7 @@ static void combat_render_targets(void)
                 continue;
         
             vec2_t delta;
-            vec2_t target_pos = G_Pos_GetXZFrom(gs->positions, curr.target_uid);
+            vec2_t target_pos = combat_xz_pos(curr.target_uid);
             PFM_Vec2_Sub(&target_pos, &ent_pos, &delta);
 
             float t = PFM_Vec2_Len(&delta);
@@ -2412,7 +2616,7 @@ static void combat_render_ranges(void)
         if(curr.stats.attack_range == 0.0f)
             continue;
 
-        vec2_t ent_pos = G_Pos_GetXZFrom(gs->positions, key);
+        vec2_t ent_pos = combat_xz_pos(key);
         mat4x4_t ident;
         PFM_Mat4x4_Identity(&ident);
 
@@ -2514,6 +2718,9 @@ bool G_Combat_Init(const struct map *map)
             goto fail_refcnts;
     }
 
+    if(!combat_update_gamestate())
+        goto fail_refcnts;
+
     vec_entity_init(&s_dying_ents);
     E_Global_Register(EVENT_1HZ_TICK, on_1hz_tick, NULL, G_RUNNING);
     register_callback_for_hz(s_combat_hz);
@@ -2521,7 +2728,6 @@ bool G_Combat_Init(const struct map *map)
     E_Global_Register(EVENT_RENDER_3D_POST, on_render_3d, NULL, G_ALL);
     E_Global_Register(EVENT_PROJECTILE_HIT, on_proj_hit, NULL, G_RUNNING);
     s_map = map;
-    combat_copy_gamestate();
     vec_corpse_init(&s_corpses);
     return true;
 
@@ -2773,6 +2979,48 @@ void G_Combat_AddRef(int faction_id, vec2_t pos)
     });
 }
 
+uint16_t G_Combat_FactionsNear(vec2_t xz_pos, float range)
+{
+    ASSERT_IN_MAIN_THREAD();
+
+    struct map_resolution mapres;
+    M_GetResolution(s_map, &mapres);
+
+    struct map_resolution binres = (struct map_resolution){
+        mapres.chunk_w, mapres.chunk_h,
+        X_BINS_PER_CHUNK, Z_BINS_PER_CHUNK,
+		mapres.field_w, mapres.field_h
+    };
+    int binlen = MIN(
+        (float)(X_COORDS_PER_TILE * TILES_PER_CHUNK_WIDTH)  / X_BINS_PER_CHUNK,
+        (float)(Z_COORDS_PER_TILE * TILES_PER_CHUNK_HEIGHT) / Z_BINS_PER_CHUNK
+    );
+    int binrange = ceil(range / binlen);
+
+    struct tile_desc td;
+    if(!M_Tile_DescForPoint2D(binres, M_GetPos(s_map), xz_pos, &td))
+        return 0;
+
+    uint16_t ret = 0;
+    for(int dr = -binrange; dr <= binrange; dr++) {
+    for(int dc = -binrange; dc <= binrange; dc++) {
+
+        struct tile_desc bin = td;
+        if(!M_Tile_RelativeDesc(binres, &bin, dc, dr))
+            continue;
+
+        size_t x = bin.chunk_c * X_BINS_PER_CHUNK + bin.tile_c;
+        size_t z = bin.chunk_r * Z_BINS_PER_CHUNK + bin.tile_r;
+        size_t idx = x * (binres.chunk_w * binres.tile_w) + z;
+
+        for(int i = 0; i < MAX_FACTIONS; i++) {
+            if(s_fac_refcnts[i][idx] > 0)
+                ret |= (0x1 << i);
+        }
+    }}
+    return ret;
+}
+
 void G_Combat_RemoveRef(int faction_id, vec2_t pos)
 {
     combat_push_cmd((struct combat_cmd){
@@ -3099,7 +3347,7 @@ bool G_Combat_SaveState(struct SDL_RWops *stream)
     };
     CHK_TRUE_RET(Attr_Write(stream, &num_ents, "num_ents"));
 
-    uint32_t curr_ticks = SDL_GetTicks();
+    uint32_t curr_ticks = G_Timer_Ticks();
     uint32_t key;
     struct combatstate curr;
 
@@ -3351,7 +3599,7 @@ bool G_Combat_SaveState(struct SDL_RWops *stream)
 bool G_Combat_LoadState(struct SDL_RWops *stream)
 {
     /* Flush the commands submitted during loading */
-    combat_update_gamestate();
+    CHK_TRUE_RET(combat_update_gamestate());
     combat_process_cmds();
 
     struct attr attr;
@@ -3361,7 +3609,7 @@ bool G_Combat_LoadState(struct SDL_RWops *stream)
     Sched_TryYield();
 
     const size_t num_ents = attr.val.as_int;
-    uint32_t curr_ticks = SDL_GetTicks();
+    uint32_t curr_ticks = G_Timer_Ticks();
 
     for(int i = 0; i < num_ents; i++) {
     
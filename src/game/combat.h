@@ -66,6 +66,10 @@ bool G_Combat_Idle(uint32_t uid);
 
 void G_Combat_AddRef(int faction_id, vec2_t pos);
 void G_Combat_RemoveRef(int faction_id, vec2_t pos);
+/* Returns a mask of the factions with entities in the bins overlapping the 
+ * circle. Since whole bins are tested, it may include factions slightly 
+ * outside of the range. */
+uint16_t G_Combat_FactionsNear(vec2_t xz_pos, float range);
 void G_Combat_AddTimeDelta(uint32_t delta);
 
 bool G_Combat_SaveState(struct SDL_RWops *stream);
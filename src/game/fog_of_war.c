@@ -108,6 +108,8 @@ static vec3_t                s_map_pos;
  * order. Within a chunk, the tiles are in row-major order. Each 32-bit value encodes
  * a 2-bit faction state for up to 16 factions. */
 static uint32_t         *s_fog_state;
+/* Bumped on every write to the fog state. Not reset between maps. */
+static uint32_t          s_state_version;
 /* How many units of a faction currently 'see' every tile. */
 static uint8_t          *s_vision_refcnts[MAX_FACTIONS];
 /* Cache all the entities that have been explored by the player, for faster queries */
@@ -190,6 +192,7 @@ static void update_tile(int faction_id, struct tile_desc td, int delta)
 {
     uint8_t old = s_vision_refcnts[faction_id][td_index(td)];
     uint8_t new = old + delta;
+    s_state_version++;
 
     if(new) {
         fog_set_state(s_fog_state + td_index(td), faction_id, STATE_VISIBLE);
@@ -544,6 +547,7 @@ static void fog_flush_pending(void)
     if(s_nupdates == 0)
         return;
     PERF_ENTER();
+    s_state_version++;
 
     for(size_t i = 0; i < s_nupdates; i++) {
         struct vis_update *u = &s_updates[i];
@@ -691,6 +695,7 @@ bool G_Fog_Init(const struct map *map)
     s_fog_state = PF_CALLOC(sizeof(s_fog_state[0]), ntiles);
     if(!s_fog_state)
         goto fail;
+    s_state_version++;
 
     for(int i = 0; i < MAX_FACTIONS; i++) {
         s_vision_refcnts[i] = PF_CALLOC(sizeof(s_vision_refcnts[0]), ntiles);
@@ -1172,6 +1177,7 @@ bool G_Fog_LoadState(struct SDL_RWops *stream)
         CHK_TRUE_RET(attr.type == TYPE_INT);
         s_fog_state[i] = attr.val.as_int;
     }
+    s_state_version++;
 
     return true;
 }
@@ -1198,6 +1204,7 @@ void G_Fog_ExploreMap(int faction_id)
             s_fog_state[td_index(td)] = ts;
         }}
     }}
+    s_state_version++;
 }
 
 uint32_t *G_Fog_CopyState(void)
@@ -1213,6 +1220,11 @@ uint32_t *G_Fog_CopyState(void)
     return ret;
 }
 
+uint32_t G_Fog_StateVersion(void)
+{
+    return s_state_version;
+}
+
 bool G_Fog_ObjVisibleFrom(uint32_t *state, bool enabled, uint16_t fac_mask, const struct obb *obb)
 {
     if(!enabled)
@@ -77,6 +77,7 @@ bool G_Fog_LoadState(struct SDL_RWops *stream);
 bool G_Fog_Enabled(void);
 
 uint32_t *G_Fog_CopyState(void);
+uint32_t  G_Fog_StateVersion(void);
 
 #endif
 
@@ -89,6 +89,11 @@
 #define EPSILON                  (1.0f/1024)
 #define FIELD_RECOMPUTE_INTERVAL (3.0f) /* seconds */
 #define MAX_CELL_ASSIGNMENT_WORK (256)
+#define AUCTION_MIN_EPSILON      (2500) /* (0.5 units)^2 at the cost matrix scale */
+#define AUCTION_EPSILON_FACTOR   (4)
+#define AUCTION_YIELD_INTERVAL   (256)  /* bids */
+#define AUCTION_WARM_BIDS        (8)    /* per entity, before a warm start is abandoned */
+#define MAX_AUCTION_WARM         (64)
 #define IDX(r, width, c)         (r * width + c)
 
 #define CHK_TRUE_RET(_pred)             \
@@ -265,6 +270,19 @@ struct subformation{
 VEC_TYPE(subformation, struct subformation)
 VEC_IMPL(static inline, subformation, struct subformation)
 
+/* The outcome of the last fast assignment of a set of entities. The next 
+ * auction over the same entities and cell layout starts from it, rather 
+ * than from scratch. 
+ */
+struct auction_warm{
+    size_t               nents;
+    struct coord        *idx_to_cell;
+    int64_t             *prices;
+    khash_t(assignment) *assignment;
+};
+
+KHASH_MAP_INIT_INT64(warm, struct auction_warm)
+
 struct cell_assignment_work{
     bool                 destroyed;
     /* Input */
@@ -273,11 +291,14 @@ struct cell_assignment_work{
     size_t               nrows, ncols;
     formation_id_t       fid;
     size_t               subformation_idx;
+    bool                 fast;
+    struct auction_warm  warm_in;
     /* Input/output */
     vec_cell_t           cells;
     /* Output */
     khash_t(assignment) *assignment;
     khash_t(reverse)    *reverse;
+    struct auction_warm  warm_out;
     /* Job data */
     uint32_t             tid;
     struct future        future;
@@ -329,7 +350,7 @@ KHASH_MAP_INIT_INT(type, enum formation_type);
 
 static void complete_cell_assignment_work(struct cell_assignment_work *work, bool yield);
 static void cell_assignment_work_destroy(struct cell_assignment_work *work);
-static void collect_cell_assignment_result(const struct cell_assignment_work *work, 
+static void collect_cell_assignment_result(struct cell_assignment_work *work, 
                                            struct subformation *out);
 
 static void complete_cell_field_work(struct subformation *formation, bool yield);
@@ -366,6 +387,9 @@ static formation_id_t         s_next_id;
 static SDL_TLSID              s_workspace;
 static queue_event_t          s_events;
 static queue_cell_recompute_t s_requests;
+static bool                   s_fast_assignment = true;
+/* Keyed by the set of entities that was assigned */
+static khash_t(warm)         *s_auction_warm;
 
 /*****************************************************************************/
 /* STATIC FUNCTIONS                                                          */
@@ -1987,16 +2011,11 @@ iterate:
 
 /* Use the Hungarian algorithm to find an optimal assignment of entities to cells
  * (minimizing the combined distance that needs to be traveled by the entities).
+ * The costs matrix is clobbered.
  */
-static void compute_cell_assignment(struct cell_assignment_work *work)
+static void hungarian_assignment(int *costs, struct coord *out_assignment, size_t nents)
 {
-    size_t nents = kh_size(work->ents);
-    STALLOC(int, costs, nents * nents);
     STALLOC(int, next, nents * nents);
-    STALLOC(struct coord, assignment, nents);
-    STALLOC(struct coord, idx_to_cell, nents);
-
-    create_cost_matrix(work, costs, idx_to_cell);
     int *rows = costs;
 
     /* Step 1: Subtract row minima
@@ -2030,7 +2049,7 @@ static void compute_cell_assignment(struct cell_assignment_work *work)
          *
          * If less than n lines are required, continue with Step 4.
          */
-        min_lines = min_lines_to_cover_zeroes(costs, next, assignment, nents);
+        min_lines = min_lines_to_cover_zeroes(costs, next, out_assignment, nents);
 
         /* Step 4: Create additional zeros
          * Find the smallest element (call it k) that is not covered by a line in Step 3. 
@@ -2041,6 +2060,315 @@ static void compute_cell_assignment(struct cell_assignment_work *work)
         }
     }while(min_lines < nents);
 
+    STFREE(next);
+}
+
+/* The value of the most valuable cell for the entity at the current prices. 
+ * The value of the second-best cell is INT64_MIN if there is only one.
+ */
+static int64_t auction_best(const int *costs, size_t nents, const int64_t *prices, 
+                            int ent, int64_t *out_second, int *out_cell)
+{
+    int64_t best = INT64_MIN, second = INT64_MIN;
+    int best_cell = -1;
+
+    for(int c = 0; c < nents; c++) {
+        int64_t value = -((int64_t)costs[IDX(ent, nents, c)]) - prices[c];
+        if(value > best) {
+            second = best;
+            best = value;
+            best_cell = c;
+        }else if(value > second) {
+            second = value;
+        }
+    }
+    assert(best_cell >= 0);
+
+    if(out_second) {
+        *out_second = second;
+    }
+    if(out_cell) {
+        *out_cell = best_cell;
+    }
+    return best;
+}
+
+/* Let the unassigned entities bid until every one of them holds a cell. 
+ * Returns false if that took more than 'max_bids' bids.
+ */
+static bool auction_bid(const int *costs, size_t nents, int64_t eps, int64_t *prices, 
+                        int *owners, int *assigned, int *unassigned, size_t nunassigned,
+                        size_t max_bids)
+{
+    size_t nbids = 0;
+    while(nunassigned > 0) {
+
+        if(nbids == max_bids)
+            return false;
+
+        int ent = unassigned[--nunassigned];
+        int64_t second;
+        int best_cell;
+        int64_t best = auction_best(costs, nents, prices, ent, &second, &best_cell);
+
+        /* With a single cell, there is nothing to outbid */
+        prices[best_cell] += (second == INT64_MIN) ? eps : (best - second + eps);
+
+        int prev = owners[best_cell];
+        if(prev >= 0) {
+            assigned[prev] = -1;
+            unassigned[nunassigned++] = prev;
+        }
+        owners[best_cell] = ent;
+        assigned[ent] = best_cell;
+
+        if(++nbids % AUCTION_YIELD_INTERVAL == 0) {
+            Sched_TryYield();
+        }
+    }
+    return true;
+}
+
+/* Use the auction algorithm (with epsilon-scaling) to find an assignment of 
+ * entities to cells that is within (nents * AUCTION_MIN_EPSILON) of the optimal 
+ * combined cost. Unassigned entities bid for their most valuable cell, raising 
+ * its price by the margin over their second-best choice plus epsilon, and 
+ * evicting the previous owner. Each bid is linear in the number of cells, and 
+ * the number of bids grows roughly linearly with the number of entities, 
+ * rather than the cubic behaviour of the Hungarian method.
+ *
+ * When 'warm_cells' is set, the auction starts from that assignment and the 
+ * passed in prices at the final epsilon. Should the costs have moved too far 
+ * for that to settle quickly, it falls back to a full run. The final prices 
+ * are written back to 'prices'.
+ */
+static void auction_assignment(const int *costs, struct coord *out_assignment, size_t nents,
+                               int64_t *prices, const int *warm_cells)
+{
+    STALLOC(int, owners, nents);
+    STALLOC(int, assigned, nents);
+    STALLOC(int, unassigned, nents);
+
+    if(warm_cells) {
+
+        /* Only the entities that are no longer within epsilon of their 
+         * most valuable cell need to bid again. 
+         */
+        for(int i = 0; i < nents; i++) {
+            owners[i] = -1;
+        }
+        size_t nunassigned = 0;
+        for(int i = 0; i < nents; i++) {
+            int c = warm_cells[i];
+            int64_t best = auction_best(costs, nents, prices, i, NULL, NULL);
+            int64_t value = -((int64_t)costs[IDX(i, nents, c)]) - prices[c];
+            if(value >= best - AUCTION_MIN_EPSILON) {
+                owners[c] = i;
+                assigned[i] = c;
+            }else{
+                assigned[i] = -1;
+                unassigned[nunassigned++] = i;
+            }
+        }
+        if(auction_bid(costs, nents, AUCTION_MIN_EPSILON, prices, owners, assigned, 
+            unassigned, nunassigned, nents * AUCTION_WARM_BIDS))
+            goto done;
+    }
+
+    int64_t max_cost = 0;
+    for(int i = 0; i < nents * nents; i++) {
+        if(costs[i] != INT_MAX) {
+            max_cost = MAX(max_cost, costs[i]);
+        }
+    }
+
+    for(int i = 0; i < nents; i++) {
+        prices[i] = 0;
+    }
+
+    int64_t eps = MAX(max_cost / AUCTION_EPSILON_FACTOR, AUCTION_MIN_EPSILON);
+
+    while(true) {
+
+        /* Each scaling phase starts from a blank assignment, but keeps the 
+         * prices from the previous phase as a starting point.
+         */
+        for(int i = 0; i < nents; i++) {
+            owners[i] = -1;
+            assigned[i] = -1;
+            unassigned[i] = nents - 1 - i;
+        }
+        auction_bid(costs, nents, eps, prices, owners, assigned, unassigned, nents, SIZE_MAX);
+
+        if(eps == AUCTION_MIN_EPSILON)
+            break;
+        eps = MAX(eps / AUCTION_EPSILON_FACTOR, AUCTION_MIN_EPSILON);
+        Sched_TryYield();
+    }
+
+done:
+    for(int i = 0; i < nents; i++) {
+        assert(assigned[i] >= 0);
+        out_assignment[i] = (struct coord){i, assigned[i]};
+    }
+
+    STFREE(owners);
+    STFREE(assigned);
+    STFREE(unassigned);
+}
+
+/* Map the previous assignment of the work's entities to cost matrix columns. 
+ * Fails if the entities or the cell layout are not the same as last time. 
+ */
+static bool auction_warm_cells(const struct cell_assignment_work *work, 
+                               const struct coord *idx_to_cell, int *out_cells)
+{
+    const struct auction_warm *warm = &work->warm_in;
+    size_t nents = kh_size(work->ents);
+
+    if(!warm->prices || warm->nents != nents)
+        return false;
+
+    for(int i = 0; i < nents; i++) {
+        if(warm->idx_to_cell[i].r != idx_to_cell[i].r
+        || warm->idx_to_cell[i].c != idx_to_cell[i].c)
+            return false;
+    }
+
+    int i = 0;
+    uint32_t uid;
+    kh_foreach_key(work->ents, uid, {
+
+        khiter_t k = kh_get(assignment, warm->assignment, uid);
+        if(k == kh_end(warm->assignment))
+            return false;
+
+        struct coord cell = kh_val(warm->assignment, k);
+        int j = 0;
+        while(j < nents && (idx_to_cell[j].r != cell.r || idx_to_cell[j].c != cell.c))
+            j++;
+        if(j == nents)
+            return false;
+        out_cells[i++] = j;
+    });
+    return true;
+}
+
+static void auction_warm_destroy(struct auction_warm *warm)
+{
+    PF_FREE(warm->idx_to_cell);
+    PF_FREE(warm->prices);
+    if(warm->assignment) {
+        kh_destroy(assignment, warm->assignment);
+    }
+    memset(warm, 0, sizeof(*warm));
+}
+
+static uint64_t auction_warm_key(khash_t(entity) *ents)
+{
+    uint64_t ret = kh_size(ents);
+    uint32_t uid;
+    kh_foreach_key(ents, uid, {
+        uint64_t x = uid * 0x9E3779B97F4A7C15ull;
+        ret += x ^ (x >> 29);
+    });
+    return ret;
+}
+
+/* Hand the result of the last auction over the same entities to the work */
+static void auction_warm_take(struct cell_assignment_work *work)
+{
+    memset(&work->warm_in, 0, sizeof(work->warm_in));
+
+    /* The replays must not depend on state that is not saved */
+    if(!work->fast || G_Deterministic())
+        return;
+
+    khiter_t k = kh_get(warm, s_auction_warm, auction_warm_key(work->ents));
+    if(k == kh_end(s_auction_warm))
+        return;
+
+    work->warm_in = kh_val(s_auction_warm, k);
+    kh_del(warm, s_auction_warm, k);
+}
+
+/* Keep the result of a completed auction for the next one over the same 
+ * entities. The work must not have lost any entities since it was started. 
+ */
+static void auction_warm_give(struct cell_assignment_work *work)
+{
+    if(!work->warm_out.prices)
+        return;
+
+    if(kh_size(s_auction_warm) >= MAX_AUCTION_WARM) {
+        struct auction_warm *curr;
+        kh_foreach_ptr(s_auction_warm, curr, {
+            auction_warm_destroy(curr);
+        });
+        kh_clear(warm, s_auction_warm);
+    }
+
+    work->warm_out.assignment = kh_copy(assignment, work->assignment);
+    if(!work->warm_out.assignment) {
+        auction_warm_destroy(&work->warm_out);
+        return;
+    }
+
+    int status;
+    khiter_t k = kh_put(warm, s_auction_warm, auction_warm_key(work->ents), &status);
+    if(status == -1) {
+        auction_warm_destroy(&work->warm_out);
+        return;
+    }
+    if(status == 0) {
+        auction_warm_destroy(&kh_val(s_auction_warm, k));
+    }
+    kh_val(s_auction_warm, k) = work->warm_out;
+    memset(&work->warm_out, 0, sizeof(work->warm_out));
+}
+
+/* Find an assignment of entities to cells, minimizing the combined distance 
+ * that needs to be traveled by the entities. This is either exact or within
+ * a bounded error of the optimum, depending on the mode the work was created 
+ * with.
+ */
+static void compute_cell_assignment(struct cell_assignment_work *work)
+{
+    size_t nents = kh_size(work->ents);
+    STALLOC(int, costs, nents * nents);
+    STALLOC(struct coord, assignment, nents);
+    STALLOC(struct coord, idx_to_cell, nents);
+
+    create_cost_matrix(work, costs, idx_to_cell);
+
+    if(work->fast) {
+        STALLOC(int64_t, prices, nents);
+        STALLOC(int, warm_cells, nents);
+
+        bool warm = auction_warm_cells(work, idx_to_cell, warm_cells);
+        if(warm) {
+            memcpy(prices, work->warm_in.prices, sizeof(int64_t) * nents);
+        }
+        auction_assignment(costs, assignment, nents, prices, warm ? warm_cells : NULL);
+
+        work->warm_out = (struct auction_warm){
+            .nents = nents,
+            .idx_to_cell = PF_MALLOC(sizeof(struct coord) * nents),
+            .prices = PF_MALLOC(sizeof(int64_t) * nents),
+        };
+        if(work->warm_out.idx_to_cell && work->warm_out.prices) {
+            memcpy(work->warm_out.idx_to_cell, idx_to_cell, sizeof(struct coord) * nents);
+            memcpy(work->warm_out.prices, prices, sizeof(int64_t) * nents);
+        }else{
+            auction_warm_destroy(&work->warm_out);
+        }
+
+        STFREE(prices);
+        STFREE(warm_cells);
+    }else{
+        hungarian_assignment(costs, assignment, nents);
+    }
+
     int i = 0;
     uint32_t uid;
     kh_foreach_key(work->ents, uid, {
@@ -2065,7 +2393,6 @@ static void compute_cell_assignment(struct cell_assignment_work *work)
     });
 
     STFREE(costs);
-    STFREE(next);
     STFREE(assignment);
     STFREE(idx_to_cell);
 }
@@ -2947,7 +3274,7 @@ static bool event_triggered_recalculate(struct formation *formation, struct bloc
 
 static void on_entity_unblock(void *user, void *event)
 {
-    uint32_t tick = SDL_GetTicks();
+    uint32_t tick = G_Timer_Ticks();
     struct block_event block_event = (struct block_event){
         .type = EVENT_MOVABLE_ENTITY_UNBLOCK,
         .desc = *(struct entity_block_desc*)event,
@@ -2958,7 +3285,7 @@ static void on_entity_unblock(void *user, void *event)
 
 static void on_entity_block(void *user, void *event)
 {
-    uint32_t tick = SDL_GetTicks();
+    uint32_t tick = G_Timer_Ticks();
     struct block_event block_event = (struct block_event){
         .type = EVENT_MOVABLE_ENTITY_BLOCK,
         .desc = *(struct entity_block_desc*)event,
@@ -2969,7 +3296,7 @@ static void on_entity_block(void *user, void *event)
 
 static void on_building_found(void *user, void *event)
 {
-    uint32_t tick = SDL_GetTicks();
+    uint32_t tick = G_Timer_Ticks();
     struct block_event block_event = (struct block_event){
         .type = EVENT_MOVABLE_ENTITY_BLOCK,
         .desc = *(struct entity_block_desc*)event,
@@ -2980,7 +3307,7 @@ static void on_building_found(void *user, void *event)
 
 static void on_building_remove(void *user, void *event)
 {
-    uint32_t tick = SDL_GetTicks();
+    uint32_t tick = G_Timer_Ticks();
     struct block_event block_event = (struct block_event){
         .type = EVENT_MOVABLE_ENTITY_UNBLOCK,
         .desc = *(struct entity_block_desc*)event,
@@ -3031,7 +3358,7 @@ static void on_1hz_tick(void *user, void *event)
     }
 
     khash_t(entity) *need_recompute = kh_init(entity);
-    uint32_t ticks = SDL_GetTicks();
+    uint32_t ticks = G_Timer_Ticks();
     struct block_event block_event;
     while(queue_event_pop(&s_events, &block_event)) {
 
@@ -3224,7 +3551,7 @@ static void dispatch_cell_task(struct formation *parent, vec2_t center, uint32_t
     work->overlay = (struct nav_cell_overlay){formation->blocked_tiles.array,
         vec_size(&formation->blocked_tiles)};
     work->uid = uid;
-    work->last_update_ticks = SDL_GetTicks();
+    work->last_update_ticks = G_Timer_Ticks();
 
     work->input.layer = formation->layer;
     work->input.enemy_faction_mask = G_GetEnemyFactions(formation->faction_id);
@@ -3304,6 +3631,12 @@ static void complete_cell_field_work(struct subformation *formation, bool yield)
 
 static void on_update_start(void *user, void *event)
 {
+    /* In deterministic mode, results must not depend on how quickly 
+     * the workers got to the jobs, so finish everything that was 
+     * dispatched on the previous tick before looking at the futures.
+     */
+    bool sync = G_Deterministic();
+
     /* Consume cell assignment work results 
     */
     struct formation *formation;
@@ -3314,6 +3647,9 @@ static void on_update_start(void *user, void *event)
             if(work->destroyed)
                 continue;
             struct subformation *sub = &vec_AT(&formation->subformations, i);
+            if(sync) {
+                complete_cell_assignment_work(work, false);
+            }
             if(Sched_FutureIsReady(&work->future)) {
                 collect_cell_assignment_result(work, sub);
                 cell_assignment_work_destroy(work);
@@ -3330,6 +3666,9 @@ static void on_update_start(void *user, void *event)
 
         for(int i = 0; i < vec_size(&formation->subformations); i++) {
             struct subformation *sub = &vec_AT(&formation->subformations, i);
+            if(sync) {
+                complete_cell_field_work(sub, false);
+            }
             for(int j = 0; j < vec_size(&sub->futures); j++) {
                 struct cell_field_work *curr = &vec_AT(&sub->futures, j);
                 uint32_t uid = curr->uid;
@@ -4147,6 +4486,9 @@ static void cell_assignment_work_init(struct cell_assignment_work *work,
     work->nrows = sub->nrows;
     work->fid = fid;
     work->subformation_idx = idx;
+    work->fast = s_fast_assignment;
+    memset(&work->warm_out, 0, sizeof(work->warm_out));
+    auction_warm_take(work);
 }
 
 static void cell_assignment_work_destroy(struct cell_assignment_work *work)
@@ -4158,10 +4500,12 @@ static void cell_assignment_work_destroy(struct cell_assignment_work *work)
     kh_destroy(assignment, work->assignment);
     kh_destroy(reverse, work->reverse);
     vec_cell_destroy(&work->cells);
+    auction_warm_destroy(&work->warm_in);
+    auction_warm_destroy(&work->warm_out);
     work->destroyed = true;
 }
 
-static void collect_cell_assignment_result(const struct cell_assignment_work *work, 
+static void collect_cell_assignment_result(struct cell_assignment_work *work, 
                                            struct subformation *out)
 {
     assert(kh_size(work->ents) == kh_size(work->reverse));
@@ -4171,7 +4515,9 @@ static void collect_cell_assignment_result(const struct cell_assignment_work *wo
     /* Account for any entities that have been removed from the 
      * subformation since the cell assignement work has been kicked off
      */
-    if(kh_size(out->ents) < kh_size(work->ents)) {
+    if(kh_size(out->ents) == kh_size(work->ents)) {
+        auction_warm_give(work);
+    }else{
 
         vec_entity_t removed;
         vec_entity_init(&removed);
@@ -4213,7 +4559,7 @@ static void collect_cell_assignment_result(const struct cell_assignment_work *wo
     out->assignment = kh_copy(assignment, work->assignment);
 
     vec_cell_reset(&out->cells);
-    vec_cell_copy(&out->cells, &(((struct cell_assignment_work*)work)->cells));
+    vec_cell_copy(&out->cells, &work->cells);
     out->state = SUBFORMATION_READY;
 }
 
@@ -4276,6 +4622,8 @@ bool G_Formation_Init(const struct map *map)
         goto fail_formations;
     if(NULL == (s_preferred = kh_init(type)))
         goto fail_preferred;
+    if(NULL == (s_auction_warm = kh_init(warm)))
+        goto fail_warm;
 
     if(s_workspace == 0) {
         s_workspace = SDL_TLSCreate();
@@ -4305,6 +4653,8 @@ bool G_Formation_Init(const struct map *map)
 fail_requests:
     queue_event_destroy(&s_events);
 fail_tls:
+    kh_destroy(warm, s_auction_warm);
+fail_warm:
     kh_destroy(type, s_preferred);
 fail_preferred:
     kh_destroy(formation, s_formations);
@@ -4331,6 +4681,12 @@ void G_Formation_Shutdown(void)
     E_Global_Unregister(EVENT_UPDATE_START, on_update_start);
     E_Global_Unregister(EVENT_RENDER_3D_POST, on_render_3d);
 
+    struct auction_warm *warm;
+    kh_foreach_ptr(s_auction_warm, warm, {
+        auction_warm_destroy(warm);
+    });
+    kh_destroy(warm, s_auction_warm);
+
     queue_cell_recompute_destroy(&s_requests);
     queue_event_destroy(&s_events);
     kh_destroy(type, s_preferred);
@@ -4400,7 +4756,7 @@ void G_Formation_Create(vec2_t target, vec2_t orientation,
         .center = field_center(target, orientation),
         .ents = copy_vector(ents),
         .speed = formation_speed(ents),
-        .created_tick = SDL_GetTicks(),
+        .created_tick = G_Timer_Ticks(),
         .sub_assignment = kh_init(assignment)
     };
     init_subformations(new);
@@ -4732,7 +5088,7 @@ void G_Formation_UpdateFieldIfNeeded(uint32_t uid)
      * field too often. Wait for a number of changes to pile up
      * and do it perfodically, as necessary.
      */
-    uint32_t curr = SDL_GetTicks();
+    uint32_t curr = G_Timer_Ticks();
     float elapsed = (curr - work->last_update_ticks) / 1000.0f;
     if(elapsed < FIELD_RECOMPUTE_INTERVAL) {
         PERF_RETURN_VOID();
@@ -4806,6 +5162,12 @@ enum formation_type G_Formation_Type(formation_id_t fid)
     return formation->type;
 }
 
+void G_Formation_SetFastAssignment(bool on)
+{
+    ASSERT_IN_MAIN_THREAD();
+    s_fast_assignment = on;
+}
+
 vec2_t G_Formation_AlignmentForce(uint32_t uid)
 {
     ASSERT_IN_MAIN_THREAD();
@@ -4976,7 +5338,7 @@ void G_Formation_RenderPlacement(const vec_entity_t *ents, vec2_t target, vec2_t
         .center = field_center(target, orientation),
         .ents = copy_vector(ents),
         .speed = formation_speed(ents),
-        .created_tick = SDL_GetTicks(),
+        .created_tick = G_Timer_Ticks(),
         .sub_assignment = kh_init(assignment)
     };
     init_subformations(&formation);
@@ -5186,7 +5548,7 @@ bool G_Formation_SaveState(struct SDL_RWops *stream)
 
 bool G_Formation_LoadState(struct SDL_RWops *stream)
 {
-    uint32_t curr_tick = SDL_GetTicks();
+    uint32_t curr_tick = G_Timer_Ticks();
     struct attr attr;
 
     /* Load next formation ID */
@@ -68,6 +68,7 @@ quat_t         G_Formation_TargetOrientation(uint32_t uid);
 void           G_Formation_UpdateFieldIfNeeded(uint32_t uid);
 float          G_Formation_Speed(uint32_t uid);
 enum formation_type G_Formation_Type(formation_id_t fid);
+void           G_Formation_SetFastAssignment(bool on);
 void           G_Formation_RenderPlacement(const vec_entity_t *ents, vec2_t pos, vec2_t orientation);
 
 vec2_t         G_Formation_CohesionForce(uint32_t uid);
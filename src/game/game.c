@@ -56,6 +56,7 @@
 #include "garrison.h"
 #include "automation.h"
 #include "population.h"
+#include "snapshot.h"
 #include "../render/public/render.h"
 #include "../render/public/render_ctrl.h"
 #include "../anim/public/anim.h"
@@ -65,6 +66,7 @@
 #include "../phys/public/phys.h"
 #include "../phys/public/collision.h"
 #include "../lib/public/pf_string.h"
+#include "../lib/public/pf_rand.h"
 #include "../mem.h"
 #include "../lib/public/pf_nuklear.h"
 #include "../entity.h"
@@ -122,6 +124,11 @@ __KHASH_IMPL(range,   extern, khint32_t, float,    1, kh_int_hash_func, kh_int_h
 /*****************************************************************************/
 
 static struct gamestate s_gs;
+/* Deterministic mode is a process-wide switch and not part of the 
+ * gamestate - it survives clearing and loading sessions. 
+ */
+static bool             s_deterministic;
+static uint32_t         s_rand_state;
 
 /*****************************************************************************/
 /* STATIC FUNCTIONS                                                          */
@@ -189,6 +196,7 @@ static void g_init_map(void)
     G_Building_Init(s_gs.map);
     G_Garrison_Init(s_gs.map);
     G_Fog_Init(s_gs.map);
+    G_Snapshot_Init();
     G_Combat_Init(s_gs.map);
     G_Move_Init(s_gs.map);
     G_Formation_Init(s_gs.map);
@@ -742,12 +750,27 @@ static void combat_hz_commit(const struct sval *new_val)
 static void move_gpu_commit(const struct sval *new_val)
 {
     bool next = new_val->as_bool;
-    if(!R_ComputeShaderSupported()) {
+    if(!R_ComputeShaderSupported() || s_deterministic) {
         next = false;
     }
     G_Move_SetUseGPU(next);
 }
 
+static void nav_bucket_integration_commit(const struct sval *new_val)
+{
+    N_SetBucketIntegration(new_val->as_bool);
+}
+
+static void nav_portal_heuristic_commit(const struct sval *new_val)
+{
+    N_SetPortalGraphHeuristic(new_val->as_bool);
+}
+
+static void formation_fast_assignment_commit(const struct sval *new_val)
+{
+    G_Formation_SetFastAssignment(new_val->as_bool);
+}
+
 static bool nav_layer_validate(const struct sval *new_val)
 {
     if(new_val->type != ST_TYPE_INT)
@@ -957,6 +980,7 @@ static void g_clear_map_state(void)
         G_Combat_Shutdown();
         G_Formation_Shutdown();
         G_Move_Shutdown();
+        G_Snapshot_Shutdown();
         G_Builder_Shutdown();
         G_Resource_Shutdown();
         G_Region_Shutdown();
@@ -1031,7 +1055,7 @@ static void g_change_simstate(void)
     if(s_gs.ss == s_gs.requested_ss)
         return;
 
-    uint32_t curr_tick = SDL_GetTicks();
+    uint32_t curr_tick = G_Timer_Ticks();
     switch(s_gs.requested_ss) {
     case G_RUNNING: {
 
@@ -1168,6 +1192,42 @@ static void g_create_settings(void)
     });
     assert(status == SS_OKAY);
 
+    status = Settings_Create((struct setting){
+        .name = "pf.game.nav_bucket_integration",
+        .val = (struct sval) {
+            .type = ST_TYPE_BOOL,
+            .as_bool = true
+        },
+        .prio = 0,
+        .validate = bool_val_validate,
+        .commit = nav_bucket_integration_commit,
+    });
+    assert(status == SS_OKAY);
+
+    status = Settings_Create((struct setting){
+        .name = "pf.game.nav_portal_heuristic",
+        .val = (struct sval) {
+            .type = ST_TYPE_BOOL,
+            .as_bool = true
+        },
+        .prio = 0,
+        .validate = bool_val_validate,
+        .commit = nav_portal_heuristic_commit,
+    });
+    assert(status == SS_OKAY);
+
+    status = Settings_Create((struct setting){
+        .name = "pf.game.formation_fast_assignment",
+        .val = (struct sval) {
+            .type = ST_TYPE_BOOL,
+            .as_bool = true
+        },
+        .prio = 0,
+        .validate = bool_val_validate,
+        .commit = formation_fast_assignment_commit,
+    });
+    assert(status == SS_OKAY);
+
     status = Settings_Create((struct setting){
         .name = "pf.game.show_map_foliage",
         .val = (struct sval) {
@@ -1643,6 +1703,7 @@ void g_delete_gpuid(uint32_t uid)
     khiter_t k = kh_get(entity, s_gs.dynamic, uid);
     assert(k != kh_end(s_gs.dynamic));
     kh_del(entity, s_gs.dynamic, k);
+    s_gs.versions.gpu_ids++;
 
     k = kh_get(id, s_gs.ent_gpu_id_map, uid);
     assert(k != kh_end(s_gs.ent_gpu_id_map));
@@ -1820,6 +1881,7 @@ bool G_Init(void)
 
     s_gs.prev_tick_map = NULL;
     s_gs.curr_ws_idx = 0;
+    s_rand_state = pf_rand_seed((uint32_t)SDL_GetPerformanceCounter());
     s_gs.ss = G_RUNNING;
     s_gs.requested_ss = G_RUNNING;
 
@@ -1897,6 +1959,11 @@ void G_ClearState(void)
     kh_clear(id, s_gs.ent_flag_map);
     kh_clear(range, s_gs.ent_visrange_map);
     kh_clear(range, s_gs.selection_radiuses);
+    s_gs.versions.active++;
+    s_gs.versions.gpu_ids++;
+    s_gs.versions.faction_ids++;
+    s_gs.versions.flags++;
+    s_gs.versions.sel_radiuses++;
     vec_entity_reset(&s_gs.visible);
     vec_entity_reset(&s_gs.light_visible);
     vec_obb_reset(&s_gs.visible_obbs);
@@ -2117,12 +2184,24 @@ void G_BakeNavDataForScene(void)
         Sched_TryYield();
     });
 
+    /* The cost field now reflects both the map tiles and the cutouts, so it
+     * fully determines the baked data. Reuse the bake from an earlier session
+     * of the same map and scene whenever we can. */
+    uint64_t key = M_NavBakeKey(s_gs.map);
+    if(M_NavLoadBake(s_gs.map, key)) {
+        Sched_TryYield();
+        PERF_RETURN_VOID();
+    }
+
     M_NavUpdatePortals(s_gs.map);
     Sched_TryYield();
 
     M_NavUpdateIslandsField(s_gs.map);
     Sched_TryYield();
 
+    M_NavStoreBake(s_gs.map, key);
+    Sched_TryYield();
+
     PERF_RETURN_VOID();
 }
 
@@ -2131,6 +2210,7 @@ void G_Shutdown(void)
     ASSERT_IN_MAIN_THREAD();
 
     E_Global_Unregister(EVENT_UPDATE_UI, on_update_ui);
+    G_Journal_End();
     G_ClearState();
 
     R_DestroyWS(&s_gs.ws[0]);
@@ -2379,6 +2459,7 @@ void G_FlagsSet(uint32_t uid, uint32_t flags)
         assert(status != -1);
     }
     kh_value(s_gs.ent_flag_map, k) = flags;
+    s_gs.versions.flags++;
 }
 
 uint32_t G_FlagsGet(uint32_t uid)
@@ -2411,6 +2492,9 @@ bool G_AddEntity(uint32_t uid, uint32_t flags, vec3_t pos)
     k = kh_put(entity, s_gs.active, uid, &ret);
     if(ret == -1 || ret == 0)
         return false;
+    s_gs.versions.active++;
+    s_gs.versions.faction_ids++;
+    s_gs.versions.sel_radiuses++;
 
     k = kh_put(id, s_gs.ent_faction_map, uid, &ret);
     if(ret == -1 || ret == 0)
@@ -2478,6 +2562,7 @@ bool G_AddEntity(uint32_t uid, uint32_t flags, vec3_t pos)
         k = kh_put(id, s_gs.gpu_id_ent_map, gpu_id, &ret);
         assert(ret != -1 && ret != 0);
         kh_value(s_gs.gpu_id_ent_map, k) = uid;
+        s_gs.versions.gpu_ids++;
 
         assert(kh_size(s_gs.dynamic) == kh_size(s_gs.ent_gpu_id_map));
         assert(kh_size(s_gs.ent_gpu_id_map) == kh_size(s_gs.gpu_id_ent_map));
@@ -2503,6 +2588,7 @@ bool G_RemoveEntity(uint32_t uid)
     if(k == kh_end(s_gs.active))
         return false;
     kh_del(entity, s_gs.active, k);
+    s_gs.versions.active++;
 
     uint32_t flags = G_FlagsGet(uid);
     if(flags & ENTITY_FLAG_MOVABLE)
@@ -2549,6 +2635,8 @@ bool G_RemoveEntity(uint32_t uid)
     k = kh_get(range, s_gs.selection_radiuses, uid);
     assert(k != kh_end(s_gs.selection_radiuses));
     kh_del(range, s_gs.selection_radiuses, k);
+    s_gs.versions.faction_ids++;
+    s_gs.versions.sel_radiuses++;
 
     G_Sel_MarkHoveredDirty();
     return true;
@@ -2658,6 +2746,7 @@ bool G_AddFaction(const char *name, vec3_t color, int *out_id)
         s_gs.diplomacy_table[i][new_fac_id] = DIPLOMACY_STATE_PEACE;
         s_gs.diplomacy_table[new_fac_id][i] = DIPLOMACY_STATE_PEACE;
     }
+    s_gs.versions.diplomacy++;
 
     E_Global_Notify(EVENT_UPDATE_FACTION, (void*)((uintptr_t)new_fac_id), ES_ENGINE);
     if(out_id) {
@@ -2768,6 +2857,7 @@ void G_SetFactionID(uint32_t uid, int faction_id)
     khiter_t k = kh_get(id, s_gs.ent_faction_map, uid);
     assert(k != kh_end(s_gs.ent_faction_map));
     kh_value(s_gs.ent_faction_map, k) = faction_id;
+    s_gs.versions.faction_ids++;
 
     vec2_t xz_pos = G_Pos_GetXZ(uid);
     float vrange = G_GetVisionRange(uid);
@@ -2845,6 +2935,7 @@ void G_SetSelectionRadius(uint32_t uid, float range)
     G_Move_UpdateSelectionRadius(uid, range);
     G_Resource_UpdateSelectionRadius(uid, range);
     kh_value(s_gs.selection_radiuses, k) = range;
+    s_gs.versions.sel_radiuses++;
 }
 
 float G_GetSelectionRadius(uint32_t uid)
@@ -2879,6 +2970,7 @@ bool G_SetDiplomacyState(int fac_id_a, int fac_id_b, enum diplomacy_state ds)
 
     s_gs.diplomacy_table[fac_id_a][fac_id_b] = ds;
     s_gs.diplomacy_table[fac_id_b][fac_id_a] = ds;
+    s_gs.versions.diplomacy++;
     return true;
 }
 
@@ -2904,6 +2996,11 @@ enum diplomacy_state (*G_CopyDiplomacyTable(void))[MAX_FACTIONS]
     return ret;
 }
 
+const struct gs_versions *G_GetVersions(void)
+{
+    return &s_gs.versions;
+}
+
 bool G_GetDiplomacyStateFrom(enum diplomacy_state (*table)[MAX_FACTIONS],
                              int fac_id_a, int fac_id_b, enum diplomacy_state *out)
 {
@@ -3027,10 +3124,47 @@ void G_SetSimState(enum simstate ss)
     s_gs.requested_ss = ss;
 }
 
+bool G_SetDeterministic(uint32_t seed)
+{
+    ASSERT_IN_MAIN_THREAD();
+
+    if(!G_Timer_SetFixedStep(true))
+        return false;
+
+    s_deterministic = true;
+    s_rand_state = pf_rand_seed(seed);
+    G_Move_SetUseGPU(false);
+    Sched_SetDrainMainTasks(true);
+
+    R_PushCmd((struct rcmd){
+        .func = R_GL_ImageQuiltSetSeed,
+        .nargs = 1,
+        .args = { R_PushArg(&seed, sizeof(seed)) },
+    });
+    return true;
+}
+
+bool G_Deterministic(void)
+{
+    return s_deterministic;
+}
+
+uint32_t G_Rand(void)
+{
+    ASSERT_IN_MAIN_THREAD();
+    return pf_rand_next(&s_rand_state);
+}
+
+float G_RandFloat(void)
+{
+    ASSERT_IN_MAIN_THREAD();
+    return pf_rand_float(&s_rand_state);
+}
+
 void G_UpdateSimStateChangeTick(void)
 {
     ASSERT_IN_MAIN_THREAD();
-    s_gs.ss_change_tick = SDL_GetTicks();
+    s_gs.ss_change_tick = G_Timer_Ticks();
 }
 
 void G_SetLightPos(vec3_t pos)
@@ -3616,6 +3750,7 @@ bool G_LoadGlobalState(SDL_RWops *stream)
         s_gs.diplomacy_table[i][j] = attr.val.as_int;
         Sched_TryYield();
     }}
+    s_gs.versions.diplomacy++;
 
     CHK_TRUE_RET(Attr_Parse(stream, &attr, true));
     CHK_TRUE_RET(attr.type == TYPE_FLOAT);
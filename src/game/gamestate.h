@@ -48,6 +48,15 @@
 KHASH_DECLARE(id, khint32_t, int)
 KHASH_DECLARE(range, khint32_t, float)
 
+/* Counters that get bumped on every write to the corresponding tables. */
+struct gs_versions{
+    uint32_t active;
+    uint32_t flags;
+    uint32_t faction_ids;
+    uint32_t sel_radiuses;
+    uint32_t gpu_ids;
+    uint32_t diplomacy;
+};
 
 struct gamestate{
     enum simstate           ss;
@@ -212,6 +221,12 @@ struct gamestate{
      *-------------------------------------------------------------------------
      */
     struct memstack         render_data_stack;
+    /*-------------------------------------------------------------------------
+     * Used to tell which parts of the latest simulation snapshot are still
+     * up-to-date.
+     *-------------------------------------------------------------------------
+     */
+    struct gs_versions      versions;
 };
 
 #endif
@@ -43,6 +43,7 @@
 #include "selection.h"
 #include "movement.h"
 #include "position.h"
+#include "public/game.h"
 #include "../main.h"
 #include "../ui.h"
 #include "../entity.h"
@@ -293,6 +294,7 @@ static void garrison_selection(void)
 
     if(vec_size(&filtered) > 0) {
         Entity_Ping(target);
+        G_Journal_NoteUnjournaled("garrison");
     }
     vec_entity_destroy(&filtered);
 }
@@ -312,6 +314,7 @@ static void try_evict(vec2_t target)
         if(!(flags & ENTITY_FLAG_GARRISONABLE))
             continue;
         G_Garrison_EvictAll(curr, target);
+        G_Journal_NoteUnjournaled("evict");
     }
 }
 
@@ -1206,6 +1206,7 @@ static void selection_try_order_gather(bool targeting)
 
     if(ngather) {
         Entity_Ping(target);
+        G_Journal_NoteUnjournaled("gather");
     }
 }
 
@@ -1247,6 +1248,7 @@ static void selection_try_order_pick_up(bool targeting)
 
     if(ncarry) {
         Entity_Ping(target);
+        G_Journal_NoteUnjournaled("pick up");
     }
 }
 
@@ -1288,6 +1290,7 @@ static void selection_try_order_drop_off(bool targeting)
 
     if(ncarry) {
         Entity_Ping(target);
+        G_Journal_NoteUnjournaled("drop off");
     }
 }
 
@@ -1326,6 +1329,7 @@ static void selection_try_order_transport(bool targeting)
 
     if(ntransport) {
         Entity_Ping(target);
+        G_Journal_NoteUnjournaled("transport");
     }
 }
 
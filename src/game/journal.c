@@ -0,0 +1,518 @@
+/*
+ *  This file is part of Permafrost Engine. 
+ *  Copyright (C) 2026 Eduard Permyakov 
+ *
+ *  Permafrost Engine is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Permafrost Engine is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *  Linking this software statically or dynamically with other modules is making 
+ *  a combined work based on this software. Thus, the terms and conditions of 
+ *  the GNU General Public License cover the whole combination. 
+ *  
+ *  As a special exception, the copyright holders of Permafrost Engine give 
+ *  you permission to link Permafrost Engine with independent modules to produce 
+ *  an executable, regardless of the license terms of these independent 
+ *  modules, and to copy and distribute the resulting executable under 
+ *  terms of your choice, provided that you also meet, for each linked 
+ *  independent module, the terms and conditions of the license of that 
+ *  module. An independent module is a module which is not derived from 
+ *  or based on Permafrost Engine. If you modify Permafrost Engine, you may 
+ *  extend this exception to your version of Permafrost Engine, but you are not 
+ *  obliged to do so. If you do not wish to do so, delete this exception 
+ *  statement from your version.
+ *
+ */
+
+#define MEM_FILE_SYS MEM_SYS_GAME
+#define MEM_FILE_SUB MEM_SUB_GAME_JOURNAL
+
+#include "journal.h"
+#include "public/game.h"
+#include "../main.h"
+
+#include <SDL.h>
+#include <assert.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../mem.h"
+
+#undef PF_MALLOC
+#undef PF_CALLOC
+#undef PF_REALLOC
+#define PF_MALLOC(_n)       PF_MALLOC_TAGGED((_n), MEM_SYS_GAME, MEM_SUB_GAME_JOURNAL)
+#define PF_CALLOC(_c, _n)   PF_CALLOC_TAGGED((_c), (_n), MEM_SYS_GAME, MEM_SUB_GAME_JOURNAL)
+#define PF_REALLOC(_p, _n)  PF_REALLOC_TAGGED((_p), (_n), MEM_SYS_GAME, MEM_SUB_GAME_JOURNAL)
+
+#define JOURNAL_MAGIC       "PFJL"
+#define JOURNAL_VERSION     (2)
+#define JOURNAL_FLAGS_OFFSET (12)
+#define MAX(a, b)           ((a) > (b) ? (a) : (b))
+
+/* File layout (native byte order):
+ *
+ *   header: char magic[4], uint32 version, uint32 seed, uint32 flags
+ *   record: uint8 stream, uint32 epoch, int32 type, uint8 nargs,
+ *           nargs * (uint8 attr type, value), uint32 blob size, blob
+ *
+ * Values are written with their exact bits (floats included), so 
+ * that the replayed commands are identical to the recorded ones.
+ */
+
+enum journal_flags{
+    /* An order that bypasses the command queues was issued while 
+     * recording - the journal can't reproduce the session. */
+    JOURNAL_FLAG_UNJOURNALED = (1 << 0),
+};
+
+enum journal_mode{
+    JOURNAL_NONE,
+    JOURNAL_RECORD,
+    JOURNAL_REPLAY
+};
+
+struct journal_record{
+    bool                valid;
+    enum journal_stream stream;
+    uint32_t            epoch;
+    int                 type;
+    size_t              nargs;
+    struct attr         args[JOURNAL_MAX_ARGS];
+    struct journal_blob blob;
+};
+
+/*****************************************************************************/
+/* STATIC VARIABLES                                                          */
+/*****************************************************************************/
+
+static enum journal_mode     s_mode = JOURNAL_NONE;
+static SDL_RWops            *s_file;
+static uint32_t              s_epochs[JOURNAL_STREAM_COUNT];
+/* When replaying, the next record in the file is read ahead of time */
+static struct journal_record s_next;
+static struct journal_blob   s_read_blob;
+static uint32_t              s_flags;
+
+/*****************************************************************************/
+/* STATIC FUNCTIONS                                                          */
+/*****************************************************************************/
+
+static bool write_bytes(const void *data, size_t size)
+{
+    if(size == 0)
+        return true;
+    return (SDL_RWwrite(s_file, data, size, 1) == 1);
+}
+
+static bool read_bytes(void *out, size_t size)
+{
+    if(size == 0)
+        return true;
+    return (SDL_RWread(s_file, out, size, 1) == 1);
+}
+
+static bool write_u8(uint8_t val)
+{
+    return write_bytes(&val, sizeof(val));
+}
+
+static bool write_u32(uint32_t val)
+{
+    return write_bytes(&val, sizeof(val));
+}
+
+static bool read_u8(uint8_t *out)
+{
+    return read_bytes(out, sizeof(*out));
+}
+
+static bool read_u32(uint32_t *out)
+{
+    return read_bytes(out, sizeof(*out));
+}
+
+static bool write_attr(const struct attr *attr)
+{
+    if(!write_u8(attr->type))
+        return false;
+
+    switch(attr->type) {
+    case TYPE_STRING: {
+        size_t len = strnlen(attr->val.as_string, sizeof(attr->val.as_string) - 1);
+        return write_u32(len) 
+            && write_bytes(attr->val.as_string, len);
+    }
+    case TYPE_FLOAT:    return write_bytes(&attr->val.as_float, sizeof(float));
+    case TYPE_INT:      return write_bytes(&attr->val.as_int, sizeof(int32_t));
+    case TYPE_VEC2:     return write_bytes(&attr->val.as_vec2, sizeof(vec2_t));
+    case TYPE_VEC3:     return write_bytes(&attr->val.as_vec3, sizeof(vec3_t));
+    case TYPE_QUAT:     return write_bytes(&attr->val.as_quat, sizeof(quat_t));
+    case TYPE_BOOL:     return write_u8(attr->val.as_bool);
+    /* The pointed-to data is written to the blob by the owner */
+    case TYPE_POINTER:  return true;
+    default: assert(0);
+    }
+    return false;
+}
+
+static bool read_attr(struct attr *out)
+{
+    uint8_t type;
+    if(!read_u8(&type))
+        return false;
+
+    memset(out, 0, sizeof(*out));
+    out->type = type;
+
+    switch(out->type) {
+    case TYPE_STRING: {
+        uint32_t len;
+        if(!read_u32(&len) || len >= sizeof(out->val.as_string))
+            return false;
+        return read_bytes(out->val.as_string, len);
+    }
+    case TYPE_FLOAT:    return read_bytes(&out->val.as_float, sizeof(float));
+    case TYPE_INT:      return read_bytes(&out->val.as_int, sizeof(int32_t));
+    case TYPE_VEC2:     return read_bytes(&out->val.as_vec2, sizeof(vec2_t));
+    case TYPE_VEC3:     return read_bytes(&out->val.as_vec3, sizeof(vec3_t));
+    case TYPE_QUAT:     return read_bytes(&out->val.as_quat, sizeof(quat_t));
+    case TYPE_BOOL: {
+        uint8_t val;
+        if(!read_u8(&val))
+            return false;
+        out->val.as_bool = val;
+        return true;
+    }
+    case TYPE_POINTER:  return true;
+    default: break;
+    }
+    return false;
+}
+
+static bool blob_reserve(struct journal_blob *blob, size_t size)
+{
+    if(blob->capacity >= size)
+        return true;
+
+    size_t newcap = MAX(size, blob->capacity * 2);
+    void *newdata = PF_REALLOC(blob->data, newcap);
+    if(!newdata)
+        return false;
+
+    blob->data = newdata;
+    blob->capacity = newcap;
+    return true;
+}
+
+static bool read_record(struct journal_record *out)
+{
+    uint8_t stream, nargs;
+    uint32_t epoch, type, blobsize;
+
+    if(!read_u8(&stream))
+        return false;
+    if(stream >= JOURNAL_STREAM_COUNT)
+        return false;
+    if(!read_u32(&epoch) || !read_u32(&type) || !read_u8(&nargs))
+        return false;
+    if(nargs > JOURNAL_MAX_ARGS)
+        return false;
+
+    for(int i = 0; i < nargs; i++) {
+        if(!read_attr(&out->args[i]))
+            return false;
+    }
+
+    if(!read_u32(&blobsize))
+        return false;
+    G_Journal_BlobReset(&out->blob);
+    if(!blob_reserve(&out->blob, blobsize))
+        return false;
+    if(!read_bytes(out->blob.data, blobsize))
+        return false;
+
+    out->blob.size = blobsize;
+    out->stream = stream;
+    out->epoch = epoch;
+    out->type = (int32_t)type;
+    out->nargs = nargs;
+    return true;
+}
+
+static void read_ahead(void)
+{
+    s_next.valid = read_record(&s_next);
+}
+
+static void journal_reset(void)
+{
+    s_mode = JOURNAL_NONE;
+    s_file = NULL;
+    s_next.valid = false;
+    s_flags = 0;
+    memset(s_epochs, 0, sizeof(s_epochs));
+    G_Journal_BlobDestroy(&s_next.blob);
+    G_Journal_BlobDestroy(&s_read_blob);
+}
+
+/*****************************************************************************/
+/* EXTERN FUNCTIONS                                                          */
+/*****************************************************************************/
+
+bool G_Journal_BeginRecord(const char *path, uint32_t seed)
+{
+    ASSERT_IN_MAIN_THREAD();
+    assert(s_mode == JOURNAL_NONE);
+
+    s_file = SDL_RWFromFile(path, "wb");
+    if(!s_file)
+        return false;
+
+    if(!write_bytes(JOURNAL_MAGIC, 4)
+    || !write_u32(JOURNAL_VERSION)
+    || !write_u32(seed)
+    || !write_u32(0)) {
+        SDL_RWclose(s_file);
+        s_file = NULL;
+        return false;
+    }
+
+    s_mode = JOURNAL_RECORD;
+    return true;
+}
+
+bool G_Journal_BeginReplay(const char *path, uint32_t *out_seed)
+{
+    ASSERT_IN_MAIN_THREAD();
+    assert(s_mode == JOURNAL_NONE);
+
+    s_file = SDL_RWFromFile(path, "rb");
+    if(!s_file)
+        return false;
+
+    char magic[4];
+    uint32_t version, flags;
+    if(!read_bytes(magic, sizeof(magic))
+    || 0 != memcmp(magic, JOURNAL_MAGIC, sizeof(magic))
+    || !read_u32(&version)
+    || version != JOURNAL_VERSION
+    || !read_u32(out_seed)
+    || !read_u32(&flags)) {
+        SDL_RWclose(s_file);
+        s_file = NULL;
+        return false;
+    }
+
+    if(flags & JOURNAL_FLAG_UNJOURNALED) {
+        fprintf(stderr, "The command journal '%s' contains orders that were not journaled "
+            "and can't be replayed.\n", path);
+        SDL_RWclose(s_file);
+        s_file = NULL;
+        return false;
+    }
+
+    s_mode = JOURNAL_REPLAY;
+    read_ahead();
+    return true;
+}
+
+void G_Journal_End(void)
+{
+    if(s_mode == JOURNAL_NONE)
+        return;
+    SDL_RWclose(s_file);
+    journal_reset();
+}
+
+void G_Journal_NoteUnjournaled(const char *order)
+{
+    ASSERT_IN_MAIN_THREAD();
+
+    if(s_mode != JOURNAL_RECORD || (s_flags & JOURNAL_FLAG_UNJOURNALED))
+        return;
+
+    s_flags |= JOURNAL_FLAG_UNJOURNALED;
+    fprintf(stderr, "A '%s' order is not journaled. The recording will not be replayable.\n", 
+        order);
+
+    Sint64 pos = SDL_RWtell(s_file);
+    bool ok = (pos >= 0)
+           && (SDL_RWseek(s_file, JOURNAL_FLAGS_OFFSET, RW_SEEK_SET) >= 0)
+           && write_u32(s_flags)
+           && (SDL_RWseek(s_file, pos, RW_SEEK_SET) >= 0);
+
+    if(!ok) {
+        fprintf(stderr, "Failed to write to the command journal. Recording stopped.\n");
+        G_Journal_End();
+    }
+}
+
+bool G_Journal_Recording(void)
+{
+    return (s_mode == JOURNAL_RECORD);
+}
+
+bool G_Journal_Replaying(void)
+{
+    return (s_mode == JOURNAL_REPLAY);
+}
+
+void G_Journal_Write(enum journal_stream stream, int type, size_t nargs, 
+                     const struct attr *args, const struct journal_blob *blob)
+{
+    ASSERT_IN_MAIN_THREAD();
+    assert(s_mode == JOURNAL_RECORD);
+    assert(nargs <= JOURNAL_MAX_ARGS);
+
+    bool ok = write_u8(stream)
+           && write_u32(s_epochs[stream])
+           && write_u32((uint32_t)type)
+           && write_u8(nargs);
+    for(int i = 0; ok && i < nargs; i++) {
+        ok = write_attr(&args[i]);
+    }
+    size_t blobsize = blob ? blob->size : 0;
+    ok = ok && write_u32(blobsize);
+    ok = ok && (!blob || write_bytes(blob->data, blobsize));
+
+    if(!ok) {
+        fprintf(stderr, "Failed to write to the command journal. Recording stopped.\n");
+        G_Journal_End();
+    }
+}
+
+bool G_Journal_Read(enum journal_stream stream, int *out_type, size_t maxargs, 
+                    struct attr *out_args, struct journal_blob **out_blob)
+{
+    ASSERT_IN_MAIN_THREAD();
+    assert(s_mode == JOURNAL_REPLAY);
+
+    if(!s_next.valid)
+        return false;
+    if(s_next.stream != stream || s_next.epoch != s_epochs[stream])
+        return false;
+
+    assert(s_next.nargs <= maxargs);
+    *out_type = s_next.type;
+    memset(out_args, 0, sizeof(struct attr) * maxargs);
+    memcpy(out_args, s_next.args, sizeof(struct attr) * s_next.nargs);
+
+    /* Hand the blob out and read the next record into the old buffer */
+    struct journal_blob tmp = s_read_blob;
+    s_read_blob = s_next.blob;
+    s_next.blob = tmp;
+    s_read_blob.cursor = 0;
+    *out_blob = &s_read_blob;
+
+    read_ahead();
+    return true;
+}
+
+void G_Journal_EndEpoch(enum journal_stream stream)
+{
+    ASSERT_IN_MAIN_THREAD();
+
+    if(s_mode == JOURNAL_NONE)
+        return;
+    s_epochs[stream]++;
+
+    if(s_mode != JOURNAL_REPLAY)
+        return;
+
+    /* The session has diverged from the recording - skip over any 
+     * commands that should have been consumed by now. */
+    size_t nskipped = 0;
+    while(s_next.valid 
+       && s_next.stream == stream 
+       && s_next.epoch < s_epochs[stream]) {
+        nskipped++;
+        read_ahead();
+    }
+    if(nskipped) {
+        fprintf(stderr, "Command journal replay desynchronized: skipped %zu command(s).\n", 
+            nskipped);
+    }
+
+    if(!s_next.valid) {
+        G_Journal_End();
+    }
+}
+
+void G_Journal_BlobInit(struct journal_blob *blob)
+{
+    memset(blob, 0, sizeof(*blob));
+}
+
+void G_Journal_BlobDestroy(struct journal_blob *blob)
+{
+    PF_FREE(blob->data);
+    G_Journal_BlobInit(blob);
+}
+
+void G_Journal_BlobReset(struct journal_blob *blob)
+{
+    blob->size = 0;
+    blob->cursor = 0;
+}
+
+bool G_Journal_BlobPut(struct journal_blob *blob, const void *data, size_t size)
+{
+    if(!blob_reserve(blob, blob->size + size))
+        return false;
+    memcpy(blob->data + blob->size, data, size);
+    blob->size += size;
+    return true;
+}
+
+bool G_Journal_BlobGet(struct journal_blob *blob, void *out, size_t size)
+{
+    if(blob->cursor + size > blob->size)
+        return false;
+    memcpy(out, blob->data + blob->cursor, size);
+    blob->cursor += size;
+    return true;
+}
+
+bool G_Journal_BlobPutString(struct journal_blob *blob, const char *str)
+{
+    uint32_t len = str ? strlen(str) : UINT32_MAX;
+    if(!G_Journal_BlobPut(blob, &len, sizeof(len)))
+        return false;
+    if(!str)
+        return true;
+    return G_Journal_BlobPut(blob, str, len);
+}
+
+bool G_Journal_BlobGetString(struct journal_blob *blob, char **out)
+{
+    uint32_t len;
+    if(!G_Journal_BlobGet(blob, &len, sizeof(len)))
+        return false;
+
+    if(len == UINT32_MAX) {
+        *out = NULL;
+        return true;
+    }
+    if(blob->cursor + len > blob->size)
+        return false;
+
+    char *ret = PF_MALLOC(len + 1);
+    if(!ret)
+        return false;
+    memcpy(ret, blob->data + blob->cursor, len);
+    ret[len] = '\0';
+    blob->cursor += len;
+    *out = ret;
+    return true;
+}
+
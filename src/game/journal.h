@@ -0,0 +1,110 @@
+/*
+ *  This file is part of Permafrost Engine. 
+ *  Copyright (C) 2026 Eduard Permyakov 
+ *
+ *  Permafrost Engine is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Permafrost Engine is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *  Linking this software statically or dynamically with other modules is making 
+ *  a combined work based on this software. Thus, the terms and conditions of 
+ *  the GNU General Public License cover the whole combination. 
+ *  
+ *  As a special exception, the copyright holders of Permafrost Engine give 
+ *  you permission to link Permafrost Engine with independent modules to produce 
+ *  an executable, regardless of the license terms of these independent 
+ *  modules, and to copy and distribute the resulting executable under 
+ *  terms of your choice, provided that you also meet, for each linked 
+ *  independent module, the terms and conditions of the license of that 
+ *  module. An independent module is a module which is not derived from 
+ *  or based on Permafrost Engine. If you modify Permafrost Engine, you may 
+ *  extend this exception to your version of Permafrost Engine, but you are not 
+ *  obliged to do so. If you do not wish to do so, delete this exception 
+ *  statement from your version.
+ *
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "../lib/public/attr.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* The journal is a record of every command that was processed by the 
+ * command-driven simulation systems, in order. Each system processes its' 
+ * queued commands in batches ('epochs'). When recording, every command is 
+ * appended to the journal as it is processed. When replaying, the commands 
+ * queued by the live session are dropped, and each batch is replaced with 
+ * the one that was recorded for the same epoch. Together with deterministic 
+ * mode (see 'G_SetDeterministic'), this reproduces the recorded session.
+ *
+ * Only the movement and combat command queues are journaled. Harvesting, 
+ * building and garrison orders are applied directly by their systems, so 
+ * issuing one from the UI or a script (or stopping an entity that may be 
+ * carrying one out) marks the recording with 'G_Journal_NoteUnjournaled', 
+ * and such a journal is refused for replay. Other script actions, such as 
+ * training units, are only reproduced if the scripts are deterministic and 
+ * don't act on live input. Recording and replaying are started through the 
+ * public API in 'game.h'.
+ */
+
+#define JOURNAL_MAX_ARGS (8)
+
+enum journal_stream{
+    JOURNAL_STREAM_MOVE,
+    JOURNAL_STREAM_COMBAT,
+    JOURNAL_STREAM_COUNT
+};
+
+/* Arguments that are passed by pointer are serialized by the owning system 
+ * into a blob, field by field, and read back in the same order. 
+ */
+struct journal_blob{
+    unsigned char *data;
+    size_t         size;
+    size_t         capacity;
+    size_t         cursor;
+};
+
+/* Append a processed command to the journal. 'blob' may be NULL. 
+ */
+void  G_Journal_Write(enum journal_stream stream, int type, size_t nargs, 
+                      const struct attr *args, const struct journal_blob *blob);
+
+/* Get the next recorded command of the current epoch for the stream. Returns 
+ * false once there are no more. The returned blob is owned by the journal 
+ * and is valid until the next call. 
+ */
+bool  G_Journal_Read(enum journal_stream stream, int *out_type, size_t maxargs, 
+                     struct attr *out_args, struct journal_blob **out_blob);
+
+/* Must be called by the owning system after every batch of commands, 
+ * whether it was empty or not. 
+ */
+void  G_Journal_EndEpoch(enum journal_stream stream);
+
+void  G_Journal_BlobInit(struct journal_blob *blob);
+void  G_Journal_BlobDestroy(struct journal_blob *blob);
+void  G_Journal_BlobReset(struct journal_blob *blob);
+bool  G_Journal_BlobPut(struct journal_blob *blob, const void *data, size_t size);
+bool  G_Journal_BlobGet(struct journal_blob *blob, void *out, size_t size);
+/* Strings may be NULL. The returned copy is allocated with PF_MALLOC 
+ * and is owned by the caller. 
+ */
+bool  G_Journal_BlobPutString(struct journal_blob *blob, const char *str);
+bool  G_Journal_BlobGetString(struct journal_blob *blob, char **out);
+
+#endif
+
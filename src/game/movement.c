@@ -44,6 +44,8 @@
 #include "clearpath.h"
 #include "position.h"
 #include "fog_of_war.h"
+#include "snapshot.h"
+#include "journal.h"
 #include "public/game.h"
 #include "../config.h"
 #include "../camera.h"
@@ -92,8 +94,8 @@ static int hz_count(enum movement_hz hz);
 #define MAX_FORCE             (0.75f)
 #define SCALED_MAX_FORCE      (MAX_FORCE / hz_count(s_move_work.hz) * 20.0)
 #define VEL_HIST_LEN          (14)
-#define MAX_MOVE_TASKS        (64)
 #define MAX_GPU_FLOCK_MEMBERS (1024)  /* Must match movement.glsl */
+#define MAX_CACHED_NEIGHBOURS (128)
 
 #define SIGNUM(x)    (((x) > 0) - ((x) < 0))
 #define MAX(a, b)    ((a) > (b) ? (a) : (b))
@@ -143,6 +145,48 @@ enum move_state{
     STATE_ARRIVING_TO_CELL
 };
 
+/* A Verlet list of the entities that were within CLEARPATH_NEIGHBOUR_RADIUS 
+ * plus NEIGHBOUR_SKIN of the entity when it was built. It stays valid until 
+ * the entity's own displacement plus the furthest any other entity may have 
+ * travelled since the build exceeds the skin, at which point some entity 
+ * outside the list might have come within the neighbour radius. 
+ */
+struct neighb_cache{
+    uint32_t epoch;         /* s_neighb_epoch at build time, 0 if never built */
+    double   drift;         /* s_neighb_drift at build time */
+    vec2_t   xz_pos;
+    int      count;
+    uint32_t uids[MAX_CACHED_NEIGHBOURS];
+};
+
+/* The rate at which an entity's velocity is recomputed. Flocks that are 
+ * cruising off-screen and away from enemies only steer every 
+ * LOD_REDUCED_PERIOD ticks, against fewer neighbours. In between, they keep 
+ * the previous tick's velocity. Deterministic and headless runs leave out 
+ * the camera and pick the tier from the simulation state alone, so that it 
+ * is the same in replays.
+ */
+enum move_lod{
+    MOVE_LOD_FULL,
+    MOVE_LOD_REDUCED,
+};
+
+enum lod_count{
+    LOD_COUNT_AWAKE,
+    LOD_COUNT_FULL,
+    LOD_COUNT_REDUCED,
+    LOD_COUNT_SKIPPED,
+    LOD_COUNT_MAX
+};
+
+enum neighb_result{
+    NEIGHB_REUSED,
+    NEIGHB_REBUILT,
+    /* More candidates than fit in the cache; queried afresh every tick */
+    NEIGHB_OVERFLOWED,
+    NEIGHB_RESULT_MAX
+};
+
 struct movestate{
     enum move_state state;
     /* The base movement speed in units of OpenGL coords / second 
@@ -202,6 +246,19 @@ struct movestate{
     /* Per-unit fine-arrival state. 
      */
     struct arrival_unit_state arrival;
+    /* The cached ClearPath neighbours. Only touched by the entity's own velocity work. 
+     */
+    struct neighb_cache neighb_cache;
+    /* The distance travelled during the movement tick 'travel_tick' 
+     */
+    uint32_t           travel_tick;
+    float              travel;
+    /* The level of detail of the last movement tick 
+     */
+    enum move_lod      lod;
+    /* Moving out of view: the interpolation between ticks is skipped 
+     */
+    bool               offscreen;
 };
 
 struct flock{
@@ -210,6 +267,9 @@ struct flock{
     dest_id_t        dest_id;
     /* Group-arrival state, computed per nav layer present in the flock. */
     struct arrival_group arrival;
+    /* Recomputed at the start of every movement tick */
+    enum move_lod    lod;
+    bool             offscreen;
 };
 
 struct formation_state{
@@ -273,6 +333,9 @@ struct move_work_in{
     bool           has_dest_los;
     struct formation_state fstate;
     vec2_t         cell_arrival_vdes;
+    enum move_lod  lod;
+    /* Keep the previous velocity instead of steering this tick */
+    bool           lod_skip;
 };
 
 struct move_work_out{
@@ -282,18 +345,23 @@ struct move_work_out{
     struct movestate_patch patch;
 };
 
-struct move_task_arg{
-    size_t begin_idx;
-    size_t end_idx;
-};
-
 /* The subset of the gamestate that is necessary 
  * to derive the new entity velocities and positions. 
- * We make a copy of this state so that movement 
+ * We take a snapshot of this state so that movement 
  * computations can safely be done asynchronously,
- * or even be spread over multiple frames. 
+ * or even be spread over multiple frames. The tables
+ * are borrowed from the shared snapshot, and are never
+ * written to.
  */
 struct move_gamestate{
+    struct gs_snapshot    *snapshot;
+    /* The entries that commands patched since the tables were taken 
+     * from the snapshot. These take precedence over the tables. The 
+     * next snapshot picks the same values up from the game. */
+    khash_t(pos)          *patched_positions;
+    khash_t(id)           *patched_flags;
+    khash_t(range)        *patched_sel_radiuses;
+    khash_t(id)           *patched_faction_ids;
     khash_t(id)           *flags;
     khash_t(pos)          *positions;
     bg_ent_t              *postree;
@@ -301,6 +369,8 @@ struct move_gamestate{
     khash_t(id)           *faction_ids;
     khash_t(id)           *ent_gpu_id_map;
     khash_t(id)           *gpu_id_ent_map;
+    /* Dense copy of the hot tables */
+    const struct gs_columns *columns;
     struct map            *map;
     /* Additional state needed for nav_unit_query_ctx */
     struct kh_aabb_s      *aabbs;
@@ -331,11 +401,24 @@ struct move_work{
     struct move_work_in      *in;
     struct move_work_out     *out;
     size_t                    nwork;
-    size_t                    ntasks;
-    uint32_t                  tids[MAX_MOVE_TASKS];
     SDL_atomic_t              gpu_velocities_ready;
     vec2_t                   *gpu_velocities;
-    struct future             futures[MAX_MOVE_TASKS];
+    struct pfor               pfor;
+};
+
+/* The arrival preparation for a single flock. The members' unit states 
+ * are private copies, merged back into the movestates once the task is 
+ * joined on the main thread.
+ */
+struct arrival_work{
+    struct arrival_group      *grp;
+    vec2_t                     target_xz;
+    int                        nmembers;
+    uint32_t                  *uids;
+    struct arrival_member     *members;
+    struct arrival_unit_state *units;
+    uint32_t                   tid;
+    struct future              future;
 };
 
 /* Must match movement.glsl */
@@ -395,7 +478,6 @@ struct move_cmd{
 };
 
 KHASH_MAP_INIT_INT(state, struct movestate)
-KHASH_MAP_INIT_INT(aabb, struct aabb)
 
 QUEUE_TYPE(cmd, struct move_cmd)
 QUEUE_IMPL(static, cmd, struct move_cmd)
@@ -435,6 +517,10 @@ static struct result navigation_tick_task(void *arg);
 #define MOVE_HEADING_HALT               (90.0f) /* degrees; halt a moving unit to re-aim past this */
 #define MOVE_HEADING_RESUME             (10.0f) /* degrees; resume/start a halted unit within this */
 #define MAX_NEIGHBOURS                  (32)
+#define NEIGHBOUR_SKIN                  (3.0f)  /* Extra radius kept in the cached neighbour lists */
+#define MAX_NEIGHBOURS_COARSE           (8)     /* The neighbour cap of reduced-rate entities */
+#define LOD_REDUCED_PERIOD              (4)     /* Ticks between velocity updates of reduced-rate entities */
+#define LOD_ENEMY_MARGIN                (75.0f) /* Flocks with enemies this much past their extent run at full rate */
 #define CLEARPATH_STILL_SPEED           (0.3f)  /* A neighbour slower than this is treated as static (full, non-reciprocal avoidance) so a settling unit is not passed through */
 
 #define SURROUND_LOW_WATER_X            (CHUNK_WIDTH/3.0f)
@@ -477,10 +563,38 @@ static bool                    s_move_hz_dirty = false;
 static bool                    s_use_gpu = true;
 static bool                    s_move_tick_queued = false;
 
-static uint32_t                s_tick_task_tid = NULL_TID;
+/* An upper bound on how far any single entity may have travelled, accumulated 
+ * over the movement ticks. Neighbour lists built at different times compare 
+ * their snapshot of it against the current value. 
+ */
+static double                  s_neighb_drift = 0.0;
+static float                   s_neighb_tick_travel = 0.0f;
+static uint32_t                s_neighb_tick = 1;
+/* Bumped whenever entities are added, invalidating all the neighbour lists */
+static uint32_t                s_neighb_epoch = 1;
+/* Neighbour list outcomes of the velocity work in flight, and of the last 
+ * finished tick. Indexed by 'enum neighb_result'.
+ */
+static SDL_atomic_t            s_neighb_counts[NEIGHB_RESULT_MAX];
+static unsigned                s_neighb_last_counts[NEIGHB_RESULT_MAX];
+/* The entities that may need work: the moving ones, the ones that have 
+ * interpolation steps left and the combat-held ones. The rest are asleep 
+ * and are skipped by the per-tick loops until their motion starts.
+ */
+static khash_t(entity)        *s_awake_ents;
+static uint32_t                s_lod_tick = 0;
+static unsigned                s_lod_last_counts[LOD_COUNT_MAX];
+/* Per-flock arrival updates in flight, and the navigation snapshot that 
+ * they read. 
+ */
+static struct memstack         s_arrival_mem;
+static struct arrival_work    *s_arrival_work;
+static size_t                  s_narrival_work;
+static struct refcounted_map  *s_arrival_nav;
+
+static uint32_t                s_tick_node = NULL_NODE;
 /* Published by the navigation task onto itself at entry and cleared at exit, */
 static uint32_t                s_nav_task_active_tid = NULL_TID;
-static struct future           s_tick_task_future;
 
 static const char *s_state_str[] = {
     [STATE_MOVING]              = STR(STATE_MOVING),
@@ -509,6 +623,226 @@ static struct movestate *movestate_get(uint32_t uid)
     return &kh_value(s_entity_state_table, k);
 }
 
+struct hot_state{
+    uint32_t flags;
+    vec2_t   xz_pos;
+    float    radius;
+};
+
+static inline bool move_patched_pos(uint32_t uid, vec3_t *out)
+{
+    khash_t(pos) *patched = s_move_work.gamestate.patched_positions;
+    if(kh_size(patched) == 0)
+        return false;
+    khiter_t k = kh_get(pos, patched, uid);
+    if(k == kh_end(patched))
+        return false;
+    *out = kh_value(patched, k);
+    return true;
+}
+
+static inline bool move_patched_id(khash_t(id) *patched, uint32_t uid, int *out)
+{
+    if(kh_size(patched) == 0)
+        return false;
+    khiter_t k = kh_get(id, patched, uid);
+    if(k == kh_end(patched))
+        return false;
+    *out = kh_value(patched, k);
+    return true;
+}
+
+static inline bool move_patched_radius(uint32_t uid, float *out)
+{
+    khash_t(range) *patched = s_move_work.gamestate.patched_sel_radiuses;
+    if(kh_size(patched) == 0)
+        return false;
+    khiter_t k = kh_get(range, patched, uid);
+    if(k == kh_end(patched))
+        return false;
+    *out = kh_value(patched, k);
+    return true;
+}
+
+/* The patched entries are looked up first. The columns only hold the 
+ * entities that had a position when the snapshot was built. Anything 
+ * else is read from the tables. 
+ */
+static inline uint32_t move_column_index(uint32_t uid)
+{
+    const struct gs_columns *cols = s_move_work.gamestate.columns;
+    return cols ? G_Columns_Index(cols, uid) : PF_SSET_NONE;
+}
+
+static inline vec3_t move_pos(uint32_t uid)
+{
+    vec3_t ret;
+    if(move_patched_pos(uid, &ret))
+        return ret;
+    return G_Pos_GetFrom(s_move_work.gamestate.positions, uid);
+}
+
+static inline bool move_has_pos(uint32_t uid)
+{
+    vec3_t pos;
+    if(move_patched_pos(uid, &pos))
+        return true;
+    khash_t(pos) *positions = s_move_work.gamestate.positions;
+    return (kh_get(pos, positions, uid) != kh_end(positions));
+}
+
+static inline vec2_t move_xz_pos(uint32_t uid)
+{
+    vec3_t pos;
+    if(move_patched_pos(uid, &pos))
+        return (vec2_t){pos.x, pos.z};
+    uint32_t idx = move_column_index(uid);
+    if(idx != PF_SSET_NONE)
+        return s_move_work.gamestate.columns->xz_pos[idx];
+    return G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
+}
+
+static inline uint32_t move_flags(uint32_t uid)
+{
+    int flags;
+    if(move_patched_id(s_move_work.gamestate.patched_flags, uid, &flags))
+        return flags;
+    uint32_t idx = move_column_index(uid);
+    if(idx != PF_SSET_NONE)
+        return s_move_work.gamestate.columns->flags[idx];
+    return G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+}
+
+static inline float move_radius(uint32_t uid)
+{
+    float radius;
+    if(move_patched_radius(uid, &radius))
+        return radius;
+    uint32_t idx = move_column_index(uid);
+    if(idx != PF_SSET_NONE)
+        return s_move_work.gamestate.columns->sel_radius[idx];
+    return G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid);
+}
+
+static inline int move_faction_id(uint32_t uid)
+{
+    int faction_id;
+    if(move_patched_id(s_move_work.gamestate.patched_faction_ids, uid, &faction_id))
+        return faction_id;
+    uint32_t idx = move_column_index(uid);
+    if(idx != PF_SSET_NONE)
+        return s_move_work.gamestate.columns->faction_id[idx];
+    return G_GetFactionIDFrom(s_move_work.gamestate.faction_ids, uid);
+}
+
+static inline struct hot_state move_hot_state(uint32_t uid)
+{
+    return (struct hot_state){
+        .flags = move_flags(uid),
+        .xz_pos = move_xz_pos(uid),
+        .radius = move_radius(uid)
+    };
+}
+
+/* Like 'move_hot_state', but for entities that may have been removed 
+ * since the uid was obtained. 
+ */
+static bool move_hot_state_find(uint32_t uid, struct hot_state *out)
+{
+    if(move_column_index(uid) == PF_SSET_NONE && !move_has_pos(uid))
+        return false;
+    *out = move_hot_state(uid);
+    return true;
+}
+
+/* Commands patch movement's view of the gamestate to keep it in step with 
+ * the changes that they mirror. The tables are shared with the snapshot, 
+ * which may be concurrently read by other systems, so only the touched 
+ * entries are recorded, on the side. The position grid is not patched - 
+ * spatial queries see the patched entities where they were as of the 
+ * snapshot. The patches are dropped along with the tables, as the next 
+ * snapshot already holds the same values. 
+ */
+static bool move_patch_pos(uint32_t uid, vec3_t pos)
+{
+    int ret;
+    khiter_t k = kh_put(pos, s_move_work.gamestate.patched_positions, uid, &ret);
+    if(ret == -1)
+        return false;
+    kh_value(s_move_work.gamestate.patched_positions, k) = pos;
+    return true;
+}
+
+static bool move_patch_flags(uint32_t uid, uint32_t flags)
+{
+    int ret;
+    khiter_t k = kh_put(id, s_move_work.gamestate.patched_flags, uid, &ret);
+    if(ret == -1)
+        return false;
+    kh_value(s_move_work.gamestate.patched_flags, k) = flags;
+    return true;
+}
+
+static bool move_patch_radius(uint32_t uid, float radius)
+{
+    int ret;
+    khiter_t k = kh_put(range, s_move_work.gamestate.patched_sel_radiuses, uid, &ret);
+    if(ret == -1)
+        return false;
+    kh_value(s_move_work.gamestate.patched_sel_radiuses, k) = radius;
+    return true;
+}
+
+static bool move_patch_faction_id(uint32_t uid, int faction_id)
+{
+    int ret;
+    khiter_t k = kh_put(id, s_move_work.gamestate.patched_faction_ids, uid, &ret);
+    if(ret == -1)
+        return false;
+    kh_value(s_move_work.gamestate.patched_faction_ids, k) = faction_id;
+    return true;
+}
+
+static bool move_init_patches(void)
+{
+    struct move_gamestate *gs = &s_move_work.gamestate;
+    if(NULL == (gs->patched_positions = kh_init(pos)))
+        goto fail_positions;
+    if(NULL == (gs->patched_flags = kh_init(id)))
+        goto fail_flags;
+    if(NULL == (gs->patched_sel_radiuses = kh_init(range)))
+        goto fail_sel_radiuses;
+    if(NULL == (gs->patched_faction_ids = kh_init(id)))
+        goto fail_faction_ids;
+    return true;
+
+fail_faction_ids:
+    kh_destroy(range, gs->patched_sel_radiuses);
+fail_sel_radiuses:
+    kh_destroy(id, gs->patched_flags);
+fail_flags:
+    kh_destroy(pos, gs->patched_positions);
+fail_positions:
+    return false;
+}
+
+static void move_destroy_patches(void)
+{
+    struct move_gamestate *gs = &s_move_work.gamestate;
+    kh_destroy(pos, gs->patched_positions);
+    kh_destroy(id, gs->patched_flags);
+    kh_destroy(range, gs->patched_sel_radiuses);
+    kh_destroy(id, gs->patched_faction_ids);
+}
+
+static void move_clear_patches(void)
+{
+    kh_clear(pos, s_move_work.gamestate.patched_positions);
+    kh_clear(id, s_move_work.gamestate.patched_flags);
+    kh_clear(range, s_move_work.gamestate.patched_sel_radiuses);
+    kh_clear(id, s_move_work.gamestate.patched_faction_ids);
+}
+
 static void flock_try_remove(struct flock *flock, uint32_t uid)
 {
     khiter_t k;
@@ -572,18 +906,18 @@ static struct flock *flock_for_dest(dest_id_t id)
 
 static struct arrival_state *flock_arrival_for_ent(const struct flock *flock, uint32_t uid)
 {
-    float radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid);
-    uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    float radius = move_radius(uid);
+    uint32_t flags = move_flags(uid);
     return G_ArrivalGroup_ForLayer(&flock->arrival, Entity_NavLayerWithRadius(flags, radius));
 }
 
 static void entity_block(uint32_t uid)
 {
-    float sel_radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid);
-    vec2_t pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
-    uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    float sel_radius = move_radius(uid);
+    vec2_t pos = move_xz_pos(uid);
+    uint32_t flags = move_flags(uid);
     M_NavBlockersIncref(pos, sel_radius, 
-        G_GetFactionIDFrom(s_move_work.gamestate.faction_ids, uid), flags, s_map);
+        move_faction_id(uid), flags, s_map);
     M_NavInvalidateZoneFieldsAt(s_move_work.gamestate.map, pos,
         Entity_NavLayerWithRadius(flags, sel_radius));
 
@@ -607,8 +941,8 @@ static void entity_unblock(uint32_t uid)
     struct movestate *ms = movestate_get(uid);
     assert(ms->blocking);
 
-    int faction_id = G_GetFactionIDFrom(s_move_work.gamestate.faction_ids, uid);
-    uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    int faction_id = move_faction_id(uid);
+    uint32_t flags = move_flags(uid);
     M_NavBlockersDecref(ms->last_stop_pos, ms->last_stop_radius, faction_id, flags, s_map);
     M_NavInvalidateZoneFieldsAt(s_move_work.gamestate.map, ms->last_stop_pos,
         Entity_NavLayerWithRadius(flags, ms->last_stop_radius));
@@ -669,8 +1003,16 @@ static float entity_speed(uint32_t uid)
 /* Callers emit these only at motion transitions, in matched start/end pairs. A start is
  * suppressed while COMBAT_HELD so a held unit keeps its idle/attack clip, not its walk clip.
  */
+static void move_wake(uint32_t uid)
+{
+    int ret;
+    kh_put(entity, s_awake_ents, uid, &ret);
+    assert(ret != -1);
+}
+
 static void move_notify_motion_start(uint32_t uid, struct movestate *ms)
 {
+    move_wake(uid);
     if(G_FlagsGet(uid) & ENTITY_FLAG_COMBAT_HELD)
         return;
     memset(ms->vel_hist, 0, sizeof(ms->vel_hist));
@@ -759,9 +1101,9 @@ static void filter_selection_pathable(const vec_entity_t *in_sel, vec_entity_t *
         if(!ms)
             continue;
 
-        vec2_t xz_pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, curr);
-        float radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, curr);
-        uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, curr);
+        vec2_t xz_pos = move_xz_pos(curr);
+        float radius = move_radius(curr);
+        uint32_t flags = move_flags(curr);
         if(!M_NavPositionPathable(s_map, Entity_NavLayerWithRadius(flags, radius), xz_pos))
             continue;
         vec_entity_push(out_sel, curr);
@@ -779,8 +1121,8 @@ static void split_into_layers(const vec_entity_t *sel, vec_entity_t layer_flocks
     for(int i = 0; i < vec_size(sel); i++) {
 
         uint32_t curr = vec_AT(sel, i);
-        float radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, curr);
-        uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, curr);
+        float radius = move_radius(curr);
+        uint32_t flags = move_flags(curr);
         enum nav_layer layer = Entity_NavLayerWithRadius(flags, radius);
         vec_entity_push(&layer_flocks[layer], curr);
     }
@@ -800,7 +1142,7 @@ static bool make_flock(const vec_entity_t *units, vec2_t target_xz,
     /* The following won't be optimal when the entities in the unitsection are on different 
      * 'islands'. Handling that case is not a top priority. 
      */
-    vec2_t first_ent_pos_xz = G_Pos_GetXZFrom(s_move_work.gamestate.positions, first);
+    vec2_t first_ent_pos_xz = move_xz_pos(first);
     target_xz = M_NavClosestReachableDest(s_map, layer, first_ent_pos_xz, target_xz);
 
     /* First remove the entities in the unitsection from any active flocks */
@@ -835,13 +1177,13 @@ static bool make_flock(const vec_entity_t *units, vec2_t target_xz,
         flock_add(&new_flock, curr_ent);
         ms->state = (type == FORMATION_NONE) ? STATE_MOVING : STATE_MOVING_IN_FORMATION;
         G_Arrival_InitUnit(&ms->arrival,
-            G_Pos_GetXZFrom(s_move_work.gamestate.positions, curr_ent));
+            move_xz_pos(curr_ent));
     }
 
     /* The flow fields will be computed on-demand during the next movement update tick */
     new_flock.target_xz = target_xz;
     if(attack) {
-        int faction_id = G_GetFactionIDFrom(s_move_work.gamestate.faction_ids, first);
+        int faction_id = move_faction_id(first);
         new_flock.dest_id = M_NavDestIDForPosAttacking(s_map, target_xz, layer, faction_id);
     }else{
         new_flock.dest_id = M_NavDestIDForPos(s_map, target_xz, layer);
@@ -863,7 +1205,7 @@ static bool make_flock(const vec_entity_t *units, vec2_t target_xz,
 
     }else{
         formation_id_t fid;
-        int faction_id = G_GetFactionIDFrom(s_move_work.gamestate.faction_ids, first);
+        int faction_id = move_faction_id(first);
         vec_flock_push(&s_flocks, new_flock);
     }
 
@@ -874,7 +1216,8 @@ static bool make_flock(const vec_entity_t *units, vec2_t target_xz,
 
 /* Build a plain-data snapshot of the flock's live members (existing entities only) for the
  * arrival module, which never touches the movement gamestate itself. Returns the count. */
-static int build_arrival_members(const struct flock *flock, struct arrival_member *out, int max)
+static int build_arrival_members(const struct flock *flock, struct arrival_member *out, 
+                                 uint32_t *out_uids, int max)
 {
     int n = 0;
     uint32_t uid;
@@ -892,14 +1235,41 @@ static int build_arrival_members(const struct flock *flock, struct arrival_membe
         out[n].radius = radius;
         out[n].layer = Entity_NavLayerWithRadius(G_FlagsGet(uid), radius);
         out[n].us = &ms->arrival;
+        if(out_uids) {
+            out_uids[n] = uid;
+        }
         n++;
     });
     return n;
 }
 
-static void update_flock_arrival_fields(void)
+static struct result arrival_task(void *arg)
+{
+    PERF_ENTER();
+
+    struct arrival_work *work = arg;
+    G_ArrivalGroup_Update(work->grp, s_arrival_nav->snapshot, work->target_xz, 
+        work->members, work->nmembers);
+
+    PERF_RETURN(NULL_RESULT);
+}
+
+/* Kick off the arrival updates of the flocks, one task per flock. These 
+ * read 'nav', the snapshot of the navigation state taken before this tick's 
+ * map update, so they may overlap it. Nothing else may touch the flocks' 
+ * arrival state or the flock set until 'join_flock_arrival_work'.
+ */
+static void submit_flock_arrival_work(struct refcounted_map *nav)
 {
     ASSERT_IN_MAIN_THREAD();
+    PERF_ENTER();
+    assert(!s_arrival_nav);
+
+    s_arrival_nav = nav;
+    s_narrival_work = 0;
+    s_arrival_work = stalloc(&s_arrival_mem, 
+        vec_size(&s_flocks) * sizeof(struct arrival_work));
+
     for(int i = 0; i < vec_size(&s_flocks); i++) {
         struct flock *flock = &vec_AT(&s_flocks, i);
 
@@ -912,11 +1282,74 @@ static void update_flock_arrival_fields(void)
             continue;
         }
 
-        STALLOC(struct arrival_member, members, kh_size(flock->ents));
-        int n = build_arrival_members(flock, members, kh_size(flock->ents));
-        G_ArrivalGroup_Update(&flock->arrival, s_map, flock->target_xz, members, n);
-        STFREE(members);
+        size_t max = kh_size(flock->ents);
+        struct arrival_work *work = &s_arrival_work[s_narrival_work++];
+        work->grp = &flock->arrival;
+        work->target_xz = flock->target_xz;
+        work->uids = stalloc(&s_arrival_mem, max * sizeof(uint32_t));
+        work->members = stalloc(&s_arrival_mem, max * sizeof(struct arrival_member));
+        work->units = stalloc(&s_arrival_mem, max * sizeof(struct arrival_unit_state));
+        work->nmembers = build_arrival_members(flock, work->members, work->uids, max);
+
+        for(int j = 0; j < work->nmembers; j++) {
+            work->units[j] = *work->members[j].us;
+            work->members[j].us = &work->units[j];
+        }
+
+        SDL_AtomicSet(&work->future.status, FUTURE_INCOMPLETE);
+        work->tid = NULL_TID;
+        if(nav) {
+            work->tid = Sched_Create(4, arrival_task, work, "move::arrival", 
+                &work->future, TASK_BIG_STACK);
+        }
+    }
+
+    /* Without a snapshot, the live map is the only navigation state. It is 
+     * safe to read here, before the map update. 
+     */
+    for(int i = 0; i < s_narrival_work; i++) {
+        struct arrival_work *work = &s_arrival_work[i];
+        if(work->tid != NULL_TID)
+            continue;
+        G_ArrivalGroup_Update(work->grp, s_map, work->target_xz, work->members, work->nmembers);
+        SDL_AtomicSet(&work->future.status, FUTURE_COMPLETE);
+    }
+
+    PERF_RETURN_VOID();
+}
+
+/* Wait for the arrival updates and fold the slot assignments back into the 
+ * movestates. The results are applied in flock order, independent of the 
+ * order in which the tasks finished.
+ */
+static void join_flock_arrival_work(void)
+{
+    ASSERT_IN_MAIN_THREAD();
+    PERF_ENTER();
+
+    for(int i = 0; i < s_narrival_work; i++) {
+        struct arrival_work *work = &s_arrival_work[i];
+        while(!Sched_FutureIsReady(&work->future)) {
+            Sched_RunSync(work->tid);
+            Sched_TryYield();
+        }
+        for(int j = 0; j < work->nmembers; j++) {
+            struct movestate *ms = movestate_get(work->uids[j]);
+            if(!ms)
+                continue;
+            G_Arrival_MergeUnit(&ms->arrival, &work->units[j]);
+        }
+    }
+
+    if(s_arrival_nav) {
+        sp_release(s_arrival_nav);
+        s_arrival_nav = NULL;
     }
+    s_arrival_work = NULL;
+    s_narrival_work = 0;
+    stalloc_clear(&s_arrival_mem);
+
+    PERF_RETURN_VOID();
 }
 
 static void request_flock_arrival_fields(void)
@@ -953,7 +1386,7 @@ static void make_flocks(const vec_entity_t *sel, vec2_t target_xz, vec2_t target
 static size_t adjacent_flock_members(uint32_t uid, const struct flock *flock, 
                                      uint32_t out[])
 {
-    vec2_t ent_xz_pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
+    vec2_t ent_xz_pos = move_xz_pos(uid);
     size_t ret = 0;
     uint32_t curr;
 
@@ -963,11 +1396,11 @@ static size_t adjacent_flock_members(uint32_t uid, const struct flock *flock,
             continue;
 
         vec2_t diff;
-        vec2_t curr_xz_pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, curr);
+        vec2_t curr_xz_pos = move_xz_pos(curr);
         PFM_Vec2_Sub(&ent_xz_pos, &curr_xz_pos, &diff);
 
-        float radius_uid = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid);
-        float radius_curr = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, curr);
+        float radius_uid = move_radius(uid);
+        float radius_curr = move_radius(curr);
 
         if(PFM_Vec2_Len(&diff) <= radius_uid + radius_curr + ADJACENCY_SEP_DIST) {
             out[ret++] = curr;  
@@ -985,9 +1418,9 @@ static int adjacent_settled_count(uint32_t uid)
      * A unit boxed in by another layer's settled ball (a separate flock) has 
      * none of its own to touch and would otherwise never satisfy the settle cascade. 
      */
-    vec2_t pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
-    float radius_uid = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid);
-    uint32_t ent_flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    vec2_t pos = move_xz_pos(uid);
+    float radius_uid = move_radius(uid);
+    uint32_t ent_flags = move_flags(uid);
 
     /* The acceptance test scales its cutoff with both radii, so the query radius must too,
      * else two large units never register as adjacent and the settle cascade starves.
@@ -1003,7 +1436,7 @@ static int adjacent_settled_count(uint32_t uid)
         uint32_t curr = near_ents[i];
         if(curr == uid)
             continue;
-        uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, curr);
+        uint32_t flags = move_flags(curr);
         if(!(flags & ENTITY_FLAG_MOVABLE))
             continue;
         if((ent_flags & ENTITY_FLAG_AIR) != (flags & ENTITY_FLAG_AIR))
@@ -1011,8 +1444,8 @@ static int adjacent_settled_count(uint32_t uid)
         const struct movestate *ams = movestate_get(curr);
         if(!ams || ams->state != STATE_ARRIVED)
             continue;
-        vec2_t cpos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, curr);
-        float radius_curr = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, curr);
+        vec2_t cpos = move_xz_pos(curr);
+        float radius_curr = move_radius(curr);
         vec2_t diff;
         PFM_Vec2_Sub(&pos, &cpos, &diff);
         if(PFM_Vec2_Len(&diff) <= radius_uid + radius_curr + ADJACENCY_SEP_DIST)
@@ -1055,6 +1488,11 @@ static void move_order(const vec_entity_t *sel, bool attack, vec3_t mouse_coord,
         if(!(flags & ENTITY_FLAG_MOVABLE))
             continue;
 
+        /* Stopping harvesting, building or garrisoning bypasses the journal */
+        if(flags & (ENTITY_FLAG_HARVESTER | ENTITY_FLAG_BUILDER 
+                  | ENTITY_FLAG_GARRISON | ENTITY_FLAG_GARRISONABLE)) {
+            G_Journal_NoteUnjournaled("stop");
+        }
         G_StopEntity(curr, false, true);
         E_Entity_Notify(EVENT_MOVE_ISSUED, curr, NULL, ES_ENGINE);
         G_NotifyOrderIssued(curr, true);
@@ -1308,9 +1746,8 @@ static void on_render_3d(void *user, void *event)
                     break;
 
                 if(ms->using_surround_field) {
-                    float radius = G_GetSelectionRadiusFrom(
-                        s_move_work.gamestate.sel_radiuses, ent);
-                    uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, ent);
+                    float radius = move_radius(ent);
+                    uint32_t flags = move_flags(ent);
                     int layer = Entity_NavLayerWithRadius(flags, radius); 
                     M_NavRenderVisibleSurroundField(s_map, cam, layer, ms->surround_target_uid);
                     UI_DrawText("(Surround Field)", (struct rect){5,75,600,50}, text_color);
@@ -1325,11 +1762,10 @@ static void on_render_3d(void *user, void *event)
             case STATE_TURNING:
                 break;
             case STATE_SEEK_ENEMIES: {
-                float radius = G_GetSelectionRadiusFrom(
-                    s_move_work.gamestate.sel_radiuses, ent);
-                uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, ent);
+                float radius = move_radius(ent);
+                uint32_t flags = move_flags(ent);
                 int layer = Entity_NavLayerWithRadius(flags, radius); 
-                int faction_id = G_GetFactionIDFrom(s_move_work.gamestate.faction_ids, ent);
+                int faction_id = move_faction_id(ent);
                 M_NavRenderVisibleEnemySeekField(s_map, cam, layer, faction_id);
                 break;
             }
@@ -1400,7 +1836,7 @@ static void on_render_3d(void *user, void *event)
             if(!G_ArrivalGroup_IsActive(&flock->arrival))
                 continue;
             STALLOC(struct arrival_member, members, kh_size(flock->ents));
-            int n = build_arrival_members(flock, members, kh_size(flock->ents));
+            int n = build_arrival_members(flock, members, NULL, kh_size(flock->ents));
             G_ArrivalGroup_RenderDebug(&flock->arrival, cam, s_map, flock->dest_id,
                 dbg_flock_pal[i % ARR_SIZE(dbg_flock_pal)], members, n);
             STFREE(members);
@@ -1423,8 +1859,7 @@ static quat_t dir_quat_from_velocity(vec2_t velocity)
 
 static bool entity_exists(uint32_t uid)
 {
-    khiter_t k = kh_get(pos, s_move_work.gamestate.positions, uid);
-    return (k != kh_end(s_move_work.gamestate.positions));
+    return move_has_pos(uid);
 }
 
 static void request_async_field(uint32_t uid)
@@ -1433,15 +1868,15 @@ static void request_async_field(uint32_t uid)
     if(!ms || ent_still(ms))
         return;
 
-    vec2_t pos_xz = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
+    vec2_t pos_xz = move_xz_pos(uid);
     struct flock *fl = flock_for_ent(uid);
 
     switch(ms->state) {
     case STATE_SEEK_ENEMIES:  {
-        float radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid);
-        uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+        float radius = move_radius(uid);
+        uint32_t flags = move_flags(uid);
         int layer = Entity_NavLayerWithRadius(flags, radius);
-        int faction_id = G_GetFactionIDFrom(s_move_work.gamestate.faction_ids, uid);
+        int faction_id = move_faction_id(uid);
         return M_NavRequestAsyncEnemySeekField(s_move_work.gamestate.map, 
             layer, pos_xz, faction_id);
     }
@@ -1451,10 +1886,10 @@ static void request_async_field(uint32_t uid)
             return;
 
         if(ms->using_surround_field) {
-            float radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid);
-            uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+            float radius = move_radius(uid);
+            uint32_t flags = move_flags(uid);
             int layer = Entity_NavLayerWithRadius(flags, radius);
-            int faction_id = G_GetFactionIDFrom(s_move_work.gamestate.faction_ids, uid);
+            int faction_id = move_faction_id(uid);
             return M_NavRequestAsyncSurroundField(s_move_work.gamestate.map, layer, pos_xz, 
                 ms->surround_target_uid, faction_id);
         }
@@ -1465,10 +1900,24 @@ static void request_async_field(uint32_t uid)
     }
 }
 
+/* The subsystem that the field cache attributes an entity's field queries to */
+static enum fc_requester ent_field_requester(const struct move_work_in *in)
+{
+    const struct movestate *ms = movestate_get(in->ent_uid);
+
+    switch(ms->state) {
+    case STATE_SEEK_ENEMIES:
+    case STATE_SURROUND_ENTITY:
+        return FC_REQ_COMBAT;
+    default:
+        return (in->fstate.fid != NULL_FID) ? FC_REQ_FORMATION : FC_REQ_MOVEMENT;
+    }
+}
+
 static vec2_t ent_desired_velocity(uint32_t uid, vec2_t cell_arrival_vdes, bool has_dest_los)
 {
     const struct movestate *ms = movestate_get(uid);
-    vec2_t pos_xz = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
+    vec2_t pos_xz = move_xz_pos(uid);
     struct flock *fl = flock_for_ent(uid);
 
     switch(ms->state) {
@@ -1476,10 +1925,10 @@ static vec2_t ent_desired_velocity(uint32_t uid, vec2_t cell_arrival_vdes, bool
         return (vec2_t){0.0f, 0.0f};
 
     case STATE_SEEK_ENEMIES:  {
-        float radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid);
-        uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+        float radius = move_radius(uid);
+        uint32_t flags = move_flags(uid);
         int layer = Entity_NavLayerWithRadius(flags, radius);
-        int faction_id = G_GetFactionIDFrom(s_move_work.gamestate.faction_ids, uid);
+        int faction_id = move_faction_id(uid);
         return M_NavDesiredEnemySeekVelocity(s_move_work.gamestate.map, layer, pos_xz, faction_id);
     }
     case STATE_SURROUND_ENTITY: {
@@ -1490,10 +1939,10 @@ static vec2_t ent_desired_velocity(uint32_t uid, vec2_t cell_arrival_vdes, bool
         }
 
         if(ms->using_surround_field) {
-            float radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid);
-            uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+            float radius = move_radius(uid);
+            uint32_t flags = move_flags(uid);
             int layer = Entity_NavLayerWithRadius(flags, radius);
-            int faction_id = G_GetFactionIDFrom(s_move_work.gamestate.faction_ids, uid);
+            int faction_id = move_faction_id(uid);
             return M_NavDesiredSurroundVelocity(s_move_work.gamestate.map, layer, pos_xz, 
                 ms->surround_target_uid, faction_id);
         }else{
@@ -1510,8 +1959,11 @@ static vec2_t ent_desired_velocity(uint32_t uid, vec2_t cell_arrival_vdes, bool
         struct movestate *mms = movestate_get(uid);
         struct arrival_state *as = flock_arrival_for_ent(fl, uid);
         vec2_t arrival_vel;
-        if(as && G_Arrival_DesiredVelocity(as, &mms->arrival, s_map,
-            s_move_work.gamestate.map, pos_xz, mms->velocity, has_dest_los, &arrival_vel))
+        enum fc_requester prev = N_FC_SetRequester(FC_REQ_ARRIVAL);
+        bool arriving = as && G_Arrival_DesiredVelocity(as, &mms->arrival, s_map,
+            s_move_work.gamestate.map, pos_xz, mms->velocity, has_dest_los, &arrival_vel);
+        N_FC_SetRequester(prev);
+        if(arriving)
             return arrival_vel;
         return M_NavDesiredPointSeekVelocity(s_move_work.gamestate.map, fl->dest_id,
             pos_xz, fl->target_xz);
@@ -1527,7 +1979,7 @@ static vec2_t seek_force(uint32_t uid, vec2_t target_xz)
     assert(ms);
 
     vec2_t ret, desired_velocity;
-    vec2_t pos_xz = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
+    vec2_t pos_xz = move_xz_pos(uid);
 
     PFM_Vec2_Sub(&target_xz, &pos_xz, &desired_velocity);
     PFM_Vec2_Normal(&desired_velocity, &desired_velocity);
@@ -1546,7 +1998,7 @@ static vec2_t seek_force(uint32_t uid, vec2_t target_xz)
 static vec2_t arrive_force_point(uint32_t uid, vec2_t target_xz, vec2_t vdes, bool has_dest_los)
 {
     vec2_t ret, desired_velocity;
-    vec2_t pos_xz = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
+    vec2_t pos_xz = move_xz_pos(uid);
     float distance;
 
     struct movestate *ms = movestate_get(uid);
@@ -1575,7 +2027,7 @@ static vec2_t arrive_force_point(uint32_t uid, vec2_t target_xz, vec2_t vdes, bo
 static vec2_t arrive_force_cell(uint32_t uid, vec2_t cell_xz, vec2_t vdes)
 {
     struct movestate *ms = movestate_get(uid);
-    vec2_t pos_xz = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
+    vec2_t pos_xz = move_xz_pos(uid);
     float distance;
 
     vec2_t desired_velocity;
@@ -1593,7 +2045,7 @@ static vec2_t arrive_force_cell(uint32_t uid, vec2_t cell_xz, vec2_t vdes)
 static vec2_t arrive_force_enemies(uint32_t uid, vec2_t vdes)
 {
     vec2_t ret, desired_velocity;
-    vec2_t pos_xz = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
+    vec2_t pos_xz = move_xz_pos(uid);
     float distance;
 
     const struct movestate *ms = movestate_get(uid);
@@ -1619,8 +2071,8 @@ static vec2_t alignment_force(uint32_t uid, const struct flock *flock)
             continue;
 
         vec2_t diff;
-        vec2_t ent_xz_pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
-        vec2_t curr_xz_pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, curr);
+        vec2_t ent_xz_pos = move_xz_pos(uid);
+        vec2_t curr_xz_pos = move_xz_pos(curr);
 
         PFM_Vec2_Sub(&curr_xz_pos, &ent_xz_pos, &diff);
         if(PFM_Vec2_Len(&diff) < ALIGN_NEIGHBOUR_RADIUS) {
@@ -1654,7 +2106,7 @@ static vec2_t cohesion_force(uint32_t uid, const struct flock *flock)
 {
     vec2_t COM = (vec2_t){0.0f};
     size_t neighbour_count = 0;
-    vec2_t ent_xz_pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
+    vec2_t ent_xz_pos = move_xz_pos(uid);
 
     uint32_t curr;
     kh_foreach_key(flock->ents, curr, {
@@ -1663,7 +2115,7 @@ static vec2_t cohesion_force(uint32_t uid, const struct flock *flock)
             continue;
 
         vec2_t diff;
-        vec2_t curr_xz_pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, curr);
+        vec2_t curr_xz_pos = move_xz_pos(curr);
         PFM_Vec2_Sub(&curr_xz_pos, &ent_xz_pos, &diff);
 
         float t = (PFM_Vec2_Len(&diff) - COHESION_NEIGHBOUR_RADIUS*0.75) 
@@ -1690,18 +2142,18 @@ static vec2_t cohesion_force(uint32_t uid, const struct flock *flock)
 static vec2_t separation_force(uint32_t uid, float buffer_dist)
 {
     vec2_t ret = (vec2_t){0.0f};
-    uint32_t ent_flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    uint32_t ent_flags = move_flags(uid);
 
     uint32_t near_ents[128];
     int num_near = G_Pos_EntsInCircleFrom(s_move_work.gamestate.postree,
         s_move_work.gamestate.flags,
-        G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid), 
+        move_xz_pos(uid), 
         SEPARATION_NEIGHB_RADIUS, near_ents, ARR_SIZE(near_ents));
 
     for(int i = 0; i < num_near; i++) {
 
         uint32_t curr = near_ents[i];
-        uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, curr);
+        uint32_t flags = move_flags(curr);
         if(curr == uid)
             continue;
         if(!(flags & ENTITY_FLAG_MOVABLE))
@@ -1710,11 +2162,11 @@ static vec2_t separation_force(uint32_t uid, float buffer_dist)
             continue;
 
         vec2_t diff;
-        vec2_t ent_xz_pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
-        vec2_t curr_xz_pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, curr);
+        vec2_t ent_xz_pos = move_xz_pos(uid);
+        vec2_t curr_xz_pos = move_xz_pos(curr);
 
-        float radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid) 
-                     + G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, curr) 
+        float radius = move_radius(uid) 
+                     + move_radius(curr) 
                      + buffer_dist;
         PFM_Vec2_Sub(&curr_xz_pos, &ent_xz_pos, &diff);
 
@@ -1774,7 +2226,7 @@ static vec2_t cell_seek_total_force(uint32_t uid, vec2_t cell_pos, vec2_t vdes,
     assert(ms);
 
     vec2_t delta;
-    vec2_t pos_xz = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
+    vec2_t pos_xz = move_xz_pos(uid);
     PFM_Vec2_Sub(&cell_pos, &pos_xz, &delta);
 
     vec2_t arrive = arrive_force_cell(uid, cell_pos, vdes);
@@ -1819,7 +2271,7 @@ static vec2_t enemy_seek_total_force(uint32_t uid, vec2_t vdes)
 
 static vec2_t new_pos_for_vel(uint32_t uid, vec2_t velocity)
 {
-    vec2_t xz_pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
+    vec2_t xz_pos = move_xz_pos(uid);
     vec2_t new_pos;
 
     PFM_Vec2_Add(&xz_pos, &velocity, &new_pos);
@@ -1831,11 +2283,11 @@ static vec2_t new_pos_for_vel(uint32_t uid, vec2_t velocity)
 static void nullify_impass_components(uint32_t uid, vec2_t *inout_force)
 {
     vec2_t nt_dims = N_TileDims();
-    float radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid);
-    uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    float radius = move_radius(uid);
+    uint32_t flags = move_flags(uid);
     enum nav_layer layer = Entity_NavLayerWithRadius(flags, radius);
 
-    vec2_t pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
+    vec2_t pos = move_xz_pos(uid);
     vec2_t left =  (vec2_t){pos.x + nt_dims.x, pos.z};
     vec2_t right = (vec2_t){pos.x - nt_dims.x, pos.z};
     vec2_t top =   (vec2_t){pos.x, pos.z + nt_dims.z};
@@ -2174,9 +2626,9 @@ static bool arrived(uint32_t uid, vec2_t xz_pos)
     assert(flock);
 
     PFM_Vec2_Sub((vec2_t*)&flock->target_xz, &xz_pos, &diff_to_target);
-    float radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid);
+    float radius = move_radius(uid);
     float arrive_thresh = radius * 1.5f;
-    uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    uint32_t flags = move_flags(uid);
     enum nav_layer layer = Entity_NavLayerWithRadius(flags, radius);
 
     if(PFM_Vec2_Len(&diff_to_target) < arrive_thresh
@@ -2198,7 +2650,7 @@ static bool arrived(uint32_t uid, vec2_t xz_pos)
 
 static float unit_height(uint32_t uid, vec2_t pos)
 {
-    uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    uint32_t flags = move_flags(uid);
     if(flags & ENTITY_FLAG_WATER)
         return 0.0f;
     if(flags & ENTITY_FLAG_AIR) {
@@ -2334,8 +2786,8 @@ static void entity_compute_update(enum movement_hz hz, uint32_t uid, vec2_t new_
     }
 
     vec2_t new_pos_xz = new_pos_for_vel(uid, new_vel);
-    float radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid);
-    uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    float radius = move_radius(uid);
+    uint32_t flags = move_flags(uid);
     enum nav_layer layer = Entity_NavLayerWithRadius(flags, radius);
 
     if(flags & ENTITY_FLAG_GARRISONED) {
@@ -2350,7 +2802,7 @@ static void entity_compute_update(enum movement_hz hz, uint32_t uid, vec2_t new_
     /* Refuse to land on a dynamically-blocked tile (a building and the like). 
      * A unit already on a blocker may still step off it. 
      */
-    vec2_t curr_xz = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
+    vec2_t curr_xz = move_xz_pos(uid);
     bool on_blocked = M_NavPositionBlocked(s_move_work.gamestate.map, layer, curr_xz);
 
     if(PFM_Vec2_Len(&new_vel) > 0
@@ -2397,7 +2849,7 @@ static void entity_compute_update(enum movement_hz hz, uint32_t uid, vec2_t new_
         /* A combat-held unit pivots toward its combat facing, not its travel heading. The
          * rotation patch is set only inside a branch that actually computes next_nrot; with no
          * branch taken the unit keeps its current rotation (else next_nrot is left unset). */
-        if(G_FlagsGetFrom(s_move_work.gamestate.flags, uid) & ENTITY_FLAG_COMBAT_HELD) {
+        if(move_flags(uid) & ENTITY_FLAG_COMBAT_HELD) {
             out->flags |= UPDATE_SET_PREV_ROT | UPDATE_SET_NEXT_ROT | UPDATE_SET_ROTATION;
             out->flags |= UPDATE_TURNING_IN_PLACE;
             out->next_prot = ms->next_rot;
@@ -2524,8 +2976,7 @@ static void entity_compute_update(enum movement_hz hz, uint32_t uid, vec2_t new_
             break;
         }
 
-        vec2_t target_pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, 
-            ms->surround_target_uid);
+        vec2_t target_pos = move_xz_pos(ms->surround_target_uid);
         vec2_t dest = ms->surround_nearest_prev;
 
         vec2_t delta;
@@ -2575,8 +3026,7 @@ static void entity_compute_update(enum movement_hz hz, uint32_t uid, vec2_t new_
             break;
         }
 
-        vec2_t xz_target = G_Pos_GetXZFrom(s_move_work.gamestate.positions, 
-            ms->surround_target_uid);
+        vec2_t xz_target = move_xz_pos(ms->surround_target_uid);
 
         vec2_t delta;
         PFM_Vec2_Sub(&new_pos_xz, &xz_target, &delta);
@@ -2674,8 +3124,8 @@ static void entity_compute_update(enum movement_hz hz, uint32_t uid, vec2_t new_
 
 static void ent_update_using_surround_field(uint32_t uid, struct movestate *ms)
 {
-    vec2_t pos_xz = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
-    vec2_t target_pos_xz = G_Pos_GetXZFrom(s_move_work.gamestate.positions, ms->surround_target_uid);
+    vec2_t pos_xz = move_xz_pos(uid);
+    vec2_t target_pos_xz = move_xz_pos(ms->surround_target_uid);
     float dx = fabs(target_pos_xz.x - pos_xz.x);
     float dz = fabs(target_pos_xz.z - pos_xz.z);
 
@@ -2765,9 +3215,21 @@ static void entity_apply_update(uint32_t uid, const struct movestate_patch *patc
     }
 }
 
-static void find_neighbours(uint32_t uid,
-                            vec_cp_ent_t *out_dyn,
-                            vec_cp_ent_t *out_stat)
+static bool neighb_cache_valid(const struct neighb_cache *cache, vec2_t xz_pos)
+{
+    if(cache->epoch != s_neighb_epoch)
+        return false;
+
+    vec2_t delta;
+    PFM_Vec2_Sub(&xz_pos, (vec2_t*)&cache->xz_pos, &delta);
+    return (PFM_Vec2_Len(&delta) + (s_neighb_drift - cache->drift) <= NEIGHBOUR_SKIN);
+}
+
+static enum neighb_result find_neighbours(uint32_t uid,
+                                          struct neighb_cache *cache,
+                                          size_t max_neighbs,
+                                          vec_cp_ent_t *out_dyn,
+                                          vec_cp_ent_t *out_stat)
 {
     /* For the ClearPath algorithm, we only consider entities with
      * ENTITY_FLAG_MOVABLE set, as they are the only ones that may need
@@ -2776,38 +3238,76 @@ static void find_neighbours(uint32_t uid,
      * meaning they will not perform collision avoidance maneuvers of
      * their own. */
 
-    uint32_t ent_flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    struct hot_state ent = move_hot_state(uid);
+    enum neighb_result ret = NEIGHB_REUSED;
     uint32_t near_ents[512];
-    int num_near = G_Pos_EntsInCircleFrom(s_move_work.gamestate.postree, 
-        s_move_work.gamestate.flags,
-        G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid), 
-        CLEARPATH_NEIGHBOUR_RADIUS, near_ents, ARR_SIZE(near_ents));
+    const uint32_t *cands = cache->uids;
+    int num_cands = cache->count;
 
-    for(int i = 0; i < num_near; i++) {
+    if(!neighb_cache_valid(cache, ent.xz_pos)) {
 
-        uint32_t curr = near_ents[i];
-        uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, curr);
+        /* Garrisoned units are kept in the list and filtered below, so that 
+         * one which is ungarrisoned right next to us doesn't stay missing 
+         * until the list is rebuilt.
+         */
+        int num_near = bg_ent_inrange_circle(s_move_work.gamestate.postree, 
+            ent.xz_pos.x, ent.xz_pos.z, CLEARPATH_NEIGHBOUR_RADIUS + NEIGHBOUR_SKIN, 
+            near_ents, ARR_SIZE(near_ents));
+        cands = near_ents;
+        num_cands = num_near;
+
+        if(num_near <= MAX_CACHED_NEIGHBOURS) {
+            memcpy(cache->uids, near_ents, num_near * sizeof(uint32_t));
+            cache->count = num_near;
+            cache->epoch = s_neighb_epoch;
+            cache->drift = s_neighb_drift;
+            cache->xz_pos = ent.xz_pos;
+            ret = NEIGHB_REBUILT;
+        }else{
+            cache->epoch = 0;
+            ret = NEIGHB_OVERFLOWED;
+        }
+    }
+
+    for(int i = 0; i < num_cands; i++) {
 
+        uint32_t curr = cands[i];
         if(curr == uid)
             continue;
 
-        if(!(flags & ENTITY_FLAG_MOVABLE))
+        /* The list holds everything within the skin, so the membership 
+         * tests that depend on the current state are redone every tick. 
+         */
+        struct hot_state neighb;
+        if(!move_hot_state_find(curr, &neighb))
             continue;
 
-        if(G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, curr) == 0.0f)
+        if(!(neighb.flags & ENTITY_FLAG_MOVABLE))
             continue;
 
-        if((ent_flags & ENTITY_FLAG_AIR) != (flags & ENTITY_FLAG_AIR))
+        if(neighb.flags & ENTITY_FLAG_GARRISONED)
+            continue;
+
+        vec2_t delta;
+        PFM_Vec2_Sub(&neighb.xz_pos, &ent.xz_pos, &delta);
+        if(PFM_Vec2_Len(&delta) > CLEARPATH_NEIGHBOUR_RADIUS)
+            continue;
+
+        if(neighb.radius == 0.0f)
+            continue;
+
+        if((ent.flags & ENTITY_FLAG_AIR) != (neighb.flags & ENTITY_FLAG_AIR))
             continue;
 
         struct movestate *ms = movestate_get(curr);
-        assert(ms);
+        if(!ms)
+            continue;
 
-        vec2_t curr_xz_pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, curr);
+        vec2_t curr_xz_pos = neighb.xz_pos;
         struct cp_ent newdesc = (struct cp_ent) {
             .xz_pos = curr_xz_pos,
             .xz_vel = ms->velocity,
-            .radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, curr)
+            .radius = neighb.radius
         };
 
         /* A neighbour right at its arrival slot is about to settle and will not yield,
@@ -2818,13 +3318,76 @@ static void find_neighbours(uint32_t uid,
             /* A static neighbour is a stationary obstacle; its velocity-obstacle apex
              * must sit on its body, not be offset by a stale/leftover velocity. */
             newdesc.xz_vel = (vec2_t){0.0f, 0.0f};
-            if(vec_size(out_stat) < MAX_NEIGHBOURS)
+            if(vec_size(out_stat) < max_neighbs)
                 vec_cp_ent_push(out_stat, newdesc);
         }else {
-            if(vec_size(out_dyn) < MAX_NEIGHBOURS)
+            if(vec_size(out_dyn) < max_neighbs)
                 vec_cp_ent_push(out_dyn, newdesc);
         }
     }
+    return ret;
+}
+
+/* Called once per movement tick, after all the position updates of the 
+ * previous tick have been applied. 
+ */
+static void neighb_lists_tick(void)
+{
+    ASSERT_IN_MAIN_THREAD();
+
+    s_neighb_drift += s_neighb_tick_travel;
+    s_neighb_tick_travel = 0.0f;
+    s_neighb_tick++;
+
+    for(int i = 0; i < NEIGHB_RESULT_MAX; i++) {
+        s_neighb_last_counts[i] = SDL_AtomicGet(&s_neighb_counts[i]);
+        SDL_AtomicSet(&s_neighb_counts[i], 0);
+    }
+}
+
+static void neighb_lists_note_travel(struct movestate *ms, vec3_t oldpos, vec3_t newpos)
+{
+    if(ms->travel_tick != s_neighb_tick) {
+        ms->travel_tick = s_neighb_tick;
+        ms->travel = 0.0f;
+    }
+
+    vec2_t delta = (vec2_t){newpos.x - oldpos.x, newpos.z - oldpos.z};
+    ms->travel += PFM_Vec2_Len(&delta);
+    s_neighb_tick_travel = MAX(s_neighb_tick_travel, ms->travel);
+}
+
+static size_t neighb_trace_counters(size_t maxout, struct perf_counter *out)
+{
+    static const char *s_keys[NEIGHB_RESULT_MAX] = {
+        "reused", "rebuilt", "overflowed"
+    };
+    static const char *s_lod_keys[LOD_COUNT_MAX] = {
+        "awake", "full", "reduced", "skipped"
+    };
+    size_t ret = 0;
+
+    if(ret == maxout)
+        return ret;
+    out[ret].name = "movement neighbour lists";
+    out[ret].nseries = NEIGHB_RESULT_MAX;
+    for(int i = 0; i < NEIGHB_RESULT_MAX; i++) {
+        out[ret].keys[i] = s_keys[i];
+        out[ret].values[i] = s_neighb_last_counts[i];
+    }
+    ret++;
+
+    if(ret == maxout)
+        return ret;
+    out[ret].name = "movement lod";
+    out[ret].nseries = LOD_COUNT_MAX;
+    for(int i = 0; i < LOD_COUNT_MAX; i++) {
+        out[ret].keys[i] = s_lod_keys[i];
+        out[ret].values[i] = s_lod_last_counts[i];
+    }
+    ret++;
+
+    return ret;
 }
 
 static void disband_empty_flocks(void)
@@ -2871,24 +3434,14 @@ static void do_add_entity(uint32_t uid, vec3_t pos, float selection_radius, int
     if(!G_EntityExists(uid))
         return;
 
-    int ret;
-    khiter_t k = kh_put(pos, s_move_work.gamestate.positions, uid, &ret);
-    assert(ret != -1);
-    kh_val(s_move_work.gamestate.positions, k) = pos;
-
-    bg_ent_insert(s_move_work.gamestate.postree, pos.x, pos.z, uid);
-
-    k = kh_put(range, s_move_work.gamestate.sel_radiuses, uid, &ret);
-    assert(ret != -1);
-    kh_value(s_move_work.gamestate.sel_radiuses, k) = selection_radius;
-
-    k = kh_put(id, s_move_work.gamestate.faction_ids, uid, &ret);
-    assert(ret != -1);
-    kh_value(s_move_work.gamestate.faction_ids, k) = faction_id;
+    if(!move_patch_pos(uid, pos)
+    || !move_patch_radius(uid, selection_radius)
+    || !move_patch_faction_id(uid, faction_id)
+    || !move_patch_flags(uid, G_FlagsGet(uid)))
+        return;
 
-    k = kh_put(id, s_move_work.gamestate.flags, uid, &ret);
-    assert(ret != -1);
-    kh_value(s_move_work.gamestate.flags, k) = G_FlagsGet(uid);
+    int ret;
+    khiter_t k;
 
     struct movestate new_ms = (struct movestate) {
         .velocity = {0.0f}, 
@@ -2910,6 +3463,7 @@ static void do_add_entity(uint32_t uid, vec3_t pos, float selection_radius, int
     k = kh_put(state, s_entity_state_table, uid, &ret);
     assert(ret != -1 && ret != 0);
     kh_value(s_entity_state_table, k) = new_ms;
+    s_neighb_epoch++;
 
     entity_block(uid);
 }
@@ -2922,7 +3476,7 @@ static void do_remove_entity(uint32_t uid)
     if(k == kh_end(s_entity_state_table))
         return;
 
-    uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    uint32_t flags = move_flags(uid);
 
     do_stop(uid);
     if(!(flags & ENTITY_FLAG_GARRISONED)) {
@@ -2930,6 +3484,10 @@ static void do_remove_entity(uint32_t uid)
     }
 
     kh_del(state, s_entity_state_table, k);
+
+    k = kh_get(entity, s_awake_ents, uid);
+    if(k != kh_end(s_awake_ents))
+        kh_del(entity, s_awake_ents, k);
 }
 
 static void do_stop(uint32_t uid)
@@ -2952,10 +3510,10 @@ static void do_set_dest(uint32_t uid, vec2_t dest_xz, bool attack)
 {
     ASSERT_IN_MAIN_THREAD();
 
-    float radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid);
-    uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    float radius = move_radius(uid);
+    uint32_t flags = move_flags(uid);
     enum nav_layer layer = Entity_NavLayerWithRadius(flags, radius);
-    vec2_t pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
+    vec2_t pos = move_xz_pos(uid);
     dest_xz = M_NavClosestReachableDest(s_map, layer, pos, dest_xz);
 
     /* If a flock already exists for the entity's destination, 
@@ -2965,7 +3523,7 @@ static void do_set_dest(uint32_t uid, vec2_t dest_xz, bool attack)
      */
     dest_id_t dest_id;
     if(attack) {
-        int faction_id = G_GetFactionIDFrom(s_move_work.gamestate.faction_ids, uid);
+        int faction_id = move_faction_id(uid);
         dest_id = M_NavDestIDForPosAttacking(s_map, dest_xz, layer, faction_id);
     }else{
         dest_id = M_NavDestIDForPos(s_map, dest_xz, layer);
@@ -3056,6 +3614,7 @@ static void do_set_combat_held(uint32_t uid, bool held)
         return;
     G_FlagsSet(uid, held ? (flags | ENTITY_FLAG_COMBAT_HELD)
                          : (flags & ~ENTITY_FLAG_COMBAT_HELD));
+    move_wake(uid);
 
     if(ent_still(ms))
         return;
@@ -3074,9 +3633,9 @@ static void do_set_enter_range(uint32_t uid, uint32_t target, float range)
     if(!ms)
         return;
 
-    vec2_t xz_src = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
-    vec2_t xz_dst = G_Pos_GetXZFrom(s_move_work.gamestate.positions, target);
-    float radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid);
+    vec2_t xz_src = move_xz_pos(uid);
+    vec2_t xz_dst = move_xz_pos(target);
+    float radius = move_radius(uid);
     range = MAX(0.0f, range - radius);
 
     vec2_t delta;
@@ -3086,7 +3645,7 @@ static void do_set_enter_range(uint32_t uid, uint32_t target, float range)
         return;
     }
 
-    uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    uint32_t flags = move_flags(uid);
     vec2_t xz_target = M_NavClosestReachableInRange(s_map, 
         Entity_NavLayerWithRadius(flags, radius), xz_src, xz_dst, range - radius);
     do_set_dest(uid, xz_target, false);
@@ -3099,8 +3658,8 @@ static void do_set_enter_range(uint32_t uid, uint32_t target, float range)
 
 static bool using_surround_field(uint32_t uid, uint32_t target)
 {
-    vec2_t pos_xz = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
-    vec2_t target_pos_xz = G_Pos_GetXZFrom(s_move_work.gamestate.positions, target);
+    vec2_t pos_xz = move_xz_pos(uid);
+    vec2_t target_pos_xz = move_xz_pos(target);
 
     float dx = fabs(target_pos_xz.x - pos_xz.x);
     float dz = fabs(target_pos_xz.z - pos_xz.z);
@@ -3117,7 +3676,7 @@ static void do_set_surround_entity(uint32_t uid, uint32_t target)
 
     do_stop(uid);
 
-    vec2_t pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, target);
+    vec2_t pos = move_xz_pos(target);
     do_set_dest(uid, pos, false);
 
     assert(!ms->blocking);
@@ -3156,18 +3715,16 @@ static void do_update_pos(uint32_t uid, vec2_t pos)
         pos.z
     };
 
-    khiter_t k = kh_get(pos, s_move_work.gamestate.positions, uid);
-    assert(k != kh_end(s_move_work.gamestate.positions));
-    vec3_t oldpos = kh_val(s_move_work.gamestate.positions, k);
-    bg_ent_delete(s_move_work.gamestate.postree, oldpos.x, oldpos.z, uid);
-    bg_ent_insert(s_move_work.gamestate.postree, newpos.x, newpos.z, uid);
-    kh_val(s_move_work.gamestate.positions, k) = newpos;
+    vec3_t oldpos = move_pos(uid);
+    if(!move_patch_pos(uid, newpos))
+        return;
+    neighb_lists_note_travel(ms, oldpos, newpos);
 
     if(!ms->blocking)
         return;
 
-    int faction_id = G_GetFactionIDFrom(s_move_work.gamestate.faction_ids, uid);
-    uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    int faction_id = move_faction_id(uid);
+    uint32_t flags = move_flags(uid);
     M_NavBlockersDecref(ms->last_stop_pos, ms->last_stop_radius, faction_id, flags, s_map);
     M_NavBlockersIncref(pos, ms->last_stop_radius, faction_id, flags, s_map);
     ms->last_stop_pos = pos;
@@ -3183,14 +3740,13 @@ static void do_update_faction_id(uint32_t uid, int oldfac, int newfac)
     if(!ms)
         return;
 
-    khiter_t k = kh_get(id, s_move_work.gamestate.faction_ids, uid);
-    assert(k != kh_end(s_move_work.gamestate.faction_ids));
-    kh_val(s_move_work.gamestate.faction_ids, k) = newfac;
+    if(!move_patch_faction_id(uid, newfac))
+        return;
 
     if(!ms->blocking)
         return;
 
-    uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    uint32_t flags = move_flags(uid);
     M_NavBlockersDecref(ms->last_stop_pos, ms->last_stop_radius, oldfac, flags, s_map);
     M_NavBlockersIncref(ms->last_stop_pos, ms->last_stop_radius, newfac, flags, s_map);
 }
@@ -3203,15 +3759,14 @@ static void do_update_selection_radius(uint32_t uid, float sel_radius)
     if(!ms)
         return;
 
-    khiter_t k = kh_get(range, s_move_work.gamestate.sel_radiuses, uid);
-    assert(k != kh_end(s_move_work.gamestate.sel_radiuses));
-    kh_val(s_move_work.gamestate.sel_radiuses, k) = sel_radius;
+    if(!move_patch_radius(uid, sel_radius))
+        return;
 
     if(!ms->blocking)
         return;
 
-    int faction_id = G_GetFactionIDFrom(s_move_work.gamestate.faction_ids, uid);
-    uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
+    int faction_id = move_faction_id(uid);
+    uint32_t flags = move_flags(uid);
     M_NavBlockersDecref(ms->last_stop_pos, ms->last_stop_radius, faction_id, flags, s_map);
     M_NavBlockersIncref(ms->last_stop_pos, sel_radius, faction_id, flags, s_map);
     ms->last_stop_radius = sel_radius;
@@ -3228,12 +3783,13 @@ static void do_set_max_speed(uint32_t uid, float speed)
 
 static void do_block(uint32_t uid, vec3_t newpos)
 {
-    khiter_t k = kh_get(pos, s_move_work.gamestate.positions, uid);
-    assert(k != kh_end(s_move_work.gamestate.positions));
-    vec3_t oldpos = kh_val(s_move_work.gamestate.positions, k);
-    bg_ent_delete(s_move_work.gamestate.postree, oldpos.x, oldpos.z, uid);
-    bg_ent_insert(s_move_work.gamestate.postree, newpos.x, newpos.z, uid);
-    kh_val(s_move_work.gamestate.positions, k) = newpos;
+    vec3_t oldpos = move_pos(uid);
+    if(!move_patch_pos(uid, newpos))
+        return;
+
+    struct movestate *ms = movestate_get(uid);
+    if(ms)
+        neighb_lists_note_travel(ms, oldpos, newpos);
 
     entity_block(uid);
 }
@@ -3243,14 +3799,98 @@ static void move_push_cmd(struct move_cmd cmd)
     queue_cmd_push(&s_move_commands, &cmd);
 }
 
-static void move_process_cmds(void)
+static void move_free_cmd(struct move_cmd *cmd)
+{
+    if(cmd->type == MOVE_CMD_MAKE_FLOCKS) {
+        vec_entity_t *sel = (vec_entity_t*)cmd->args[0].val.as_pointer;
+        vec_entity_destroy(sel);
+        PF_FREE(sel);
+    }
+}
+
+static void move_discard_cmds(void)
 {
     struct move_cmd cmd;
     while(queue_cmd_pop(&s_move_commands, &cmd)) {
+        move_free_cmd(&cmd);
+    }
+}
+
+static void move_journal_cmd(const struct move_cmd *cmd)
+{
+    struct journal_blob blob;
+    G_Journal_BlobInit(&blob);
+
+    if(cmd->type == MOVE_CMD_MAKE_FLOCKS) {
+        const vec_entity_t *sel = cmd->args[0].val.as_pointer;
+        uint32_t nents = vec_size(sel);
+        G_Journal_BlobPut(&blob, &nents, sizeof(nents));
+        G_Journal_BlobPut(&blob, sel->array, nents * sizeof(uint32_t));
+    }
+    G_Journal_Write(JOURNAL_STREAM_MOVE, cmd->type, ARR_SIZE(cmd->args), cmd->args, &blob);
+    G_Journal_BlobDestroy(&blob);
+}
+
+/* Queue up the recorded commands for the current epoch. Returns 
+ * the number of commands queued. 
+ */
+static size_t move_replay_cmds(void)
+{
+    size_t ret = 0;
+    struct move_cmd cmd = {0};
+    int type;
+    struct journal_blob *blob;
+
+    while(G_Journal_Read(JOURNAL_STREAM_MOVE, &type, ARR_SIZE(cmd.args), cmd.args, &blob)) {
+
+        cmd.type = type;
+        if(cmd.type == MOVE_CMD_MAKE_FLOCKS) {
+
+            uint32_t nents = 0;
+            G_Journal_BlobGet(blob, &nents, sizeof(nents));
+            vec_entity_t *sel = PF_MALLOC(sizeof(vec_entity_t));
+            if(!sel)
+                continue;
+            vec_entity_init(sel);
+            for(int i = 0; i < nents; i++) {
+                uint32_t uid;
+                if(!G_Journal_BlobGet(blob, &uid, sizeof(uid)))
+                    break;
+                vec_entity_push(sel, uid);
+            }
+            cmd.args[0].val.as_pointer = sel;
+        }
+        move_push_cmd(cmd);
+        ret++;
+    }
+    return ret;
+}
 
+static void move_process_cmds(void)
+{
+    /* When replaying, the commands that were issued this time around
+     * are thrown away and the recorded ones are processed instead. Any 
+     * commands issued while processing them were already recorded,
+     * so those are thrown away as well. 
+     */
+    size_t limit = SIZE_MAX;
+    bool replay = G_Journal_Replaying();
+    if(replay) {
+        move_discard_cmds();
+        limit = move_replay_cmds();
+    }
+
+    struct move_cmd cmd;
+    while(limit > 0 && queue_cmd_pop(&s_move_commands, &cmd)) {
+
+        limit--;
         if(cmd.deleted)
             continue;
 
+        if(G_Journal_Recording()) {
+            move_journal_cmd(&cmd);
+        }
+
         switch(cmd.type) {
         case MOVE_CMD_ADD: {
             uint32_t uid = cmd.args[0].val.as_int;
@@ -3370,6 +4010,11 @@ static void move_process_cmds(void)
             assert(0);
         }
     }
+
+    if(replay) {
+        move_discard_cmds();
+    }
+    G_Journal_EndEpoch(JOURNAL_STREAM_MOVE);
 }
 
 static void *cp_vec_realloc(void *ptr, size_t size)
@@ -3392,22 +4037,42 @@ static void cp_vec_free(void *ptr)
     /* no-op */
 }
 
-static void move_velocity_work(int begin_idx, int end_idx)
+static void move_velocity_work(int begin_idx, int end_idx, void *arg)
 {
-    for(int i = begin_idx; i <= end_idx; i++) {
+    /* The preferred velocities and neighbours of the whole chunk are gathered 
+     * first so that ClearPath can solve for all of the entities in one batch.
+     */
+    const size_t nwork = end_idx - begin_idx;
+    STALLOC(int, work_idxs, nwork);
+    STALLOC(struct cp_ent, ents, nwork);
+    STALLOC(vec2_t, vprefs, nwork);
+    STALLOC(vec_cp_ent_t, dyn_neighbs, nwork);
+    STALLOC(vec_cp_ent_t, stat_neighbs, nwork);
+    STALLOC(bool, save_debug, nwork);
+    STALLOC(vec2_t, new_vels, nwork);
+    size_t nbatch = 0;
+    int neighb_counts[NEIGHB_RESULT_MAX] = {0};
+
+    for(int i = begin_idx; i < end_idx; i++) {
     
         struct move_work_in *in = &s_move_work.in[i];
         struct move_work_out *out = &s_move_work.out[i];
 
-        const struct movestate *ms = movestate_get(in->ent_uid);
-
         /* COMBAT_HELD: keep the move state/cell but zero velocity so the unit holds position. */
-        if(G_FlagsGetFrom(s_move_work.gamestate.flags, in->ent_uid) & ENTITY_FLAG_COMBAT_HELD) {
+        if(move_flags(in->ent_uid) & ENTITY_FLAG_COMBAT_HELD) {
             out->ent_uid = in->ent_uid;
             out->ent_vel = (vec2_t){0.0f, 0.0f};
             continue;
         }
 
+        struct movestate *ms = movestate_get(in->ent_uid);
+
+        if(in->lod_skip) {
+            out->ent_uid = in->ent_uid;
+            out->ent_vel = ms->velocity;
+            continue;
+        }
+
         const struct flock *flock = flock_for_ent(in->ent_uid);
 
         /* Compute the preferred velocity */
@@ -3453,21 +4118,58 @@ static void move_velocity_work(int begin_idx, int end_idx)
         assert(vpref.x == vpref.x && vpref.z == vpref.z); /* a NaN vpref would corrupt the integration */
 
         /* Find the entity's neighbours */
-        find_neighbours(in->ent_uid, in->dyn_neighbs, in->stat_neighbs);
-
-        /* Compute the velocity constrainted by potential collisions */
-        vec2_t new_vel = G_ClearPath_NewVelocity(in->cp_ent, in->ent_uid, 
-            vpref, *in->dyn_neighbs, *in->stat_neighbs, in->save_debug);
+        size_t max_neighbs = (in->lod == MOVE_LOD_FULL) ? MAX_NEIGHBOURS : MAX_NEIGHBOURS_COARSE;
+        enum neighb_result result = find_neighbours(in->ent_uid, &ms->neighb_cache, 
+            max_neighbs, in->dyn_neighbs, in->stat_neighbs);
+        neighb_counts[result]++;
+
+        work_idxs[nbatch] = i;
+        ents[nbatch] = in->cp_ent;
+        vprefs[nbatch] = vpref;
+        dyn_neighbs[nbatch] = *in->dyn_neighbs;
+        stat_neighbs[nbatch] = *in->stat_neighbs;
+        save_debug[nbatch] = in->save_debug;
+        nbatch++;
+    }
+
+    /* Compute the velocities constrainted by potential collisions */
+    G_ClearPath_NewVelocities(&(struct cp_batch){
+        .nagents = nbatch,
+        .ents = ents,
+        .des_vs = vprefs,
+        .dyn_neighbs = dyn_neighbs,
+        .stat_neighbs = stat_neighbs,
+        .save_debug = save_debug,
+    }, new_vels);
+
+    for(int i = 0; i < NEIGHB_RESULT_MAX; i++) {
+        if(neighb_counts[i])
+            SDL_AtomicAdd(&s_neighb_counts[i], neighb_counts[i]);
+    }
+
+    for(size_t i = 0; i < nbatch; i++) {
+
+        struct move_work_in *in = &s_move_work.in[work_idxs[i]];
+        struct move_work_out *out = &s_move_work.out[work_idxs[i]];
+        const struct movestate *ms = movestate_get(in->ent_uid);
 
         out->ent_uid = in->ent_uid;
-        out->ent_vel = new_vel;
+        out->ent_vel = new_vels[i];
         vec2_truncate(&out->ent_vel, ms->max_speed / hz_count(s_move_work.hz));
     }
+
+    STFREE(work_idxs);
+    STFREE(ents);
+    STFREE(vprefs);
+    STFREE(dyn_neighbs);
+    STFREE(stat_neighbs);
+    STFREE(save_debug);
+    STFREE(new_vels);
 }
 
-static void move_update_work(int begin_idx, int end_idx)
+static void move_update_work(int begin_idx, int end_idx, void *arg)
 {
-    for(int i = begin_idx; i <= end_idx; i++) {
+    for(int i = begin_idx; i < end_idx; i++) {
     
         struct move_work_in *in = &s_move_work.in[i];
         struct move_work_out *out = &s_move_work.out[i];
@@ -3477,47 +4179,9 @@ static void move_update_work(int begin_idx, int end_idx)
     }
 }
 
-static struct result move_velocity_task(void *arg)
-{
-    struct move_task_arg *move_arg = arg;
-    size_t ncomputed = 0;
-
-    for(int i = move_arg->begin_idx; i <= move_arg->end_idx; i++) {
-
-        move_velocity_work(i, i);
-        ncomputed++;
-
-        if(ncomputed % 16 == 0)
-            Task_Yield();
-    }
-    return NULL_RESULT;
-}
-
-static struct result move_update_task(void *arg)
-{
-    struct move_task_arg *move_arg = arg;
-    size_t ncomputed = 0;
-
-    for(int i = move_arg->begin_idx; i <= move_arg->end_idx; i++) {
-
-        move_update_work(i, i);
-        ncomputed++;
-
-        if(ncomputed % 16 == 0)
-            Task_Yield();
-    }
-    return NULL_RESULT;
-}
-
 static void move_complete_cpu_work(void)
 {
-    for(int i = 0; i < s_move_work.ntasks; i++) {
-        while(!Sched_FutureIsReady(&s_move_work.futures[i])) {
-            Sched_RunSync(s_move_work.tids[i]);
-            Sched_TryYield();
-        }
-    }
-    s_move_work.ntasks = 0;
+    Sched_ParallelForJoin(&s_move_work.pfor);
 }
 
 static void move_complete_gpu_velocity_work(void)
@@ -3549,25 +4213,6 @@ static void move_complete_gpu_velocity_work(void)
     });
 }
 
-static khash_t(aabb) *move_copy_aabbs(void)
-{
-    PERF_ENTER();
-    khash_t(aabb) *aabbs = kh_init(aabb);
-    if(!aabbs)
-        PERF_RETURN(NULL);
-
-    const khash_t(entity) *ents = G_GetAllEntsSet();
-
-    uint32_t uid;
-    kh_foreach_key(ents, uid, {
-        int ret;
-        khiter_t k = kh_put(aabb, aabbs, uid, &ret);
-        assert(ret != -1);
-        kh_value(aabbs, k) = AL_EntityGet(uid)->identity_aabb;
-    });
-    PERF_RETURN(aabbs);
-}
-
 static void move_init_nav_unit_query_ctx(void)
 {
     s_move_work.unit_query_ctx.flags = s_move_work.gamestate.flags;
@@ -3604,28 +4249,30 @@ struct refcounted_map *G_Move_NavSnapshotAcquire(void)
     return s_nav_snapshot;
 }
 
-static void move_copy_gamestate(void)
+static void move_copy_gamestate(struct gs_snapshot *gs)
 {
     PERF_ENTER();
-    s_move_work.gamestate.flags = G_FlagsCopyTable();
-    s_move_work.gamestate.positions = G_Pos_CopyTable();
-    s_move_work.gamestate.postree = G_Pos_CopyBitmapGrid();
-    s_move_work.gamestate.sel_radiuses = G_SelectionRadiusCopyTable();
-    s_move_work.gamestate.faction_ids = G_FactionIDCopyTable();
-    s_move_work.gamestate.ent_gpu_id_map = G_CopyEntGPUIDMap();
-    s_move_work.gamestate.gpu_id_ent_map = G_CopyGPUIDEntMap();
+    s_move_work.gamestate.snapshot = gs;
+    s_move_work.gamestate.flags = gs->flags;
+    s_move_work.gamestate.positions = gs->positions;
+    s_move_work.gamestate.postree = gs->postree;
+    s_move_work.gamestate.sel_radiuses = gs->sel_radiuses;
+    s_move_work.gamestate.faction_ids = gs->faction_ids;
+    s_move_work.gamestate.columns = gs->columns;
+    s_move_work.gamestate.ent_gpu_id_map = gs->ent_gpu_id_map;
+    s_move_work.gamestate.gpu_id_ent_map = gs->gpu_id_ent_map;
     struct refcounted_map *snap = PF_MALLOC(sizeof(struct refcounted_map));
     snap->snapshot = M_AL_SnapshotShared(s_map);
     sp_init(snap, refcounted_map_destroy);
     s_nav_snapshot = snap;
     s_move_work.gamestate.map = snap->snapshot;
-    s_move_work.gamestate.transforms = Entity_CopyTransforms();
-    s_move_work.gamestate.aabbs = move_copy_aabbs();
-    s_move_work.gamestate.fog_enabled = G_Fog_Enabled();
-    s_move_work.gamestate.fog_state = G_Fog_CopyState();
+    s_move_work.gamestate.transforms = gs->transforms;
+    s_move_work.gamestate.aabbs = gs->aabbs;
+    s_move_work.gamestate.fog_enabled = gs->fog_enabled;
+    s_move_work.gamestate.fog_state = gs->fog_state;
     s_move_work.gamestate.dying_set = G_Combat_GetDyingSetCopy();
-    s_move_work.gamestate.diptable = G_CopyDiplomacyTable();
-    s_move_work.gamestate.player_controllable = G_GetPlayerControlledFactions();
+    s_move_work.gamestate.diptable = gs->diptable;
+    s_move_work.gamestate.player_controllable = gs->player_controllable;
 
     move_init_nav_unit_query_ctx();
     M_NavSetNavUnitQueryCtx(s_move_work.gamestate.map, &s_move_work.unit_query_ctx);
@@ -3636,33 +4283,22 @@ static void move_copy_gamestate(void)
 static void move_release_gamestate(void)
 {
     PERF_ENTER();
-    if(s_move_work.gamestate.flags) {
-        kh_destroy(id, s_move_work.gamestate.flags);
-        s_move_work.gamestate.flags = NULL;
-    }
-    if(s_move_work.gamestate.positions) {
-        kh_destroy(pos, s_move_work.gamestate.positions);
-        s_move_work.gamestate.positions = NULL;
-    }
-    if(s_move_work.gamestate.postree) {
-        G_Pos_DestroyBitmapGrid(s_move_work.gamestate.postree);
-        s_move_work.gamestate.postree = NULL;
-    }
-    if(s_move_work.gamestate.sel_radiuses) {
-        kh_destroy(range, s_move_work.gamestate.sel_radiuses);
-        s_move_work.gamestate.sel_radiuses = NULL;
-    }
-    if(s_move_work.gamestate.faction_ids) {
-        kh_destroy(id, s_move_work.gamestate.faction_ids);
-        s_move_work.gamestate.faction_ids = NULL;
-    }
-    if(s_move_work.gamestate.ent_gpu_id_map) {
-        kh_destroy(id, s_move_work.gamestate.ent_gpu_id_map);
-        s_move_work.gamestate.ent_gpu_id_map = NULL;
-    }
-    if(s_move_work.gamestate.gpu_id_ent_map) {
-        kh_destroy(id, s_move_work.gamestate.gpu_id_ent_map);
-        s_move_work.gamestate.gpu_id_ent_map = NULL;
+    move_clear_patches();
+    s_move_work.gamestate.flags = NULL;
+    s_move_work.gamestate.positions = NULL;
+    s_move_work.gamestate.postree = NULL;
+    s_move_work.gamestate.sel_radiuses = NULL;
+    s_move_work.gamestate.faction_ids = NULL;
+    s_move_work.gamestate.columns = NULL;
+    s_move_work.gamestate.ent_gpu_id_map = NULL;
+    s_move_work.gamestate.gpu_id_ent_map = NULL;
+    s_move_work.gamestate.transforms = NULL;
+    s_move_work.gamestate.aabbs = NULL;
+    s_move_work.gamestate.fog_state = NULL;
+    s_move_work.gamestate.diptable = NULL;
+    if(s_move_work.gamestate.snapshot) {
+        G_Snapshot_Release(s_move_work.gamestate.snapshot);
+        s_move_work.gamestate.snapshot = NULL;
     }
     s_move_work.gamestate.map = NULL;
     /* Release before the next tick allocates so the freed block is recycled. */
@@ -3670,33 +4306,25 @@ static void move_release_gamestate(void)
         sp_release(s_nav_snapshot);
         s_nav_snapshot = NULL;
     }
-    if(s_move_work.gamestate.transforms) {
-        kh_destroy(trans, s_move_work.gamestate.transforms);
-        s_move_work.gamestate.transforms = NULL;
-    }
-    if(s_move_work.gamestate.aabbs) {
-        kh_destroy(aabb, s_move_work.gamestate.aabbs);
-        s_move_work.gamestate.aabbs = NULL;
-    }
-    if(s_move_work.gamestate.fog_state) {
-        PF_FREE(s_move_work.gamestate.fog_state);
-        s_move_work.gamestate.fog_state = NULL;
-    }
     if(s_move_work.gamestate.dying_set) {
         kh_destroy(id, s_move_work.gamestate.dying_set);
         s_move_work.gamestate.dying_set = NULL;
     }
-    if(s_move_work.gamestate.diptable) {
-        PF_FREE(s_move_work.gamestate.diptable);
-        s_move_work.gamestate.diptable = NULL;
-    }
     PERF_RETURN_VOID();
 }
 
-static void move_update_gamestate(void)
+static bool move_update_gamestate(void)
 {
+    /* Acquire the new snapshot before dropping the old one, so that 
+     * a failed allocation leaves the previous gamestate in place. 
+     */
+    struct gs_snapshot *gs = G_Snapshot_Acquire();
+    if(!gs)
+        return false;
+
     move_release_gamestate();
-    move_copy_gamestate();
+    move_copy_gamestate(gs);
+    return true;
 }
 
 static void move_consume_work_results(void)
@@ -3723,7 +4351,6 @@ static void move_consume_work_results(void)
     s_move_work.in = NULL;
     s_move_work.out = NULL;
     s_move_work.nwork = 0;
-    s_move_work.ntasks = 0;
 
     PERF_RETURN_VOID();
 }
@@ -3743,34 +4370,13 @@ static void move_push_work(struct move_work_in in)
     s_move_work.in[s_move_work.nwork++] = in;
 }
 
-static void move_submit_cpu_work(task_func_t code)
+static void move_submit_cpu_work(pfor_func_t code)
 {
     if(s_move_work.nwork == 0)
         return;
 
-    size_t ntasks = SDL_GetCPUCount();
-    if(s_move_work.nwork < 64)
-        ntasks = 1;
-    ntasks = MIN(ntasks, MAX_MOVE_TASKS);
-
-    for(int i = 0; i < ntasks; i++) {
-
-        struct move_task_arg *arg = stalloc(&s_move_work.mem, sizeof(struct move_task_arg));
-        size_t nitems = ceil((float)s_move_work.nwork / ntasks);
-
-        arg->begin_idx = nitems * i;
-        arg->end_idx = MIN(nitems * (i + 1) - 1, s_move_work.nwork-1);
-
-        SDL_AtomicSet(&s_move_work.futures[s_move_work.ntasks].status, FUTURE_INCOMPLETE);
-        s_move_work.tids[s_move_work.ntasks] = Sched_Create(4, code, arg, 
-            "move::work", &s_move_work.futures[s_move_work.ntasks], TASK_BIG_STACK);
-
-        if(s_move_work.tids[s_move_work.ntasks] == NULL_TID) {
-            code(arg);
-        }else{
-            s_move_work.ntasks++;
-        }
-    }
+    Sched_ParallelForSubmit(&s_move_work.pfor, 4, "move::work", TASK_BIG_STACK,
+        0, s_move_work.nwork, 16, code, NULL);
 }
 
 static struct move_work_in *work_input_for_uid(uint32_t uid)
@@ -3821,11 +4427,11 @@ static void move_upload_input(size_t nents)
         const struct flock *flock;
         uint32_t flock_id = flock_id_for_ent(uid, &flock);
         uint32_t movestate = curr->state;
-        vec2_t pos = G_Pos_GetXZFrom(s_move_work.gamestate.positions, uid);
+        vec2_t pos = move_xz_pos(uid);
         vec2_t dest_xz = flock ? flock->target_xz : (vec2_t){0.0f, 0.0f};
 
-        uint32_t flags = G_FlagsGetFrom(s_move_work.gamestate.flags, uid);
-        float radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, uid);
+        uint32_t flags = move_flags(uid);
+        float radius = move_radius(uid);
 
         struct move_work_in *work = NULL;
         if(!ent_still(curr)) {
@@ -3973,31 +4579,28 @@ static void nav_tick_submit_work(void)
         s_move_work.gpu_velocities = stalloc(&s_move_work.mem, size);
     }
 
-    SDL_AtomicSet(&s_tick_task_future.status, FUTURE_INCOMPLETE);
-    s_tick_task_tid = Sched_Create(0, navigation_tick_task, NULL, 
-            "navigation_tick_task", &s_tick_task_future, TASK_BIG_STACK);
-    assert(s_tick_task_tid != NULL_TID);
+    s_tick_node = Sched_GraphSubmit(0, navigation_tick_task, NULL, 
+        "navigation_tick_task", TASK_BIG_STACK, 
+        SCHED_RES_NAV, SCHED_RES_NAV_FIELDS | SCHED_RES_MOVEMENT);
     s_last_tick = g_frame_idx;
 }
 
 static enum move_work_status nav_tick_finish_work(void)
 {
-    if(s_tick_task_tid == NULL_TID) {
+    if(s_tick_node == NULL_NODE) {
         return WORK_COMPLETE;
     }
 
     PERF_PUSH("nav tick drain");
-    while(!Sched_FutureIsReady(&s_tick_task_future)) {
-        /* If the task is event-blocked waiting for GPU results,
-         * we are not able to run it to completion at this point.
-         */
-        if(!Sched_RunSync(s_tick_task_tid)) {
-            PERF_POP();
-            return WORK_INCOMPLETE;
-        }
+    /* If the task is event-blocked waiting for GPU results,
+     * we are not able to run it to completion at this point.
+     */
+    if(!Sched_GraphTryWaitNode(s_tick_node)) {
+        PERF_POP();
+        return WORK_INCOMPLETE;
     }
     PERF_POP();
-    s_tick_task_tid = NULL_TID;
+    s_tick_node = NULL_NODE;
     return WORK_COMPLETE;
 }
 
@@ -4112,11 +4715,20 @@ static void interpolate_tick(void *user, void *event)
     /* Iterate over all the entities and advance the position forward
      * by one interpolated step */
     uint32_t key;
-    kh_foreach_key(s_entity_state_table, key, {
+    kh_foreach_key(s_awake_ents, key, {
         /* The entity has been removed already */
         if(!G_EntityExists(key))
             continue;
 
+        /* Off-screen moving entities jump straight to their next position at 
+         * the following tick, which flushes any interpolation that is left. 
+         * Still entities get no more ticks, so they are always interpolated 
+         * the rest of the way.
+         */
+        const struct movestate *ms = movestate_get(key);
+        if(!ms || (ms->offscreen && !ent_still(ms)))
+            continue;
+
         /* Coalese together queued updates when possible */
         int steps = coalese ? 2 : 1;
         entity_interpolation_step(key, steps);
@@ -4126,9 +4738,47 @@ static void interpolate_tick(void *user, void *event)
     PERF_RETURN_VOID();
 }
 
+/* Serve the paths of all the moving members of a flock in one batched request, 
+ * ahead of the per-entity LOS and velocity queries. Otherwise, each member that 
+ * lands in a chunk without fields issues a full path request of its own.
+ */
+static void request_flock_paths(void)
+{
+    PERF_ENTER();
+    N_FC_SetRequester(FC_REQ_MOVEMENT);
+    for(int i = 0; i < vec_size(&s_flocks); i++) {
+
+        const struct flock *flock = &vec_AT(&s_flocks, i);
+        size_t nents = kh_size(flock->ents);
+        if(nents == 0)
+            continue;
+
+        STALLOC(vec2_t, srcs, nents);
+        size_t nsrcs = 0;
+
+        uint32_t curr;
+        kh_foreach_key(flock->ents, curr, {
+
+            const struct movestate *ms = movestate_get(curr);
+            if(!ms || ent_still(ms))
+                continue;
+            if(ms->state == STATE_SURROUND_ENTITY && ms->using_surround_field)
+                continue;
+            srcs[nsrcs++] = (vec2_t){ms->prev_pos.x, ms->prev_pos.z};
+        });
+
+        M_NavRequestPathsBatch(s_move_work.gamestate.map, flock->dest_id, 
+            flock->target_xz, srcs, nsrcs, NULL);
+        STFREE(srcs);
+        Sched_TryYield();
+    }
+    PERF_RETURN_VOID();
+}
+
 static void compute_los_state(void)
 {
     PERF_ENTER();
+    N_FC_SetRequester(FC_REQ_MOVEMENT);
     for(int i = 0; i < s_move_work.nwork; i++) {
 
         struct move_work_in *in = &s_move_work.in[i];
@@ -4154,11 +4804,14 @@ static void compute_async_fields(void)
      */
     N_PrepareAsyncWork();
 
+    /* Only the enemy seek and surround fields are requested per entity */
+    N_FC_SetRequester(FC_REQ_COMBAT);
     for(int i = 0; i < s_move_work.nwork; i++) {
         struct move_work_in *in = &s_move_work.in[i];
         request_async_field(in->ent_uid);
         Sched_TryYield();
     }
+    N_FC_SetRequester(FC_REQ_ARRIVAL);
     request_flock_arrival_fields();
     N_AwaitAsyncFields();
 }
@@ -4171,19 +4824,21 @@ static void compute_desired_velocity(void)
         struct move_work_out *out = &s_move_work.out[i];
 
         PERF_PUSH("desired velocity");
+        N_FC_SetRequester(ent_field_requester(in));
         in->ent_des_v = ent_desired_velocity(in->ent_uid, in->cell_arrival_vdes, in->has_dest_los);
         out->ent_des_v = in->ent_des_v;
         PERF_POP();
 
 		Sched_TryYield();
     }
+    N_FC_SetRequester(FC_REQ_OTHER);
 }
 
 static void fork_join_velocity_computations(void)
 {
     switch(s_move_work.type) {
     case WORK_TYPE_CPU:
-        move_submit_cpu_work(move_velocity_task);
+        move_submit_cpu_work(move_velocity_work);
         move_complete_cpu_work();
         break;
     case WORK_TYPE_GPU:
@@ -4197,7 +4852,7 @@ static void fork_join_state_updates(void)
 {
     PERF_ENTER();
     PERF_PUSH("move::submit state updates");
-    move_submit_cpu_work(move_update_task);
+    move_submit_cpu_work(move_update_work);
     PERF_POP();
 
     Sched_TryYield();
@@ -4264,7 +4919,8 @@ static struct result navigation_tick_task(void *arg)
 {
     s_nav_task_active_tid = Sched_ActiveTID();
 
-    N_ApplyDeferredInvalidations();
+    M_NavApplyDeferredInvalidations(s_move_work.gamestate.map);
+    request_flock_paths();
     compute_los_state();
     compute_async_fields();
     compute_desired_velocity();
@@ -4281,6 +4937,7 @@ static struct result navigation_tick_task(void *arg)
     }
 
     fork_join_state_updates();
+    N_FC_PublishTelemetry();
 
     s_nav_task_active_tid = NULL_TID;
     return NULL_RESULT;
@@ -4292,7 +4949,7 @@ static void pivot_held_still_units(void)
     ASSERT_IN_MAIN_THREAD();
 
     uint32_t uid;
-    kh_foreach_key(s_entity_state_table, uid, {
+    kh_foreach_key(s_awake_ents, uid, {
 
         struct movestate *ms = movestate_get(uid);
         if(!ms || !ent_still(ms))
@@ -4309,6 +4966,121 @@ static void pivot_held_still_units(void)
     });
 }
 
+static uint16_t enemies_of(int faction_id)
+{
+    uint16_t factions = s_move_work.gamestate.snapshot->factions;
+    uint16_t ret = 0;
+
+    for(int i = 0; i < MAX_FACTIONS; i++) {
+
+        if(!(factions & (0x1 << i)))
+            continue;
+
+        enum diplomacy_state ds;
+        if(G_GetDiplomacyStateFrom(s_move_work.gamestate.diptable, faction_id, i, &ds)
+        && ds == DIPLOMACY_STATE_WAR)
+            ret |= (0x1 << i);
+    }
+    return ret;
+}
+
+static enum move_lod flock_lod(const struct flock *flock)
+{
+    vec2_t centroid = (vec2_t){0.0f, 0.0f};
+    int faction_id = -1;
+    size_t nmoving = 0;
+
+    uint32_t curr;
+    kh_foreach_key(flock->ents, curr, {
+
+        const struct movestate *ms = movestate_get(curr);
+        if(!ms || ent_still(ms))
+            continue;
+
+        /* Arrival, combat and the like need precise steering */
+        if(ms->state != STATE_MOVING && ms->state != STATE_MOVING_IN_FORMATION)
+            return MOVE_LOD_FULL;
+
+        centroid.x += ms->prev_pos.x;
+        centroid.z += ms->prev_pos.z;
+        faction_id = move_faction_id(curr);
+        nmoving++;
+    });
+
+    if(nmoving == 0)
+        return MOVE_LOD_FULL;
+    PFM_Vec2_Scale(&centroid, 1.0f / nmoving, &centroid);
+
+    float radius = 0.0f;
+    kh_foreach_key(flock->ents, curr, {
+
+        const struct movestate *ms = movestate_get(curr);
+        if(!ms || ent_still(ms))
+            continue;
+
+        vec2_t delta = (vec2_t){ms->prev_pos.x - centroid.x, ms->prev_pos.z - centroid.z};
+        radius = MAX(radius, PFM_Vec2_Len(&delta));
+    });
+
+    uint16_t near = G_Combat_FactionsNear(centroid, radius + LOD_ENEMY_MARGIN);
+    if(near & enemies_of(faction_id))
+        return MOVE_LOD_FULL;
+
+    return MOVE_LOD_REDUCED;
+}
+
+static bool flock_offscreen(const struct flock *flock, const struct frustum *frustum)
+{
+    uint32_t curr;
+    kh_foreach_key(flock->ents, curr, {
+
+        const struct movestate *ms = movestate_get(curr);
+        if(!ms || ent_still(ms))
+            continue;
+
+        if(C_FrustumPointIntersectionFast(frustum, ms->prev_pos) != VOLUME_INTERSEC_OUTSIDE)
+            return false;
+    });
+    return true;
+}
+
+static void update_flock_lods(void)
+{
+    ASSERT_IN_MAIN_THREAD();
+
+    /* The tier and the interpolated positions are visible to the rest of 
+     * the simulation, so the camera may only be taken into account when the 
+     * run doesn't need to be reproducible. Flocks in view always get full 
+     * steering then.
+     */
+    bool cull = !G_Deterministic() && !Engine_Headless();
+    struct frustum frustum;
+    if(cull) {
+        Camera_MakeFrustum(G_GetActiveCamera(), &frustum);
+    }
+
+    for(int i = 0; i < vec_size(&s_flocks); i++) {
+        struct flock *flock = &vec_AT(&s_flocks, i);
+        flock->offscreen = cull && flock_offscreen(flock, &frustum);
+        flock->lod = (cull && !flock->offscreen) ? MOVE_LOD_FULL : flock_lod(flock);
+    }
+}
+
+static enum move_lod entity_lod(uint32_t uid, const struct movestate *ms, bool save_debug)
+{
+    if(save_debug)
+        return MOVE_LOD_FULL;
+
+    if(ms->state != STATE_MOVING && ms->state != STATE_MOVING_IN_FORMATION)
+        return MOVE_LOD_FULL;
+
+    const struct flock *flock = flock_for_ent(uid);
+    if(!flock)
+        return MOVE_LOD_FULL;
+
+    return flock->lod;
+}
+
 static void move_do_tick(enum eventtype curr_event, enum movement_hz hz)
 {
     ASSERT_IN_MAIN_THREAD();
@@ -4318,22 +5090,49 @@ static void move_do_tick(enum eventtype curr_event, enum movement_hz hz)
     pivot_held_still_units();
     move_handle_hz_update(curr_event);
     move_process_cmds();
+    neighb_lists_tick();
+
+    struct gs_snapshot *gs = G_Snapshot_Acquire();
+    if(!gs) {
+        /* No snapshot to hand the workers - keep the previous gamestate 
+         * and skip this tick's work. The results were already consumed. 
+         */
+        s_last_tick = g_frame_idx;
+        PERF_POP();
+        return;
+    }
+
+    /* Keep the outgoing navigation snapshot alive for the arrival tasks */
+    struct refcounted_map *arrival_nav = G_Move_NavSnapshotAcquire();
     move_release_gamestate();
     disband_empty_flocks();
-    update_flock_arrival_fields();
+    submit_flock_arrival_work(arrival_nav);
 
     /* Run the navigation updates synchronous to the movement tick */
     G_UpdateMap();
 
     move_prepare_work(hz);
-    move_copy_gamestate();
+    move_copy_gamestate(gs);
 
     PERF_PUSH("submit move work");
-    uint32_t curr;
-    kh_foreach_key(s_entity_state_table, curr, {
+    update_flock_lods();
+    s_lod_tick++;
+    memset(s_lod_last_counts, 0, sizeof(s_lod_last_counts));
 
+    for(khiter_t k = kh_begin(s_awake_ents); k != kh_end(s_awake_ents); k++) {
+
+        if(!kh_exist(s_awake_ents, k))
+            continue;
+
+        uint32_t curr = kh_key(s_awake_ents, k);
         struct movestate *ms = movestate_get(curr);
-        assert(ms);
+        if(!ms || (ent_still(ms) && ms->left == 0 
+               && !(move_flags(curr) & ENTITY_FLAG_COMBAT_HELD))) {
+            /* Deleting the current key doesn't disturb the iteration */
+            kh_del(entity, s_awake_ents, k);
+            continue;
+        }
+        s_lod_last_counts[LOD_COUNT_AWAKE]++;
 
         if(ent_still(ms))
             continue;
@@ -4349,7 +5148,7 @@ static void move_do_tick(enum eventtype curr_event, enum movement_hz hz)
         vec_cp_ent_resize(stat, MAX_NEIGHBOURS);
 
         vec2_t pos = (vec2_t){ms->prev_pos.x, ms->prev_pos.z};
-        float radius = G_GetSelectionRadiusFrom(s_move_work.gamestate.sel_radiuses, curr);
+        float radius = move_radius(curr);
 
         struct cp_ent curr_cp = (struct cp_ent) {
             .xz_pos = pos,
@@ -4369,13 +5168,27 @@ static void move_do_tick(enum eventtype curr_event, enum movement_hz hz)
             }
         }
 
+        bool save_debug = G_ClearPath_ShouldSaveDebug(curr);
+        enum move_lod lod = entity_lod(curr, ms, save_debug);
+        /* Stagger the steering ticks of the reduced-rate entities. An entity 
+         * that is not moving yet has no velocity to coast on. 
+         */
+        bool lod_skip = (lod == MOVE_LOD_REDUCED)
+                     && ((s_lod_tick + curr) % LOD_REDUCED_PERIOD != 0)
+                     && (PFM_Vec2_Len(&ms->velocity) > EPSILON);
+        ms->lod = lod;
+        const struct flock *flock = flock_for_ent(curr);
+        ms->offscreen = flock && flock->offscreen;
+        s_lod_last_counts[lod == MOVE_LOD_FULL ? LOD_COUNT_FULL : LOD_COUNT_REDUCED]++;
+        s_lod_last_counts[LOD_COUNT_SKIPPED] += lod_skip;
+
         formation_id_t fid = G_Formation_GetForEnt(curr);
         move_push_work((struct move_work_in){
             .ent_uid = curr,
             .speed = entity_speed(curr),
             .cell_pos = cell_pos,
             .cp_ent = curr_cp,
-            .save_debug = G_ClearPath_ShouldSaveDebug(curr),
+            .save_debug = save_debug,
             .stat_neighbs = stat,
             .dyn_neighbs = dyn,
             .fstate.fid = fid,
@@ -4403,11 +5216,14 @@ static void move_do_tick(enum eventtype curr_event, enum movement_hz hz)
             .fstate.target_orientation = 
                 ((fid != NULL_FID) ? G_Formation_TargetOrientation(curr)
                                    : (quat_t){0.0f, 0.0f, 0.0f, 0.0f}),
-            .cell_arrival_vdes = cell_arrival_vdes
+            .cell_arrival_vdes = cell_arrival_vdes,
+            .lod = lod,
+            .lod_skip = lod_skip
         });
-    });
+    }
     PERF_POP();
 
+    join_flock_arrival_work();
     nav_tick_submit_work();
     PERF_POP();
 }
@@ -4459,9 +5275,9 @@ static void nav_cancel_gpu_work(void)
      * cannot run it yet, as the new velocity data from the GPU won't 
      * be available until the next frame. Kill off the task.
      */
-    assert(s_tick_task_tid != NULL_TID);
-    Sched_TryCancel(s_tick_task_tid);
-    s_tick_task_tid = NULL_TID;
+    assert(s_tick_node != NULL_NODE);
+    Sched_GraphCancel(s_tick_node);
+    s_tick_node = NULL_NODE;
 }
 
 /*****************************************************************************/
@@ -4488,24 +5304,54 @@ bool G_Move_Init(const struct map *map)
         return false;
     }
 
+    if(NULL == (s_awake_ents = kh_init(entity))) {
+        kh_destroy(state, s_entity_state_table);
+        return false;
+    }
+
     memset(&s_move_work, 0, sizeof(s_move_work));
     if(!stalloc_init(&s_move_work.mem)) {
+        kh_destroy(entity, s_awake_ents);
         kh_destroy(state, s_entity_state_table);
         return NULL;
     }
 
     if(!queue_cmd_init(&s_move_commands, 256)) {
         stalloc_destroy(&s_move_work.mem);
+        kh_destroy(entity, s_awake_ents);
         kh_destroy(state, s_entity_state_table);
         return NULL;
     }
 
     if(!stalloc_init(&s_eventargs)) {
         stalloc_destroy(&s_move_work.mem);
+        kh_destroy(entity, s_awake_ents);
+        kh_destroy(state, s_entity_state_table);
+        queue_cmd_destroy(&s_move_commands);
+        return NULL;
+    }
+
+    if(!stalloc_init(&s_arrival_mem)) {
+        stalloc_destroy(&s_eventargs);
+        stalloc_destroy(&s_move_work.mem);
+        kh_destroy(entity, s_awake_ents);
+        kh_destroy(state, s_entity_state_table);
+        queue_cmd_destroy(&s_move_commands);
+        return NULL;
+    }
+
+    if(!move_init_patches()) {
+        stalloc_destroy(&s_arrival_mem);
+        stalloc_destroy(&s_eventargs);
+        stalloc_destroy(&s_move_work.mem);
+        kh_destroy(entity, s_awake_ents);
         kh_destroy(state, s_entity_state_table);
         queue_cmd_destroy(&s_move_commands);
         return NULL;
     }
+    s_arrival_work = NULL;
+    s_narrival_work = 0;
+    s_arrival_nav = NULL;
 
     vec_entity_init(&s_move_markers);
     vec_flock_init(&s_flocks);
@@ -4527,7 +5373,20 @@ bool G_Move_Init(const struct map *map)
     s_mouse_dragged = false;
     s_drag_attacking = false;
     s_nav_snapshot = NULL;
-    move_copy_gamestate();
+
+    s_neighb_drift = 0.0;
+    s_neighb_tick_travel = 0.0f;
+    s_neighb_tick = 1;
+    s_neighb_epoch = 1;
+    memset(s_neighb_last_counts, 0, sizeof(s_neighb_last_counts));
+    s_lod_tick = 0;
+    memset(s_lod_last_counts, 0, sizeof(s_lod_last_counts));
+    Perf_RegisterCounterProvider(neighb_trace_counters);
+
+    if(!move_update_gamestate()) {
+        G_Move_Shutdown();
+        return false;
+    }
     return true;
 }
 
@@ -4538,6 +5397,7 @@ void G_Move_Shutdown(void)
     }
     s_move_tick_queued = false;
     s_map = NULL;
+    Perf_UnregisterCounterProvider(neighb_trace_counters);
 
     unregister_callback_for_hz(s_move_hz);
     E_Global_Unregister(EVENT_20HZ_TICK, interpolate_tick);
@@ -4554,11 +5414,14 @@ void G_Move_Shutdown(void)
     }
 
     move_release_gamestate();
+    move_destroy_patches();
     vec_flock_destroy(&s_flocks);
     vec_entity_destroy(&s_move_markers);
+    stalloc_destroy(&s_arrival_mem);
     stalloc_destroy(&s_eventargs);
     queue_cmd_destroy(&s_move_commands);
     stalloc_destroy(&s_move_work.mem);
+    kh_destroy(entity, s_awake_ents);
     kh_destroy(state, s_entity_state_table);
 }
 
@@ -4583,7 +5446,7 @@ void G_Move_FlushWork(void)
     s_move_work.in = NULL;
     s_move_work.out = NULL;
     s_move_work.nwork = 0;
-    s_move_work.ntasks = 0;
+    Sched_ParallelForReset(&s_move_work.pfor);
 
     move_process_cmds();
 }
@@ -5250,7 +6113,7 @@ bool G_Move_SaveState(struct SDL_RWops *stream)
 bool G_Move_LoadState(struct SDL_RWops *stream)
 {
     /* Flush the commands submitted during loading */
-    move_update_gamestate();
+    CHK_TRUE_RET(move_update_gamestate());
     move_process_cmds();
 
     struct attr attr;
@@ -5431,6 +6294,13 @@ bool G_Move_LoadState(struct SDL_RWops *stream)
         Sched_TryYield();
     }
 
+    /* Let the next tick put back to sleep whatever has nothing to do */
+    uint32_t key;
+    kh_foreach_key(s_entity_state_table, key, {
+        move_wake(key);
+    });
+
+    s_neighb_epoch++;
     return true;
 }
 
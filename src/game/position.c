@@ -82,6 +82,8 @@ __KHASH_IMPL(pos,  extern, khint32_t, vec3_t, 1, kh_int_hash_func, kh_int_hash_e
 static khash_t(pos) *s_postable;
 /* The bitmap_grid is always synchronized with the postable, at function call boundaries */
 static bg_ent_t      s_postree;
+/* Bumped on every write to the postable. Not reset between maps. */
+static uint32_t      s_version;
 
 /*****************************************************************************/
 /* STATIC FUNCTIONS                                                          */
@@ -155,6 +157,7 @@ bool G_Pos_Set(uint32_t uid, vec3_t pos)
 
     kh_val(s_postable, k) = pos;
     assert(kh_size(s_postable) == s_postree.nrecs);
+    s_version++;
 
     G_Move_UpdatePos(uid, (vec2_t){pos.x, pos.z});
     G_Combat_AddRef(G_GetFactionID(uid), (vec2_t){pos.x, pos.z});
@@ -186,6 +189,11 @@ khash_t(pos) *G_Pos_CopyTable(void)
     return kh_copy_pos(s_postable);
 }
 
+uint32_t G_Pos_Version(void)
+{
+    return s_version;
+}
+
 vec3_t G_Pos_GetFrom(khash_t(pos) *table, uint32_t uid)
 {
     khiter_t k = kh_get(pos, table, uid);
@@ -210,6 +218,7 @@ void G_Pos_Delete(uint32_t uid)
 
     vec3_t pos = kh_val(s_postable, k);
     kh_del(pos, s_postable, k);
+    s_version++;
 
     bool ret = bg_ent_delete(&s_postree, pos.x, pos.z, uid);
     assert(ret);
@@ -242,6 +251,7 @@ void G_Pos_Ungarrison(uint32_t uid, vec3_t pos)
     bg_ent_insert(&s_postree, pos.x, pos.z, uid);
 
     kh_val(s_postable, k) = pos;
+    s_version++;
     float vrange = G_GetVisionRange(uid);
 
     G_Combat_AddRef(G_GetFactionID(uid), (vec2_t){pos.x, pos.z});
@@ -287,6 +297,7 @@ bool G_Pos_Init(const struct map *map)
     }
 
     E_Global_Register(EVENT_UPDATE_START, on_update_start, NULL, G_ALL);
+    s_version++;
     return true;
 }
 
@@ -370,6 +381,18 @@ bg_ent_t *G_Pos_CopyBitmapGrid(void)
     return ret;
 }
 
+bg_ent_t *G_Pos_CopyBitmapGridFrom(bg_ent_t *tree)
+{
+    bg_ent_t *ret = PF_MALLOC(sizeof(bg_ent_t));
+    if(!ret)
+        return NULL;
+    if(!bg_ent_copy(tree, ret)) {
+        PF_FREE(ret);
+        return NULL;
+    }
+    return ret;
+}
+
 void G_Pos_DestroyBitmapGrid(bg_ent_t *tree)
 {
     bg_ent_destroy(tree);
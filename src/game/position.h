@@ -68,6 +68,8 @@ uint32_t  G_Pos_NearestWithPredFrom(bg_ent_t *tree, khash_t(pos) *positions,
                                     float max_range);
 
 khash_t(pos) *G_Pos_CopyTable(void);
+bg_ent_t     *G_Pos_CopyBitmapGridFrom(bg_ent_t *tree);
+uint32_t      G_Pos_Version(void);
 
 void      G_Pos_Garrison(uint32_t uid);
 void      G_Pos_Ungarrison(uint32_t uid, vec3_t pos);
@@ -141,6 +141,35 @@ void            G_Update(void);
 void            G_Render(void);
 void            G_SwapBuffers(void);
 
+/* In deterministic mode, the simulation clock advances by exactly one 
+ * 60Hz step per call to 'G_Timer_Step' (once per simulated frame) rather 
+ * than following the wall clock, simulation-side randomness is drawn from 
+ * a generator seeded with 'seed', and work which could otherwise finish 
+ * on a different tick from one run to the next (GPU movement, asynchronous 
+ * formation jobs) is done on the CPU or waited on. Set it up before the 
+ * first map is loaded. 
+ */
+bool            G_SetDeterministic(uint32_t seed);
+bool            G_Deterministic(void);
+void            G_Timer_Step(void);
+uint32_t        G_Timer_Ticks(void);
+uint32_t        G_Rand(void);
+float           G_RandFloat(void);
+
+/* Record the movement and combat commands processed by the simulation to 
+ * a file, or replay them from one in place of the commands issued by the 
+ * session. Both are only meaningful in deterministic mode. The seed is 
+ * stored in the journal. Orders that bypass the journaled command queues 
+ * are reported with 'G_Journal_NoteUnjournaled' - a recording that has 
+ * any is refused for replay.
+ */
+bool            G_Journal_BeginRecord(const char *path, uint32_t seed);
+bool            G_Journal_BeginReplay(const char *path, uint32_t *out_seed);
+void            G_Journal_End(void);
+bool            G_Journal_Recording(void);
+bool            G_Journal_Replaying(void);
+void            G_Journal_NoteUnjournaled(const char *order);
+
 /* This does not have any side effects besides  making draw calls, 
  * so it is safe to invoke from the render thread. 
  */
@@ -0,0 +1,498 @@
+/*
+ *  This file is part of Permafrost Engine. 
+ *  Copyright (C) 2026 Eduard Permyakov 
+ *
+ *  Permafrost Engine is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Permafrost Engine is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *  Linking this software statically or dynamically with other modules is making 
+ *  a combined work based on this software. Thus, the terms and conditions of 
+ *  the GNU General Public License cover the whole combination. 
+ *  
+ *  As a special exception, the copyright holders of Permafrost Engine give 
+ *  you permission to link Permafrost Engine with independent modules to produce 
+ *  an executable, regardless of the license terms of these independent 
+ *  modules, and to copy and distribute the resulting executable under 
+ *  terms of your choice, provided that you also meet, for each linked 
+ *  independent module, the terms and conditions of the license of that 
+ *  module. An independent module is a module which is not derived from 
+ *  or based on Permafrost Engine. If you modify Permafrost Engine, you may 
+ *  extend this exception to your version of Permafrost Engine, but you are not 
+ *  obliged to do so. If you do not wish to do so, delete this exception 
+ *  statement from your version.
+ *
+ */
+
+
+#define MEM_FILE_SYS MEM_SYS_GAME
+#define MEM_FILE_SUB MEM_SUB_GAME_SNAPSHOT
+
+#include "snapshot.h"
+#include "fog_of_war.h"
+#include "../entity.h"
+#include "../main.h"
+#include "../perf.h"
+#include "../asset_load.h"
+#include "../phys/public/collision.h"
+#include "../lib/public/khash.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "../mem.h"
+
+#undef PF_MALLOC
+#undef PF_CALLOC
+#undef PF_REALLOC
+#define PF_MALLOC(_n)       PF_MALLOC_TAGGED((_n), MEM_SYS_GAME, MEM_SUB_GAME_SNAPSHOT)
+#define PF_CALLOC(_c, _n)   PF_CALLOC_TAGGED((_c), (_n), MEM_SYS_GAME, MEM_SUB_GAME_SNAPSHOT)
+#define PF_REALLOC(_p, _n)  PF_REALLOC_TAGGED((_p), (_n), MEM_SYS_GAME, MEM_SUB_GAME_SNAPSHOT)
+
+struct gs_component{
+    SHARED_PTR_HEADER;
+    enum gs_component_type type;
+    /* The version of the source state that the data was copied from */
+    uint64_t               key;
+    void                  *data[2];
+};
+
+KHASH_MAP_INIT_INT(aabb, struct aabb)
+
+SHARED_PTR_ASSERT_LAYOUT(struct gs_component, sp);
+SHARED_PTR_ASSERT_LAYOUT(struct gs_snapshot, sp);
+
+/*****************************************************************************/
+/* STATIC VARIABLES                                                          */
+/*****************************************************************************/
+
+/* The most recently built snapshot. We hold a reference to it 
+ * so that its' components can be shared with the next one. */
+static struct gs_snapshot *s_latest;
+static uint64_t            s_next_version;
+
+/*****************************************************************************/
+/* STATIC FUNCTIONS                                                          */
+/*****************************************************************************/
+
+static khash_t(aabb) *snapshot_copy_aabbs(void)
+{
+    PERF_ENTER();
+    khash_t(aabb) *aabbs = kh_init(aabb);
+    if(!aabbs)
+        PERF_RETURN(NULL);
+
+    const khash_t(entity) *ents = G_GetAllEntsSet();
+    if(kh_resize(aabb, aabbs, kh_size(ents)) < 0) {
+        kh_destroy(aabb, aabbs);
+        PERF_RETURN(NULL);
+    }
+
+    uint32_t uid;
+    kh_foreach_key(ents, uid, {
+        int ret;
+        khiter_t k = kh_put(aabb, aabbs, uid, &ret);
+        assert(ret != -1);
+        kh_value(aabbs, k) = AL_EntityGet(uid)->identity_aabb;
+    });
+    PERF_RETURN(aabbs);
+}
+
+/* Assigns every entity with a position a slot in 'cols->index' and writes its' 
+ * position column. Returns false if the index holds an entity that no longer 
+ * has a position, or on allocation failure. 
+ */
+static bool columns_index_positions(struct gs_columns *cols, const khash_t(pos) *positions)
+{
+    size_t nents = kh_size(positions);
+
+    uint32_t uid;
+    vec3_t pos;
+    kh_foreach(positions, uid, pos, {
+        uint32_t idx = pf_sset_insert(&cols->index, uid);
+        if(idx == PF_SSET_NONE || idx >= nents)
+            return false;
+        cols->xz_pos[idx] = (vec2_t){pos.x, pos.z};
+    });
+    return (cols->index.size == nents);
+}
+
+#define COLUMN_SCATTER(_cols, _type, _table, _out)                          \
+    do{                                                                     \
+        uint32_t _uid;                                                      \
+        _type _val;                                                         \
+        kh_foreach((_table), _uid, _val, {                                  \
+            uint32_t _idx = pf_sset_index(&(_cols)->index, _uid);           \
+            if(_idx != PF_SSET_NONE)                                        \
+                (_out)[_idx] = _val;                                        \
+        });                                                                 \
+    }while(0)
+
+/* The columns are built from the previous snapshot's, when there is one. An 
+ * entity keeps its' slot for as long as it has a position, so the columns 
+ * whose source component is shared with the previous snapshot can be copied 
+ * over as-is. The rest are scattered from a single pass over their tables. 
+ */
+static struct gs_columns *snapshot_build_columns(const struct gs_snapshot *snap, 
+                                                 const struct gs_snapshot *prev)
+{
+    PERF_ENTER();
+    size_t nents = kh_size(snap->positions);
+    const struct gs_columns *prev_cols = prev ? prev->columns : NULL;
+
+    struct gs_columns *ret = PF_CALLOC(1, sizeof(struct gs_columns));
+    if(!ret)
+        goto fail_alloc;
+
+    bool reuse = prev_cols && pf_sset_copy(&ret->index, &prev_cols->index);
+    if(!reuse && !pf_sset_init(&ret->index, nents, MEM_SYS_GAME, MEM_SUB_GAME_SNAPSHOT))
+        goto fail_index;
+
+    size_t cap = nents ? nents : 1;
+    ret->flags = PF_MALLOC(cap * sizeof(uint32_t));
+    ret->xz_pos = PF_MALLOC(cap * sizeof(vec2_t));
+    ret->sel_radius = PF_MALLOC(cap * sizeof(float));
+    ret->faction_id = PF_MALLOC(cap * sizeof(int));
+    if(!ret->flags || !ret->xz_pos || !ret->sel_radius || !ret->faction_id)
+        goto fail_columns;
+
+    if(!columns_index_positions(ret, snap->positions)) {
+        /* Some entity lost its' position - lay the index out from scratch */
+        pf_sset_clear(&ret->index);
+        reuse = false;
+        if(!columns_index_positions(ret, snap->positions))
+            goto fail_columns;
+    }
+
+    /* Don't assume that everything with a position was added to the game */
+    bool same_layout = reuse && (prev_cols->index.size == nents);
+    if(same_layout && snap->comps[GS_COMP_FLAGS] == prev->comps[GS_COMP_FLAGS]) {
+        memcpy(ret->flags, prev_cols->flags, nents * sizeof(uint32_t));
+    }else{
+        memset(ret->flags, 0, cap * sizeof(uint32_t));
+        COLUMN_SCATTER(ret, int, snap->flags, ret->flags);
+    }
+    if(same_layout && snap->comps[GS_COMP_SEL_RADIUSES] == prev->comps[GS_COMP_SEL_RADIUSES]) {
+        memcpy(ret->sel_radius, prev_cols->sel_radius, nents * sizeof(float));
+    }else{
+        memset(ret->sel_radius, 0, cap * sizeof(float));
+        COLUMN_SCATTER(ret, float, snap->sel_radiuses, ret->sel_radius);
+    }
+    if(same_layout && snap->comps[GS_COMP_FACTION_IDS] == prev->comps[GS_COMP_FACTION_IDS]) {
+        memcpy(ret->faction_id, prev_cols->faction_id, nents * sizeof(int));
+    }else{
+        memset(ret->faction_id, 0, cap * sizeof(int));
+        COLUMN_SCATTER(ret, int, snap->faction_ids, ret->faction_id);
+    }
+    PERF_RETURN(ret);
+
+fail_columns:
+    PF_FREE(ret->flags);
+    PF_FREE(ret->xz_pos);
+    PF_FREE(ret->sel_radius);
+    PF_FREE(ret->faction_id);
+    pf_sset_destroy(&ret->index);
+fail_index:
+    PF_FREE(ret);
+fail_alloc:
+    PERF_RETURN(NULL);
+}
+
+static void snapshot_destroy_columns(struct gs_columns *cols)
+{
+    PF_FREE(cols->flags);
+    PF_FREE(cols->xz_pos);
+    PF_FREE(cols->sel_radius);
+    PF_FREE(cols->faction_id);
+    pf_sset_destroy(&cols->index);
+    PF_FREE(cols);
+}
+
+static uint64_t component_key(enum gs_component_type type)
+{
+    const struct gs_versions *versions = G_GetVersions();
+
+    switch(type) {
+    case GS_COMP_FLAGS:
+        return versions->flags;
+    case GS_COMP_POSITIONS:
+        return G_Pos_Version();
+    case GS_COMP_SEL_RADIUSES:
+        return versions->sel_radiuses;
+    case GS_COMP_FACTION_IDS:
+        return versions->faction_ids;
+    case GS_COMP_GPU_IDS:
+        return versions->gpu_ids;
+    case GS_COMP_TRANSFORMS:
+        return Entity_TransformsVersion();
+    case GS_COMP_AABBS:
+        /* There is an AABB for every active entity. Changing an entity's 
+         * model (and thus its' AABB) always rewrites its' flags. */
+        return (((uint64_t)versions->active) << 32) | versions->flags;
+    case GS_COMP_FOG:
+        return G_Fog_StateVersion();
+    case GS_COMP_DIPLOMACY:
+        return versions->diplomacy;
+    case GS_COMP_COLUMNS:
+        /* Derived data - rebuilt whenever any of its' sources are */
+        return 0;
+    default: assert(0);
+    }
+    return 0;
+}
+
+static void component_destroy(void *owner)
+{
+    struct gs_component *comp = owner;
+
+    switch(comp->type) {
+    case GS_COMP_FLAGS:
+    case GS_COMP_FACTION_IDS:
+        kh_destroy(id, comp->data[0]);
+        break;
+    case GS_COMP_POSITIONS:
+        kh_destroy(pos, comp->data[0]);
+        if(comp->data[1]) {
+            G_Pos_DestroyBitmapGrid(comp->data[1]);
+        }
+        break;
+    case GS_COMP_SEL_RADIUSES:
+        kh_destroy(range, comp->data[0]);
+        break;
+    case GS_COMP_GPU_IDS:
+        kh_destroy(id, comp->data[0]);
+        kh_destroy(id, comp->data[1]);
+        break;
+    case GS_COMP_TRANSFORMS:
+        kh_destroy(trans, comp->data[0]);
+        break;
+    case GS_COMP_AABBS:
+        kh_destroy(aabb, comp->data[0]);
+        break;
+    case GS_COMP_FOG:
+    case GS_COMP_DIPLOMACY:
+        PF_FREE(comp->data[0]);
+        break;
+    case GS_COMP_COLUMNS:
+        if(comp->data[0]) {
+            snapshot_destroy_columns(comp->data[0]);
+        }
+        break;
+    default: assert(0);
+    }
+    PF_FREE(comp);
+}
+
+static struct gs_component *component_alloc(enum gs_component_type type, uint64_t key)
+{
+    struct gs_component *ret = PF_MALLOC(sizeof(struct gs_component));
+    if(!ret)
+        return NULL;
+
+    ret->type = type;
+    ret->key = key;
+    ret->data[0] = NULL;
+    ret->data[1] = NULL;
+    sp_init(ret, component_destroy);
+    return ret;
+}
+
+static struct gs_component *component_create(enum gs_component_type type, uint64_t key)
+{
+    PERF_ENTER();
+    struct gs_component *ret = component_alloc(type, key);
+    if(!ret)
+        PERF_RETURN(NULL);
+
+    bool ok = true;
+    switch(type) {
+    case GS_COMP_FLAGS:
+        ok = !!(ret->data[0] = G_FlagsCopyTable());
+        break;
+    case GS_COMP_POSITIONS:
+        ok = !!(ret->data[0] = G_Pos_CopyTable())
+          && !!(ret->data[1] = G_Pos_CopyBitmapGrid());
+        break;
+    case GS_COMP_SEL_RADIUSES:
+        ok = !!(ret->data[0] = G_SelectionRadiusCopyTable());
+        break;
+    case GS_COMP_FACTION_IDS:
+        ok = !!(ret->data[0] = G_FactionIDCopyTable());
+        break;
+    case GS_COMP_GPU_IDS:
+        ok = !!(ret->data[0] = G_CopyEntGPUIDMap())
+          && !!(ret->data[1] = G_CopyGPUIDEntMap());
+        break;
+    case GS_COMP_TRANSFORMS:
+        ok = !!(ret->data[0] = Entity_CopyTransforms());
+        break;
+    case GS_COMP_AABBS:
+        ok = !!(ret->data[0] = snapshot_copy_aabbs());
+        break;
+    case GS_COMP_FOG:
+        ok = !!(ret->data[0] = G_Fog_CopyState());
+        break;
+    case GS_COMP_DIPLOMACY:
+        ok = !!(ret->data[0] = G_CopyDiplomacyTable());
+        break;
+    default: assert(0);
+    }
+
+    if(!ok) {
+        sp_release(ret);
+        PERF_RETURN(NULL);
+    }
+    PERF_RETURN(ret);
+}
+
+static bool columns_sources_shared(const struct gs_snapshot *snap)
+{
+    static const enum gs_component_type sources[] = {
+        GS_COMP_FLAGS, 
+        GS_COMP_POSITIONS, 
+        GS_COMP_SEL_RADIUSES, 
+        GS_COMP_FACTION_IDS,
+    };
+    if(!s_latest)
+        return false;
+
+    for(int i = 0; i < sizeof(sources)/sizeof(sources[0]); i++) {
+        if(snap->comps[sources[i]] != s_latest->comps[sources[i]])
+            return false;
+    }
+    return true;
+}
+
+static struct gs_component *component_create_columns(const struct gs_snapshot *snap)
+{
+    struct gs_component *ret = component_alloc(GS_COMP_COLUMNS, component_key(GS_COMP_COLUMNS));
+    if(!ret)
+        return NULL;
+
+    if(!(ret->data[0] = snapshot_build_columns(snap, s_latest))) {
+        sp_release(ret);
+        return NULL;
+    }
+    return ret;
+}
+
+static void snapshot_destroy(void *owner)
+{
+    struct gs_snapshot *snap = owner;
+    for(int i = 0; i < GS_COMP_COUNT; i++) {
+        sp_release(snap->comps[i]);
+    }
+    PF_FREE(snap);
+}
+
+static bool snapshot_current(const uint64_t keys[static GS_COMP_COUNT], 
+                             bool fog_enabled, uint16_t factions, uint16_t player_controllable)
+{
+    if(!s_latest)
+        return false;
+
+    for(int i = 0; i < GS_COMP_COUNT; i++) {
+        if(s_latest->comps[i]->key != keys[i])
+            return false;
+    }
+    return (s_latest->fog_enabled == fog_enabled)
+        && (s_latest->factions == factions)
+        && (s_latest->player_controllable == player_controllable);
+}
+
+/*****************************************************************************/
+/* EXTERN FUNCTIONS                                                          */
+/*****************************************************************************/
+
+bool G_Snapshot_Init(void)
+{
+    s_latest = NULL;
+    return true;
+}
+
+void G_Snapshot_Shutdown(void)
+{
+    sp_release(s_latest);
+    s_latest = NULL;
+}
+
+struct gs_snapshot *G_Snapshot_Acquire(void)
+{
+    ASSERT_IN_MAIN_THREAD();
+    PERF_ENTER();
+
+    uint64_t keys[GS_COMP_COUNT];
+    for(int i = 0; i < GS_COMP_COUNT; i++) {
+        keys[i] = component_key(i);
+    }
+    bool fog_enabled = G_Fog_Enabled();
+    uint16_t factions = G_GetFactions(NULL, NULL, NULL);
+    uint16_t player_controllable = G_GetPlayerControlledFactions();
+
+    if(snapshot_current(keys, fog_enabled, factions, player_controllable))
+        PERF_RETURN(sp_retain(s_latest));
+
+    struct gs_snapshot *ret = PF_CALLOC(1, sizeof(struct gs_snapshot));
+    if(!ret)
+        PERF_RETURN(NULL);
+    sp_init(ret, snapshot_destroy);
+
+    for(int i = 0; i < GS_COMP_COLUMNS; i++) {
+
+        if(s_latest && s_latest->comps[i]->key == keys[i]) {
+            ret->comps[i] = sp_retain(s_latest->comps[i]);
+            continue;
+        }
+        ret->comps[i] = component_create(i, keys[i]);
+        if(!ret->comps[i]) {
+            sp_release(ret);
+            PERF_RETURN(NULL);
+        }
+    }
+
+    ret->flags = ret->comps[GS_COMP_FLAGS]->data[0];
+    ret->positions = ret->comps[GS_COMP_POSITIONS]->data[0];
+    ret->postree = ret->comps[GS_COMP_POSITIONS]->data[1];
+    ret->sel_radiuses = ret->comps[GS_COMP_SEL_RADIUSES]->data[0];
+    ret->faction_ids = ret->comps[GS_COMP_FACTION_IDS]->data[0];
+    ret->ent_gpu_id_map = ret->comps[GS_COMP_GPU_IDS]->data[0];
+    ret->gpu_id_ent_map = ret->comps[GS_COMP_GPU_IDS]->data[1];
+    ret->transforms = ret->comps[GS_COMP_TRANSFORMS]->data[0];
+    ret->aabbs = ret->comps[GS_COMP_AABBS]->data[0];
+    ret->fog_state = ret->comps[GS_COMP_FOG]->data[0];
+    ret->diptable = ret->comps[GS_COMP_DIPLOMACY]->data[0];
+    ret->fog_enabled = fog_enabled;
+    ret->factions = factions;
+    ret->player_controllable = player_controllable;
+
+    if(columns_sources_shared(ret)) {
+        ret->comps[GS_COMP_COLUMNS] = sp_retain(s_latest->comps[GS_COMP_COLUMNS]);
+    }else{
+        ret->comps[GS_COMP_COLUMNS] = component_create_columns(ret);
+    }
+    if(!ret->comps[GS_COMP_COLUMNS]) {
+        sp_release(ret);
+        PERF_RETURN(NULL);
+    }
+    ret->columns = ret->comps[GS_COMP_COLUMNS]->data[0];
+    ret->version = ++s_next_version;
+
+    sp_release(s_latest);
+    s_latest = sp_retain(ret);
+    PERF_RETURN(ret);
+}
+
+void G_Snapshot_Release(struct gs_snapshot *snap)
+{
+    sp_release(snap);
+}
+
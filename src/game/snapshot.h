@@ -0,0 +1,129 @@
+/*
+ *  This file is part of Permafrost Engine. 
+ *  Copyright (C) 2026 Eduard Permyakov 
+ *
+ *  Permafrost Engine is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Permafrost Engine is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *  Linking this software statically or dynamically with other modules is making 
+ *  a combined work based on this software. Thus, the terms and conditions of 
+ *  the GNU General Public License cover the whole combination. 
+ *  
+ *  As a special exception, the copyright holders of Permafrost Engine give 
+ *  you permission to link Permafrost Engine with independent modules to produce 
+ *  an executable, regardless of the license terms of these independent 
+ *  modules, and to copy and distribute the resulting executable under 
+ *  terms of your choice, provided that you also meet, for each linked 
+ *  independent module, the terms and conditions of the license of that 
+ *  module. An independent module is a module which is not derived from 
+ *  or based on Permafrost Engine. If you modify Permafrost Engine, you may 
+ *  extend this exception to your version of Permafrost Engine, but you are not 
+ *  obliged to do so. If you do not wish to do so, delete this exception 
+ *  statement from your version.
+ *
+ */
+
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "game_private.h"
+#include "position.h"
+#include "../lib/public/shared_ptr.h"
+#include "../lib/public/pf_sparse_set.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct kh_aabb_s;
+struct gs_component;
+
+enum gs_component_type{
+    GS_COMP_FLAGS,
+    GS_COMP_POSITIONS,      /* position table and bitmap grid */
+    GS_COMP_SEL_RADIUSES,
+    GS_COMP_FACTION_IDS,
+    GS_COMP_GPU_IDS,        /* both directions of the GPU ID mapping */
+    GS_COMP_TRANSFORMS,
+    GS_COMP_AABBS,
+    GS_COMP_FOG,
+    GS_COMP_DIPLOMACY,
+    GS_COMP_COLUMNS,        /* derived from flags, positions, radiuses and faction IDs */
+    GS_COMP_COUNT
+};
+
+/* The hottest per-entity state, packed into parallel arrays. The index of 
+ * an entity is the same in every column, and is looked up through 'index'
+ * without any hashing. Entities without a position are not present.
+ *
+ * This is a read-side cache for the tick workers. The tables remain the 
+ * authoritative state. All the writers (the game API, scripting, the save 
+ * and load paths) go through them, and the columns are rebuilt from them 
+ * whenever a snapshot with changed tables is taken. Readers must fall back 
+ * to the tables for the entities that are not present.
+ */
+struct gs_columns{
+    struct pf_sparse_set index;
+    uint32_t            *flags;
+    vec2_t              *xz_pos;
+    float               *sel_radius;
+    int                 *faction_id;
+};
+
+/* An immutable copy of the parts of the gamestate that are read by the 
+ * asynchronous simulation systems (movement, combat, navigation), so that 
+ * they can all be fed the same state for a tick.
+ *
+ * A new version is only built when some part of the gamestate was written 
+ * since the last one. It shares every component that did not change with 
+ * the previous version, and each component is reference-counted on its own, 
+ * so that an old version stays valid for as long as anyone holds on to it.
+ */
+struct gs_snapshot{
+    SHARED_PTR_HEADER;
+    uint64_t               version;
+    khash_t(id)           *flags;
+    khash_t(pos)          *positions;
+    bg_ent_t              *postree;
+    khash_t(range)        *sel_radiuses;
+    khash_t(id)           *faction_ids;
+    khash_t(id)           *ent_gpu_id_map;
+    khash_t(id)           *gpu_id_ent_map;
+    void                  *transforms;
+    struct kh_aabb_s      *aabbs;
+    uint32_t              *fog_state;
+    enum diplomacy_state (*diptable)[MAX_FACTIONS];
+    bool                   fog_enabled;
+    uint16_t               factions;
+    uint16_t               player_controllable;
+    const struct gs_columns *columns;
+    struct gs_component   *comps[GS_COMP_COUNT];
+};
+
+bool G_Snapshot_Init(void);
+void G_Snapshot_Shutdown(void);
+
+/* Returns a new reference to a snapshot of the current gamestate, or NULL 
+ * on allocation failure. May only be called from the main thread. 
+ */
+struct gs_snapshot *G_Snapshot_Acquire(void);
+/* May be called from any thread. */
+void                G_Snapshot_Release(struct gs_snapshot *snap);
+
+static inline uint32_t G_Columns_Index(const struct gs_columns *cols, uint32_t uid)
+{
+    return pf_sset_index(&cols->index, uid);
+}
+
+#endif
+
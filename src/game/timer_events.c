@@ -61,6 +61,12 @@
 
 static unsigned long long s_num_60hz_ticks;
 static SDL_TimerID        s_60hz_timer;
+/* In fixed-step mode, the 60Hz tick is not driven by an SDL timer but 
+ * by the main loop (exactly once per simulation frame) and the 
+ * simulation clock counts those steps instead of wall-clock time. 
+ */
+static bool               s_fixed_step;
+static unsigned long long s_num_steps;
 
 /*****************************************************************************/
 /* STATIC FUNCTIONS                                                          */
@@ -142,6 +148,40 @@ bool G_Timer_Init(void)
 void G_Timer_Shutdown(void)
 {
     E_Global_Unregister(EVENT_60HZ_TICK, timer_60hz_handler);
-    SDL_RemoveTimer(s_60hz_timer);
+    if(s_60hz_timer) {
+        SDL_RemoveTimer(s_60hz_timer);
+    }
+}
+
+bool G_Timer_SetFixedStep(bool on)
+{
+    if(on == s_fixed_step)
+        return true;
+
+    if(on) {
+        SDL_RemoveTimer(s_60hz_timer);
+        s_60hz_timer = 0;
+    }else{
+        s_60hz_timer = SDL_AddTimer(TIMER_INTERVAL, timer_callback, NULL);
+        if(0 == s_60hz_timer)
+            return false;
+    }
+    s_fixed_step = on;
+    return true;
+}
+
+void G_Timer_Step(void)
+{
+    if(!s_fixed_step)
+        return;
+    s_num_steps++;
+    E_Global_Notify(EVENT_60HZ_TICK, NULL, ES_ENGINE);
+}
+
+uint32_t G_Timer_Ticks(void)
+{
+    if(!s_fixed_step)
+        return SDL_GetTicks();
+    return (uint32_t)(s_num_steps * 1000 / 60);
 }
 
@@ -41,6 +41,7 @@
 
 bool G_Timer_Init(void);
 void G_Timer_Shutdown(void);
+bool G_Timer_SetFixedStep(bool on);
 
 #endif
 
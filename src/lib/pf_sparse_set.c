@@ -0,0 +1,189 @@
+/*
+ *  This file is part of Permafrost Engine.
+ *  Copyright (C) 2026 Eduard Permyakov
+ *
+ *  Permafrost Engine is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Permafrost Engine is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Linking this software statically or dynamically with other modules is making
+ *  a combined work based on this software. Thus, the terms and conditions of
+ *  the GNU General Public License cover the whole combination.
+ *
+ *  As a special exception, the copyright holders of Permafrost Engine give
+ *  you permission to link Permafrost Engine with independent modules to produce
+ *  an executable, regardless of the license terms of these independent
+ *  modules, and to copy and distribute the resulting executable under
+ *  terms of your choice, provided that you also meet, for each linked
+ *  independent module, the terms and conditions of the license of that
+ *  module. An independent module is a module which is not derived from
+ *  or based on Permafrost Engine. If you modify Permafrost Engine, you may
+ *  extend this exception to your version of Permafrost Engine, but you are not
+ *  obliged to do so. If you do not wish to do so, delete this exception
+ *  statement from your version.
+ *
+ */
+
+#define MEM_FILE_SYS MEM_SYS_LIB
+
+#include "public/pf_sparse_set.h"
+
+#include <string.h>
+#include <assert.h>
+
+#include "../mem.h"
+
+#define MAX(a, b)   ((a) > (b) ? (a) : (b))
+
+/*****************************************************************************/
+/* STATIC FUNCTIONS                                                          */
+/*****************************************************************************/
+
+static bool sset_reserve_dense(struct pf_sparse_set *set, size_t capacity)
+{
+    if(set->capacity >= capacity)
+        return true;
+
+    size_t new_cap = MAX(capacity, MAX(set->capacity * 2, 64));
+    uint32_t *dense = PF_REALLOC_TAGGED(set->dense, new_cap * sizeof(uint32_t), 
+        set->mem_sys, set->mem_sub);
+    if(!dense)
+        return false;
+
+    set->dense = dense;
+    set->capacity = new_cap;
+    return true;
+}
+
+static uint32_t *sset_page(struct pf_sparse_set *set, uint32_t id)
+{
+    size_t page = id >> PF_SSET_PAGE_SHIFT;
+    if(page >= set->npages) {
+
+        size_t new_npages = MAX(page + 1, set->npages * 2);
+        uint32_t **pages = PF_REALLOC_TAGGED(set->pages, new_npages * sizeof(uint32_t*), 
+            set->mem_sys, set->mem_sub);
+        if(!pages)
+            return NULL;
+
+        memset(pages + set->npages, 0, (new_npages - set->npages) * sizeof(uint32_t*));
+        set->pages = pages;
+        set->npages = new_npages;
+    }
+
+    if(!set->pages[page]) {
+        uint32_t *slots = PF_MALLOC_TAGGED(PF_SSET_PAGE_SIZE * sizeof(uint32_t), 
+            set->mem_sys, set->mem_sub);
+        if(!slots)
+            return NULL;
+        /* PF_SSET_NONE has all bits set */
+        memset(slots, 0xff, PF_SSET_PAGE_SIZE * sizeof(uint32_t));
+        set->pages[page] = slots;
+    }
+    return set->pages[page];
+}
+
+/*****************************************************************************/
+/* EXTERN FUNCTIONS                                                          */
+/*****************************************************************************/
+
+bool pf_sset_init(struct pf_sparse_set *set, size_t reserve, uint16_t mem_sys, uint16_t mem_sub)
+{
+    set->pages = NULL;
+    set->npages = 0;
+    set->dense = NULL;
+    set->size = 0;
+    set->capacity = 0;
+    set->mem_sys = mem_sys;
+    set->mem_sub = mem_sub;
+
+    if(reserve && !sset_reserve_dense(set, reserve))
+        return false;
+    return true;
+}
+
+void pf_sset_destroy(struct pf_sparse_set *set)
+{
+    for(size_t i = 0; i < set->npages; i++) {
+        if(set->pages[i]) {
+            PF_FREE(set->pages[i]);
+        }
+    }
+    if(set->pages) {
+        PF_FREE(set->pages);
+    }
+    if(set->dense) {
+        PF_FREE(set->dense);
+    }
+    set->pages = NULL;
+    set->npages = 0;
+    set->dense = NULL;
+    set->size = 0;
+    set->capacity = 0;
+}
+
+void pf_sset_clear(struct pf_sparse_set *set)
+{
+    for(size_t i = 0; i < set->size; i++) {
+        uint32_t id = set->dense[i];
+        set->pages[id >> PF_SSET_PAGE_SHIFT][id & (PF_SSET_PAGE_SIZE - 1)] = PF_SSET_NONE;
+    }
+    set->size = 0;
+}
+
+bool pf_sset_copy(struct pf_sparse_set *dst, const struct pf_sparse_set *src)
+{
+    if(!pf_sset_init(dst, src->size, src->mem_sys, src->mem_sub))
+        return false;
+
+    for(size_t i = 0; i < src->size; i++) {
+        if(pf_sset_insert(dst, src->dense[i]) == PF_SSET_NONE) {
+            pf_sset_destroy(dst);
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t pf_sset_insert(struct pf_sparse_set *set, uint32_t id)
+{
+    assert(id != PF_SSET_NONE);
+
+    uint32_t *page = sset_page(set, id);
+    if(!page)
+        return PF_SSET_NONE;
+
+    uint32_t *slot = &page[id & (PF_SSET_PAGE_SIZE - 1)];
+    if(*slot != PF_SSET_NONE)
+        return *slot;
+
+    if(!sset_reserve_dense(set, set->size + 1))
+        return PF_SSET_NONE;
+
+    *slot = set->size;
+    set->dense[set->size++] = id;
+    return *slot;
+}
+
+uint32_t pf_sset_remove(struct pf_sparse_set *set, uint32_t id)
+{
+    uint32_t idx = pf_sset_index(set, id);
+    if(idx == PF_SSET_NONE)
+        return PF_SSET_NONE;
+
+    uint32_t last = set->dense[--set->size];
+    set->dense[idx] = last;
+    set->pages[last >> PF_SSET_PAGE_SHIFT][last & (PF_SSET_PAGE_SIZE - 1)] = idx;
+    set->pages[id >> PF_SSET_PAGE_SHIFT][id & (PF_SSET_PAGE_SIZE - 1)] = PF_SSET_NONE;
+    return idx;
+}
+
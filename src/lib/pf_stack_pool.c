@@ -0,0 +1,274 @@
+/*
+ *  This file is part of Permafrost Engine.
+ *  Copyright (C) 2026 Eduard Permyakov
+ *
+ *  Permafrost Engine is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Permafrost Engine is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Linking this software statically or dynamically with other modules is making
+ *  a combined work based on this software. Thus, the terms and conditions of
+ *  the GNU General Public License cover the whole combination.
+ *
+ *  As a special exception, the copyright holders of Permafrost Engine give
+ *  you permission to link Permafrost Engine with independent modules to produce
+ *  an executable, regardless of the license terms of these independent
+ *  modules, and to copy and distribute the resulting executable under
+ *  terms of your choice, provided that you also meet, for each linked
+ *  independent module, the terms and conditions of the license of that
+ *  module. An independent module is a module which is not derived from
+ *  or based on Permafrost Engine. If you modify Permafrost Engine, you may
+ *  extend this exception to your version of Permafrost Engine, but you are not
+ *  obliged to do so. If you do not wish to do so, delete this exception
+ *  statement from your version.
+ *
+ */
+
+
+#define MEM_FILE_SYS MEM_SYS_LIB
+
+#include "public/pf_stack_pool.h"
+#include "public/vec.h"
+
+#if defined(_WIN32)
+#include "public/windows.h"
+#include <psapi.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "../mem.h"
+
+#define PAINT_PATTERN   (0xdeadbeefcafef00dull)
+#define MIN(a, b)       ((a) < (b) ? (a) : (b))
+#define MAX(a, b)       ((a) > (b) ? (a) : (b))
+
+VEC_TYPE(stack, struct pf_stack)
+VEC_IMPL(static inline, stack, struct pf_stack)
+
+struct pf_stack_pool{
+    size_t      size;
+    size_t      retain;
+    size_t      max_cached;
+    size_t      page;
+    vec_stack_t cached;
+};
+
+/*****************************************************************************/
+/* STATIC FUNCTIONS                                                          */
+/*****************************************************************************/
+
+static size_t stack_page_size(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwPageSize;
+#else
+    long ret = sysconf(_SC_PAGESIZE);
+    return (ret > 0) ? (size_t)ret : 4096;
+#endif
+}
+
+static size_t stack_round_up(size_t n, size_t mult)
+{
+    return ((n + mult - 1) / mult) * mult;
+}
+
+static bool stack_map(size_t size, size_t page, struct pf_stack *out)
+{
+#if defined(_WIN32)
+    char *base = VirtualAlloc(NULL, size + page, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if(!base)
+        return false;
+    DWORD old;
+    if(!VirtualProtect(base, page, PAGE_NOACCESS, &old)) {
+        VirtualFree(base, 0, MEM_RELEASE);
+        return false;
+    }
+#else
+    char *base = mmap(NULL, size + page, PROT_READ | PROT_WRITE, 
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(base == MAP_FAILED)
+        return false;
+    if(mprotect(base, page, PROT_NONE) != 0) {
+        munmap(base, size + page);
+        return false;
+    }
+#endif
+    out->lo = base + page;
+    out->size = size;
+    out->retained = 0;
+    out->painted = 0;
+    return true;
+}
+
+static void stack_unmap(struct pf_stack *stack, size_t page)
+{
+    char *base = (char*)stack->lo - page;
+#if defined(_WIN32)
+    VirtualFree(base, 0, MEM_RELEASE);
+#else
+    munmap(base, stack->size + page);
+#endif
+}
+
+/* Give the pages back to the OS. They read as zeroes when next touched. */
+static void stack_discard(char *lo, size_t len)
+{
+#if defined(_WIN32)
+    VirtualFree(lo, len, MEM_DECOMMIT);
+    VirtualAlloc(lo, len, MEM_COMMIT, PAGE_READWRITE);
+#else
+    madvise(lo, len, MADV_DONTNEED);
+#endif
+}
+
+/* The lowest page in [lo, lo + len) that is backed by physical memory, or
+ * NULL if there are none. Should the OS not tell us, assume the worst. 
+ */
+static char *stack_lowest_resident(char *lo, size_t len, size_t page)
+{
+    size_t total = len / page;
+
+#if defined(_WIN32)
+    PSAPI_WORKING_SET_EX_INFORMATION info[256];
+    HANDLE proc = GetCurrentProcess();
+
+    for(size_t first = 0; first < total; first += 256) {
+        size_t npages = MIN(total - first, 256);
+        for(size_t k = 0; k < npages; k++)
+            info[k].VirtualAddress = lo + (first + k) * page;
+        if(!QueryWorkingSetEx(proc, info, (DWORD)(npages * sizeof(info[0]))))
+            return lo + first * page;
+        for(size_t k = 0; k < npages; k++) {
+            if(info[k].VirtualAttributes.Valid)
+                return lo + (first + k) * page;
+        }
+    }
+#else
+    unsigned char resident[256];
+
+    for(size_t first = 0; first < total; first += 256) {
+        size_t npages = MIN(total - first, 256);
+        if(mincore(lo + first * page, npages * page, resident) != 0)
+            return lo + first * page;
+        for(size_t k = 0; k < npages; k++) {
+            if(resident[k] & 0x1)
+                return lo + (first + k) * page;
+        }
+    }
+#endif
+    return NULL;
+}
+
+static void stack_paint(char *lo, size_t len)
+{
+    uint64_t *curr = (uint64_t*)lo;
+    uint64_t *end = (uint64_t*)(lo + len);
+    while(curr < end) {
+        *curr++ = PAINT_PATTERN;
+    }
+}
+
+/*****************************************************************************/
+/* EXTERN FUNCTIONS                                                          */
+/*****************************************************************************/
+
+struct pf_stack_pool *pf_stack_pool_create(size_t size, size_t retain, size_t max_cached)
+{
+    if(size == 0)
+        return NULL;
+
+    struct pf_stack_pool *pool = PF_MALLOC_TAGGED(sizeof(*pool), MEM_SYS_LIB, 0);
+    if(!pool)
+        return NULL;
+
+    pool->page = stack_page_size();
+    pool->size = stack_round_up(size, pool->page);
+    pool->retain = MIN(stack_round_up(retain, pool->page), pool->size);
+    pool->max_cached = max_cached;
+    vec_stack_init(&pool->cached);
+    return pool;
+}
+
+void pf_stack_pool_destroy(struct pf_stack_pool *pool)
+{
+    if(!pool)
+        return;
+
+    for(int i = 0; i < vec_size(&pool->cached); i++) {
+        stack_unmap(&vec_AT(&pool->cached, i), pool->page);
+    }
+    vec_stack_destroy(&pool->cached);
+    PF_FREE(pool);
+}
+
+bool pf_stack_alloc(struct pf_stack_pool *pool, struct pf_stack *out)
+{
+    if(vec_size(&pool->cached) > 0) {
+        *out = vec_stack_pop(&pool->cached);
+        return true;
+    }
+    return stack_map(pool->size, pool->page, out);
+}
+
+size_t pf_stack_free(struct pf_stack_pool *pool, struct pf_stack *stack)
+{
+    char *top = (char*)stack->lo + stack->size;
+    size_t used;
+
+    /* Nothing below the retained part is resident when the stack is handed 
+     * out, so any resident page there is one that got touched since. Within 
+     * the retained part, only the fill pattern tells the use apart. */
+    char *resident = stack_lowest_resident(stack->lo, stack->size - stack->retained, pool->page);
+    if(resident) {
+        used = top - resident;
+    }else if(stack->painted == stack->retained) {
+        uint64_t *curr = (uint64_t*)(top - stack->painted);
+        while((char*)curr < top && *curr == PAINT_PATTERN)
+            curr++;
+        used = top - (char*)curr;
+    }else{
+        used = PF_STACK_USED_UNKNOWN;
+    }
+
+    if(vec_size(&pool->cached) >= pool->max_cached) {
+        stack_unmap(stack, pool->page);
+        return used;
+    }
+
+    size_t touched = (used == PF_STACK_USED_UNKNOWN) ? stack->retained 
+                   : MAX(stack_round_up(used, pool->page), stack->retained);
+    size_t retained = MIN(touched, pool->retain);
+
+    if(touched > retained) {
+        stack_discard(top - touched, touched - retained);
+    }
+    stack->retained = retained;
+#ifndef NDEBUG
+    stack_paint(top - retained, retained);
+    stack->painted = retained;
+#else
+    stack->painted = 0;
+#endif
+
+    if(!vec_stack_push(&pool->cached, *stack)) {
+        stack_unmap(stack, pool->page);
+    }
+    return used;
+}
@@ -0,0 +1,70 @@
+/*
+ *  This file is part of Permafrost Engine.
+ *  Copyright (C) 2026 Eduard Permyakov
+ *
+ *  Permafrost Engine is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Permafrost Engine is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Linking this software statically or dynamically with other modules is making
+ *  a combined work based on this software. Thus, the terms and conditions of
+ *  the GNU General Public License cover the whole combination.
+ *
+ *  As a special exception, the copyright holders of Permafrost Engine give
+ *  you permission to link Permafrost Engine with independent modules to produce
+ *  an executable, regardless of the license terms of these independent
+ *  modules, and to copy and distribute the resulting executable under
+ *  terms of your choice, provided that you also meet, for each linked
+ *  independent module, the terms and conditions of the license of that
+ *  module. An independent module is a module which is not derived from
+ *  or based on Permafrost Engine. If you modify Permafrost Engine, you may
+ *  extend this exception to your version of Permafrost Engine, but you are not
+ *  obliged to do so. If you do not wish to do so, delete this exception
+ *  statement from your version.
+ *
+ */
+
+#ifndef PF_RAND_H
+#define PF_RAND_H
+
+#include <stdint.h>
+
+/* A tiny xorshift32 generator. Unlike rand(), the whole state is the 
+ * caller's 32-bit word, so the sequence is identical on every platform
+ * and every build for a given seed. Not suitable for anything that 
+ * needs to be unpredictable.
+ */
+
+static inline uint32_t pf_rand_seed(uint32_t seed)
+{
+    /* xorshift gets stuck on a zero state */
+    return seed ? seed : 0x9e3779b9u;
+}
+
+static inline uint32_t pf_rand_next(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/* Returns a value in [0.0, 1.0) */
+static inline float pf_rand_float(uint32_t *state)
+{
+    return (pf_rand_next(state) >> 8) / (float)(1u << 24);
+}
+
+#endif /* PF_RAND_H */
+
@@ -0,0 +1,98 @@
+/*
+ *  This file is part of Permafrost Engine.
+ *  Copyright (C) 2026 Eduard Permyakov
+ *
+ *  Permafrost Engine is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Permafrost Engine is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Linking this software statically or dynamically with other modules is making
+ *  a combined work based on this software. Thus, the terms and conditions of
+ *  the GNU General Public License cover the whole combination.
+ *
+ *  As a special exception, the copyright holders of Permafrost Engine give
+ *  you permission to link Permafrost Engine with independent modules to produce
+ *  an executable, regardless of the license terms of these independent
+ *  modules, and to copy and distribute the resulting executable under
+ *  terms of your choice, provided that you also meet, for each linked
+ *  independent module, the terms and conditions of the license of that
+ *  module. An independent module is a module which is not derived from
+ *  or based on Permafrost Engine. If you modify Permafrost Engine, you may
+ *  extend this exception to your version of Permafrost Engine, but you are not
+ *  obliged to do so. If you do not wish to do so, delete this exception
+ *  statement from your version.
+ *
+ */
+
+#ifndef PF_SPARSE_SET_H
+#define PF_SPARSE_SET_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PF_SSET_NONE        (~((uint32_t)0))
+#define PF_SSET_PAGE_SHIFT  (10)
+#define PF_SSET_PAGE_SIZE   (1u << PF_SSET_PAGE_SHIFT)
+
+/* A set of 32-bit IDs (entity UIDs) packed into a dense array. 
+ *
+ * Every ID maps to a stable index in [0, size) for as long as it is in the 
+ * set, so that the caller can keep per-ID data in parallel arrays that are 
+ * indexed the same way ('columns'), without any hashing on lookup. The 
+ * sparse side is split into lazily allocated pages, so a few large IDs 
+ * don't cost a full-sized table.
+ *
+ * Removal moves the last element into the vacated slot. The caller must 
+ * apply the same move to its' columns.
+ */
+
+struct pf_sparse_set{
+    uint32_t **pages;      /* ID -> dense index, PF_SSET_NONE when absent */
+    size_t     npages;
+    uint32_t  *dense;      /* dense index -> ID */
+    size_t     size;
+    size_t     capacity;
+    uint16_t   mem_sys;
+    uint16_t   mem_sub;
+};
+
+bool     pf_sset_init(struct pf_sparse_set *set, size_t reserve, uint16_t mem_sys, uint16_t mem_sub);
+void     pf_sset_destroy(struct pf_sparse_set *set);
+void     pf_sset_clear(struct pf_sparse_set *set);
+bool     pf_sset_copy(struct pf_sparse_set *dst, const struct pf_sparse_set *src);
+
+/* Returns the dense index of 'id', appending it if it was not present 
+ * already. Returns PF_SSET_NONE on allocation failure. 
+ */
+uint32_t pf_sset_insert(struct pf_sparse_set *set, uint32_t id);
+/* Returns the dense index that 'id' occupied, which now holds the element 
+ * that was previously last (unless 'id' was the last one itself). Returns 
+ * PF_SSET_NONE if 'id' was not in the set. 
+ */
+uint32_t pf_sset_remove(struct pf_sparse_set *set, uint32_t id);
+
+static inline uint32_t pf_sset_index(const struct pf_sparse_set *set, uint32_t id)
+{
+    size_t page = id >> PF_SSET_PAGE_SHIFT;
+    if(page >= set->npages || !set->pages[page])
+        return PF_SSET_NONE;
+    return set->pages[page][id & (PF_SSET_PAGE_SIZE - 1)];
+}
+
+static inline bool pf_sset_contains(const struct pf_sparse_set *set, uint32_t id)
+{
+    return (pf_sset_index(set, id) != PF_SSET_NONE);
+}
+
+#endif /* PF_SPARSE_SET_H */
+
@@ -0,0 +1,84 @@
+/*
+ *  This file is part of Permafrost Engine.
+ *  Copyright (C) 2026 Eduard Permyakov
+ *
+ *  Permafrost Engine is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Permafrost Engine is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Linking this software statically or dynamically with other modules is making
+ *  a combined work based on this software. Thus, the terms and conditions of
+ *  the GNU General Public License cover the whole combination.
+ *
+ *  As a special exception, the copyright holders of Permafrost Engine give
+ *  you permission to link Permafrost Engine with independent modules to produce
+ *  an executable, regardless of the license terms of these independent
+ *  modules, and to copy and distribute the resulting executable under
+ *  terms of your choice, provided that you also meet, for each linked
+ *  independent module, the terms and conditions of the license of that
+ *  module. An independent module is a module which is not derived from
+ *  or based on Permafrost Engine. If you modify Permafrost Engine, you may
+ *  extend this exception to your version of Permafrost Engine, but you are not
+ *  obliged to do so. If you do not wish to do so, delete this exception
+ *  statement from your version.
+ *
+ */
+
+
+#ifndef PF_STACK_POOL_H
+#define PF_STACK_POOL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/* A pool of same-sized stacks for fibers. 
+ *
+ * Each stack is mapped separately, with a no-access guard page right below 
+ * it so that an overflow faults instead of silently corrupting a neighbour. 
+ * Pages are only backed by physical memory once they're touched. 
+ *
+ * Freed stacks are cached for reuse. Up to 'retain' bytes of the part of the 
+ * stack that was last used stay resident so that the next user doesn't take
+ * page faults on them, while anything deeper is given back to the OS. In 
+ * debug builds, the retained part is filled with a pattern so that the next 
+ * free can tell how deep the stack was used. Release builds skip the fill 
+ * and only measure the usage to the page, from what is resident below the 
+ * retained part. Use that stayed within the retained part is unknown.
+ *
+ * The pool is not thread-safe.
+ */
+
+struct pf_stack{
+    void  *lo;       /* lowest usable address */
+    size_t size;     /* usable bytes */
+    size_t retained; /* bytes below the top left resident by the last user */
+    size_t painted;  /* bytes below the top holding the fill pattern */
+};
+
+/* Returned by pf_stack_free when the depth of use can't be told */
+#define PF_STACK_USED_UNKNOWN ((size_t)-1)
+
+struct pf_stack_pool;
+
+/* 'size' is rounded up to a page. Returns NULL on failure. */
+struct pf_stack_pool *pf_stack_pool_create(size_t size, size_t retain, size_t max_cached);
+void                  pf_stack_pool_destroy(struct pf_stack_pool *pool);
+
+bool   pf_stack_alloc(struct pf_stack_pool *pool, struct pf_stack *out);
+/* Returns the number of bytes (rounded up to a page, when the stack went 
+ * deeper than the painted part) that were used since the stack was allocated, 
+ * or PF_STACK_USED_UNKNOWN in release builds when the use didn't go past the 
+ * part retained from the previous user. 
+ */
+size_t pf_stack_free(struct pf_stack_pool *pool, struct pf_stack *stack);
+
+#endif /* PF_STACK_POOL_H */
@@ -125,6 +125,7 @@ static unsigned long             s_resume_tick;
  */
 static bool                      s_step_frame = false;
 static bool                      s_quit = false; 
+static int                       s_exit_code = EXIT_SUCCESS;
 static vec_event_t               s_prev_tick_events;
 
 static SDL_Thread               *s_render_thread;
@@ -133,6 +134,16 @@ static struct render_sync_state  s_rstate;
 static int                       s_argc;
 static char                    **s_argv;
 
+/* In headless mode, there is no GL context, render thread or audio output, 
+ * and the window is a hidden one on SDL's dummy video driver. The render 
+ * commands are dropped at the point where they would be handed off to the 
+ * render thread. The simulation either runs unthrottled,
+ * or at a fixed rate of 's_tick_hz' ticks per second. 
+ */
+static bool                      s_headless = false;
+static int                       s_tick_hz = 0;
+static uint64_t                  s_next_tick;
+
 /*****************************************************************************/
 /* STATIC FUNCTIONS                                                          */
 /*****************************************************************************/
@@ -248,6 +259,9 @@ static void rstate_destroy(struct render_sync_state *rstate)
 
 static int render_thread_quit(void)
 {
+    if(!s_render_thread)
+        return 0;
+
     SDL_LockMutex(s_rstate.sq_lock);
     s_rstate.quit = true;
     SDL_CondSignal(s_rstate.sq_cond);
@@ -260,6 +274,16 @@ static int render_thread_quit(void)
 
 static void render_thread_start_work(void)
 {
+    if(s_headless) {
+        /* Nobody will consume the commands - drop them and report the 
+         * work as done right away. */
+        R_ClearWS(G_GetRenderWS());
+        SDL_LockMutex(s_rstate.done_lock);
+        s_rstate.status = RSTAT_DONE;
+        SDL_UnlockMutex(s_rstate.done_lock);
+        return;
+    }
+
     SDL_LockMutex(s_rstate.done_lock);
     s_rstate.status = RSTAT_NONE;
     SDL_UnlockMutex(s_rstate.done_lock);
@@ -311,6 +335,99 @@ static void render_maybe_enable(void)
     s_rstate.swap_buffers = true;
 }
 
+static void headless_wait_next_tick(void)
+{
+    if(s_tick_hz <= 0)
+        return;
+
+    uint64_t freq = SDL_GetPerformanceFrequency();
+    uint64_t period = freq / s_tick_hz;
+    uint64_t now = SDL_GetPerformanceCounter();
+
+    /* Don't try to catch up after a tick that overran by a whole period */
+    if(s_next_tick == 0 || now > s_next_tick + period) {
+        s_next_tick = now;
+    }
+    s_next_tick += period;
+
+    if(now < s_next_tick) {
+        SDL_Delay((Uint32)((s_next_tick - now) * 1000 / freq));
+    }
+}
+
+static bool engine_has_flag(const char *name)
+{
+    for(int i = 3; i < s_argc; i++) {
+        const char *curr = s_argv[i];
+        if(strstr(curr, "--") != curr)
+            continue;
+        if(0 == strcmp(curr + 2, name))
+            return true;
+    }
+    return false;
+}
+
+static void engine_parse_headless_args(void)
+{
+    s_headless = engine_has_flag("headless");
+    if(!s_headless)
+        return;
+
+    char hz[32];
+    if(Engine_GetArg("tick_hz", sizeof(hz), hz)) {
+        s_tick_hz = strtol(hz, NULL, 10);
+        if(s_tick_hz < 0) {
+            s_tick_hz = 0;
+        }
+    }
+}
+
+/* Deterministic mode is turned on by '--deterministic' or '--seed=N', 
+ * and implied by recording ('--record=PATH') or replaying ('--replay=PATH') 
+ * a command journal. When replaying, the seed is taken from the journal.
+ */
+static bool engine_init_determinism(void)
+{
+    char record[512], replay[512], seedstr[32];
+    bool deterministic = engine_has_flag("deterministic");
+    bool has_record = Engine_GetArg("record", sizeof(record), record);
+    bool has_replay = Engine_GetArg("replay", sizeof(replay), replay);
+    uint32_t seed = 0;
+
+    if(Engine_GetArg("seed", sizeof(seedstr), seedstr)) {
+        seed = strtoul(seedstr, NULL, 10);
+        deterministic = true;
+    }
+
+    if(has_record && has_replay) {
+        fprintf(stderr, "Only one of '--record' and '--replay' can be used at a time.\n");
+        return false;
+    }
+
+    if(has_replay) {
+        if(!G_Journal_BeginReplay(replay, &seed)) {
+            fprintf(stderr, "Failed to open command journal for replay: %s\n", replay);
+            return false;
+        }
+        deterministic = true;
+    }
+
+    if(has_record) {
+        if(!G_Journal_BeginRecord(record, seed)) {
+            fprintf(stderr, "Failed to open command journal for recording: %s\n", record);
+            return false;
+        }
+        deterministic = true;
+    }
+
+    if(deterministic && !G_SetDeterministic(seed)) {
+        fprintf(stderr, "Failed to enable deterministic mode.\n");
+        G_Journal_End();
+        return false;
+    }
+    return true;
+}
+
 static void fs_on_key_press(void *user, void *event)
 {
     SDL_KeyboardEvent *key = &((SDL_Event*)event)->key;
@@ -334,6 +451,20 @@ static void frame_step_commit(const struct sval *new_val)
     }
 }
 
+static bool trace_frames_validate(const struct sval *new_val)
+{
+    return (new_val->type == ST_TYPE_INT && new_val->as_int >= 0);
+}
+
+static void trace_frames_commit(const struct sval *new_val)
+{
+    if(new_val->as_int > 0) {
+        Perf_TraceBegin(new_val->as_int);
+    }else{
+        Perf_TraceEnd();
+    }
+}
+
 static void engine_create_settings(void)
 {
     ss_e status = Settings_Create((struct setting){
@@ -347,6 +478,19 @@ static void engine_create_settings(void)
         .commit = frame_step_commit,
     });
     assert(status == SS_OKAY);
+
+    status = Settings_Create((struct setting){
+        .name = "pf.debug.trace_frames",
+        .val = (struct sval) {
+            .type = ST_TYPE_INT,
+            .as_int = 0 
+        },
+        .prio = 0,
+        .validate = trace_frames_validate,
+        .commit = trace_frames_commit,
+    });
+    assert(status == SS_OKAY);
+    (void)status;
 }
 
 static void engine_set_icon(void)
@@ -380,6 +524,16 @@ fail_surface:
     PF_FREE(image);
 }
 
+static void engine_render(void)
+{
+    if(!s_headless) {
+        G_Render();
+        return;
+    }
+    /* Nothing gets drawn - only throw away the UI that was built this frame */
+    UI_ClearFrame();
+}
+
 static bool engine_init(void)
 {
     if(!Mem_Init()) {
@@ -412,7 +566,16 @@ static bool engine_init(void)
             Settings_GetFile(), status);
     }
 
-    if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_TIMER) < 0) {
+    /* The dummy video driver still gives us a display mode, a window (with no 
+     * GL support) and mouse cursors, without needing a display server. */
+    Uint32 sdl_flags = SDL_INIT_VIDEO | SDL_INIT_TIMER;
+    if(s_headless) {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    }else{
+        sdl_flags |= SDL_INIT_AUDIO;
+    }
+
+    if(SDL_Init(sdl_flags) < 0) {
         fprintf(stderr, "Failed to initialize SDL: %s\n", SDL_GetError());
         goto fail_sdl;
     }
@@ -436,7 +599,12 @@ static bool engine_init(void)
         extra_flags = setting.as_bool ? SDL_WINDOW_ALWAYS_ON_TOP : 0;
     }
 
-    R_InitAttributes();
+    Uint32 win_flags = SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN | wf | extra_flags;
+    if(s_headless) {
+        win_flags = SDL_WINDOW_HIDDEN;
+    }else{
+        R_InitAttributes();
+    }
 
     char appname[64] = "Permafrost Engine";
     Engine_GetArg("appname", sizeof(appname), appname);
@@ -446,13 +614,20 @@ static bool engine_init(void)
         SDL_WINDOWPOS_UNDEFINED,
         res[0], 
         res[1], 
-        SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN | wf | extra_flags);
+        win_flags);
+
+    if(!s_window) {
+        fprintf(stderr, "Failed to create window: %s\n", SDL_GetError());
+        goto fail_window;
+    }
 
     LoadingScreen_Init();
-    engine_set_icon();
     stbi_set_flip_vertically_on_load(true);
 
-    LoadingScreen_DrawEarly(s_window);
+    if(!s_headless) {
+        engine_set_icon();
+        LoadingScreen_DrawEarly(s_window);
+    }
 
     if(!rstate_init(&s_rstate)) {
         fprintf(stderr, "Failed to initialize the render sync state.\n");
@@ -465,29 +640,38 @@ static bool engine_init(void)
         .in_height = res[1],
     };
 
-    s_rstate.arg = &rarg;
-    s_render_thread = R_Run(&s_rstate);
+    if(!s_headless) {
 
-    if(!s_render_thread) {
-        fprintf(stderr, "Failed to start the render thread.\n");
-        goto fail_rthread;
-    }
+        s_rstate.arg = &rarg;
+        s_render_thread = R_Run(&s_rstate);
 
-    render_thread_start_work();
-    render_thread_wait_done();
-    render_maybe_enable();
+        if(!s_render_thread) {
+            fprintf(stderr, "Failed to start the render thread.\n");
+            goto fail_rthread;
+        }
+
+        render_thread_start_work();
+        render_thread_wait_done();
+        render_maybe_enable();
 
-    if(!rarg.out_success)
-        goto fail_render_init;
+        if(!rarg.out_success)
+            goto fail_render_init;
+    }
 
     Perf_RegisterThread(g_main_thread_id, "main");
-    Perf_RegisterThread(g_render_thread_id, "render");
+    if(!s_headless) {
+        Perf_RegisterThread(g_render_thread_id, "render");
+    }
 
     if(!Sched_Init()) {
         fprintf(stderr, "Failed to initialize scheduling module.\n");
         goto fail_sched;
     }
 
+    if(s_headless && s_tick_hz > 0) {
+        Sched_SetTickBudget(1000.0f / s_tick_hz);
+    }
+
     if(!Session_Init()) {
         fprintf(stderr, "Failed to initialize session module.\n");
         goto fail_sesh;
@@ -605,6 +789,7 @@ fail_rthread:
 fail_rstate:
     LoadingScreen_Shutdown();
     SDL_DestroyWindow(s_window);
+fail_window:
     SDL_Quit();
 fail_sdl:
     Settings_Shutdown();
@@ -723,7 +908,7 @@ void Engine_SetRenderThreadID(SDL_threadID id)
 void Engine_WaitRenderWorkDone(void)
 {
     PERF_ENTER();
-    if(s_quit) {
+    if(s_quit || s_headless) {
         PERF_RETURN_VOID();
     }
 
@@ -754,6 +939,17 @@ bool Engine_InRunningState(void)
     return (s_state == ENGINE_STATE_RUNNING);
 }
 
+bool Engine_Headless(void)
+{
+    return s_headless;
+}
+
+void Engine_Quit(int exit_code)
+{
+    s_exit_code = exit_code;
+    s_quit = true;
+}
+
 bool Engine_GetArg(const char *name, size_t maxout, char out[])
 {
     size_t namelen = strlen(name);
@@ -788,7 +984,9 @@ int main(int argc, char **argv)
     int ret = EXIT_SUCCESS;
 
     if(argc < 3) {
-        printf("Usage: %s [base directory path (containing 'assets', 'shaders' and 'scripts' folders)] [script path]\n", argv[0]);
+        printf("Usage: %s [base directory path (containing 'assets', 'shaders' and 'scripts' folders)] [script path] "
+            "[--headless [--tick_hz=N]] [--deterministic] [--seed=N] [--record=PATH | --replay=PATH]\n", 
+            argv[0]);
         ret = EXIT_FAILURE;
         goto fail_args;
     }
@@ -796,12 +994,18 @@ int main(int argc, char **argv)
     g_basepath = argv[1];
     s_argc = argc;
     s_argv = argv;
+    engine_parse_headless_args();
 
     if(!engine_init()) {
         ret = EXIT_FAILURE; 
         goto fail_init;
     }
 
+    if(!engine_init_determinism()) {
+        ret = EXIT_FAILURE;
+        goto fail_determinism;
+    }
+
     Audio_PlayMusicFirst();
     LoadingScreen_SetStatusText("Interpreting script: %s", argv[2]);
     S_RunFileAsync(argv[2], 0, NULL, &s_request_done);
@@ -810,7 +1014,7 @@ int main(int argc, char **argv)
 
     /* Run the first frame of the simulation, and prepare the buffers for rendering. */
     G_Update();
-    G_Render();
+    engine_render();
     G_SwapBuffers();
 
     while(!s_quit) {
@@ -824,7 +1028,7 @@ int main(int argc, char **argv)
             G_SetSimState(G_RUNNING);
         }
 
-        if(s_state != ENGINE_STATE_RUNNING) {
+        if(s_state != ENGINE_STATE_RUNNING && !s_headless) {
             LoadingScreen_Tick();
         }
 
@@ -841,10 +1045,11 @@ int main(int argc, char **argv)
         case ENGINE_STATE_RUNNING:
 
             process_sdl_events();
+            G_Timer_Step();
             E_ServiceQueue();
 
             G_Update();
-            G_Render();
+            engine_render();
             Sched_Tick();
 
             render_status = render_thread_wait_done();
@@ -886,14 +1091,21 @@ int main(int argc, char **argv)
             s_step_frame = false;
         }
         ++g_frame_idx;
+
+        if(s_headless) {
+            headless_wait_next_tick();
+        }
     }
 
+    ret = s_exit_code;
+
     ss_e status;
     if((status = Settings_SaveToFile()) != SS_OKAY) {
         fprintf(stderr, "Could not save settings to file: %s [status: %d]\n", 
             Settings_GetFile(), status);
     }
 
+fail_determinism:
     engine_shutdown();
 fail_init:
 fail_args:
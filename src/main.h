@@ -80,6 +80,14 @@ void Engine_WaitRenderWorkDone(void);
 void Engine_ClearPendingEvents(void);
 bool Engine_GetArg(const char *name, size_t maxout, char out[]);
 bool Engine_InRunningState(void);
+/* True when running with the '--headless' flag: the simulation runs without 
+ * a GL context, render thread or audio output, and nothing is presented. 
+ */
+bool Engine_Headless(void);
+/* Exit the main loop at the end of the current frame. The process will 
+ * exit with the specified status. 
+ */
+void Engine_Quit(int exit_code);
 
 /* Present the window (from render thread only).
  */
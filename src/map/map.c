@@ -567,12 +567,34 @@ void M_NavUpdateIslandsField(const struct map *map)
     N_UpdateIslandsField(map->nav_private);
 }
 
+uint64_t M_NavBakeKey(const struct map *map)
+{
+    return N_BakeKey(map->nav_private);
+}
+
+bool M_NavLoadBake(const struct map *map, uint64_t key)
+{
+    return N_LoadBake(map->nav_private, key);
+}
+
+bool M_NavStoreBake(const struct map *map, uint64_t key)
+{
+    return N_StoreBake(map->nav_private, key);
+}
+
 bool M_NavRequestPath(const struct map *map, vec2_t xz_src, vec2_t xz_dest, 
                       enum nav_layer layer, dest_id_t *out_dest_id)
 {
     return N_RequestPath(map->nav_private, xz_src, xz_dest, map->pos, layer, out_dest_id);
 }
 
+size_t M_NavRequestPathsBatch(const struct map *map, dest_id_t id, vec2_t xz_dest, 
+                              const vec2_t *xz_srcs, size_t nsrcs, bool *out_found)
+{
+    return N_RequestPathsBatch(map->nav_private, id, xz_dest, xz_srcs, nsrcs, 
+                               map->pos, out_found);
+}
+
 void M_NavRenderVisiblePathFlowField(const struct map *map, const struct camera *cam, 
                                      dest_id_t id)
 {
@@ -1125,6 +1147,11 @@ void M_NavInvalidateZoneFieldsAt(const struct map *map, vec2_t xz_pos, enum nav_
     N_InvalidateZoneFieldsAt(map->nav_private, map->pos, xz_pos, layer);
 }
 
+void M_NavApplyDeferredInvalidations(const struct map *map)
+{
+    N_ApplyDeferredInvalidations(map->nav_private);
+}
+
 void M_NavCopyIslandsFieldView(const struct map *map, vec2_t center,
                                int nrows, int ncols, enum nav_layer layer, uint16_t *out_field)
 {
@@ -367,6 +367,18 @@ void   M_NavUpdatePortals(const struct map *map);
  */
 void   M_NavUpdateIslandsField(const struct map *map);
 
+/* ------------------------------------------------------------------------
+ * The portals and islands baked from the cost field (including any static
+ * cutouts) are persisted in the asset cache, keyed by the hash returned 
+ * from M_NavBakeKey. Loading one takes the place of M_NavUpdatePortals 
+ * and M_NavUpdateIslandsField. Load returns false if there's no valid 
+ * entry for the key.
+ * ------------------------------------------------------------------------
+ */
+uint64_t M_NavBakeKey(const struct map *map);
+bool   M_NavLoadBake(const struct map *map, uint64_t key);
+bool   M_NavStoreBake(const struct map *map, uint64_t key);
+
 /* ------------------------------------------------------------------------
  * Makes a path request to the navigation subsystem, causing the required
  * flowfields to be generated and cached. Returns true if a successful path
@@ -376,6 +388,15 @@ void   M_NavUpdateIslandsField(const struct map *map);
 bool   M_NavRequestPath(const struct map *map, vec2_t xz_src, vec2_t xz_dest, 
                         enum nav_layer layer, dest_id_t *out_dest_id);
 
+/* ------------------------------------------------------------------------
+ * Generates and caches the flowfields for an existing destination from 
+ * many source positions at once, searching only once per distinct source 
+ * chunk and island. Returns the number of sources that have a path.
+ * ------------------------------------------------------------------------
+ */
+size_t M_NavRequestPathsBatch(const struct map *map, dest_id_t id, vec2_t xz_dest, 
+                              const vec2_t *xz_srcs, size_t nsrcs, bool *out_found);
+
 /* ------------------------------------------------------------------------
  * Render the flow field that will steer entities towards a particular 
  * destination over the map surface.
@@ -621,6 +642,7 @@ void M_NavRequestAsyncSurroundField(const struct map *map, enum nav_layer layer,
 void M_NavRequestAsyncGroupArrivalField(const struct map *map, enum nav_layer layer,
                                         vec2_t centre_pos, uint16_t radius);
 void M_NavInvalidateZoneFieldsAt(const struct map *map, vec2_t xz_pos, enum nav_layer layer);
+void M_NavApplyDeferredInvalidations(const struct map *map);
 
 /* ------------------------------------------------------------------------
  * Returns true if the tiles under the entity selection cirlce overlap or 
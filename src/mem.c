@@ -474,12 +474,14 @@ const char *Mem_SubName(uint16_t sys, uint16_t sub)
         [MEM_SUB_GAME_FORMATION]    = "formation",
         [MEM_SUB_GAME_GARRISON]     = "garrison",
         [MEM_SUB_GAME_HARVESTER]    = "harvester",
+        [MEM_SUB_GAME_JOURNAL]      = "journal",
         [MEM_SUB_GAME_MOVEMENT]     = "movement",
         [MEM_SUB_GAME_POPULATION]   = "population",
         [MEM_SUB_GAME_POSITION]     = "position",
         [MEM_SUB_GAME_REGION]       = "region",
         [MEM_SUB_GAME_RESOURCE]     = "resource",
         [MEM_SUB_GAME_SELECTION]    = "selection",
+        [MEM_SUB_GAME_SNAPSHOT]     = "snapshot",
         [MEM_SUB_GAME_STORAGE_SITE] = "storage_site",
         [MEM_SUB_GAME_TIMER_EVENTS] = "timer_events",
     };
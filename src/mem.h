@@ -117,12 +117,14 @@ enum mem_sub_game{
     MEM_SUB_GAME_FORMATION,
     MEM_SUB_GAME_GARRISON,
     MEM_SUB_GAME_HARVESTER,
+    MEM_SUB_GAME_JOURNAL,
     MEM_SUB_GAME_MOVEMENT,
     MEM_SUB_GAME_POPULATION,
     MEM_SUB_GAME_POSITION,
     MEM_SUB_GAME_REGION,
     MEM_SUB_GAME_RESOURCE,
     MEM_SUB_GAME_SELECTION,
+    MEM_SUB_GAME_SNAPSHOT,
     MEM_SUB_GAME_STORAGE_SITE,
     MEM_SUB_GAME_TIMER_EVENTS
 };
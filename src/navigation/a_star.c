@@ -81,6 +81,12 @@ KHASH_MAP_INIT_INT64(key_float, float)
         kh_value(table, k) = val;                       \
     }while(0)
 
+/*****************************************************************************/
+/* STATIC VARIABLES                                                          */
+/*****************************************************************************/
+
+static SDL_atomic_t s_portal_heuristic = {1};
+
 /*****************************************************************************/
 /* STATIC FUNCTIONS                                                          */
 /*****************************************************************************/
@@ -217,24 +223,25 @@ static int neighbours_portal_graph(const struct nav_private *priv, enum nav_laye
     int ret = 0;
     const struct nav_chunk *chunk = 
         &priv->chunks[layer][portal->chunk.r * priv->width + portal->chunk.c];
+    const float *dists = chunk->portal_dists[portal - chunk->portals];
 
-    for(int i = 0; i < portal->num_neighbours; i++) {
+    for(int i = 0; i < chunk->num_portals; i++) {
 
         if(ret == maxout)
             return ret;
 
-        const struct edge *edge = &portal->edges[i];
-        if(edge->es == EDGE_STATE_BLOCKED)
+        /* No unblocked path to this portal inside the chunk */
+        if(dists[i] == FLT_MAX)
             continue;
 
         /* If the portal is not reachable from our source local island, then 
          * we can't use it 
          */
-        if(!portal_reachable_from_island(chunk, n_portal(priv, layer, edge->neighbour), liid))
+        if(!portal_reachable_from_island(chunk, &chunk->portals[i], liid))
             continue;
 
-        out_neighbours[ret] = n_portal(priv, layer, edge->neighbour);
-        out_costs[ret] = edge->cost;
+        out_neighbours[ret] = &chunk->portals[i];
+        out_costs[ret] = dists[i];
         out_enter_liids[ret] = liid;
         ret++;
     }
@@ -287,6 +294,281 @@ static float heuristic(struct coord a, struct coord b)
     return D * (dx + dy) + (D2 - 2 * D) * MIN(dx, dy);
 }
 
+static bool grid_passable(const uint8_t cost_field[FIELD_RES_R][FIELD_RES_C], int r, int c)
+{
+    return (r >= 0 && r < FIELD_RES_R)
+        && (c >= 0 && c < FIELD_RES_C)
+        && (cost_field[r][c] != COST_IMPASSABLE);
+}
+
+/* Mirrors the rules of 'neighbours_grid': a diagonal step may cut a corner, 
+ * but may not squeeze between two impassable tiles. 
+ */
+static bool grid_can_step(const uint8_t cost_field[FIELD_RES_R][FIELD_RES_C], 
+                          struct coord from, int dr, int dc)
+{
+    if(!grid_passable(cost_field, from.r + dr, from.c + dc))
+        return false;
+    if(dr == 0 || dc == 0)
+        return true;
+    return grid_passable(cost_field, from.r + dr, from.c)
+        || grid_passable(cost_field, from.r, from.c + dc);
+}
+
+/* Jump point search is only optimal when every step costs the same, so it 
+ * is used only on fields where all the passable tiles share a single cost.
+ */
+static bool grid_uniform_cost(const uint8_t cost_field[FIELD_RES_R][FIELD_RES_C], 
+                              uint8_t *out_cost)
+{
+    uint8_t cost = COST_IMPASSABLE;
+    for(int r = 0; r < FIELD_RES_R; r++) {
+    for(int c = 0; c < FIELD_RES_C; c++) {
+
+        uint8_t curr = cost_field[r][c];
+        if(curr == COST_IMPASSABLE)
+            continue;
+        if(cost == COST_IMPASSABLE)
+            cost = curr;
+        if(curr != cost)
+            return false;
+    }}
+    *out_cost = cost;
+    return true;
+}
+
+/* A tile has a 'forced' neighbour when an obstacle next to it means that the
+ * optimal path to that neighbour must pass through the tile itself.
+ */
+static bool jps_has_forced(const uint8_t cost_field[FIELD_RES_R][FIELD_RES_C], 
+                           struct coord n, int dr, int dc)
+{
+    if(dr == 0) {
+        for(int side = -1; side <= 1; side += 2) {
+            if(!grid_passable(cost_field, n.r + side, n.c) 
+            && grid_can_step(cost_field, n, side, dc))
+                return true;
+        }
+        return false;
+    }
+    if(dc == 0) {
+        for(int side = -1; side <= 1; side += 2) {
+            if(!grid_passable(cost_field, n.r, n.c + side) 
+            && grid_can_step(cost_field, n, dr, side))
+                return true;
+        }
+        return false;
+    }
+    return (!grid_passable(cost_field, n.r, n.c - dc) && grid_can_step(cost_field, n, dr, -dc))
+        || (!grid_passable(cost_field, n.r - dr, n.c) && grid_can_step(cost_field, n, -dr, dc));
+}
+
+/* Step from 'from' in the direction (dr, dc) until reaching the goal, a tile 
+ * with a forced neighbour or (when moving diagonally) a tile from which a 
+ * straight jump reaches such a tile. All the tiles skipped over need never 
+ * be expanded.
+ */
+static bool jps_jump(const uint8_t cost_field[FIELD_RES_R][FIELD_RES_C], struct coord from, 
+                     int dr, int dc, struct coord finish, struct coord *out)
+{
+    struct coord curr = from;
+    while(grid_can_step(cost_field, curr, dr, dc)) {
+
+        curr = (struct coord){curr.r + dr, curr.c + dc};
+
+        if(curr.r == finish.r && curr.c == finish.c)
+            goto found;
+        if(jps_has_forced(cost_field, curr, dr, dc))
+            goto found;
+
+        struct coord jp;
+        if(dr != 0 && dc != 0
+        && (jps_jump(cost_field, curr, dr, 0, finish, &jp) 
+         || jps_jump(cost_field, curr, 0, dc, finish, &jp)))
+            goto found;
+    }
+    return false;
+
+found:
+    *out = curr;
+    return true;
+}
+
+static int sign(int val)
+{
+    return (val > 0) - (val < 0);
+}
+
+static int jps_successors(const uint8_t cost_field[FIELD_RES_R][FIELD_RES_C], 
+                          struct coord curr, const struct coord *parent, struct coord finish,
+                          struct coord out_succ[static 8])
+{
+    int dirs[8][2];
+    int ndirs = 0;
+
+    if(!parent) {
+        for(int dr = -1; dr <= 1; dr++) {
+        for(int dc = -1; dc <= 1; dc++) {
+            if(dr == 0 && dc == 0)
+                continue;
+            dirs[ndirs][0] = dr;
+            dirs[ndirs][1] = dc;
+            ndirs++;
+        }}
+    }else{
+
+        int dr = sign(curr.r - parent->r);
+        int dc = sign(curr.c - parent->c);
+
+        /* Prune the neighbours that are reached at least as cheaply without 
+         * passing through 'curr', keeping the natural and forced ones. */
+        if(dr != 0 && dc != 0) {
+
+            dirs[ndirs][0] = dr; dirs[ndirs][1] = 0;  ndirs++;
+            dirs[ndirs][0] = 0;  dirs[ndirs][1] = dc; ndirs++;
+            dirs[ndirs][0] = dr; dirs[ndirs][1] = dc; ndirs++;
+
+            if(!grid_passable(cost_field, curr.r, curr.c - dc)) {
+                dirs[ndirs][0] = dr; dirs[ndirs][1] = -dc; ndirs++;
+            }
+            if(!grid_passable(cost_field, curr.r - dr, curr.c)) {
+                dirs[ndirs][0] = -dr; dirs[ndirs][1] = dc; ndirs++;
+            }
+        }else if(dr == 0) {
+
+            dirs[ndirs][0] = 0; dirs[ndirs][1] = dc; ndirs++;
+            for(int side = -1; side <= 1; side += 2) {
+                if(!grid_passable(cost_field, curr.r + side, curr.c)) {
+                    dirs[ndirs][0] = side; dirs[ndirs][1] = dc; ndirs++;
+                }
+            }
+        }else{
+
+            dirs[ndirs][0] = dr; dirs[ndirs][1] = 0; ndirs++;
+            for(int side = -1; side <= 1; side += 2) {
+                if(!grid_passable(cost_field, curr.r, curr.c + side)) {
+                    dirs[ndirs][0] = dr; dirs[ndirs][1] = side; ndirs++;
+                }
+            }
+        }
+    }
+
+    int ret = 0;
+    for(int i = 0; i < ndirs; i++) {
+        struct coord jp;
+        if(jps_jump(cost_field, curr, dirs[i][0], dirs[i][1], finish, &jp))
+            out_succ[ret++] = jp;
+    }
+    return ret;
+}
+
+/* Jump point search over a field where every passable tile costs 'cost'. Only 
+ * the jump points are ever added to the open set. The path is then filled in 
+ * between consecutive jump points, which always lie on a straight or diagonal 
+ * line. Returns false only if the search could not be carried out.
+ */
+static bool grid_path_jps(const uint8_t cost_field[FIELD_RES_R][FIELD_RES_C], uint8_t cost,
+                          struct coord start, struct coord finish, 
+                          vec_coord_t *out_path, float *out_cost, bool *out_exists)
+{
+    pq_coord_t          frontier;
+    khash_t(key_coord) *came_from;
+    khash_t(key_float) *running_cost;
+
+    pq_coord_init(&frontier);
+    if(NULL == (came_from = kh_init(key_coord)))
+        goto fail_came_from;
+    if(NULL == (running_cost = kh_init(key_float)))
+        goto fail_running_cost;
+
+    kh_put_val(key_float, running_cost, coord_to_key(start), 0.0f);
+    pq_coord_push(&frontier, 0.0f, start);
+
+    while(pq_size(&frontier) > 0) {
+
+        struct coord curr;
+        pq_coord_pop(&frontier, &curr);
+
+        if(0 == memcmp(&curr, &finish, sizeof(struct coord)))
+            break;
+
+        struct coord parent;
+        khiter_t k = kh_get(key_coord, came_from, coord_to_key(curr));
+        bool has_parent = (k != kh_end(came_from));
+        if(has_parent) {
+            parent = kh_value(came_from, k);
+        }
+
+        struct coord succ[8];
+        int nsucc = jps_successors(cost_field, curr, has_parent ? &parent : NULL, finish, succ);
+
+        k = kh_get(key_float, running_cost, coord_to_key(curr));
+        assert(k != kh_end(running_cost));
+        float curr_cost = kh_value(running_cost, k);
+
+        for(int i = 0; i < nsucc; i++) {
+
+            struct coord *next = &succ[i];
+            float new_cost = curr_cost + heuristic(curr, *next) * cost;
+
+            if((k = kh_get(key_float, running_cost, coord_to_key(*next))) == kh_end(running_cost)
+            || new_cost < kh_value(running_cost, k)) {
+
+                kh_put_val(key_float, running_cost, coord_to_key(*next), new_cost);
+                float priority = new_cost + heuristic(finish, *next);
+                pq_coord_push(&frontier, priority, *next);
+                kh_put_val(key_coord, came_from, coord_to_key(*next), curr);
+            }
+        }
+    }
+
+    *out_exists = (kh_get(key_coord, came_from, coord_to_key(finish)) != kh_end(came_from));
+    if(!*out_exists)
+        goto out;
+
+    vec_coord_reset(out_path);
+
+    /* Walk backwards from jump point to jump point, adding every tile in between */
+    struct coord curr = finish;
+    while(0 != memcmp(&curr, &start, sizeof(struct coord))) {
+
+        khiter_t k = kh_get(key_coord, came_from, coord_to_key(curr));
+        assert(k != kh_end(came_from));
+        struct coord prev = kh_value(came_from, k);
+
+        int dr = sign(prev.r - curr.r);
+        int dc = sign(prev.c - curr.c);
+        while(0 != memcmp(&curr, &prev, sizeof(struct coord))) {
+            vec_coord_push(out_path, curr);
+            curr = (struct coord){curr.r + dr, curr.c + dc};
+        }
+    }
+    vec_coord_push(out_path, start);
+
+    /* Reverse the path vector */
+    for(int i = 0, j = vec_size(out_path) - 1; i < j; i++, j--) {
+        struct coord tmp = vec_AT(out_path, i);
+        vec_AT(out_path, i) = vec_AT(out_path, j);
+        vec_AT(out_path, j) = tmp;
+    }
+
+    khiter_t k = kh_get(key_float, running_cost, coord_to_key(finish));
+    assert(k != kh_end(running_cost));
+    *out_cost = kh_value(running_cost, k);
+
+out:
+    pq_coord_destroy(&frontier);
+    kh_destroy(key_float, running_cost);
+    kh_destroy(key_coord, came_from);
+    return true;
+
+fail_running_cost:
+    kh_destroy(key_coord, came_from);
+fail_came_from:
+    pq_coord_destroy(&frontier);
+    return false;
+}
+
 /* Add a constant pentalty to every portal node on top of the existing 
  * cost of the edge between two portals. This will prioritize paths
  * with the fewest number of hops over paths with the shortest distance,
@@ -300,14 +582,37 @@ static float portal_node_penalty(void)
     return sqrt(pow(FIELD_RES_R, 2.0f) + pow(FIELD_RES_C, 2.0f));
 }
 
+/* A lower bound on the cost of reaching 'finish' from 'portal', taken from 
+ * the abstract graph of chunks. Every chunk boundary crossed on the way is 
+ * a hop between a pair of connected portals, costing 1 plus the node penalty,
+ * so the chunk distance between the two portals bounds the cost from below.
+ * The bound never drops by more than the cost of a hop, making it consistent:
+ * the first time the goal is taken off the frontier, its cost is optimal.
+ */
+static float portal_graph_heuristic(const struct portal *portal, const struct portal *finish)
+{
+    if(!SDL_AtomicGet(&s_portal_heuristic))
+        return 0.0f;
+
+    int dr = abs(portal->chunk.r - finish->chunk.r);
+    int dc = abs(portal->chunk.c - finish->chunk.c);
+    return (dr + dc) * (1.0f + portal_node_penalty());
+}
+
 /*****************************************************************************/
 /* EXTERN FUNCTIONS                                                          */
 /*****************************************************************************/
 
+void N_SetPortalGraphHeuristic(bool on)
+{
+    SDL_AtomicSet(&s_portal_heuristic, on);
+}
+
 bool AStar_GridPath(struct fieldcache_ctx *cache,
                     struct coord start, struct coord finish, struct coord chunk,
                     const uint8_t cost_field[FIELD_RES_R][FIELD_RES_C], 
-                    enum nav_layer layer, vec_coord_t *out_path, float *out_cost)
+                    enum nav_layer layer, enum grid_path_mode mode, 
+                    vec_coord_t *out_path, float *out_cost)
 {
     PERF_ENTER();
 
@@ -325,6 +630,24 @@ bool AStar_GridPath(struct fieldcache_ctx *cache,
         PERF_RETURN(true);
     }
 
+    uint8_t uniform_cost;
+    if(mode == GRID_PATH_JPS && grid_uniform_cost(cost_field, &uniform_cost)) {
+
+        bool exists;
+        if(!grid_path_jps(cost_field, uniform_cost, start, finish, out_path, out_cost, &exists))
+            PERF_RETURN(false);
+
+        gp.exists = exists;
+        if(exists) {
+            vec_coord_copy(&gp.path, out_path);
+            gp.cost = *out_cost;
+        }
+        if(cache) {
+            N_FC_PutGridPath(cache, start, finish, chunk, layer, &gp);
+        }
+        PERF_RETURN(exists);
+    }
+
     pq_coord_t          frontier;
     khash_t(key_coord) *came_from;
     khash_t(key_float) *running_cost;
@@ -466,7 +789,7 @@ bool AStar_PortalGraphPath(struct tile_desc start_tile, struct tile_desc end_til
 
                 struct portal_hop hop = (struct portal_hop){port, start_liid};
                 kh_put_val(key_float, running_cost, phop_to_key(&hop), cost);
-                pq_portal_push(&frontier, cost, hop);
+                pq_portal_push(&frontier, cost + portal_graph_heuristic(port, finish), hop);
             }
         }
     }
@@ -499,8 +822,7 @@ bool AStar_PortalGraphPath(struct tile_desc start_tile, struct tile_desc end_til
             || new_cost < kh_value(running_cost, k)) {
 
                 kh_put_val(key_float, running_cost, phop_to_key(&next_hop), new_cost);
-                /* No heuristic used - effectively Dijkstra's algorithm */
-                float priority = new_cost;
+                float priority = new_cost + portal_graph_heuristic(next, finish);
                 pq_portal_push(&frontier, priority, next_hop);
                 kh_put_val(key_portal, came_from, phop_to_key(&next_hop), curr);
             }
@@ -107,6 +107,14 @@ VEC_TYPE(portal, struct portal_hop)
 VEC_IMPL(static inline, portal, struct portal_hop)
 
 
+enum grid_path_mode{
+    /* Expand every tile through its neighbours */
+    GRID_PATH_ASTAR,
+    /* Expand only jump points when all passable tiles of the field have the 
+     * same cost, falling back to GRID_PATH_ASTAR for weighted fields. */
+    GRID_PATH_JPS,
+};
+
 /* ------------------------------------------------------------------------
  * Finds the shortest path in a rectangular cost field. Returns true if a 
  * path is found, false otherwise. If returning true, 'out_path' holds the
@@ -116,7 +124,8 @@ VEC_IMPL(static inline, portal, struct portal_hop)
 bool AStar_GridPath(struct fieldcache_ctx *cache,
                     struct coord start, struct coord finish, struct coord chunk,
                     const uint8_t cost_field[FIELD_RES_R][FIELD_RES_C], 
-                    enum nav_layer layer, vec_coord_t *out_path, float *out_cost);
+                    enum nav_layer layer, enum grid_path_mode mode, 
+                    vec_coord_t *out_path, float *out_cost);
 
 /* ------------------------------------------------------------------------
  * Finds the shortest path between a tile and a node in a portal graph. Returns 
@@ -64,6 +64,9 @@
 #define MAX_ENTS_PER_CHUNK  (4096)
 #define SEARCH_BUFFER       (16.0f)
 #define IDX(r, width, c)    ((r) * (width) + (c))
+/* Must be greater than the largest tile cost */
+#define BQ_NBUCKETS         (256)
+#define BQ_NIL              (0xffff)
 
 PQUEUE_TYPE(coord, struct coord)
 PQUEUE_IMPL(static, coord, struct coord)
@@ -86,6 +89,29 @@ struct region{
     size_t r, c;
 };
 
+/* A Dial's algorithm bucket queue for integer-cost Dijkstra over a single 
+ * chunk. Since all edge costs are less than BQ_NBUCKETS, all the queued 
+ * costs always fall within a window of BQ_NBUCKETS of the current minimum, 
+ * so the buckets can be indexed circularly by (cost % BQ_NBUCKETS). Every 
+ * tile is in at most one bucket, which is kept as an intrusive doubly-linked 
+ * list, so lowering a tile's cost is an O(1) move between buckets. 
+ */
+struct bucket_queue{
+    uint16_t head[BQ_NBUCKETS];
+    uint16_t next[FIELD_RES_R * FIELD_RES_C];
+    uint16_t prev[FIELD_RES_R * FIELD_RES_C];
+    uint32_t cost[FIELD_RES_R * FIELD_RES_C];
+    bool     queued[FIELD_RES_R * FIELD_RES_C];
+    size_t   size;
+    uint32_t cursor;
+};
+
+/*****************************************************************************/
+/* STATIC VARIABLES                                                          */
+/*****************************************************************************/
+
+static SDL_atomic_t s_bucket_integration = {1};
+
 /*****************************************************************************/
 /* STATIC FUNCTIONS                                                          */
 /*****************************************************************************/
@@ -330,7 +356,7 @@ static int field_neighbours_grid_los(
             continue;
         if((r == c) || (r == -c)) /* diag */
             continue;
-        if(los->field[abs_r][abs_c].wavefront_blocked)
+        if(N_LOSWavefrontBlocked(los, abs_r, abs_c))
             continue;
 
         out_neighbours[ret] = (struct coord){abs_r, abs_c};
@@ -501,7 +527,7 @@ static void field_create_wavefront_blocked_line(
     struct coord curr = (struct coord){corner.tile_r, corner.tile_c};
     do {
 
-        out_los->field[curr.r][curr.c].wavefront_blocked = 1;
+        N_LOSSetWavefrontBlocked(out_los, curr.r, curr.c, true);
 
         e2 = 2 * err;
         if(e2 >= dy) {
@@ -521,7 +547,7 @@ static void field_pad_wavefront(struct LOS_field *out_los)
     for(int r = 0; r < FIELD_RES_R; r++) {
     for(int c = 0; c < FIELD_RES_C; c++) {
 
-        if(out_los->field[r][c].wavefront_blocked) {
+        if(N_LOSWavefrontBlocked(out_los, r, c)) {
         
             for(int rr = r-1; rr <= r+1; rr++) {
             for(int cc = c-1; cc <= c+1; cc++) {
@@ -530,12 +556,129 @@ static void field_pad_wavefront(struct LOS_field *out_los)
                     continue;
                 if(cc < 0 || cc > FIELD_RES_C-1)
                     continue;
-                out_los->field[rr][cc].visible = 0;
+                N_LOSSetVisible(out_los, rr, cc, false);
             }}
         }
     }}
 }
 
+static void bq_init(struct bucket_queue *bq)
+{
+    memset(bq->head, 0xff, sizeof(bq->head));
+    memset(bq->queued, 0, sizeof(bq->queued));
+    bq->size = 0;
+    bq->cursor = 0;
+}
+
+static void bq_unlink(struct bucket_queue *bq, uint16_t idx)
+{
+    uint16_t *head = &bq->head[bq->cost[idx] % BQ_NBUCKETS];
+    if(bq->prev[idx] != BQ_NIL) {
+        bq->next[bq->prev[idx]] = bq->next[idx];
+    }else{
+        *head = bq->next[idx];
+    }
+    if(bq->next[idx] != BQ_NIL) {
+        bq->prev[bq->next[idx]] = bq->prev[idx];
+    }
+    bq->queued[idx] = false;
+    bq->size--;
+}
+
+static void bq_push(struct bucket_queue *bq, uint32_t cost, struct coord coord)
+{
+    uint16_t idx = IDX(coord.r, FIELD_RES_C, coord.c);
+    if(bq->queued[idx]) {
+        bq_unlink(bq, idx);
+    }
+
+    uint16_t *head = &bq->head[cost % BQ_NBUCKETS];
+    bq->cost[idx] = cost;
+    bq->prev[idx] = BQ_NIL;
+    bq->next[idx] = *head;
+    if(*head != BQ_NIL) {
+        bq->prev[*head] = idx;
+    }
+    *head = idx;
+    bq->queued[idx] = true;
+    bq->size++;
+}
+
+static struct coord bq_pop(struct bucket_queue *bq)
+{
+    assert(bq->size > 0);
+    while(bq->head[bq->cursor % BQ_NBUCKETS] == BQ_NIL) {
+        bq->cursor++;
+    }
+    uint16_t idx = bq->head[bq->cursor % BQ_NBUCKETS];
+    bq_unlink(bq, idx);
+    return (struct coord){idx / FIELD_RES_C, idx % FIELD_RES_C};
+}
+
+/* Integer-cost equivalent of the binary heap Dijkstra in 'field_build_integration' 
+ * and 'field_build_integration_nonpass'. Shortest path costs are unique, so the 
+ * resulting integration field (and thus the flow field) is identical. Returns 
+ * false, leaving the frontier untouched, when the frontier costs cannot be 
+ * represented in the bucket queue.
+ */
+static bool field_build_integration_bucket(
+    pq_coord_t                *frontier, 
+    const struct nav_chunk    *chunk, 
+    bool                       nonpass,
+    int                        faction_id, 
+    struct nav_unit_query_ctx *ctx,
+    float                      inout[FIELD_RES_R][FIELD_RES_C])
+{
+    struct coord curr;
+    float min_cost = INFINITY, max_cost = 0.0f;
+
+    pq_foreach(frontier, curr, {
+        float cost = inout[curr.r][curr.c];
+        if(cost != floorf(cost) || cost < 0.0f)
+            return false;
+        min_cost = MIN(min_cost, cost);
+        max_cost = MAX(max_cost, cost);
+    });
+    if(max_cost - min_cost >= BQ_NBUCKETS)
+        return false;
+
+    struct bucket_queue bq;
+    bq_init(&bq);
+
+    while(pq_size(frontier) > 0) {
+        pq_coord_pop(frontier, &curr);
+        bq_push(&bq, inout[curr.r][curr.c], curr);
+    }
+    if(bq.size == 0)
+        return true;
+    bq.cursor = min_cost;
+
+    while(bq.size > 0) {
+
+        curr = bq_pop(&bq);
+        uint32_t curr_cost = inout[curr.r][curr.c];
+
+        struct coord neighbours[8];
+        uint8_t neighbour_costs[8];
+        int num_neighbours = field_neighbours_grid(chunk, curr, !nonpass, faction_id, 
+            ctx, neighbours, neighbour_costs);
+
+        for(int i = 0; i < num_neighbours; i++) {
+
+            if(nonpass && field_tile_passable(chunk, neighbours[i]))
+                continue;
+
+            uint32_t total_cost = curr_cost + neighbour_costs[i];
+            if(total_cost < inout[neighbours[i].r][neighbours[i].c]) {
+
+                inout[neighbours[i].r][neighbours[i].c] = total_cost;
+                bq_push(&bq, total_cost, neighbours[i]);
+            }
+        }
+    }
+    return true;
+}
+
 static void field_build_integration(
     pq_coord_t                *frontier, 
     const struct nav_chunk    *chunk, 
@@ -543,6 +686,10 @@ static void field_build_integration(
     struct nav_unit_query_ctx *ctx,
     float                      inout[FIELD_RES_R][FIELD_RES_C])
 {
+    if(SDL_AtomicGet(&s_bucket_integration)
+    && field_build_integration_bucket(frontier, chunk, false, faction_id, ctx, inout))
+        return;
+
     while(pq_size(frontier) > 0) {
 
         struct coord curr;
@@ -647,6 +794,10 @@ static void field_build_integration_nonpass(
     struct nav_unit_query_ctx *ctx,
     float                      inout[FIELD_RES_R][FIELD_RES_C])
 {
+    if(SDL_AtomicGet(&s_bucket_integration)
+    && field_build_integration_bucket(frontier, chunk, true, faction_id, ctx, inout))
+        return;
+
     while(pq_size(frontier) > 0) {
 
         struct coord curr;
@@ -746,12 +897,12 @@ static void field_build_flow(float intf[FIELD_RES_R][FIELD_RES_C], struct flow_f
 
         if(intf[r][c] == 0.0f) {
 
-            inout_flow->field[r][c].dir_idx = FD_NONE;
+            N_FlowDirSet(inout_flow, r, c, FD_NONE);
             continue;
         }
 
-        inout_flow->field[r][c].dir_idx = field_flow_dir(FIELD_RES_R, FIELD_RES_C, 
-            (const float*)intf, (struct coord){r, c});
+        N_FlowDirSet(inout_flow, r, c, field_flow_dir(FIELD_RES_R, FIELD_RES_C, 
+            (const float*)intf, (struct coord){r, c}));
     }}
 }
 
@@ -778,12 +929,12 @@ static void field_build_flow_region(
 
         if(intf[infr * rdim + infc] == 0.0f) {
 
-            inout_flow->field[r][c].dir_idx = FD_NONE;
+            N_FlowDirSet(inout_flow, r, c, FD_NONE);
             continue;
         }
 
-        inout_flow->field[r][c].dir_idx = field_flow_dir(rdim ,cdim, 
-            intf, (struct coord){infr, infc});
+        N_FlowDirSet(inout_flow, r, c, field_flow_dir(rdim ,cdim, 
+            intf, (struct coord){infr, infc}));
     }}
 }
 
@@ -847,13 +998,13 @@ static void field_fixup_portal_edges(
         if(intf[r][c] == 0.0f) {
 
             if(up)
-                inout_flow->field[r][c].dir_idx = FD_N;
+                N_FlowDirSet(inout_flow, r, c, FD_N);
             else if(down)
-                inout_flow->field[r][c].dir_idx = FD_S;
+                N_FlowDirSet(inout_flow, r, c, FD_S);
             else if(left)
-                inout_flow->field[r][c].dir_idx = FD_W;
+                N_FlowDirSet(inout_flow, r, c, FD_W);
             else if(right)
-                inout_flow->field[r][c].dir_idx = FD_E;
+                N_FlowDirSet(inout_flow, r, c, FD_E);
             else
                 assert(0);
         }
@@ -1428,6 +1579,77 @@ static void field_fixup(
     }
 }
 
+static void field_effective_costs(
+    const struct nav_chunk    *chunk, 
+    int                        faction_id,
+    struct nav_unit_query_ctx *ctx,
+    uint8_t                    out[FIELD_RES_R][FIELD_RES_C])
+{
+    uint16_t enemies = enemies_for_faction(faction_id, ctx);
+    for(int r = 0; r < FIELD_RES_R; r++) {
+    for(int c = 0; c < FIELD_RES_C; c++) {
+
+        bool passable;
+        if(faction_id == FACTION_ID_NONE) {
+            passable = field_tile_passable(chunk, (struct coord){r, c});
+        }else{
+            passable = field_tile_passable_no_enemies(chunk, (struct coord){r, c}, enemies);
+        }
+        out[r][c] = passable ? chunk->cost_base[r][c] : COST_IMPASSABLE;
+    }}
+}
+
+static void field_update_target(
+    struct coord               chunk_coord, 
+    const struct nav_private  *priv, 
+    int                        faction_id,
+    enum nav_layer             layer, 
+    struct field_target        target, 
+    struct nav_unit_query_ctx *ctx,
+    struct flow_field         *inout_flow,
+    struct field_integration  *out_intf)
+{
+    const struct nav_chunk *chunk = &priv->chunks[layer][IDX(chunk_coord.r, priv->width, chunk_coord.c)];
+    pq_coord_t frontier;
+    pq_coord_init(&frontier);
+
+    float local_field[FIELD_RES_R][FIELD_RES_C];
+    float (*integration_field)[FIELD_RES_C] = out_intf ? out_intf->field : local_field;
+
+    for(int r = 0; r < FIELD_RES_R; r++) {
+    for(int c = 0; c < FIELD_RES_C; c++) {
+        integration_field[r][c] = INFINITY;
+    }}
+
+    struct coord init_frontier[FIELD_RES_R * FIELD_RES_C];
+    size_t ninit = field_initial_frontier(layer, target, chunk, priv, false, faction_id, 
+        ctx, init_frontier, ARR_SIZE(init_frontier));
+
+    for(int i = 0; i < ninit; i++) {
+
+        struct coord curr = init_frontier[i];
+        pq_coord_push(&frontier, 0.0f, curr); 
+        integration_field[curr.r][curr.c] = 0.0f;
+    }
+
+    inout_flow->target = target;
+    field_build_integration(&frontier, chunk, faction_id, ctx, integration_field);
+    field_build_flow(integration_field, inout_flow);
+    field_fixup(priv, layer, target, integration_field, inout_flow, chunk);
+
+    if(out_intf) {
+
+        out_intf->faction_id = faction_id;
+        memset(out_intf->target, 0, sizeof(out_intf->target));
+        for(int i = 0; i < ninit; i++) {
+            out_intf->target[init_frontier[i].r][init_frontier[i].c] = true;
+        }
+        field_effective_costs(chunk, faction_id, ctx, out_intf->cost);
+    }
+
+    pq_coord_destroy(&frontier);
+}
+
 static size_t visited_idx(struct map_resolution res, struct region region, struct tile_desc curr)
 {
     int dr, dc;
@@ -2022,7 +2244,7 @@ void N_FlowFieldInit(struct coord chunk_coord, struct flow_field *out)
     for(int r = 0; r < FIELD_RES_R; r++) {
     for(int c = 0; c < FIELD_RES_C; c++) {
 
-        out->field[r][c].dir_idx = FD_NONE;
+        N_FlowDirSet(out, r, c, FD_NONE);
     }}
     out->chunk = chunk_coord;
 }
@@ -2052,34 +2274,199 @@ void N_FlowFieldUpdate(
         PERF_RETURN_VOID();
     }
 
+    field_update_target(chunk_coord, priv, faction_id, layer, target, ctx, inout_flow, NULL);
+    PERF_RETURN_VOID();
+}
+
+bool N_FlowFieldBuild(
+    struct coord               chunk_coord, 
+    const struct nav_private  *priv, 
+    int                        faction_id,
+    enum nav_layer             layer, 
+    struct field_target        target, 
+    struct nav_unit_query_ctx *ctx,
+    struct flow_field         *out_flow,
+    struct field_integration  *out_intf)
+{
+    N_FlowFieldInit(chunk_coord, out_flow);
+
+    if(target.type != TARGET_PORTAL && target.type != TARGET_TILE) {
+        N_FlowFieldUpdate(chunk_coord, priv, faction_id, layer, target, ctx, out_flow);
+        return false;
+    }
+
+    PERF_ENTER();
+    field_update_target(chunk_coord, priv, faction_id, layer, target, ctx, out_flow, out_intf);
+    PERF_RETURN(true);
+}
+
+bool N_FlowFieldRepair(
+    const struct nav_private  *priv,
+    enum nav_layer             layer,
+    struct nav_unit_query_ctx *ctx,
+    struct flow_field         *inout_flow,
+    struct field_integration  *inout_intf)
+{
+    PERF_ENTER();
+
+    static const struct coord deltas[] = {{-1, 0}, {+1, 0}, {0, -1}, {0, +1}};
+    struct coord chunk_coord = inout_flow->chunk;
+    struct field_target target = inout_flow->target;
     const struct nav_chunk *chunk = &priv->chunks[layer][IDX(chunk_coord.r, priv->width, chunk_coord.c)];
+    float (*intf)[FIELD_RES_C] = inout_intf->field;
+
+    uint8_t cost[FIELD_RES_R][FIELD_RES_C];
+    field_effective_costs(chunk, inout_intf->faction_id, ctx, cost);
+    if(0 == memcmp(cost, inout_intf->cost, sizeof(cost)))
+        PERF_RETURN(true);
+
+    /* The repair keeps the original target tiles as the seeds. If the set of 
+     * target tiles is no longer the same, the field must be rebuilt. */
+    struct coord init_frontier[FIELD_RES_R * FIELD_RES_C];
+    size_t ninit = field_initial_frontier(layer, target, chunk, priv, false, 
+        inout_intf->faction_id, ctx, init_frontier, ARR_SIZE(init_frontier));
+
+    bool targets[FIELD_RES_R][FIELD_RES_C] = {0};
+    for(int i = 0; i < ninit; i++) {
+        targets[init_frontier[i].r][init_frontier[i].c] = true;
+    }
+    if(0 != memcmp(targets, inout_intf->target, sizeof(targets)))
+        PERF_RETURN(false);
+
+    /* Find all the tiles whose integration values may have depended on a tile 
+     * that became more expensive: the tiles themselves and, transitively, every 
+     * tile that had one of them as its cheapest predecessor. Their values are 
+     * discarded and re-derived from the remaining tiles. Since 'changed' is 
+     * consumed as a FIFO, the search is breadth-first. */
+    bool changed[FIELD_RES_R][FIELD_RES_C] = {0};
+    struct coord changed_list[FIELD_RES_R * FIELD_RES_C];
+    size_t nchanged = 0;
+
+    for(int r = 0; r < FIELD_RES_R; r++) {
+    for(int c = 0; c < FIELD_RES_C; c++) {
+
+        if(cost[r][c] <= inout_intf->cost[r][c])
+            continue;
+        if(intf[r][c] == INFINITY || inout_intf->target[r][c])
+            continue;
+        changed[r][c] = true;
+        changed_list[nchanged++] = (struct coord){r, c};
+    }}
+
+    for(int i = 0; i < nchanged; i++) {
+
+        struct coord curr = changed_list[i];
+        for(int j = 0; j < ARR_SIZE(deltas); j++) {
+
+            int r = curr.r + deltas[j].r;
+            int c = curr.c + deltas[j].c;
+            if(r < 0 || r >= FIELD_RES_R || c < 0 || c >= FIELD_RES_C)
+                continue;
+            if(changed[r][c] || inout_intf->target[r][c] || intf[r][c] == INFINITY)
+                continue;
+            if(intf[r][c] != intf[curr.r][curr.c] + inout_intf->cost[r][c])
+                continue;
+            changed[r][c] = true;
+            changed_list[nchanged++] = (struct coord){r, c};
+        }
+    }
+
+    size_t nraised = nchanged;
+    for(int i = 0; i < nraised; i++) {
+        intf[changed_list[i].r][changed_list[i].c] = INFINITY;
+    }
+
+    /* Seed the search with the discarded tiles and the tiles that became 
+     * cheaper, at the best value reachable from their neighbours. */
     pq_coord_t frontier;
     pq_coord_init(&frontier);
 
-    float integration_field[FIELD_RES_R][FIELD_RES_C];
     for(int r = 0; r < FIELD_RES_R; r++) {
     for(int c = 0; c < FIELD_RES_C; c++) {
-        integration_field[r][c] = INFINITY;
+
+        if(!changed[r][c] && cost[r][c] >= inout_intf->cost[r][c])
+            continue;
+        if(cost[r][c] == COST_IMPASSABLE)
+            continue;
+
+        float best = intf[r][c];
+        for(int j = 0; j < ARR_SIZE(deltas); j++) {
+
+            int nr = r + deltas[j].r;
+            int nc = c + deltas[j].c;
+            if(nr < 0 || nr >= FIELD_RES_R || nc < 0 || nc >= FIELD_RES_C)
+                continue;
+            best = MIN(best, intf[nr][nc] + cost[r][c]);
+        }
+        if(best >= intf[r][c])
+            continue;
+
+        intf[r][c] = best;
+        pq_coord_push(&frontier, best, (struct coord){r, c});
+        if(!changed[r][c]) {
+            changed[r][c] = true;
+            changed_list[nchanged++] = (struct coord){r, c};
+        }
     }}
 
-    struct coord init_frontier[FIELD_RES_R * FIELD_RES_C];
-    size_t ninit = field_initial_frontier(layer, target, chunk, priv, false, faction_id, 
-        ctx, init_frontier, ARR_SIZE(init_frontier));
+    while(pq_size(&frontier) > 0) {
 
-    for(int i = 0; i < ninit; i++) {
+        struct coord curr;
+        pq_coord_pop(&frontier, &curr);
 
-        struct coord curr = init_frontier[i];
-        pq_coord_push(&frontier, 0.0f, curr); 
-        integration_field[curr.r][curr.c] = 0.0f;
-    }
+        for(int j = 0; j < ARR_SIZE(deltas); j++) {
 
-    inout_flow->target = target;
-    field_build_integration(&frontier, chunk, faction_id, ctx, integration_field);
-    field_build_flow(integration_field, inout_flow);
-    field_fixup(priv, layer, target, integration_field, inout_flow, chunk);
+            int r = curr.r + deltas[j].r;
+            int c = curr.c + deltas[j].c;
+            if(r < 0 || r >= FIELD_RES_R || c < 0 || c >= FIELD_RES_C)
+                continue;
+            if(cost[r][c] == COST_IMPASSABLE)
+                continue;
+
+            float total_cost = intf[curr.r][curr.c] + cost[r][c];
+            if(total_cost >= intf[r][c])
+                continue;
 
+            intf[r][c] = total_cost;
+            pq_coord_push(&frontier, total_cost, (struct coord){r, c});
+            if(!changed[r][c]) {
+                changed[r][c] = true;
+                changed_list[nchanged++] = (struct coord){r, c};
+            }
+        }
+    }
     pq_coord_destroy(&frontier);
-    PERF_RETURN_VOID();
+
+    /* A tile's direction depends only on its own integration value and on 
+     * those of its 8 neighbours, so only the directions around the changed 
+     * tiles need to be re-derived. */
+    bool redirected[FIELD_RES_R][FIELD_RES_C] = {0};
+    for(int i = 0; i < nchanged; i++) {
+
+        struct coord curr = changed_list[i];
+        for(int dr = -1; dr <= 1; dr++) {
+        for(int dc = -1; dc <= 1; dc++) {
+
+            int r = curr.r + dr;
+            int c = curr.c + dc;
+            if(r < 0 || r >= FIELD_RES_R || c < 0 || c >= FIELD_RES_C)
+                continue;
+            if(redirected[r][c])
+                continue;
+            redirected[r][c] = true;
+
+            if(intf[r][c] == INFINITY || intf[r][c] == 0.0f) {
+                N_FlowDirSet(inout_flow, r, c, FD_NONE);
+                continue;
+            }
+            N_FlowDirSet(inout_flow, r, c, field_flow_dir(FIELD_RES_R, FIELD_RES_C, 
+                (const float*)intf, (struct coord){r, c}));
+        }}
+    }
+
+    field_fixup(priv, layer, target, intf, inout_flow, chunk);
+    memcpy(inout_intf->cost, cost, sizeof(cost));
+    PERF_RETURN(true);
 }
 
 void N_LOSFieldCreate(
@@ -2094,7 +2481,8 @@ void N_LOSFieldCreate(
 {
     int faction_id = N_DestFactionID(id);
     out_los->chunk = chunk_coord;
-    memset(out_los->field, 0x00, sizeof(out_los->field));
+    memset(out_los->visible, 0x00, sizeof(out_los->visible));
+    memset(out_los->wavefront_blocked, 0x00, sizeof(out_los->wavefront_blocked));
 
     pq_coord_t frontier;
     pq_coord_init(&frontier);
@@ -2158,8 +2546,11 @@ void N_LOSFieldCreate(
 
             for(int r = 0; r < FIELD_RES_R; r++) {
 
-                out_los->field[r][curr_edge_idx] = prev_los->field[r][prev_edge_idx];
-                if(out_los->field[r][curr_edge_idx].wavefront_blocked) {
+                N_LOSSetVisible(out_los, r, curr_edge_idx, 
+                    N_LOSVisible(prev_los, r, prev_edge_idx));
+                N_LOSSetWavefrontBlocked(out_los, r, curr_edge_idx, 
+                    N_LOSWavefrontBlocked(prev_los, r, prev_edge_idx));
+                if(N_LOSWavefrontBlocked(out_los, r, curr_edge_idx)) {
 
                     struct tile_desc src_desc = (struct tile_desc) {
                         chunk_coord.r, chunk_coord.c, 
@@ -2167,7 +2558,7 @@ void N_LOSFieldCreate(
                     };
                     field_create_wavefront_blocked_line(target, src_desc, priv, map_pos, out_los);
                 }
-                if(out_los->field[r][curr_edge_idx].visible) {
+                if(N_LOSVisible(out_los, r, curr_edge_idx)) {
 
                     pq_coord_push(&frontier, 0.0f, (struct coord){r, curr_edge_idx});
                     integration_field[r][curr_edge_idx] = 0.0f;
@@ -2177,8 +2568,11 @@ void N_LOSFieldCreate(
         
             for(int c = 0; c < FIELD_RES_C; c++) {
 
-                out_los->field[curr_edge_idx][c] = prev_los->field[prev_edge_idx][c];
-                if(out_los->field[curr_edge_idx][c].wavefront_blocked) {
+                N_LOSSetVisible(out_los, curr_edge_idx, c, 
+                    N_LOSVisible(prev_los, prev_edge_idx, c));
+                N_LOSSetWavefrontBlocked(out_los, curr_edge_idx, c, 
+                    N_LOSWavefrontBlocked(prev_los, prev_edge_idx, c));
+                if(N_LOSWavefrontBlocked(out_los, curr_edge_idx, c)) {
 
                     struct tile_desc src_desc = (struct tile_desc) {
                         chunk_coord.r, chunk_coord.c, 
@@ -2186,7 +2580,7 @@ void N_LOSFieldCreate(
                     };
                     field_create_wavefront_blocked_line(target, src_desc, priv, map_pos, out_los);
                 }
-                if(out_los->field[curr_edge_idx][c].visible) {
+                if(N_LOSVisible(out_los, curr_edge_idx, c)) {
 
                     pq_coord_push(&frontier, 0.0f, (struct coord){curr_edge_idx, c});
                     integration_field[curr_edge_idx][c] = 0.0f; 
@@ -2223,7 +2617,7 @@ void N_LOSFieldCreate(
             }else{
 
                 float new_cost = integration_field[curr.r][curr.c] + 1;
-                out_los->field[nr][nc].visible = 1;
+                N_LOSSetVisible(out_los, nr, nc, true);
 
                 if(new_cost < integration_field[neighbours[i].r][neighbours[i].c]) {
 
@@ -2297,8 +2691,8 @@ void N_FlowFieldUpdateToNearestPathable(
             continue;
         if(integration_field[r][c] == 0.0f)
             continue;
-        inout_flow->field[r][c].dir_idx = field_flow_dir(FIELD_RES_R, FIELD_RES_C, 
-            (const float*)integration_field, (struct coord){r, c});
+        N_FlowDirSet(inout_flow, r, c, field_flow_dir(FIELD_RES_R, FIELD_RES_C, 
+            (const float*)integration_field, (struct coord){r, c}));
     }}
 
     pq_coord_destroy(&frontier);
@@ -2426,6 +2820,11 @@ void N_FlowFieldUpdateIslandToNearest(
     pq_coord_destroy(&frontier);
 }
 
+void N_SetBucketIntegration(bool on)
+{
+    SDL_AtomicSet(&s_bucket_integration, on);
+}
+
 vec2_t N_FlowDir(enum flow_dir dir)
 {
     static vec2_t s_flow_dir_lookup[9] = {0};
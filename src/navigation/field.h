@@ -45,14 +45,40 @@
 typedef uint64_t ff_id_t;
 struct nav_private;
 
+#if FIELD_RES_C > 64
+#error "LOS field rows must fit in a single 64-bit word"
+#endif
+
+/* The LOS flags are bit-packed: bit 'c' of row 'r' holds the flag for tile 
+ * (r, c). Use the accessors below.
+ */
 struct LOS_field{
     struct coord chunk;
-    struct{
-        uint8_t visible : 1;
-        uint8_t wavefront_blocked : 1;
-    }field[FIELD_RES_R][FIELD_RES_C];
+    uint64_t     visible[FIELD_RES_R];
+    uint64_t     wavefront_blocked[FIELD_RES_R];
 };
 
+static inline bool N_LOSVisible(const struct LOS_field *lf, int r, int c)
+{
+    return (lf->visible[r] >> c) & 0x1;
+}
+
+static inline void N_LOSSetVisible(struct LOS_field *lf, int r, int c, bool on)
+{
+    lf->visible[r] = (lf->visible[r] & ~((uint64_t)1 << c)) | ((uint64_t)on << c);
+}
+
+static inline bool N_LOSWavefrontBlocked(const struct LOS_field *lf, int r, int c)
+{
+    return (lf->wavefront_blocked[r] >> c) & 0x1;
+}
+
+static inline void N_LOSSetWavefrontBlocked(struct LOS_field *lf, int r, int c, bool on)
+{
+    lf->wavefront_blocked[r] = (lf->wavefront_blocked[r] & ~((uint64_t)1 << c)) 
+                             | ((uint64_t)on << c);
+}
+
 struct enemies_desc{
     int          faction_id;
     vec3_t       map_pos;
@@ -100,12 +126,37 @@ struct field_target{
     };
 };
 
+/* The directions are packed two to a byte, with the even column of each 
+ * pair in the high nibble (as in the unaligned grid fields). Use the 
+ * accessors below.
+ */
 struct flow_field{
     struct coord chunk;
     struct field_target target;
-    struct{
-        uint8_t dir_idx : 4;
-    }field[FIELD_RES_R][FIELD_RES_C];
+    uint8_t field[FIELD_RES_R][FIELD_RES_C / 2];
+};
+
+static inline enum flow_dir N_FlowDirAt(const struct flow_field *ff, int r, int c)
+{
+    return (ff->field[r][c >> 1] >> ((~c & 0x1) << 2)) & 0xf;
+}
+
+static inline void N_FlowDirSet(struct flow_field *ff, int r, int c, enum flow_dir dir)
+{
+    int shift = (~c & 0x1) << 2;
+    ff->field[r][c >> 1] = (ff->field[r][c >> 1] & ~(0xf << shift)) | ((dir & 0xf) << shift);
+}
+
+/* The integration field that a flow field was derived from, along with the 
+ * target tiles and the effective tile costs (COST_IMPASSABLE for tiles that 
+ * were not passable for the faction) it was computed with. Retaining these allows the flow field 
+ * to be repaired locally when some of the chunk's costs change.
+ */
+struct field_integration{
+    int     faction_id;
+    bool    target[FIELD_RES_R][FIELD_RES_C];
+    uint8_t cost[FIELD_RES_R][FIELD_RES_C];
+    float   field[FIELD_RES_R][FIELD_RES_C];
 };
 
 /* ------------------------------------------------------------------------
@@ -151,6 +202,36 @@ void    N_FlowFieldUpdate(struct coord               chunk_coord,
                           struct nav_unit_query_ctx *ctx,
                           struct flow_field         *inout_flow);
 
+/* ------------------------------------------------------------------------
+ * Initialize and populate a flow field for a single target. For targets that
+ * support incremental repair (portal and tile targets), the integration field 
+ * is additionally written to 'out_intf' and true is returned.
+ * ------------------------------------------------------------------------
+ */
+bool    N_FlowFieldBuild(struct coord               chunk_coord, 
+                         const struct nav_private  *priv, 
+                         int                        faction_id,
+                         enum nav_layer             layer, 
+                         struct field_target        target, 
+                         struct nav_unit_query_ctx *ctx,
+                         struct flow_field         *out_flow,
+                         struct field_integration  *out_intf);
+
+/* ------------------------------------------------------------------------
+ * Bring a flow field previously made with 'N_FlowFieldBuild' up to date with
+ * the current tile costs of its chunk. Only the integration values which 
+ * depended on the changed tiles are recomputed, and only the directions of 
+ * the tiles around them are re-derived. Returns false if the field cannot be
+ * repaired in place (e.g. the target tiles themselves have changed), in 
+ * which case it must be rebuilt.
+ * ------------------------------------------------------------------------
+ */
+bool    N_FlowFieldRepair(const struct nav_private  *priv,
+                          enum nav_layer             layer,
+                          struct nav_unit_query_ctx *ctx,
+                          struct flow_field         *inout_flow,
+                          struct field_integration  *inout_intf);
+
 /* ------------------------------------------------------------------------
  * Update all tiles with a specific local island ID from the
  * 'local_islands' field for the chunk. The new directions will guide to
@@ -45,8 +45,10 @@
 #include "../event.h"
 #include "../sched.h"
 #include "../config.h"
+#include "../perf.h"
 
 #include <assert.h>
+#include <SDL.h>
 
 #undef PF_MALLOC
 #undef PF_CALLOC
@@ -55,6 +57,14 @@
 #define PF_CALLOC(_c, _n)   PF_CALLOC_TAGGED((_c), (_n), MEM_SYS_NAV, MEM_SUB_NAV_FIELDCACHE)
 #define PF_REALLOC(_p, _n)  PF_REALLOC_TAGGED((_p), (_n), MEM_SYS_NAV, MEM_SUB_NAV_FIELDCACHE)
 
+#define LOS_CACHE_ENTRIES   (CONFIG_LOS_CACHE_BYTES / sizeof(struct LOS_field))
+#define FLOW_CACHE_ENTRIES  (CONFIG_FLOW_CACHE_BYTES / sizeof(struct flow_field))
+/* One in this many newly added fields has its' eviction age tracked */
+#define EVICT_SAMPLE_PERIOD (8)
+/* At most this many invalidations are written to the trace per frame */
+#define TRACE_MAX_INVALS    (8)
+#define ARR_SIZE(a)         (sizeof(a)/sizeof(a[0]))
+#define LRU_TAIL_KEY(name, lru) (mp_##name##_entry(&(lru)->node_pool, (lru)->ilru_tail)->key)
 
 LRU_CACHE_TYPE(los, struct LOS_field)
 LRU_CACHE_PROTOTYPES(static, los, struct LOS_field)
@@ -64,6 +74,10 @@ LRU_CACHE_TYPE(flow, struct flow_field)
 LRU_CACHE_PROTOTYPES(static, flow, struct flow_field)
 LRU_CACHE_IMPL(static, flow, struct flow_field)
 
+LRU_CACHE_TYPE(intf, struct field_integration)
+LRU_CACHE_PROTOTYPES(static, intf, struct field_integration)
+LRU_CACHE_IMPL(static, intf, struct field_integration)
+
 LRU_CACHE_TYPE(ffid, ff_id_t)
 LRU_CACHE_PROTOTYPES(static, ffid, ff_id_t)
 LRU_CACHE_IMPL(static, ffid, ff_id_t)
@@ -77,6 +91,7 @@ VEC_PROTOTYPES(static, id, uint64_t)
 VEC_IMPL(static, id, uint64_t)
 
 KHASH_MAP_INIT_INT64(idvec, vec_id_t)
+KHASH_MAP_INIT_INT64(stamp, uint32_t)
 
 struct priv_fc_stats{
     unsigned los_query;
@@ -85,6 +100,7 @@ struct priv_fc_stats{
     unsigned flow_query;
     unsigned flow_hit;
     unsigned flow_invalidated;
+    unsigned flow_repaired;
     unsigned ffid_query;
     unsigned ffid_hit;
     unsigned grid_path_query;
@@ -94,6 +110,10 @@ struct priv_fc_stats{
 struct fieldcache_ctx{
     lru(los)          los_cache;       /* key: (dest_id, chunk coord) */
     lru(flow)         flow_cache;      /* key: (ffid) */
+    /* The integration fields retained for a subset of the cached flow fields,
+     * allowing them to be repaired in place rather than invalidated when the
+     * costs of their chunk change. */
+    lru(intf)         intf_cache;      /* key: (ffid) */
     /* The ffid cache maps a (dest_id, chunk coordinate) tuple to a flow field ID,
      * which could be used to retreive the relevant field from the flow cache. 
      * The reason for this is that the same flow field chunk can be shared between
@@ -107,6 +127,16 @@ struct fieldcache_ctx{
 
     /* Statistics */
     struct priv_fc_stats perfstats;
+    struct fc_telemetry  telemetry;
+    /* The copy of 'telemetry' published by the navigation task at the end of
+     * its' tick, for reading from other threads. */
+    struct fc_telemetry  published;
+    SDL_SpinLock         published_lock;
+    enum fc_requester    requester;
+    /* The time at which each of the sampled fields was added, for 
+     * measuring how long they stay in the cache before eviction. */
+    khash_t(stamp)      *added_ms[FC_FIELD_MAX];
+    unsigned             nadded[FC_FIELD_MAX];
 };
 
 /* The field cache is a process-wide singleton owned by the navigation tick
@@ -115,6 +145,8 @@ struct fieldcache_ctx{
  */
 static struct fieldcache_ctx *s_singleton;
 static uint32_t             (*s_nav_task_tid_provider)(void);
+/* The number of invalidation events already written to the trace */
+static unsigned               s_inval_traced;
 
 /* A fieldcache mutation is safe either when no navigation task is in flight (e.g. the
  * synchronous save-time flush, which runs in a session-task fiber) or when it happens
@@ -165,6 +197,201 @@ uint64_t grid_path_key(struct coord local_start, struct coord local_dest,
          |  (( ((uint64_t)layer)         & 0xf   ) << 60));
 }
 
+static int hist_bucket(uint64_t val)
+{
+    int ret = 0;
+    while(val && ret < FC_HIST_BUCKETS - 1) {
+        val >>= 1;
+        ret++;
+    }
+    return ret;
+}
+
+static void sample_added(struct fieldcache_ctx *ctx, enum fc_field_type type, uint64_t key)
+{
+    if((ctx->nadded[type]++ % EVICT_SAMPLE_PERIOD) != 0)
+        return;
+
+    int ret;
+    khiter_t k = kh_put(stamp, ctx->added_ms[type], key, &ret);
+    if(ret == -1)
+        return;
+    kh_val(ctx->added_ms[type], k) = SDL_GetTicks();
+}
+
+static void sample_removed(struct fieldcache_ctx *ctx, enum fc_field_type type, 
+                           uint64_t key, bool evicted)
+{
+    khash_t(stamp) *hash = ctx->added_ms[type];
+    khiter_t k = kh_get(stamp, hash, key);
+    if(k == kh_end(hash))
+        return;
+
+    if(evicted) {
+        uint32_t age = SDL_GetTicks() - kh_val(hash, k);
+        ctx->telemetry.evict_age_ms[type][hist_bucket(age)]++;
+    }
+    kh_del(stamp, hash, k);
+}
+
+static void log_invalidation(struct fieldcache_ctx *ctx, struct coord chunk, 
+                             enum nav_layer layer, enum fc_inval_cause cause, 
+                             unsigned nlos, unsigned nflow)
+{
+    ctx->telemetry.invalidated[FC_FIELD_LOS][cause] += nlos;
+    ctx->telemetry.invalidated[FC_FIELD_FLOW][cause] += nflow;
+    if(nlos + nflow == 0)
+        return;
+
+    unsigned idx = (ctx->telemetry.ninval_events++) % FC_INVAL_LOG_SIZE;
+    ctx->telemetry.inval_events[idx] = (struct fc_inval_event){
+        .tick_ms = SDL_GetTicks(),
+        .chunk_r = chunk.r,
+        .chunk_c = chunk.c,
+        .layer = layer,
+        .cause = cause,
+        .nremoved = (nlos + nflow > UINT16_MAX) ? UINT16_MAX : (nlos + nflow)
+    };
+}
+
+static bool los_remove(struct fieldcache_ctx *ctx, uint64_t key)
+{
+    bool found = lru_los_remove(&ctx->los_cache, key);
+    ctx->perfstats.los_invalidated += !!found;
+    sample_removed(ctx, FC_FIELD_LOS, key, false);
+    return found;
+}
+
+static bool flow_remove(struct fieldcache_ctx *ctx, uint64_t key)
+{
+    bool found = lru_flow_remove(&ctx->flow_cache, key);
+    ctx->perfstats.flow_invalidated += !!found;
+    lru_intf_remove(&ctx->intf_cache, key);
+    sample_removed(ctx, FC_FIELD_FLOW, key, false);
+    return found;
+}
+
+static struct coord ffid_chunk(ff_id_t ffid)
+{
+    return (struct coord){(ffid >> 8) & 0xff, ffid & 0xff};
+}
+
+static void fill_counter(struct perf_counter *out, const char *name, size_t nseries,
+                         const char **keys, const unsigned *values)
+{
+    assert(nseries <= PERF_COUNTER_MAX_SERIES);
+    out->name = name;
+    out->instant = false;
+    out->nseries = nseries;
+    for(size_t i = 0; i < nseries; i++) {
+        out->keys[i] = keys[i];
+        out->values[i] = values[i];
+    }
+}
+
+static size_t fc_trace_counters(size_t maxout, struct perf_counter *out)
+{
+    static const char *s_bucket_keys[FC_HIST_BUCKETS] = {
+        "0", "1", "2-3", "4-7", "8-15", "16-31", "32-63", "64-127", "128-255", 
+        "256-511", "512-1023", "1024-2047", "2048-4095", "4096-8191", 
+        "8192-16383", "16384+"
+    };
+    static const char *s_cause_keys[FC_INVAL_MAX] = {
+        "chunk", "repair", "zone", "through chunk", "enemy seek", "surround"
+    };
+    static const char *s_requester_keys[FC_REQ_MAX * FC_FIELD_MAX] = {
+        "other LOS",     "other flow",
+        "movement LOS",  "movement flow",
+        "formation LOS", "formation flow",
+        "arrival LOS",   "arrival flow",
+        "combat LOS",    "combat flow",
+    };
+    static const char *s_hist_names[][FC_FIELD_MAX] = {
+        {"fieldcache LOS build (us)", "fieldcache flow build (us)"},
+        {"fieldcache LOS eviction age (ms)", "fieldcache flow eviction age (ms)"},
+    };
+    static const char *s_inval_names[FC_FIELD_MAX] = {
+        "fieldcache LOS invalidations", "fieldcache flow invalidations"
+    };
+    static const char *s_event_keys[] = {
+        "chunk_r", "chunk_c", "layer", "removed", "age_ms"
+    };
+    static const char *s_event_names[FC_INVAL_MAX] = {
+        "fieldcache invalidation (chunk)", 
+        "fieldcache invalidation (repair)", 
+        "fieldcache invalidation (zone)", 
+        "fieldcache invalidation (through chunk)", 
+        "fieldcache invalidation (enemy seek)", 
+        "fieldcache invalidation (surround)"
+    };
+
+    struct fc_telemetry telemetry;
+    N_FC_GetTelemetry(&telemetry);
+
+    const unsigned (*hists[])[FC_HIST_BUCKETS] = {
+        (const unsigned (*)[FC_HIST_BUCKETS])telemetry.build_us, 
+        (const unsigned (*)[FC_HIST_BUCKETS])telemetry.evict_age_ms
+    };
+    struct{
+        const char     *name;
+        const unsigned *values;
+    }per_requester[] = {
+        {"fieldcache queries", &telemetry.query[0][0]},
+        {"fieldcache hits",    &telemetry.hit[0][0]},
+        {"fieldcache builds",  &telemetry.built[0][0]},
+    };
+
+    size_t ret = 0;
+    for(int i = 0; i < ARR_SIZE(hists); i++) {
+    for(int type = 0; type < FC_FIELD_MAX; type++) {
+        if(ret == maxout)
+            return ret;
+        fill_counter(&out[ret++], s_hist_names[i][type], FC_HIST_BUCKETS, 
+            s_bucket_keys, hists[i][type]);
+    }}
+
+    for(int type = 0; type < FC_FIELD_MAX; type++) {
+        if(ret == maxout)
+            return ret;
+        fill_counter(&out[ret++], s_inval_names[type], FC_INVAL_MAX, 
+            s_cause_keys, telemetry.invalidated[type]);
+    }
+
+    for(int i = 0; i < ARR_SIZE(per_requester); i++) {
+        if(ret == maxout)
+            return ret;
+        fill_counter(&out[ret++], per_requester[i].name, FC_REQ_MAX * FC_FIELD_MAX,
+            s_requester_keys, per_requester[i].values);
+    }
+
+    /* Write out the invalidations logged since the last frame, as far as 
+     * they are still held by the ring. The remainder carries over to the 
+     * next frame. 
+     */
+    if(s_inval_traced > telemetry.ninval_events)
+        s_inval_traced = 0;
+    if(telemetry.ninval_events - s_inval_traced > FC_INVAL_LOG_SIZE)
+        s_inval_traced = telemetry.ninval_events - FC_INVAL_LOG_SIZE;
+
+    uint32_t now = SDL_GetTicks();
+    for(int i = 0; i < TRACE_MAX_INVALS; i++) {
+        if(ret == maxout || s_inval_traced == telemetry.ninval_events)
+            break;
+
+        const struct fc_inval_event *event = 
+            &telemetry.inval_events[s_inval_traced++ % FC_INVAL_LOG_SIZE];
+        const unsigned values[] = {
+            event->chunk_r, event->chunk_c, event->layer, 
+            event->nremoved, now - event->tick_ms
+        };
+        assert(event->cause < FC_INVAL_MAX);
+        fill_counter(&out[ret], s_event_names[event->cause], ARR_SIZE(values), 
+            s_event_keys, values);
+        out[ret++].instant = true;
+    }
+    return ret;
+}
+
 static void on_grid_path_evict(struct grid_path_desc *victim)
 {
     vec_coord_destroy(&victim->path);
@@ -210,12 +437,13 @@ static bool dest_array_contains(dest_id_t *array, size_t size, dest_id_t item)
     return false;
 }
 
-static void clear_chunk_los_map(struct fieldcache_ctx *ctx, uint64_t key, enum nav_layer layer)
+static unsigned clear_chunk_los_map(struct fieldcache_ctx *ctx, uint64_t key, enum nav_layer layer)
 {
     khiter_t k = kh_get(idvec, ctx->chunk_lfield_map, key);
     if(k == kh_end(ctx->chunk_lfield_map))
-        return;
+        return 0;
 
+    unsigned ret = 0;
     vec_id_t *keys = &kh_val(ctx->chunk_lfield_map, k);
     for(int i = vec_size(keys)-1; i >= 0; i--) {
 
@@ -223,23 +451,24 @@ static void clear_chunk_los_map(struct fieldcache_ctx *ctx, uint64_t key, enum n
         if(N_DestLayer(key_dest(key)) != layer)
             continue;
 
-        bool found = lru_los_remove(&ctx->los_cache, key);
-        ctx->perfstats.los_invalidated += !!found;
+        ret += los_remove(ctx, key);
         vec_id_del(keys, i);
     }
     if(vec_size(keys) == 0) {
         vec_id_destroy(keys);
         kh_del(idvec, ctx->chunk_lfield_map, k);
     }
+    return ret;
 }
 
-static void clear_chunk_flow_map(struct fieldcache_ctx *ctx, uint64_t key, 
-                                 enum nav_layer layer, int only_target_type)
+static unsigned clear_chunk_flow_map(struct fieldcache_ctx *ctx, uint64_t key, 
+                                     enum nav_layer layer, int only_target_type)
 {
     khiter_t k = kh_get(idvec, ctx->chunk_ffield_map, key);
     if(k == kh_end(ctx->chunk_ffield_map))
-        return;
+        return 0;
 
+    unsigned ret = 0;
     vec_id_t *keys = &kh_val(ctx->chunk_ffield_map, k);
     for(int i = vec_size(keys)-1; i >= 0; i--) {
 
@@ -250,14 +479,23 @@ static void clear_chunk_flow_map(struct fieldcache_ctx *ctx, uint64_t key,
         if(only_target_type >= 0 && (N_FlowFieldTargetType(key) != only_target_type))
             continue;
 
-        bool found = lru_flow_remove(&ctx->flow_cache, key);
-        ctx->perfstats.flow_invalidated += !!found;
+        ret += flow_remove(ctx, key);
         vec_id_del(keys, i);
     }
     if(vec_size(keys) == 0) {
         vec_id_destroy(keys);
         kh_del(idvec, ctx->chunk_ffield_map, k);
     }
+    return ret;
+}
+
+static bool id_vec_contains_from(const vec_id_t *keys, int begin, uint64_t key)
+{
+    for(int i = begin; i < vec_size(keys); i++) {
+        if(vec_AT(keys, i) == key)
+            return true;
+    }
+    return false;
 }
 
 /*****************************************************************************/
@@ -266,12 +504,15 @@ static void clear_chunk_flow_map(struct fieldcache_ctx *ctx, uint64_t key,
 
 bool N_FC_Init(struct fieldcache_ctx *ctx)
 {
-    if(!lru_los_init(&ctx->los_cache, CONFIG_LOS_CACHE_SZ, NULL))
+    if(!lru_los_init(&ctx->los_cache, LOS_CACHE_ENTRIES, NULL))
         goto fail_los;
 
-    if(!lru_flow_init(&ctx->flow_cache, CONFIG_FLOW_CACHE_SZ, NULL))
+    if(!lru_flow_init(&ctx->flow_cache, FLOW_CACHE_ENTRIES, NULL))
         goto fail_flow;
 
+    if(!lru_intf_init(&ctx->intf_cache, CONFIG_INTEGRATION_CACHE_SZ, NULL))
+        goto fail_intf;
+
     if(!lru_ffid_init(&ctx->ffid_cache, CONFIG_MAPPING_CACHE_SZ, NULL))
         goto fail_ffid;
 
@@ -284,9 +525,24 @@ bool N_FC_Init(struct fieldcache_ctx *ctx)
     if(NULL == (ctx->chunk_lfield_map = kh_init(idvec)))
         goto fail_chunk_lfield;
 
+    if(NULL == (ctx->added_ms[FC_FIELD_LOS] = kh_init(stamp)))
+        goto fail_los_stamps;
+
+    if(NULL == (ctx->added_ms[FC_FIELD_FLOW] = kh_init(stamp)))
+        goto fail_flow_stamps;
+
     memset(&ctx->perfstats, 0, sizeof(ctx->perfstats));
+    memset(&ctx->telemetry, 0, sizeof(ctx->telemetry));
+    memset(&ctx->published, 0, sizeof(ctx->published));
+    ctx->published_lock = 0;
+    memset(ctx->nadded, 0, sizeof(ctx->nadded));
+    ctx->requester = FC_REQ_OTHER;
     return true;
 
+fail_flow_stamps:
+    kh_destroy(stamp, ctx->added_ms[FC_FIELD_LOS]);
+fail_los_stamps:
+    kh_destroy(idvec, ctx->chunk_lfield_map);
 fail_chunk_lfield:
     kh_destroy(idvec, ctx->chunk_ffield_map);
 fail_chunk_ffield:
@@ -294,6 +550,8 @@ fail_chunk_ffield:
 fail_grid_path:
     lru_ffid_destroy(&ctx->ffid_cache);
 fail_ffid:
+    lru_intf_destroy(&ctx->intf_cache);
+fail_intf:
     lru_flow_destroy(&ctx->flow_cache);
 fail_flow:
     lru_los_destroy(&ctx->los_cache);
@@ -305,6 +563,7 @@ void N_FC_Destroy(struct fieldcache_ctx *ctx)
 {
     lru_los_destroy(&ctx->los_cache);
     lru_flow_destroy(&ctx->flow_cache);
+    lru_intf_destroy(&ctx->intf_cache);
     lru_ffid_destroy(&ctx->ffid_cache);
     lru_grid_path_destroy(&ctx->grid_path_cache);
 
@@ -313,12 +572,16 @@ void N_FC_Destroy(struct fieldcache_ctx *ctx)
 
     destroy_all_entries(ctx->chunk_lfield_map);
     kh_destroy(idvec, ctx->chunk_lfield_map);
+
+    kh_destroy(stamp, ctx->added_ms[FC_FIELD_LOS]);
+    kh_destroy(stamp, ctx->added_ms[FC_FIELD_FLOW]);
 }
 
 void N_FC_ClearAll(struct fieldcache_ctx *ctx)
 {
     lru_los_clear(&ctx->los_cache);
     lru_flow_clear(&ctx->flow_cache);
+    lru_intf_clear(&ctx->intf_cache);
     lru_ffid_clear(&ctx->ffid_cache);
     lru_grid_path_clear(&ctx->grid_path_cache);
 
@@ -327,11 +590,31 @@ void N_FC_ClearAll(struct fieldcache_ctx *ctx)
 
     destroy_all_entries(ctx->chunk_lfield_map);
     kh_clear(idvec, ctx->chunk_lfield_map);
+
+    kh_clear(stamp, ctx->added_ms[FC_FIELD_LOS]);
+    kh_clear(stamp, ctx->added_ms[FC_FIELD_FLOW]);
 }
 
 void N_FC_ClearStats(struct fieldcache_ctx *ctx)
 {
     memset(&ctx->perfstats, 0, sizeof(ctx->perfstats));
+    memset(&ctx->telemetry, 0, sizeof(ctx->telemetry));
+
+    SDL_AtomicLock(&ctx->published_lock);
+    memset(&ctx->published, 0, sizeof(ctx->published));
+    SDL_AtomicUnlock(&ctx->published_lock);
+}
+
+void N_FC_RecordBuild(struct fieldcache_ctx *ctx, enum fc_field_type type, uint64_t pc_delta)
+{
+    uint64_t us = pc_delta * 1000000 / SDL_GetPerformanceFrequency();
+    ctx->telemetry.build_us[type][hist_bucket(us)]++;
+    ctx->telemetry.built[ctx->requester][type]++;
+}
+
+enum fc_requester N_FC_GetRequester(struct fieldcache_ctx *ctx)
+{
+    return ctx->requester;
 }
 
 void N_FC_GetStats(struct fieldcache_ctx *ctx, struct fc_stats *out_stats)
@@ -347,6 +630,7 @@ void N_FC_GetStats(struct fieldcache_ctx *ctx, struct fc_stats *out_stats)
     out_stats->flow_hit_rate = !ctx->perfstats.flow_query ? 0
         : ((float)ctx->perfstats.flow_hit) / ctx->perfstats.flow_query;
     out_stats->flow_invalidated = ctx->perfstats.flow_invalidated;
+    out_stats->flow_repaired = ctx->perfstats.flow_repaired;
 
     out_stats->ffid_used = ctx->ffid_cache.used;
     out_stats->ffid_max = ctx->ffid_cache.capacity;
@@ -368,6 +652,8 @@ bool N_FC_ContainsLOSField(struct fieldcache_ctx *ctx, dest_id_t id,
 
     ctx->perfstats.los_query++;
     ctx->perfstats.los_hit += !!ret;
+    ctx->telemetry.query[ctx->requester][FC_FIELD_LOS]++;
+    ctx->telemetry.hit[ctx->requester][FC_FIELD_LOS] += !!ret;
     return ret;
 }
 
@@ -384,7 +670,16 @@ void N_FC_PutLOSField(struct fieldcache_ctx *ctx, dest_id_t id,
 {
     FC_ASSERT_NAV_TASK();
     uint64_t key = key_for_dest_and_chunk(id, chunk_coord);
-    lru_los_put(&ctx->los_cache, key, lf);
+
+    lru(los) *lru = &ctx->los_cache;
+    if(!lru_los_peek(lru, key)) {
+        if(lru->used == lru->capacity) {
+            sample_removed(ctx, FC_FIELD_LOS, LRU_TAIL_KEY(los, lru), true);
+        }
+        sample_added(ctx, FC_FIELD_LOS, key);
+    }
+
+    lru_los_put(lru, key, lf);
     field_map_add(ctx->chunk_lfield_map, key_for_chunk(chunk_coord), key);
 }
 
@@ -395,6 +690,8 @@ bool N_FC_ContainsFlowField(struct fieldcache_ctx *ctx, ff_id_t ffid)
 
     ctx->perfstats.flow_query++;
     ctx->perfstats.flow_hit += !!ret;
+    ctx->telemetry.query[ctx->requester][FC_FIELD_FLOW]++;
+    ctx->telemetry.hit[ctx->requester][FC_FIELD_FLOW] += !!ret;
     return ret;
 }
 
@@ -408,10 +705,27 @@ void N_FC_PutFlowField(struct fieldcache_ctx *ctx, ff_id_t ffid,
                        const struct flow_field *ff)
 {
     FC_ASSERT_NAV_TASK();
-    lru_flow_put(&ctx->flow_cache, ffid, ff);
 
-    struct coord chunk = (struct coord){(ffid >> 8) & 0xff, ffid & 0xff};
-    field_map_add(ctx->chunk_ffield_map, key_for_chunk(chunk), ffid);
+    lru(flow) *lru = &ctx->flow_cache;
+    if(!lru_flow_peek(lru, ffid)) {
+        if(lru->used == lru->capacity) {
+            sample_removed(ctx, FC_FIELD_FLOW, LRU_TAIL_KEY(flow, lru), true);
+        }
+        sample_added(ctx, FC_FIELD_FLOW, ffid);
+    }
+
+    lru_flow_put(lru, ffid, ff);
+    /* Any retained integration field no longer describes the new contents */
+    lru_intf_remove(&ctx->intf_cache, ffid);
+    field_map_add(ctx->chunk_ffield_map, key_for_chunk(ffid_chunk(ffid)), ffid);
+}
+
+void N_FC_PutIntegrationField(struct fieldcache_ctx *ctx, ff_id_t ffid, 
+                              const struct field_integration *intf)
+{
+    FC_ASSERT_NAV_TASK();
+    assert(lru_flow_contains(&ctx->flow_cache, ffid));
+    lru_intf_put(&ctx->intf_cache, ffid, intf);
 }
 
 bool N_FC_GetDestFFMapping(struct fieldcache_ctx *ctx, dest_id_t id, 
@@ -467,15 +781,65 @@ void N_FC_InvalidateAllAtChunk(struct fieldcache_ctx *ctx, struct coord chunk, e
      * necessarily be in the caches. */
 
     uint64_t key = key_for_chunk(chunk);
-    clear_chunk_los_map(ctx, key, layer);
-    clear_chunk_flow_map(ctx, key, layer, -1);
+    unsigned nlos = clear_chunk_los_map(ctx, key, layer);
+    unsigned nflow = clear_chunk_flow_map(ctx, key, layer, -1);
+    log_invalidation(ctx, chunk, layer, FC_INVAL_CHUNK, nlos, nflow);
+}
+
+void N_FC_RepairAllAtChunk(struct fieldcache_ctx *ctx, const struct nav_private *priv,
+                           struct coord chunk, enum nav_layer layer)
+{
+    FC_ASSERT_NAV_TASK();
+
+    uint64_t key = key_for_chunk(chunk);
+    unsigned nlos = clear_chunk_los_map(ctx, key, layer);
+    unsigned nflow = 0;
+
+    khiter_t k = kh_get(idvec, ctx->chunk_ffield_map, key);
+    if(k == kh_end(ctx->chunk_ffield_map)) {
+        log_invalidation(ctx, chunk, layer, FC_INVAL_REPAIR, nlos, nflow);
+        return;
+    }
+
+    vec_id_t *keys = &kh_val(ctx->chunk_ffield_map, k);
+    for(int i = vec_size(keys)-1; i >= 0; i--) {
+
+        ff_id_t ffid = vec_AT(keys, i);
+        if(N_FlowFieldLayer(ffid) != layer)
+            continue;
+
+        /* Peek at the entries so as to not mess up the age history */
+        struct flow_field *ff = lru_flow_peek(&ctx->flow_cache, ffid);
+        struct field_integration *intf = lru_intf_peek(&ctx->intf_cache, ffid);
+
+        if(ff && intf) {
+            /* The key of a field that was put more than once is repeated */
+            if(id_vec_contains_from(keys, i + 1, ffid)) {
+                vec_id_del(keys, i);
+                continue;
+            }
+            if(N_FlowFieldRepair(priv, layer, priv->unit_query_ctx, ff, intf)) {
+                ctx->perfstats.flow_repaired++;
+                continue;
+            }
+        }
+
+        nflow += flow_remove(ctx, ffid);
+        vec_id_del(keys, i);
+    }
+    if(vec_size(keys) == 0) {
+        vec_id_destroy(keys);
+        kh_del(idvec, ctx->chunk_ffield_map, k);
+    }
+    log_invalidation(ctx, chunk, layer, FC_INVAL_REPAIR, nlos, nflow);
 }
 
 void N_FC_InvalidateZoneFieldsAtChunk(struct fieldcache_ctx *ctx, struct coord chunk,
                                       enum nav_layer layer)
 {
     FC_ASSERT_NAV_TASK();
-    clear_chunk_flow_map(ctx, key_for_chunk(chunk), layer, TARGET_ZONE);
+    unsigned nflow = clear_chunk_flow_map(ctx, key_for_chunk(chunk), layer, TARGET_ZONE);
+    log_invalidation(ctx, chunk, layer, FC_INVAL_ZONE, 0, nflow);
 }
 
 void N_FC_InvalidateAllThroughChunk(struct fieldcache_ctx *ctx, struct coord chunk, enum nav_layer layer)
@@ -483,8 +847,9 @@ void N_FC_InvalidateAllThroughChunk(struct fieldcache_ctx *ctx, struct coord chu
     FC_ASSERT_NAV_TASK();
     assert(Sched_UsingBigStack());
 
-    dest_id_t paths[CONFIG_FLOW_CACHE_SZ];
+    dest_id_t paths[FLOW_CACHE_ENTRIES];
     size_t npaths = 0;
+    unsigned nlos = 0, nflow = 0;
 
     uint64_t key;
     ff_id_t ffid_val;
@@ -516,9 +881,7 @@ void N_FC_InvalidateAllThroughChunk(struct fieldcache_ctx *ctx, struct coord chu
         dest_id_t curr_dest = key_dest(key);
 
         if(dest_array_contains(paths, npaths, curr_dest)) {
-        
-            bool found = lru_flow_remove(&ctx->flow_cache, key);
-            ctx->perfstats.flow_invalidated += !!found;
+            nflow += flow_remove(ctx, key);
         }
     });
 
@@ -530,11 +893,10 @@ void N_FC_InvalidateAllThroughChunk(struct fieldcache_ctx *ctx, struct coord chu
         dest_id_t curr_dest = key_dest(key);
 
         if(dest_array_contains(paths, npaths, curr_dest)) {
-        
-            bool found = lru_los_remove(&ctx->los_cache, key);
-            ctx->perfstats.los_invalidated += !!found;
+            nlos += los_remove(ctx, key);
         }
     });
+    log_invalidation(ctx, chunk, layer, FC_INVAL_THROUGH_CHUNK, nlos, nflow);
 }
 
 void N_FC_InvalidateNeighbourEnemySeekFields(struct fieldcache_ctx *ctx, int width, int height, 
@@ -557,7 +919,8 @@ void N_FC_InvalidateNeighbourEnemySeekFields(struct fieldcache_ctx *ctx, int wid
 
         struct coord curr = (struct coord){abs_r, abs_c};
         uint64_t key = key_for_chunk(curr);
-        clear_chunk_flow_map(ctx, key, layer, TARGET_ENEMIES);
+        unsigned nflow = clear_chunk_flow_map(ctx, key, layer, TARGET_ENEMIES);
+        log_invalidation(ctx, curr, layer, FC_INVAL_ENEMY_SEEK, 0, nflow);
     }}
 }
 
@@ -577,7 +940,8 @@ void N_FC_InvalidateDynamicSurroundFields(struct fieldcache_ctx *ctx)
         if(!(G_FlagsGet(ent) & ENTITY_FLAG_MOVABLE))
             continue;
 
-        lru_flow_remove(&ctx->flow_cache, key);
+        unsigned nflow = flow_remove(ctx, key);
+        log_invalidation(ctx, ffid_chunk(key), N_FlowFieldLayer(key), FC_INVAL_SURROUND, 0, nflow);
     });
 }
 
@@ -608,6 +972,7 @@ bool N_FC_InitSingleton(void)
         s_singleton = NULL;
         return false;
     }
+    Perf_RegisterCounterProvider(fc_trace_counters);
     return true;
 }
 
@@ -615,6 +980,7 @@ void N_FC_ShutdownSingleton(void)
 {
     if(!s_singleton)
         return;
+    Perf_UnregisterCounterProvider(fc_trace_counters);
     N_FC_Destroy(s_singleton);
     N_FC_Free(s_singleton);
     s_singleton = NULL;
@@ -625,3 +991,35 @@ struct fieldcache_ctx *N_FC_GetSingleton(void)
     return s_singleton;
 }
 
+enum fc_requester N_FC_SetRequester(enum fc_requester requester)
+{
+    FC_ASSERT_NAV_TASK();
+    assert(s_singleton);
+
+    enum fc_requester ret = s_singleton->requester;
+    s_singleton->requester = requester;
+    return ret;
+}
+
+void N_FC_GetTelemetry(struct fc_telemetry *out)
+{
+    if(!s_singleton) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    SDL_AtomicLock(&s_singleton->published_lock);
+    *out = s_singleton->published;
+    SDL_AtomicUnlock(&s_singleton->published_lock);
+}
+
+void N_FC_PublishTelemetry(void)
+{
+    FC_ASSERT_NAV_TASK();
+    if(!s_singleton)
+        return;
+
+    SDL_AtomicLock(&s_singleton->published_lock);
+    s_singleton->published = s_singleton->telemetry;
+    SDL_AtomicUnlock(&s_singleton->published_lock);
+}
+
@@ -67,6 +67,15 @@ void N_FC_InvalidateAllAtChunk(struct fieldcache_ctx *ctx,
                                struct coord chunk, 
                                enum nav_layer layer);
 
+/* Bring all the flow fields at a particular chunk up to date with its current 
+ * costs. Fields with a retained integration field are repaired in place; all 
+ * others, along with the LOS fields, are invalidated.
+ */
+void N_FC_RepairAllAtChunk(struct fieldcache_ctx *ctx, 
+                           const struct nav_private *priv,
+                           struct coord chunk, 
+                           enum nav_layer layer);
+
 /* Invalidate only the TARGET_ZONE (arrival) flow fields for a particular chunk,
  * leaving transit, portal and enemy-seek fields intact.
  */
@@ -124,6 +133,14 @@ bool                     N_FC_ContainsFlowField(struct fieldcache_ctx *ctx, ff_i
 void                     N_FC_PutFlowField(struct fieldcache_ctx *ctx, 
                                            ff_id_t ffid, const struct flow_field *ff);
 
+/* Retain the integration field that the cached flow field 'ffid' was built from,
+ * so that it can be repaired rather than invalidated. Must be called after the
+ * corresponding N_FC_PutFlowField, which discards any previously retained field.
+ */
+void                     N_FC_PutIntegrationField(struct fieldcache_ctx *ctx, 
+                                                  ff_id_t ffid, 
+                                                  const struct field_integration *intf);
+
 bool                     N_FC_GetDestFFMapping(struct fieldcache_ctx *ctx, 
                                                dest_id_t id, 
                                                struct coord chunk_coord, 
@@ -166,5 +183,14 @@ void      N_FC_ClearStats(struct fieldcache_ctx *ctx);
 void      N_FC_GetStats(struct fieldcache_ctx *ctx, struct fc_stats *out_stats);
 void      N_FC_ClearAll(struct fieldcache_ctx *ctx);
 
+/* Record the time (in performance counter ticks) that it took to build a 
+ * field which is about to be added to the cache. The build is attributed 
+ * to the current requester.
+ */
+void      N_FC_RecordBuild(struct fieldcache_ctx *ctx, enum fc_field_type type, 
+                           uint64_t pc_delta);
+
+enum fc_requester N_FC_GetRequester(struct fieldcache_ctx *ctx);
+
 #endif
 
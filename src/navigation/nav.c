@@ -46,6 +46,7 @@
 #include "../render/public/render.h"
 #include "../render/public/render_ctrl.h"
 #include "../mem.h"
+#include "../asset_cache.h"
 #include "../lib/public/pf_cow_region.h"
 #include "../lib/public/queue.h"
 #include "../lib/public/pqueue.h"
@@ -65,6 +66,7 @@
 #include <assert.h>
 #include <string.h>
 #include <float.h>
+#include <SDL.h>
 
 #undef PF_MALLOC
 #undef PF_CALLOC
@@ -86,6 +88,8 @@ bool M_TileAdjacentToLand(const struct map *map, const struct tile_desc *td);
 
 #define EPSILON                  (1.0f / 1024)
 #define MAX_FIELD_TASKS          (256)
+/* Bump whenever the baking of portals or islands changes */
+#define NAV_BAKE_VERSION         (2)
 
 #define FOREACH_PORTAL(_priv, _layer, _local, ...)                                              \
     do{                                                                                         \
@@ -130,10 +134,12 @@ struct field_work_in{
     int                 faction_id;
     enum nav_layer      layer;
     ff_id_t             id;
+    enum fc_requester   requester;
 };
 
 struct field_work_out{
     struct flow_field field;
+    uint64_t          pc_delta;
 };
 
 VEC_TYPE(in, struct field_work_in)
@@ -162,14 +168,43 @@ VEC_IMPL(static inline, crange, struct cow_range)
 /* Scratch list of writer byte-ranges to publish to the canonical each tick. */
 static vec_crange_t s_pub_ranges;
 
+/* A source of a batched path request. Sources sharing a 'key' (chunk, global 
+ * island and local island) are served by the same path. */
+struct batch_src{
+    uint64_t key;
+    int      dist;
+    size_t   idx;
+};
+
+/* A flow field to build for a chunk along a requested path. */
+struct path_field_job{
+    struct coord             chunk;
+    struct field_target      target;
+    ff_id_t                  id;
+    bool                     repairable;
+    uint64_t                 pc_delta;
+    struct flow_field        ff;
+    struct field_integration intf;
+};
+
+struct path_field_work{
+    struct nav_private    *priv;
+    int                    faction_id;
+    enum nav_layer         layer;
+    size_t                 njobs;
+    struct path_field_job *jobs;
+};
+
+struct path_field_hop{
+    struct coord chunk;
+    ff_id_t      id;
+};
+
 struct field_work{
     struct memstack mem;
     vec_in_t        in;
     vec_out_t       out;
     size_t          nwork;
-    size_t          ntasks;
-    uint32_t        tids[MAX_FIELD_TASKS];
-    struct future   futures[MAX_FIELD_TASKS];
 };
 
 __KHASH_IMPL(coord, static inline, khint32_t, struct coord, 1, kh_int_hash_func, kh_int_hash_equal)
@@ -590,6 +625,26 @@ static void n_create_portals(struct nav_private *priv, enum nav_layer layer)
     assert(n_links == (priv->height)*(priv->width-1) + (priv->width)*(priv->height-1));
 }
 
+static void n_update_portal_dists(struct nav_chunk *chunk)
+{
+    for(int i = 0; i < MAX_PORTALS_PER_CHUNK; i++) {
+    for(int j = 0; j < MAX_PORTALS_PER_CHUNK; j++) {
+        chunk->portal_dists[i][j] = FLT_MAX;
+    }}
+
+    for(int i = 0; i < chunk->num_portals; i++) {
+
+        const struct portal *port = &chunk->portals[i];
+        for(int j = 0; j < port->num_neighbours; j++) {
+
+            const struct edge *edge = &port->edges[j];
+            if(edge->es == EDGE_STATE_BLOCKED)
+                continue;
+            chunk->portal_dists[i][edge->neighbour & PORTAL_REF_PORTAL_MASK] = edge->cost;
+        }
+    }
+}
+
 static void n_link_chunk_portals(struct nav_private *priv, struct nav_chunk *chunk, 
                                  struct coord chunk_coord, enum nav_layer layer)
 {
@@ -616,7 +671,7 @@ static void n_link_chunk_portals(struct nav_private *priv, struct nav_chunk *chu
 
             float cost;
             bool has_path = AStar_GridPath(priv->fieldcache, a, b, chunk_coord, chunk->cost_base, 
-                layer, &path, &cost);
+                layer, GRID_PATH_JPS, &path, &cost);
             if(has_path) {
                 port->edges[port->num_neighbours] = (struct edge){
                     EDGE_STATE_ACTIVE,
@@ -630,6 +685,7 @@ static void n_link_chunk_portals(struct nav_private *priv, struct nav_chunk *chu
     }
 
     vec_coord_destroy(&path);
+    n_update_portal_dists(chunk);
 }
 
 static void n_visit_portal(struct nav_private *priv, enum nav_layer layer,
@@ -713,6 +769,9 @@ static int n_update_edge_states(struct nav_private *priv, enum nav_layer layer,
         }
     }
 
+    if(ret) {
+        n_update_portal_dists(chunk);
+    }
     return ret;
 }
 
@@ -900,53 +959,36 @@ static void n_visit_island(struct nav_private *priv, uint16_t id,
     queue_td_destroy(&frontier);
 }
 
-static void n_visit_island_local(struct nav_private *priv, struct coord chunk_coord,
-                                 struct nav_chunk *chunk, uint16_t id, struct coord start)
+static bool n_tile_open(const struct nav_chunk *chunk, int r, int c)
 {
-    struct map_resolution res;
-    N_GetResolution(priv, &res);
-
-    struct tile_desc start_td = {
-        chunk_coord.r, chunk_coord.c, start.r, start.c
-    };
-
-    queue_td_t frontier;
-    queue_td_init(&frontier, 1024);
-    queue_td_push(&frontier, &start_td);
-
-    while(queue_size(frontier) > 0) {
-    
-        struct tile_desc curr;
-        queue_td_pop(&frontier, &curr);
-
-        struct coord deltas[] = {
-            { 0, -1},
-            { 0, +1},
-            {-1,  0},
-            {+1,  0},
-        };
-
-        if(curr.chunk_r != chunk_coord.r || curr.chunk_c != chunk_coord.c)
-            continue;
-        if(chunk->cost_base[curr.tile_r][curr.tile_c] == COST_IMPASSABLE)
-            continue;
-        if(chunk->blockers[curr.tile_r][curr.tile_c] > 0)
-            continue;
-        if(chunk->local_islands[curr.tile_r][curr.tile_c] != ISLAND_NONE)
-            continue;
+    return (chunk->cost_base[r][c] != COST_IMPASSABLE)
+        && (chunk->blockers[r][c] == 0);
+}
 
-        chunk->local_islands[curr.tile_r][curr.tile_c] = id;
+static int uf_find(uint16_t *parent, int idx)
+{
+    int root = idx;
+    while(parent[root] != root)
+        root = parent[root];
 
-        for(int i = 0; i < ARR_SIZE(deltas); i++) {
-        
-            struct tile_desc neighb = curr;
-            if(!M_Tile_RelativeDesc(res, &neighb, deltas[i].c, deltas[i].r))
-                continue;
-            queue_td_push(&frontier, &neighb);
-        }
+    /* Path compression */
+    while(parent[idx] != root) {
+        int next = parent[idx];
+        parent[idx] = root;
+        idx = next;
     }
+    return root;
+}
 
-    queue_td_destroy(&frontier);
+static void uf_union(uint16_t *parent, int a, int b)
+{
+    int root_a = uf_find(parent, a);
+    int root_b = uf_find(parent, b);
+
+    if(root_a < root_b)
+        parent[root_b] = root_a;
+    else if(root_b < root_a)
+        parent[root_a] = root_b;
 }
 
 static bool enemy_ent(uint32_t ent, void *arg)
@@ -967,19 +1009,44 @@ static bool enemy_ent(uint32_t ent, void *arg)
 static void n_update_local_islands(struct nav_private *priv, struct coord chunk_coord, 
                                    struct nav_chunk *chunk)
 {
+    /* Label the open tiles of the chunk in two passes using a union-find
+     * forest. In the first pass, every open tile is joined with its' open 
+     * left and upper neighbours, always keeping the lower index as the root. 
+     * This makes every root the first tile of its' island in row-major order, 
+     * so the IDs come out in the same order as a flood fill would give them.
+     */
+    uint16_t parent[FIELD_RES_R * FIELD_RES_C];
     int local_iid = 0;
-    memset(chunk->local_islands, 0xff, sizeof(chunk->local_islands));
 
     for(int r = 0; r < FIELD_RES_R; r++) {
     for(int c = 0; c < FIELD_RES_C; c++) {
 
-        if(chunk->local_islands[r][c] != ISLAND_NONE)
-            continue;
-        if(chunk->cost_base[r][c] == COST_IMPASSABLE)
+        int idx = IDX(r, FIELD_RES_C, c);
+        parent[idx] = idx;
+
+        if(!n_tile_open(chunk, r, c))
             continue;
-        if(chunk->blockers[r][c] > 0)
+        if(c > 0 && n_tile_open(chunk, r, c - 1))
+            uf_union(parent, idx, idx - 1);
+        if(r > 0 && n_tile_open(chunk, r - 1, c))
+            uf_union(parent, idx, idx - FIELD_RES_C);
+    }}
+
+    for(int r = 0; r < FIELD_RES_R; r++) {
+    for(int c = 0; c < FIELD_RES_C; c++) {
+
+        int idx = IDX(r, FIELD_RES_C, c);
+        if(!n_tile_open(chunk, r, c)) {
+            chunk->local_islands[r][c] = ISLAND_NONE;
             continue;
-        n_visit_island_local(priv, chunk_coord, chunk, ++local_iid, (struct coord){r, c});
+        }
+
+        int root = uf_find(parent, idx);
+        if(root == idx) {
+            chunk->local_islands[r][c] = ++local_iid;
+        }else{
+            chunk->local_islands[r][c] = chunk->local_islands[root / FIELD_RES_C][root % FIELD_RES_C];
+        }
     }}
 }
 
@@ -1210,105 +1277,165 @@ static void n_update_blockers_obb_air(struct nav_private *priv, const struct obb
     n_update_blockers(priv, NAV_LAYER_AIR_7X7, faction_id, outline7x7, noutline7x7, ref_delta);
 }
 
-static int manhattan_dist(struct tile_desc a, struct tile_desc b)
+/* A chunk region that may hold tiles of the island being searched for, along 
+ * with a lower bound on the manhattan distance from the target to any of them. */
+struct island_candidate{
+    int      chunk_idx;
+    int      rmin, cmin, rmax, cmax;
+    int      lower_bound;
+};
+
+static int compare_island_candidates(const void *a, const void *b)
+{
+    const struct island_candidate *ca = a, *cb = b;
+    if(ca->lower_bound != cb->lower_bound)
+        return ca->lower_bound - cb->lower_bound;
+    return ca->chunk_idx - cb->chunk_idx;
+}
+
+static int range_dist(int val, int min, int max)
 {
-    int dr = abs(
-        (a.chunk_r * TILES_PER_CHUNK_HEIGHT + a.tile_r) 
-      - (b.chunk_r * TILES_PER_CHUNK_HEIGHT + b.tile_r)
-    );
-    int dc = abs(
-        (a.chunk_c * TILES_PER_CHUNK_HEIGHT + a.tile_c) 
-      - (b.chunk_c * TILES_PER_CHUNK_HEIGHT + b.tile_c)
-    );
-    return dr + dc;
+    if(val < min)
+        return min - val;
+    if(val > max)
+        return val - max;
+    return 0;
 }
 
+/* Find the tiles of the global island 'global_iid' that are the nearest (by
+ * manhattan distance) to 'target', returning all equally near ones up to 
+ * 'maxout'. The island extents index lets us only visit the chunk regions 
+ * that could hold a nearer tile than the best one found so far.
+ */
 static int n_closest_island_tiles(const struct nav_private *priv, 
                                   enum nav_layer layer, struct tile_desc target, 
                                   uint16_t global_iid, bool ignore_blockers,
                                   struct tile_desc *out, int maxout)
 {
-    struct map_resolution res;
-    N_GetResolution(priv, &res);
+    const int tr = target.chunk_r * FIELD_RES_R + target.tile_r;
+    const int tc = target.chunk_c * FIELD_RES_C + target.tile_c;
+    const size_t nchunks = priv->width * priv->height;
 
-    queue_td_t frontier;
-    queue_td_init(&frontier, 1024);
-    queue_td_push(&frontier, &target);
+    STALLOC(struct island_candidate, cands, nchunks);
+    size_t ncands = 0;
 
-    const size_t count = res.chunk_h * res.chunk_w * res.tile_h * res.tile_w;
-    STALLOC(bool, visited, count);
-    memset(visited, 0, count);
+    for(size_t i = 0; i < nchunks; i++) {
 
-    const size_t stride_a = res.chunk_w * res.tile_h * res.tile_w;
-    const size_t stride_b = res.tile_h * res.tile_w;
-    const size_t stride_c = res.tile_w;
+        const struct nav_chunk *chunk = &priv->chunks[layer][i];
+        const int base_r = (i / priv->width) * FIELD_RES_R;
+        const int base_c = (i % priv->width) * FIELD_RES_C;
 
-    visited[target.chunk_r * stride_a + target.chunk_c * stride_b 
-          + target.tile_r  * stride_c + target.tile_c] = true;
+        /* When the chunk has too many islands to index, we have to 
+         * consider all of its' tiles */
+        if(chunk->island_extents_overflow) {
+            cands[ncands++] = (struct island_candidate){i, 
+                base_r, base_c, 
+                base_r + FIELD_RES_R - 1, base_c + FIELD_RES_C - 1
+            };
+            continue;
+        }
+
+        for(int j = 0; j < chunk->num_island_extents; j++) {
+
+            const struct island_extent *ext = &chunk->island_extents[j];
+            if(ext->iid != global_iid)
+                continue;
+            cands[ncands++] = (struct island_candidate){i, 
+                base_r + ext->rmin, base_c + ext->cmin, 
+                base_r + ext->rmax, base_c + ext->cmax
+            };
+            break;
+        }
+    }
+
+    for(size_t i = 0; i < ncands; i++) {
+        cands[i].lower_bound = range_dist(tr, cands[i].rmin, cands[i].rmax)
+                             + range_dist(tc, cands[i].cmin, cands[i].cmax);
+    }
+    qsort(cands, ncands, sizeof(struct island_candidate), compare_island_candidates);
 
     int ret = 0;
-    int first_mh_dist = -1;
+    int best = INT_MAX;
 
-    while(queue_size(frontier) > 0) {
-    
-        struct tile_desc curr;
-        queue_td_pop(&frontier, &curr);
+    for(size_t i = 0; i < ncands; i++) {
 
-        struct coord deltas[] = {
-            { 0,  0},
-            { 0, -1},
-            { 0, +1},
-            {-1,  0},
-            {+1,  0},
-            {-1, -1},
-            {-1,  1},
-            { 1, -1},
-            { 1,  1},
-        };
+        const struct island_candidate *cand = &cands[i];
+        if(cand->lower_bound > best)
+            break;
 
-        for(int i = 0; i < ARR_SIZE(deltas); i++) {
-        
-            struct tile_desc neighb = curr;
-            if(!M_Tile_RelativeDesc(res, &neighb, deltas[i].c, deltas[i].r))
-                continue;
+        const struct nav_chunk *chunk = &priv->chunks[layer][cand->chunk_idx];
+        const int chunk_r = cand->chunk_idx / priv->width;
+        const int chunk_c = cand->chunk_idx % priv->width;
+
+        for(int r = cand->rmin; r <= cand->rmax; r++) {
+        for(int c = cand->cmin; c <= cand->cmax; c++) {
 
-            const struct nav_chunk *chunk = 
-                &priv->chunks[layer][IDX(neighb.chunk_r, priv->width, neighb.chunk_c)];
+            const int tile_r = r - chunk_r * FIELD_RES_R;
+            const int tile_c = c - chunk_c * FIELD_RES_C;
+
+            if(chunk->islands[tile_r][tile_c] != global_iid)
+                continue;
+            if(!ignore_blockers && chunk->blockers[tile_r][tile_c] > 0)
+                continue;
 
-            if(visited[neighb.chunk_r * stride_a + neighb.chunk_c * stride_b
-                     + neighb.tile_r  * stride_c + neighb.tile_c])
+            struct tile_desc curr = {chunk_r, chunk_c, tile_r, tile_c};
+            int dist = abs(r - tr) + abs(c - tc);
+            if(dist > best)
                 continue;
+            if(dist < best) {
+                best = dist;
+                ret = 0;
+            }
+            if(ret < maxout) {
+                out[ret++] = curr;
+            }
+        }}
+    }
 
-            bool skip = (chunk->islands[neighb.tile_r][neighb.tile_c] != global_iid);
-            if(!ignore_blockers
-            && chunk->blockers[neighb.tile_r][neighb.tile_c] > 0)
-                skip = true;
+    STFREE(cands);
+    return ret; 
+}
 
-            int mh_dist = manhattan_dist(target, neighb);
-            if(first_mh_dist > 0 && mh_dist > first_mh_dist)
-                goto done; /* The mh distance is strictly increasing as we go outwards */
+/* Rebuild the island extents index of a chunk from its 'islands' field. */
+static void n_index_chunk_islands(struct nav_chunk *chunk)
+{
+    chunk->num_island_extents = 0;
+    chunk->island_extents_overflow = false;
 
-            if(!skip) {
-            
-                assert(ret < maxout);
-                out[ret++] = neighb;
+    for(int r = 0; r < FIELD_RES_R; r++) {
+    for(int c = 0; c < FIELD_RES_C; c++) {
+
+        uint16_t iid = chunk->islands[r][c];
+        struct island_extent *ext = NULL;
 
-                if(first_mh_dist == -1)
-                    first_mh_dist = mh_dist;
-                if(ret == maxout)
-                    goto done;
+        for(int i = 0; i < chunk->num_island_extents; i++) {
+            if(chunk->island_extents[i].iid == iid) {
+                ext = &chunk->island_extents[i];
+                break;
             }
+        }
 
-            visited[neighb.chunk_r * stride_a + neighb.chunk_c * stride_b
-                  + neighb.tile_r  * stride_c + neighb.tile_c] = true;
-            queue_td_push(&frontier, &neighb);
+        if(!ext) {
+            if(chunk->num_island_extents == MAX_ISLAND_EXTENTS) {
+                chunk->island_extents_overflow = true;
+                continue;
+            }
+            ext = &chunk->island_extents[chunk->num_island_extents++];
+            *ext = (struct island_extent){iid, r, c, r, c};
         }
-    }
 
-done:
-    STFREE(visited);
-    queue_td_destroy(&frontier);
-    return ret; 
+        ext->rmin = MIN(ext->rmin, r);
+        ext->cmin = MIN(ext->cmin, c);
+        ext->rmax = MAX(ext->rmax, r);
+        ext->cmax = MAX(ext->cmax, c);
+    }}
+}
+
+static void n_index_islands(struct nav_private *priv, enum nav_layer layer)
+{
+    for(size_t i = 0; i < priv->width * priv->height; i++) {
+        n_index_chunk_islands(&priv->chunks[layer][i]);
+    }
 }
 
 static void n_build_portal_travel_index(struct nav_chunk *chunk)
@@ -1769,10 +1896,81 @@ static void n_update_island_field(struct nav_private *priv, enum nav_layer layer
             island_id++;
         }}
     }}
+
+    n_index_islands(priv, layer);
 }
 
-static bool n_request_path(void *nav_private, vec2_t xz_src, vec2_t xz_dest, int faction_id,
-                           vec3_t map_pos, enum nav_layer layer, dest_id_t *out_dest_id)
+static void path_field_work(int begin_idx, int end_idx, void *arg)
+{
+    struct path_field_work *work = arg;
+
+    for(int i = begin_idx; i < end_idx; i++) {
+
+        struct path_field_job *job = &work->jobs[i];
+        uint64_t begin = SDL_GetPerformanceCounter();
+        job->repairable = N_FlowFieldBuild(job->chunk, work->priv, work->faction_id, 
+            work->layer, job->target, work->priv->unit_query_ctx, &job->ff, &job->intf);
+        job->pc_delta = SDL_GetPerformanceCounter() - begin;
+    }
+}
+
+static bool n_path_field_pending(const struct path_field_work *work, struct coord chunk)
+{
+    for(size_t i = 0; i < work->njobs; i++) {
+        if(work->jobs[i].chunk.r == chunk.r && work->jobs[i].chunk.c == chunk.c)
+            return true;
+    }
+    return false;
+}
+
+/* Build the pending path fields as one task per chunk and add them to the cache. */
+static void n_path_fields_flush(struct path_field_work *work)
+{
+    if(work->njobs == 0)
+        return;
+
+    Sched_ParallelFor(0, work->njobs, 1, path_field_work, work, TASK_BIG_STACK);
+
+    for(size_t i = 0; i < work->njobs; i++) {
+
+        const struct path_field_job *job = &work->jobs[i];
+        N_FC_RecordBuild(work->priv->fieldcache, FC_FIELD_FLOW, job->pc_delta);
+        N_FC_PutFlowField(work->priv->fieldcache, job->id, &job->ff);
+        if(job->repairable) {
+            N_FC_PutIntegrationField(work->priv->fieldcache, job->id, &job->intf);
+        }
+    }
+    work->njobs = 0;
+}
+
+/* The baked state of every chunk: the portal graph (all the fields preceding 
+ * the cost field), the portal travel costs and the global islands. The cost 
+ * field itself is the key of the bake, and the rest is live state.
+ */
+static struct nav_cache_span *n_bake_spans(struct nav_private *priv, size_t *out_nspans)
+{
+    size_t nchunks = priv->width * priv->height;
+    struct nav_cache_span *ret = PF_MALLOC(sizeof(struct nav_cache_span) * 3 * NAV_LAYER_MAX * nchunks);
+    if(!ret)
+        return NULL;
+
+    size_t n = 0;
+    for(int layer = 0; layer < NAV_LAYER_MAX; layer++) {
+        for(size_t i = 0; i < nchunks; i++) {
+
+            struct nav_chunk *chunk = &priv->chunks[layer][i];
+            ret[n++] = (struct nav_cache_span){chunk, offsetof(struct nav_chunk, cost_base)};
+            ret[n++] = (struct nav_cache_span){chunk->portal_travel_costs, sizeof(chunk->portal_travel_costs)};
+            ret[n++] = (struct nav_cache_span){chunk->islands, sizeof(chunk->islands)};
+        }
+    }
+    *out_nspans = n;
+    return ret;
+}
+
+/* Expects the islands and edge states of the layer to be up to date. */
+static bool n_request_path_from(void *nav_private, vec2_t xz_src, vec2_t xz_dest, int faction_id,
+                                vec3_t map_pos, enum nav_layer layer, dest_id_t *out_dest_id)
 {
     PERF_ENTER();
 
@@ -1783,9 +1981,6 @@ static bool n_request_path(void *nav_private, vec2_t xz_src, vec2_t xz_dest, int
     bool result;
     (void)result;
 
-    n_update_dirty_local_islands(nav_private, layer);
-    n_update_all_edge_states(nav_private, layer);
-
     /* Convert source and destination positions to tile coordinates */
     struct tile_desc src_desc, dst_desc;
     result = M_Tile_DescForPoint2D(res, map_pos, xz_src, &src_desc);
@@ -1822,14 +2017,20 @@ static bool n_request_path(void *nav_private, vec2_t xz_src, vec2_t xz_dest, int
         };
 
         struct flow_field ff;
+        struct field_integration intf;
         id = N_FlowFieldID((struct coord){dst_desc.chunk_r, dst_desc.chunk_c}, target, layer);
 
         if(!N_FC_ContainsFlowField(priv->fieldcache, id)) {
         
             struct coord chunk = (struct coord){dst_desc.chunk_r, dst_desc.chunk_c};
-            N_FlowFieldInit(chunk, &ff);
-            N_FlowFieldUpdate(chunk, priv, faction_id, layer, target, priv->unit_query_ctx, &ff);
+            uint64_t begin = SDL_GetPerformanceCounter();
+            bool repairable = N_FlowFieldBuild(chunk, priv, faction_id, layer, target, 
+                priv->unit_query_ctx, &ff, &intf);
+            N_FC_RecordBuild(priv->fieldcache, FC_FIELD_FLOW, SDL_GetPerformanceCounter() - begin);
             N_FC_PutFlowField(priv->fieldcache, id, &ff);
+            if(repairable) {
+                N_FC_PutIntegrationField(priv->fieldcache, id, &intf);
+            }
         }
 
         N_FC_PutDestFFMapping(priv->fieldcache, ret, 
@@ -1841,8 +2042,10 @@ static bool n_request_path(void *nav_private, vec2_t xz_src, vec2_t xz_dest, int
         (struct coord){dst_desc.chunk_r, dst_desc.chunk_c})) {
 
         struct LOS_field lf;
+        uint64_t begin = SDL_GetPerformanceCounter();
         N_LOSFieldCreate(ret, (struct coord){dst_desc.chunk_r, dst_desc.chunk_c}, 
             dst_desc, priv, map_pos, priv->unit_query_ctx, &lf, NULL);
+        N_FC_RecordBuild(priv->fieldcache, FC_FIELD_LOS, SDL_GetPerformanceCounter() - begin);
         N_FC_PutLOSField(priv->fieldcache, ret, (struct coord){dst_desc.chunk_r, dst_desc.chunk_c}, &lf);
     }
 
@@ -1934,10 +2137,27 @@ static bool n_request_path(void *nav_private, vec2_t xz_src, vec2_t xz_dest, int
         }
     }
 
-    struct coord prev_los_coord = (struct coord){dst_desc.chunk_r, dst_desc.chunk_c};
+    struct path_field_work work = (struct path_field_work){
+        .priv = priv,
+        .faction_id = faction_id,
+        .layer = layer,
+        .njobs = 0,
+        .jobs = PF_MALLOC(sizeof(struct path_field_job) * vec_size(&path)),
+    };
+    struct path_field_hop *hops = PF_MALLOC(sizeof(struct path_field_hop) * vec_size(&path));
+    size_t nhops = 0;
+
+    if(!work.jobs || !hops) {
+        PF_FREE(work.jobs);
+        PF_FREE(hops);
+        vec_portal_destroy(&path);
+        PERF_RETURN(false);
+    }
 
-    /* Traverse the portal path _backwards_ and generate the required fields, 
-     * If they are not already cached. Add the results to the fieldcache. */
+    /* Traverse the portal path _backwards_ and work out the required fields. The 
+     * ones that are not already cached only depend on the portal targets of their 
+     * chunk, so they are built in parallel and added to the fieldcache together.
+     */
     for(int i = vec_size(&path)-1; i > 0; i--) {
 
         int next_hop_idx = i;
@@ -1984,6 +2204,13 @@ static bool n_request_path(void *nav_private, vec2_t xz_src, vec2_t xz_dest, int
         ff_id_t exist_id;
         struct flow_field ff;
 
+        /* A path passing through the same chunk more than once must update the 
+         * field from the earlier pass, so that one needs to be in the cache. 
+         */
+        if(n_path_field_pending(&work, chunk_coord)) {
+            n_path_fields_flush(&work);
+        }
+
         if(N_FC_GetDestFFMapping(priv->fieldcache, ret, chunk_coord, &exist_id)
         && N_FC_ContainsFlowField(priv->fieldcache, exist_id)) {
 
@@ -1998,7 +2225,9 @@ static bool n_request_path(void *nav_private, vec2_t xz_src, vec2_t xz_dest, int
             const struct flow_field *exist_ff  = N_FC_FlowFieldAt(priv->fieldcache, exist_id);
             memcpy(&ff, exist_ff, sizeof(struct flow_field));
 
+            uint64_t begin = SDL_GetPerformanceCounter();
             N_FlowFieldUpdate(chunk_coord, priv, faction_id, layer, target, priv->unit_query_ctx, &ff);
+            N_FC_RecordBuild(priv->fieldcache, FC_FIELD_FLOW, SDL_GetPerformanceCounter() - begin);
             /* We set the updated flow field for the new (least recently used) key. Since in 
              * this case more than one flowfield ID maps to the same field but we only keep 
              * one of the IDs, it may be possible that the same flowfield will be redundantly 
@@ -2013,15 +2242,34 @@ static bool n_request_path(void *nav_private, vec2_t xz_src, vec2_t xz_dest, int
         N_FC_PutDestFFMapping(priv->fieldcache, ret, chunk_coord, new_id);
         if(!N_FC_ContainsFlowField(priv->fieldcache, new_id)) {
 
-            N_FlowFieldInit(chunk_coord, &ff);
-            N_FlowFieldUpdate(chunk_coord, priv, faction_id, layer, target, priv->unit_query_ctx, &ff);
-            N_FC_PutFlowField(priv->fieldcache, new_id, &ff);
+            struct path_field_job *job = &work.jobs[work.njobs++];
+            job->chunk = chunk_coord;
+            job->target = target;
+            job->id = new_id;
         }
 
     ff_exists:
-        assert(N_FC_ContainsFlowField(priv->fieldcache, new_id));
+        /* Reference the cached fields of the path now, so that adding the 
+         * pending ones to the cache doesn't evict them before their use. 
+         */
+        if(N_FC_ContainsFlowField(priv->fieldcache, new_id)) {
+            (void)N_FC_FlowFieldAt(priv->fieldcache, new_id);
+        }
+        hops[nhops++] = (struct path_field_hop){chunk_coord, new_id};
+    }
+    n_path_fields_flush(&work);
+    PF_FREE(work.jobs);
+
+    /* The LOS fields are seamless across chunk borders, so each one is built from 
+     * its predecessor along the path, in order. */
+    struct coord prev_los_coord = (struct coord){dst_desc.chunk_r, dst_desc.chunk_c};
+    for(size_t i = 0; i < nhops; i++) {
+
+        struct coord chunk_coord = hops[i].chunk;
+
+        assert(N_FC_ContainsFlowField(priv->fieldcache, hops[i].id));
         /* Reference field in the cache */
-        (void)N_FC_FlowFieldAt(priv->fieldcache, new_id);
+        (void)N_FC_FlowFieldAt(priv->fieldcache, hops[i].id);
 
         if(!N_FC_ContainsLOSField(priv->fieldcache, ret, chunk_coord)) {
 
@@ -2034,38 +2282,71 @@ static bool n_request_path(void *nav_private, vec2_t xz_src, vec2_t xz_dest, int
             assert(prev_los->chunk.r == prev_los_coord.r && prev_los->chunk.c == prev_los_coord.c);
 
             struct LOS_field lf;
+            uint64_t begin = SDL_GetPerformanceCounter();
             N_LOSFieldCreate(ret, chunk_coord, dst_desc, priv, map_pos, priv->unit_query_ctx, &lf, prev_los);
+            N_FC_RecordBuild(priv->fieldcache, FC_FIELD_LOS, SDL_GetPerformanceCounter() - begin);
             N_FC_PutLOSField(priv->fieldcache, ret, chunk_coord, &lf);
         }
 
         prev_los_coord = chunk_coord;
     }
+    PF_FREE(hops);
     vec_portal_destroy(&path);
 
     *out_dest_id = ret; 
     PERF_RETURN(true);
 }
 
-static struct result field_task(void *arg)
+static bool n_request_path(void *nav_private, vec2_t xz_src, vec2_t xz_dest, int faction_id,
+                           vec3_t map_pos, enum nav_layer layer, dest_id_t *out_dest_id)
+{
+    n_update_dirty_local_islands(nav_private, layer);
+    n_update_all_edge_states(nav_private, layer);
+
+    return n_request_path_from(nav_private, xz_src, xz_dest, faction_id, 
+                               map_pos, layer, out_dest_id);
+}
+
+/* True if the fields already cached for the destination steer an entity standing on 
+ * 'tile' - the same conditions under which the lazy queries would not issue a request.
+ */
+static bool n_path_served(struct nav_private *priv, dest_id_t id, struct tile_desc tile)
 {
-    size_t *index = arg;
-    struct field_work_in *in = &vec_AT(&s_field_work.in, *index);
-    struct field_work_out *out = &vec_AT(&s_field_work.out, *index);
+    struct coord chunk = (struct coord){tile.chunk_r, tile.chunk_c};
+
+    ff_id_t ffid;
+    if(!N_FC_GetDestFFMapping(priv->fieldcache, id, chunk, &ffid))
+        return false;
 
-    N_FlowFieldInit(in->chunk, &out->field);
-    N_FlowFieldUpdate(in->chunk, in->priv, in->faction_id, in->layer, in->target, 
-        in->priv->unit_query_ctx, &out->field);
+    const struct flow_field *ff = N_FC_FlowFieldAt(priv->fieldcache, ffid);
+    if(!ff || N_FlowDirAt(ff, tile.tile_r, tile.tile_c) == FD_NONE)
+        return false;
 
-    return NULL_RESULT;
+    return N_FC_ContainsLOSField(priv->fieldcache, id, chunk);
 }
 
-static void field_join_work(void)
+static int compare_batch_srcs(const void *a, const void *b)
 {
-    for(int i = 0; i < s_field_work.ntasks; i++) {
-        while(!Sched_FutureIsReady(&s_field_work.futures[i])) {
-            Sched_RunSync(s_field_work.tids[i]);
-            Sched_TryYield();
-        }
+    const struct batch_src *sa = a, *sb = b;
+    if(sa->dist != sb->dist)
+        return (sa->dist < sb->dist) ? 1 : -1;
+    if(sa->key != sb->key)
+        return (sa->key < sb->key) ? -1 : 1;
+    return 0;
+}
+
+static void field_work(int begin_idx, int end_idx, void *arg)
+{
+    for(int i = begin_idx; i < end_idx; i++) {
+
+        struct field_work_in *in = &vec_AT(&s_field_work.in, i);
+        struct field_work_out *out = &vec_AT(&s_field_work.out, i);
+
+        uint64_t begin = SDL_GetPerformanceCounter();
+        N_FlowFieldInit(in->chunk, &out->field);
+        N_FlowFieldUpdate(in->chunk, in->priv, in->faction_id, in->layer, in->target, 
+            in->priv->unit_query_ctx, &out->field);
+        out->pc_delta = SDL_GetPerformanceCounter() - begin;
     }
 }
 
@@ -2205,15 +2486,16 @@ void N_Update(void *nav_private)
     PERF_RETURN_VOID();
 }
 
-void N_ApplyDeferredInvalidations(void)
+void N_ApplyDeferredInvalidations(void *nav_private)
 {
+    struct nav_private *priv = nav_private;
     struct fieldcache_ctx *fc = N_FC_GetSingleton();
     N_FC_InvalidateDynamicSurroundFields(fc);
 
     for(int i = 0; i < vec_size(&s_pending_inval); i++) {
 
         const struct fc_inval_cmd *cmd = &vec_AT(&s_pending_inval, i);
-        N_FC_InvalidateAllAtChunk(fc, cmd->chunk, cmd->layer);
+        N_FC_RepairAllAtChunk(fc, priv, cmd->chunk, cmd->layer);
         N_FC_InvalidateNeighbourEnemySeekFields(fc, cmd->width, cmd->height,
             cmd->chunk, cmd->layer);
         if(cmd->through)
@@ -2224,7 +2506,6 @@ void N_ApplyDeferredInvalidations(void)
 
 void N_Shutdown(void)
 {
-    field_join_work();
     N_FC_ShutdownSingleton();
     vec_inval_destroy(&s_pending_inval);
     vec_crange_destroy(&s_pub_ranges);
@@ -2233,7 +2514,8 @@ void N_Shutdown(void)
 
 void N_ClearState(void)
 {
-    field_join_work();
+    vec_in_reset(&s_field_work.in);
+    s_field_work.nwork = 0;
 }
 
 void N_DestroyCtx(void *nav_private)
@@ -2612,7 +2894,7 @@ void N_RenderPathFlowField(void *nav_private, const struct map *map,
             square_x - square_x_len / 2.0f,
             square_z + square_z_len / 2.0f
         };
-        dirs_buff[r * FIELD_RES_C + c] = N_FlowDir(ff->field[r][c].dir_idx);
+        dirs_buff[r * FIELD_RES_C + c] = N_FlowDir(N_FlowDirAt(ff, r, c));
     }}
 
     size_t count = FIELD_RES_R * FIELD_RES_C;
@@ -2667,7 +2949,7 @@ void N_RenderLOSField(void *nav_private, const struct map *map, mat4x4_t *chunk_
         *corners_base++ = (vec2_t){square_x - square_x_len, square_z + square_z_len};
         *corners_base++ = (vec2_t){square_x - square_x_len, square_z};
 
-        *colors_base++ = lf->field[r][c].visible ? (vec3_t){1.0f, 1.0f, 0.0f}
+        *colors_base++ = N_LOSVisible(lf, r, c) ? (vec3_t){1.0f, 1.0f, 0.0f}
                                                  : (vec3_t){0.0f, 0.0f, 0.0f};
     }}
 
@@ -2736,14 +3018,14 @@ void N_RenderEnemySeekField(void *nav_private, const struct map *map, mat4x4_t *
             square_x - square_x_len / 2.0f,
             square_z + square_z_len / 2.0f
         };
-        dirs_buff[r * FIELD_RES_C + c] = N_FlowDir(ff->field[r][c].dir_idx);
+        dirs_buff[r * FIELD_RES_C + c] = N_FlowDir(N_FlowDirAt(ff, r, c));
 
         *corners_base++ = (vec2_t){square_x, square_z};
         *corners_base++ = (vec2_t){square_x, square_z + square_z_len};
         *corners_base++ = (vec2_t){square_x - square_x_len, square_z + square_z_len};
         *corners_base++ = (vec2_t){square_x - square_x_len, square_z};
 
-        *colors_base++ = ff->field[r][c].dir_idx == FD_NONE ? (vec3_t){1.0f, 0.0f, 0.0f}
+        *colors_base++ = N_FlowDirAt(ff, r, c) == FD_NONE ? (vec3_t){1.0f, 0.0f, 0.0f}
                                                             : (vec3_t){0.0f, 1.0f, 0.0f};
     }}
 
@@ -2818,7 +3100,7 @@ void N_RenderGroupArrivalField(void *nav_private, vec3_t map_pos, mat4x4_t *chun
         bool has_flow = false;
         for(int r = 0; ff && r < FIELD_RES_R && !has_flow; r++) {
         for(int c = 0; c < FIELD_RES_C && !has_flow; c++) {
-            if(ff->field[r][c].dir_idx != FD_NONE)
+            if(N_FlowDirAt(ff, r, c) != FD_NONE)
                 has_flow = true;
         }}
         if(!has_flow)
@@ -2848,7 +3130,7 @@ void N_RenderGroupArrivalField(void *nav_private, vec3_t map_pos, mat4x4_t *chun
             square_x - square_x_len / 2.0f,
             square_z + square_z_len / 2.0f
         };
-        dirs_buff[r * FIELD_RES_C + c] = ff ? N_FlowDir(ff->field[r][c].dir_idx)
+        dirs_buff[r * FIELD_RES_C + c] = ff ? N_FlowDir(N_FlowDirAt(ff, r, c))
                                             : (vec2_t){0.0f, 0.0f};
 
         /* Blue: cost-zero sinks (open goal tiles). Red: blocked or impassable tiles,
@@ -2859,14 +3141,14 @@ void N_RenderGroupArrivalField(void *nav_private, vec3_t map_pos, mat4x4_t *chun
          */
         vec3_t color;
         bool draw = true;
-        if(ff && ff->field[r][c].dir_idx == FD_NONE) {
+        if(ff && N_FlowDirAt(ff, r, c) == FD_NONE) {
             struct tile_desc td = {.chunk_r = chunk_r, .chunk_c = chunk_c,
                                    .tile_r = r, .tile_c = c};
             color = n_tile_blocked((struct nav_private*)nav_private, layer, td)
                   ? (vec3_t){1.0f, 0.0f, 0.0f}
                   : (vec3_t){0.0f, 0.0f, 1.0f};
         }
-        else if(lf && lf->field[r][c].visible)
+        else if(lf && N_LOSVisible(lf, r, c))
             color = (vec3_t){1.0f, 1.0f, 0.0f};
         else if(ff)
             color = (vec3_t){0.0f, 1.0f, 0.0f};
@@ -2952,7 +3234,7 @@ void N_RenderSurroundField(void *nav_private, const struct map *map, mat4x4_t *c
             square_x - square_x_len / 2.0f,
             square_z + square_z_len / 2.0f
         };
-        dirs_buff[r * FIELD_RES_C + c] = N_FlowDir(ff->field[r][c].dir_idx);
+        dirs_buff[r * FIELD_RES_C + c] = N_FlowDir(N_FlowDirAt(ff, r, c));
     }}
 
     size_t count = FIELD_RES_R * FIELD_RES_C;
@@ -3314,7 +3596,8 @@ void N_RenderNavigationPortals(void *nav_private, const struct map *map,
 
             float cost;
             bool has_path = AStar_GridPath(priv->fieldcache, a, b, 
-                (struct coord){chunk_r, chunk_c}, chunk->cost_base, layer, &path, &cost);
+                (struct coord){chunk_r, chunk_c}, chunk->cost_base, layer, GRID_PATH_JPS, 
+                &path, &cost);
             assert(has_path);
             n_render_grid_path(chunk, chunk_model, map, &path, link_color);
         }
@@ -3364,6 +3647,65 @@ void N_UpdateIslandsField(void *nav_private)
     }
 }
 
+uint64_t N_BakeKey(void *nav_private)
+{
+    PERF_ENTER();
+
+    struct nav_private *priv = nav_private;
+    const uint64_t layout[] = {
+        NAV_BAKE_VERSION, 
+        priv->width, 
+        priv->height, 
+        NAV_LAYER_MAX, 
+        sizeof(struct nav_chunk)
+    };
+    uint64_t ret = AssetCache_HashBytes(ASSET_CACHE_HASH_SEED, layout, sizeof(layout));
+
+    for(int layer = 0; layer < NAV_LAYER_MAX; layer++) {
+        for(size_t i = 0; i < priv->width * priv->height; i++) {
+            const struct nav_chunk *chunk = &priv->chunks[layer][i];
+            ret = AssetCache_HashBytes(ret, chunk->cost_base, sizeof(chunk->cost_base));
+        }
+    }
+    PERF_RETURN(ret);
+}
+
+bool N_LoadBake(void *nav_private, uint64_t key)
+{
+    PERF_ENTER();
+
+    size_t nspans;
+    struct nav_cache_span *spans = n_bake_spans(nav_private, &nspans);
+    if(!spans)
+        PERF_RETURN(false);
+
+    bool ret = AssetCache_NavLoad(key, spans, nspans);
+    PF_FREE(spans);
+
+    if(ret) {
+        /* The island extents index is not part of the baked data */
+        for(int i = 0; i < NAV_LAYER_MAX; i++) {
+            n_index_islands(nav_private, i);
+        }
+        N_PublishLive(nav_private);
+    }
+    PERF_RETURN(ret);
+}
+
+bool N_StoreBake(void *nav_private, uint64_t key)
+{
+    PERF_ENTER();
+
+    size_t nspans;
+    struct nav_cache_span *spans = n_bake_spans(nav_private, &nspans);
+    if(!spans)
+        PERF_RETURN(false);
+
+    bool ret = AssetCache_NavStore(key, spans, nspans);
+    PF_FREE(spans);
+    PERF_RETURN(ret);
+}
+
 dest_id_t N_DestIDForPos(void *nav_private, vec3_t map_pos, vec2_t xz_pos, enum nav_layer layer)
 {
     struct tile_desc td;
@@ -3398,6 +3740,93 @@ bool N_RequestPathAttacking(void *nav_private, vec2_t xz_src, vec2_t xz_dest,
                           map_pos, layer, out_dest_id);
 }
 
+size_t N_RequestPathsBatch(void *nav_private, dest_id_t id, vec2_t xz_dest, 
+                           const vec2_t *xz_srcs, size_t nsrcs, vec3_t map_pos, 
+                           bool *out_found)
+{
+    PERF_ENTER();
+
+    if(nsrcs == 0)
+        PERF_RETURN(0);
+
+    struct nav_private *priv = nav_private;
+    enum nav_layer layer = N_DestLayer(id);
+    int faction_id = N_DestFactionID(id);
+
+    struct map_resolution res;
+    N_GetResolution(priv, &res);
+
+    struct tile_desc dst_desc;
+    bool result = M_Tile_DescForPoint2D(res, map_pos, xz_dest, &dst_desc);
+    assert(result);
+    (void)result;
+
+    STALLOC(struct batch_src, srcs, nsrcs);
+    for(size_t i = 0; i < nsrcs; i++) {
+
+        struct tile_desc td;
+        result = M_Tile_DescForPoint2D(res, map_pos, xz_srcs[i], &td);
+        assert(result);
+
+        const struct nav_chunk *chunk = &priv->chunks[layer][IDX(td.chunk_r, priv->width, td.chunk_c)];
+        srcs[i] = (struct batch_src){
+            .key = ((uint64_t)td.chunk_r << 48) 
+                 | ((uint64_t)td.chunk_c << 32)
+                 | ((uint64_t)chunk->islands[td.tile_r][td.tile_c] << 16)
+                 | ((uint64_t)chunk->local_islands[td.tile_r][td.tile_c] << 0),
+            .dist = abs(td.chunk_r - dst_desc.chunk_r) + abs(td.chunk_c - dst_desc.chunk_c),
+            .idx = i
+        };
+    }
+
+    /* Serve the sources furthest from the destination first. The fields laid down 
+     * along their paths then already steer most of the nearer sources, which are 
+     * skipped without a search of their own. Sorting also makes sources with 
+     * the same key adjacent, so each distinct key is resolved only once.
+     */
+    qsort(srcs, nsrcs, sizeof(struct batch_src), compare_batch_srcs);
+
+    bool prepared = false;
+    bool found = false;
+    size_t ret = 0;
+
+    for(size_t i = 0; i < nsrcs; i++) {
+
+        const vec2_t xz_src = xz_srcs[srcs[i].idx];
+
+        if(i == 0 || srcs[i].key != srcs[i - 1].key) {
+
+            struct tile_desc td;
+            M_Tile_DescForPoint2D(res, map_pos, xz_src, &td);
+
+            if(n_path_served(priv, id, td)) {
+                found = true;
+            }else{
+                /* The island and edge state updates walk the entire layer - only 
+                 * pay for them when there is a path to compute.
+                 */
+                if(!prepared) {
+                    n_update_dirty_local_islands(priv, layer);
+                    n_update_all_edge_states(priv, layer);
+                    prepared = true;
+                }
+                dest_id_t dest;
+                found = n_request_path_from(priv, xz_src, xz_dest, faction_id, 
+                    map_pos, layer, &dest);
+                assert(!found || dest == id);
+            }
+        }
+
+        if(out_found) {
+            out_found[srcs[i].idx] = found;
+        }
+        ret += found;
+    }
+
+    STFREE(srcs);
+    PERF_RETURN(ret);
+}
+
 /* Bilinearly blend the flow directions of the four tiles bracketing 'curr_pos', so a
  * unit straddling a discontinuity in the quantised field (the cardinal-first staircase)
  * follows the averaged heading rather than snapping onto a single-tile lane. Samples on
@@ -3448,7 +3877,7 @@ static vec2_t n_interpolated_flow_dir(struct nav_private *priv, dest_id_t id,
                 continue;
         }
 
-        enum flow_dir dir = ff->field[td.tile_r][td.tile_c].dir_idx;
+        enum flow_dir dir = N_FlowDirAt(ff, td.tile_r, td.tile_c);
         if(dir == FD_NONE)
             continue;
 
@@ -3459,7 +3888,7 @@ static vec2_t n_interpolated_flow_dir(struct nav_private *priv, dest_id_t id,
     }
 
     if(wsum < 1e-6f || PFM_Vec2_Len(&acc) < 1e-6f)
-        return N_FlowDir(base_ff->field[base_tile.tile_r][base_tile.tile_c].dir_idx);
+        return N_FlowDir(N_FlowDirAt(base_ff, base_tile.tile_r, base_tile.tile_c));
 
     PFM_Vec2_Normal(&acc, &acc);
     return acc;
@@ -3492,7 +3921,7 @@ vec2_t N_DesiredPointSeekVelocity(dest_id_t id, vec2_t curr_pos, vec2_t xz_dest,
     }
 
     const struct flow_field *ff = N_FC_FlowFieldAt(priv->fieldcache, ffid);
-    if(!ff || ff->field[tile.tile_r][tile.tile_c].dir_idx == FD_NONE) {
+    if(!ff || N_FlowDirAt(ff, tile.tile_r, tile.tile_c) == FD_NONE) {
 
         dest_id_t ret;
         bool result = n_request_path(nav_private, curr_pos, xz_dest, 
@@ -3512,7 +3941,7 @@ vec2_t N_DesiredPointSeekVelocity(dest_id_t id, vec2_t curr_pos, vec2_t xz_dest,
      *      would have updated the flow field with a valid direction for
      *      the current tile.
      */
-    if(ff->field[tile.tile_r][tile.tile_c].dir_idx != FD_NONE)
+    if(N_FlowDirAt(ff, tile.tile_r, tile.tile_c) != FD_NONE)
         goto ff_found;
 
     const struct nav_chunk *chunk = 
@@ -3588,7 +4017,7 @@ bool N_DesiredGroupArrivalVelocity(vec2_t curr_pos, void *nav_private, enum nav_
     if(!ff)
         return false;
 
-    enum flow_dir dir = ff->field[tile.tile_r][tile.tile_c].dir_idx;
+    enum flow_dir dir = N_FlowDirAt(ff, tile.tile_r, tile.tile_c);
     *out_vel = N_FlowDir(dir);
 
     /* A sink (no outgoing direction) within the disc is an open arrival slot. */
@@ -3628,8 +4057,10 @@ vec2_t N_DesiredEnemySeekVelocity(vec2_t curr_pos, void *nav_private, enum nav_l
 
     if(!N_FC_ContainsFlowField(priv->fieldcache, ffid)) {
 
+        uint64_t begin = SDL_GetPerformanceCounter();
         N_FlowFieldInit(chunk, &ff);
         N_FlowFieldUpdate(chunk, priv, faction_id, layer, target, priv->unit_query_ctx, &ff);
+        N_FC_RecordBuild(priv->fieldcache, FC_FIELD_FLOW, SDL_GetPerformanceCounter() - begin);
         N_FC_PutFlowField(priv->fieldcache, ffid, &ff);
 
         assert(N_FC_ContainsFlowField(priv->fieldcache, ffid));
@@ -3641,7 +4072,7 @@ vec2_t N_DesiredEnemySeekVelocity(vec2_t curr_pos, void *nav_private, enum nav_l
     const struct nav_chunk *nchunk = 
         &priv->chunks[layer][IDX(curr_tile.chunk_r, priv->width, curr_tile.chunk_c)];
     uint16_t local_iid = nchunk->local_islands[curr_tile.tile_r][curr_tile.tile_c];
-    int dir_idx = pff->field[curr_tile.tile_r][curr_tile.tile_c].dir_idx;
+    int dir_idx = N_FlowDirAt(pff, curr_tile.tile_r, curr_tile.tile_c);
 
     if(dir_idx != FD_NONE)
         goto ff_found;
@@ -3668,7 +4099,7 @@ vec2_t N_DesiredEnemySeekVelocity(vec2_t curr_pos, void *nav_private, enum nav_l
     /* We are on an island that is cut off by blockers or impassable terrain from any 
      * valid enemies - do our best to get as close to the 'action' as possible.
      */
-    dir_idx = pff->field[curr_tile.tile_r][curr_tile.tile_c].dir_idx;
+    dir_idx = N_FlowDirAt(pff, curr_tile.tile_r, curr_tile.tile_c);
     if(dir_idx == FD_NONE) {
 
         struct flow_field exist_ff = *pff;
@@ -3680,7 +4111,7 @@ vec2_t N_DesiredEnemySeekVelocity(vec2_t curr_pos, void *nav_private, enum nav_l
     }
 
 ff_found:
-    dir_idx = pff->field[curr_tile.tile_r][curr_tile.tile_c].dir_idx;
+    dir_idx = N_FlowDirAt(pff, curr_tile.tile_r, curr_tile.tile_c);
     PERF_RETURN(N_FlowDir(dir_idx));
 }
 
@@ -3711,8 +4142,10 @@ vec2_t N_DesiredSurroundVelocity(vec2_t curr_pos, void *nav_private, enum nav_la
 
     if(!N_FC_ContainsFlowField(priv->fieldcache, ffid)) {
 
+        uint64_t begin = SDL_GetPerformanceCounter();
         N_FlowFieldInit(chunk, &ff);
         N_FlowFieldUpdate(chunk, priv, faction_id, layer, target, priv->unit_query_ctx, &ff);
+        N_FC_RecordBuild(priv->fieldcache, FC_FIELD_FLOW, SDL_GetPerformanceCounter() - begin);
         N_FC_PutFlowField(priv->fieldcache, ffid, &ff);
 
         assert(N_FC_ContainsFlowField(priv->fieldcache, ffid));
@@ -3724,7 +4157,7 @@ vec2_t N_DesiredSurroundVelocity(vec2_t curr_pos, void *nav_private, enum nav_la
     const struct nav_chunk *nchunk = 
         &priv->chunks[layer][IDX(curr_tile.chunk_r, priv->width, curr_tile.chunk_c)];
     uint16_t local_iid = nchunk->local_islands[curr_tile.tile_r][curr_tile.tile_c];
-    int dir_idx = pff->field[curr_tile.tile_r][curr_tile.tile_c].dir_idx;
+    int dir_idx = N_FlowDirAt(pff, curr_tile.tile_r, curr_tile.tile_c);
 
     /* The entity has somehow ended up on an impassable tile. One example
      * where this can happen is if an adjacent entity 'stops' and occupies 
@@ -3748,7 +4181,7 @@ vec2_t N_DesiredSurroundVelocity(vec2_t curr_pos, void *nav_private, enum nav_la
     /* We are on an island that is cut off by blockers or impassable terrain from any 
      * valid enemies - do our best to get as close to the 'action' as possible.
      */
-    dir_idx = pff->field[curr_tile.tile_r][curr_tile.tile_c].dir_idx;
+    dir_idx = N_FlowDirAt(pff, curr_tile.tile_r, curr_tile.tile_c);
     if(dir_idx == FD_NONE) {
 
         struct flow_field exist_ff = *pff;
@@ -3760,7 +4193,7 @@ vec2_t N_DesiredSurroundVelocity(vec2_t curr_pos, void *nav_private, enum nav_la
     }
 
 ff_found:
-    dir_idx = pff->field[curr_tile.tile_r][curr_tile.tile_c].dir_idx;
+    dir_idx = N_FlowDirAt(pff, curr_tile.tile_r, curr_tile.tile_c);
     PERF_RETURN(N_FlowDir(dir_idx));
 }
 
@@ -3815,17 +4248,10 @@ void N_RequestAsyncEnemySeekField(vec2_t curr_pos, void *nav_private, enum nav_l
         .target = target,
         .faction_id = faction_id,
         .layer = layer,
-        .id = ffid
+        .id = ffid,
+        .requester = N_FC_GetRequester(priv->fieldcache)
     });
-    size_t *arg = stalloc(&s_field_work.mem, sizeof(size_t));
-    *arg = s_field_work.nwork++;
-
-    SDL_AtomicSet(&s_field_work.futures[s_field_work.ntasks].status, FUTURE_INCOMPLETE);
-    s_field_work.tids[s_field_work.ntasks] = Sched_Create(1, field_task, arg, 
-        "nav::field_task", &s_field_work.futures[s_field_work.ntasks], TASK_BIG_STACK);
-    if(s_field_work.tids[s_field_work.ntasks] != NULL_TID) {
-        s_field_work.ntasks++;
-    }
+    s_field_work.nwork++;
 }
 
 void N_RequestAsyncSurroundField(vec2_t curr_pos, void *nav_private, enum nav_layer layer,
@@ -3869,17 +4295,10 @@ void N_RequestAsyncSurroundField(vec2_t curr_pos, void *nav_private, enum nav_la
         .target = target,
         .faction_id = faction_id,
         .layer = layer,
-        .id = ffid
+        .id = ffid,
+        .requester = N_FC_GetRequester(priv->fieldcache)
     });
-    size_t *arg = stalloc(&s_field_work.mem, sizeof(size_t));
-    *arg = s_field_work.nwork++;
-
-    SDL_AtomicSet(&s_field_work.futures[s_field_work.ntasks].status, FUTURE_INCOMPLETE);
-    s_field_work.tids[s_field_work.ntasks] = Sched_Create(1, field_task, arg, 
-        "nav::field_task", &s_field_work.futures[s_field_work.ntasks], TASK_BIG_STACK);
-    if(s_field_work.tids[s_field_work.ntasks] != NULL_TID) {
-        s_field_work.ntasks++;
-    }
+    s_field_work.nwork++;
 }
 
 static void request_zone_field_chunk(struct nav_private *priv, struct coord chunk,
@@ -3905,17 +4324,10 @@ static void request_zone_field_chunk(struct nav_private *priv, struct coord chun
         .target = target,
         .faction_id = 0,
         .layer = layer,
-        .id = ffid
+        .id = ffid,
+        .requester = N_FC_GetRequester(priv->fieldcache)
     });
-    size_t *arg = stalloc(&s_field_work.mem, sizeof(size_t));
-    *arg = s_field_work.nwork++;
-
-    SDL_AtomicSet(&s_field_work.futures[s_field_work.ntasks].status, FUTURE_INCOMPLETE);
-    s_field_work.tids[s_field_work.ntasks] = Sched_Create(1, field_task, arg,
-        "nav::field_task", &s_field_work.futures[s_field_work.ntasks], TASK_BIG_STACK);
-    if(s_field_work.tids[s_field_work.ntasks] != NULL_TID) {
-        s_field_work.ntasks++;
-    }
+    s_field_work.nwork++;
 }
 
 void N_RequestAsyncGroupArrivalField(vec2_t centre_pos, void *nav_private, enum nav_layer layer,
@@ -3957,15 +4369,19 @@ void N_RequestAsyncGroupArrivalField(vec2_t centre_pos, void *nav_private, enum
 
 void N_AwaitAsyncFields(void)
 {
-    field_join_work();
-    for(int i = 0; i < s_field_work.ntasks; i++) {
+    Sched_ParallelFor(0, s_field_work.nwork, 1, field_work, NULL, TASK_BIG_STACK);
+    for(int i = 0; i < s_field_work.nwork; i++) {
         struct field_work_in *in = &vec_AT(&s_field_work.in, i);
         struct field_work_out *out = &vec_AT(&s_field_work.out, i);
+
+        /* Attribute the build to whoever requested the field */
+        enum fc_requester prev = N_FC_SetRequester(in->requester);
+        N_FC_RecordBuild(in->priv->fieldcache, FC_FIELD_FLOW, out->pc_delta);
+        N_FC_SetRequester(prev);
         N_FC_PutFlowField(in->priv->fieldcache, in->id, &out->field);
     }
     stalloc_clear(&s_field_work.mem);
     s_field_work.nwork = 0;
-    s_field_work.ntasks = 0;
 }
 
 void N_InvalidateZoneFieldsAt(void *nav_private, vec3_t map_pos, vec2_t xz_pos,
@@ -4049,7 +4465,7 @@ bool N_HasDestLOS(dest_id_t id, vec2_t curr_pos, void *nav_private, vec3_t map_p
 
     const struct LOS_field *lf = N_FC_LOSFieldAt(priv->fieldcache, id, chunk);
     assert(lf);
-    return lf->field[tile.tile_r][tile.tile_c].visible;
+    return N_LOSVisible(lf, tile.tile_r, tile.tile_c);
 }
 
 bool N_PositionPathable(vec2_t xz_pos, enum nav_layer layer, void *nav_private, vec3_t map_pos)
@@ -38,6 +38,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <float.h>
 #include "../game/public/game.h" /* MAX_FACTIONS */
 
@@ -47,6 +48,7 @@
 #define COST_IMPASSABLE       0xff
 #define ISLAND_NONE           0xffff
 #define FACTION_ID_NONE       0xf
+#define MAX_ISLAND_EXTENTS    16
 
 /* portal_travel_costs are octile distances within a chunk (max ~5800), stored as
  * 16-bit fixed-point with 3 fractional bits; UNREACHABLE is the 'no path' sentinel. */
@@ -115,9 +117,22 @@ struct portal{
     portal_ref        connected;
 };
 
+/* The bounding box of the tiles of one global island within a chunk. */
+struct island_extent{
+    uint16_t iid;
+    uint8_t  rmin, cmin;
+    uint8_t  rmax, cmax;
+};
+
 struct nav_chunk{
     size_t          num_portals; 
     struct portal   portals[MAX_PORTALS_PER_CHUNK];
+    /* All-pairs table of the costs of moving between the centers of two 
+     * portals of this chunk, without leaving it. This is FLT_MAX if there 
+     * is no such path or if the edge between the portals is blocked. It 
+     * mirrors the portal edges and is refreshed along with their states.
+     */
+    float           portal_dists[MAX_PORTALS_PER_CHUNK][MAX_PORTALS_PER_CHUNK];
     /* The per-tile cost of traversal. Tiles with 'COST_IMPASSABLE'
      * cost may never be reached.
      */
@@ -146,6 +161,14 @@ struct nav_chunk{
      * (shared by all chunks)
      */
     uint16_t        islands[FIELD_RES_R][FIELD_RES_C];
+    /* Spatial index of the 'islands' field: the extent of every global 
+     * island (ISLAND_NONE included) present in the chunk. Chunks with 
+     * more distinct islands than fit are flagged as overflowing and 
+     * have to be scanned in full.
+     */
+    uint8_t         num_island_extents;
+    bool            island_extents_overflow;
+    struct island_extent island_extents[MAX_ISLAND_EXTENTS];
     /* This field uses chunk-local island IDs and accounts for
      * the blockers, but does not account for any part of the
      * map outside the local chunk. This field is synchronized
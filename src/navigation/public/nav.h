@@ -61,6 +61,7 @@ struct fc_stats{
     unsigned flow_max;
     float    flow_hit_rate;
     unsigned flow_invalidated;
+    unsigned flow_repaired;
     unsigned ffid_used;
     unsigned ffid_max;
     float    ffid_hit_rate;
@@ -69,6 +70,63 @@ struct fc_stats{
     float    grid_path_hit_rate;
 };
 
+enum fc_field_type{
+    FC_FIELD_LOS,
+    FC_FIELD_FLOW,
+    FC_FIELD_MAX,
+};
+
+/* The subsystem on whose behalf cached fields are being queried and built. */
+enum fc_requester{
+    FC_REQ_OTHER,
+    FC_REQ_MOVEMENT,
+    FC_REQ_FORMATION,
+    FC_REQ_ARRIVAL,
+    FC_REQ_COMBAT,
+    FC_REQ_MAX,
+};
+
+/* The field cache API through which fields were invalidated. */
+enum fc_inval_cause{
+    FC_INVAL_CHUNK,
+    FC_INVAL_REPAIR,
+    FC_INVAL_ZONE,
+    FC_INVAL_THROUGH_CHUNK,
+    FC_INVAL_ENEMY_SEEK,
+    FC_INVAL_SURROUND,
+    FC_INVAL_MAX,
+};
+
+#define FC_HIST_BUCKETS     (16)
+#define FC_INVAL_LOG_SIZE   (64)
+
+struct fc_inval_event{
+    uint32_t tick_ms;
+    uint16_t chunk_r, chunk_c;
+    uint8_t  layer;
+    uint8_t  cause;
+    uint16_t nremoved;
+};
+
+/* Detailed field cache counters, meant for tuning the cache sizes and the 
+ * invalidation policy. The histograms have power-of-two buckets: bucket 0 
+ * counts the zero samples and bucket i counts the ones in [2^(i-1), 2^i), 
+ * with the last bucket being open-ended. Eviction ages are only recorded 
+ * for a sample of the fields.
+ */
+struct fc_telemetry{
+    unsigned build_us[FC_FIELD_MAX][FC_HIST_BUCKETS];
+    unsigned evict_age_ms[FC_FIELD_MAX][FC_HIST_BUCKETS];
+    unsigned invalidated[FC_FIELD_MAX][FC_INVAL_MAX];
+    unsigned query[FC_REQ_MAX][FC_FIELD_MAX];
+    unsigned hit[FC_REQ_MAX][FC_FIELD_MAX];
+    unsigned built[FC_REQ_MAX][FC_FIELD_MAX];
+    /* A ring of the most recent invalidations, with 'ninval_events' 
+     * counting all of them */
+    unsigned ninval_events;
+    struct fc_inval_event inval_events[FC_INVAL_LOG_SIZE];
+};
+
 /* Pathfinding happens on a per-layer basis. Each layer has 
  * its' own view of the navigation state. For example, passages
  * that are blocked for 3x3 units may not be blocked for 1x1 
@@ -324,6 +382,24 @@ void      N_UpdatePortals(void *nav_private);
  */
 void      N_UpdateIslandsField(void *nav_private);
 
+/* ------------------------------------------------------------------------
+ * Returns a hash of the current cost fields of all the layers. This is 
+ * the content from which the portals and islands are baked, so it keys 
+ * the persisted bake.
+ * ------------------------------------------------------------------------
+ */
+uint64_t  N_BakeKey(void *nav_private);
+
+/* ------------------------------------------------------------------------
+ * Restore the portals and islands of all the layers from the asset cache,
+ * in place of N_UpdatePortals and N_UpdateIslandsField. Returns false if 
+ * there is no valid entry for the key, in which case the data must be 
+ * baked (and can then be persisted with N_StoreBake).
+ * ------------------------------------------------------------------------
+ */
+bool      N_LoadBake(void *nav_private, uint64_t key);
+bool      N_StoreBake(void *nav_private, uint64_t key);
+
 /* ------------------------------------------------------------------------
  * Returns a unique ID that is used to associated all flow fields guiding 
  * to this (at tile granularity) position.
@@ -369,6 +445,18 @@ bool      N_RequestPathAttacking(void *nav_private, vec2_t xz_src,
                                  vec3_t map_pos, enum nav_layer layer, 
                                  dest_id_t *out_dest_id);
 
+/* ------------------------------------------------------------------------
+ * Makes sure the fields for the destination 'id' steer every one of the 
+ * 'nsrcs' source positions. Sources sharing a chunk and island are served 
+ * by a single path, and sources already covered by cached fields are not 
+ * searched for again. If 'out_found' is not NULL, it receives, per source, 
+ * whether a path exists. Returns the number of sources with a path.
+ * ------------------------------------------------------------------------
+ */
+size_t    N_RequestPathsBatch(void *nav_private, dest_id_t id, vec2_t xz_dest,
+                              const vec2_t *xz_srcs, size_t nsrcs, 
+                              vec3_t map_pos, bool *out_found);
+
 /* ------------------------------------------------------------------------
  * Returns the desired velocity for an entity at 'curr_pos' for it to flow
  * towards a particular destination.
@@ -671,10 +759,12 @@ void  N_PublishLive(void *nav_private);
 /* ------------------------------------------------------------------------
  * Applies the field-cache invalidation commands that N_Update accumulated
  * since the previous tick. Must run from the navigation tick task (it mutates
- * the task-owned field cache), as the first step of a tick's work.
+ * the task-owned field cache), as the first step of a tick's work. Flow fields
+ * of the affected chunks are repaired against the costs in 'nav_private'
+ * where possible, so it must be the same view that the task builds fields from.
  * ------------------------------------------------------------------------
  */
-void N_ApplyDeferredInvalidations(void);
+void N_ApplyDeferredInvalidations(void *nav_private);
 
 /* ------------------------------------------------------------------------
  * Registers a callback returning the tid of the navigation tick task. The
@@ -683,6 +773,30 @@ void N_ApplyDeferredInvalidations(void);
  */
 void N_FC_SetNavTaskTIDProvider(uint32_t (*provider)(void));
 
+/* ------------------------------------------------------------------------
+ * Attributes the subsequent field cache queries and field builds to the
+ * specified subsystem, returning the previous one. Must be called from the 
+ * navigation tick task.
+ * ------------------------------------------------------------------------
+ */
+enum fc_requester N_FC_SetRequester(enum fc_requester requester);
+
+/* ------------------------------------------------------------------------
+ * Get a snapshot of the detailed field cache counters, as of the last 
+ * N_FC_PublishTelemetry call. These are also written to the perf trace 
+ * captures. They are reset along with the other field cache stats.
+ * Safe to call from any thread.
+ * ------------------------------------------------------------------------
+ */
+void N_FC_GetTelemetry(struct fc_telemetry *out);
+
+/* ------------------------------------------------------------------------
+ * Publish the current field cache counters for N_FC_GetTelemetry. Must be 
+ * called from the navigation task, at the end of its' tick.
+ * ------------------------------------------------------------------------
+ */
+void N_FC_PublishTelemetry(void);
+
 /* ------------------------------------------------------------------------
  * Creates an arbitrary-resolution flow field guiding to a set of tiles.
  * The 'out' array holds a (rdim * cdim) 2-dimensional row-major 
@@ -735,6 +849,21 @@ void N_GroupArrivalFieldCreate(void *nav_private, size_t rdim, size_t cdim,
  */
 vec2_t N_FlowDir(enum flow_dir dir);
 
+/* ------------------------------------------------------------------------
+ * Select between the bucket queue (default) and the binary heap for 
+ * building integration fields. Both produce identical flow fields.
+ * ------------------------------------------------------------------------
+ */
+void N_SetBucketIntegration(bool on);
+
+/* ------------------------------------------------------------------------
+ * Toggle guiding the portal graph search with a lower bound derived from 
+ * the chunk distance to the destination (A*) instead of searching in all 
+ * directions (Dijkstra). Both find a path of the least cost.
+ * ------------------------------------------------------------------------
+ */
+void N_SetPortalGraphHeuristic(bool on);
+
 /* ------------------------------------------------------------------------
  * Set the pointer to the state which is used for making unit queries
  * during field generation.
@@ -764,31 +893,31 @@ size_t N_CopyBlockersPacked(void *nav_private, void *out, size_t maxout);
 void N_PrepareAsyncWork(void);
 
 /* ------------------------------------------------------------------------
- * Await all the outstanding flow field computation jobs and place the
- * result in the fieldcache.
+ * Compute all the requested flow fields in parallel, taking part in the 
+ * work, and place the results in the fieldcache.
  * ------------------------------------------------------------------------
  */
 void N_AwaitAsyncFields(void);
 
 /* ------------------------------------------------------------------------
- * Start an async job computing the required TARGET_ENEMIES field, if it
- * is not in the cache and has not been started already.
+ * Queue a job computing the required TARGET_ENEMIES field, if it is not 
+ * in the cache and has not been queued already.
  * ------------------------------------------------------------------------
  */
 void N_RequestAsyncEnemySeekField(vec2_t curr_pos, void *nav_private, enum nav_layer layer,
                                   vec3_t map_pos, int faction_id);
 
 /* ------------------------------------------------------------------------
- * Start an async job computing the required TARGET_ENTITY field, if it
- * is not in the cache and has not been started already.
+ * Queue a job computing the required TARGET_ENTITY field, if it is not 
+ * in the cache and has not been queued already.
  * ------------------------------------------------------------------------
  */
 void N_RequestAsyncSurroundField(vec2_t curr_pos, void *nav_private, enum nav_layer layer,
                                  vec3_t map_pos, uint32_t ent, int faction_id);
 
 /* ------------------------------------------------------------------------
- * Start an async job computing the required TARGET_ZONE arrival field for a
- * flock, if it is not in the cache and has not been started already.
+ * Queue a job computing the required TARGET_ZONE arrival field for a
+ * flock, if it is not in the cache and has not been queued already.
  * ------------------------------------------------------------------------
  */
 void N_RequestAsyncGroupArrivalField(vec2_t centre_pos, void *nav_private, enum nav_layer layer,
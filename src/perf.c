@@ -38,6 +38,7 @@
 
 #include "perf.h"
 #include "main.h"
+#include "sched.h"
 #include "lib/public/khash.h"
 #include "lib/public/vec.h"
 #include "lib/public/pf_string.h"
@@ -52,6 +53,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <time.h>
 
 #if defined(__linux__) && !defined(NDEBUG)
 #include <linux/perf_event.h>
@@ -76,6 +78,9 @@
 #define GPU_STATE_KEY   UINT64_MAX
 #define GPU_TIMER_HZ    (1 * 1000 * 1000 * 1000)
 #define LOG_FREQUENCY   (60)
+#define MAX_STACK_USAGE (128)
+#define MAX_COUNTER_PROVIDERS (8)
+#define MAX_FRAME_COUNTERS    (32)
 
 #if defined(__linux__) && !defined(NDEBUG)
 enum {
@@ -101,6 +106,8 @@ struct perf_entry{
             }begin, end;
         };
     };
+    /* CPU entries only: performance counter value at the push */
+    uint64_t pc_begin;
     uint32_t parent_idx;
     uint32_t name_id;
 #if defined(__linux__) && !defined(NDEBUG)
@@ -146,6 +153,13 @@ struct perf_state{
     /* GPU-only: size of each tree slot when its cookies were last
      * scheduled for read. Prevents double-consume on wraparound. */
     size_t            last_read_size[NFRAMES_LOGGED];
+    /* Whether the tree index moved forward on the last tick. If not, 
+     * the oldest tree was already traced. */
+    bool              rotated;
+    /* Trace thread ID, and whether the thread name was already 
+     * written to the current trace. */
+    uint32_t          trace_tid;
+    bool              trace_named;
 #if defined(__linux__) && !defined(NDEBUG)
     /* perf_event_open group leader + 7 followers; opened lazily by the
      * thread itself on its first Perf_Push so the kernel attaches them
@@ -175,6 +189,31 @@ static struct gpu_mem_accounting s_gpu_accounting[NFRAMES_LOGGED];
 static uint32_t               s_gpu_stat_cookies[NFRAMES_LOGGED][PERF_GPU_STAT_COUNT];
 static bool                   s_gpu_stat_valid[NFRAMES_LOGGED];
 static struct gpu_frame_stats s_gpu_frame_stats[NFRAMES_LOGGED];
+static struct perf_sched_stats s_last_frames_schedstats[NFRAMES_LOGGED];
+static struct perf_counter    s_last_frames_counters[NFRAMES_LOGGED][MAX_FRAME_COUNTERS];
+static size_t                 s_last_frames_ncounters[NFRAMES_LOGGED];
+static perf_counter_provider_t s_counter_providers[MAX_COUNTER_PROVIDERS];
+static size_t                 s_ncounter_providers;
+static uint64_t               s_last_frames_begin_pc[NFRAMES_LOGGED];
+static uint32_t               s_next_trace_tid = 1;
+
+/* Streaming trace capture in the Chrome trace-event JSON format. 
+ * Frames are written out as they age out of the ring of logged frames 
+ * (when their GPU timestamps are available), so the capture lags 
+ * NFRAMES_LOGGED frames behind.
+ */
+static FILE                  *s_trace_file;
+static int                    s_trace_frames_left;
+static size_t                 s_trace_nevents;
+static uint64_t               s_trace_origin_pc;
+/* A pair of GPU and CPU clock samples taken at the same time. These are 
+ * written by the render thread, and may only be read once 'ready' is set.
+ */
+static uint64_t               s_trace_clock_gpu_ns;
+static uint64_t               s_trace_clock_cpu_pc;
+static SDL_atomic_t           s_trace_clock_ready;
+/* Mirrors 's_trace_file' for the other threads */
+static SDL_atomic_t           s_trace_active;
 
 /*****************************************************************************/
 /* STATIC FUNCTIONS                                                          */
@@ -383,6 +422,9 @@ static bool pstate_init(struct perf_state *out, const char *name)
     pf_strlcpy(out->name, name, sizeof(out->name));
     out->perf_tree_idx = 0;
     memset(out->last_read_size, 0, sizeof(out->last_read_size));
+    out->rotated = false;
+    out->trace_tid = s_next_trace_tid++;
+    out->trace_named = false;
 #if defined(__linux__) && !defined(NDEBUG)
     for(int i = 0; i < PE_COUNT; i++)
         out->hw_fds[i] = -1;
@@ -487,6 +529,201 @@ static void perf_log_call_graph(size_t nthreads, struct perf_info **infos)
     fflush(stdout);
 }
 
+static void trace_write_string(const char *str)
+{
+    fputc('"', s_trace_file);
+    for(const char *c = str; c && *c; c++) {
+        if(*c == '"' || *c == '\\') {
+            fputc('\\', s_trace_file);
+            fputc(*c, s_trace_file);
+        }else if((unsigned char)*c < 0x20) {
+            fprintf(s_trace_file, "\\u%04x", (unsigned char)*c);
+        }else{
+            fputc(*c, s_trace_file);
+        }
+    }
+    fputc('"', s_trace_file);
+}
+
+static void trace_begin_event(void)
+{
+    fputs(s_trace_nevents++ ? ",\n" : "\n", s_trace_file);
+}
+
+static double trace_us(uint64_t pc)
+{
+    return (double)((int64_t)(pc - s_trace_origin_pc)) * 1000000.0 / SDL_GetPerformanceFrequency();
+}
+
+static void trace_write_thread_name(const struct perf_state *ps)
+{
+    trace_begin_event();
+    fprintf(s_trace_file, "{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":", 
+        ps->trace_tid);
+    trace_write_string(ps->name);
+    fputs("}}", s_trace_file);
+}
+
+static void trace_write_cpu_tree(struct perf_state *ps, const vec_perf_t *tree)
+{
+    for(int i = 0; i < vec_size(tree); i++) {
+
+        const struct perf_entry *entry = &vec_AT(tree, i);
+        const char *name = name_for_id(ps, entry->name_id);
+        bool task = (0 == strncmp(name, "Task ", 5));
+        double ts = trace_us(entry->pc_begin);
+        double dur = entry->pc_delta * 1000000.0 / SDL_GetPerformanceFrequency();
+
+        trace_begin_event();
+        fputs("{\"ph\":\"X\",\"name\":", s_trace_file);
+        trace_write_string(name);
+        fprintf(s_trace_file, ",\"cat\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+            task ? "task" : "cpu", ps->trace_tid, ts, dur);
+
+#if defined(__linux__) && !defined(NDEBUG)
+        uint64_t cyc = entry->hw_counters[PE_CYCLES];
+        uint64_t ins = entry->hw_counters[PE_INSTR];
+        uint64_t br  = entry->hw_counters[PE_BRANCH];
+        uint64_t brm = entry->hw_counters[PE_BRANCH_MISS];
+        if(cyc) {
+            fprintf(s_trace_file, ",\"args\":{\"ipc\":%.2f,\"br_miss_pc\":%.2f}",
+                (float)ins / cyc, br ? 100.0f * brm / br : 0.0f);
+        }
+#endif
+        fputc('}', s_trace_file);
+
+        /* A task span ends whenever the task's fiber is switched out, 
+         * either because it finished or because it blocked or yielded. */
+        if(task) {
+            trace_begin_event();
+            fprintf(s_trace_file, "{\"ph\":\"i\",\"s\":\"t\",\"name\":\"fiber switch\","
+                "\"cat\":\"task\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}",
+                ps->trace_tid, ts + dur);
+        }
+    }
+}
+
+static void trace_write_gpu_tree(struct perf_state *ps, const vec_perf_t *tree)
+{
+    if(!SDL_AtomicGet(&s_trace_clock_ready))
+        return;
+    SDL_MemoryBarrierAcquire();
+
+    double base = trace_us(s_trace_clock_cpu_pc);
+    for(int i = 0; i < vec_size(tree); i++) {
+
+        const struct perf_entry *entry = &vec_AT(tree, i);
+        if(entry->begin.gpu_ts == 0 || entry->end.gpu_ts < entry->begin.gpu_ts)
+            continue;
+
+        double ts = base + ((int64_t)(entry->begin.gpu_ts - s_trace_clock_gpu_ns)) / 1000.0;
+        double dur = (entry->end.gpu_ts - entry->begin.gpu_ts) / 1000.0;
+
+        trace_begin_event();
+        fputs("{\"ph\":\"X\",\"name\":", s_trace_file);
+        trace_write_string(name_for_id(ps, entry->name_id));
+        fprintf(s_trace_file, ",\"cat\":\"gpu\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+            ps->trace_tid, ts, dur);
+    }
+}
+
+static void trace_write_counters(int frame_idx)
+{
+    const struct perf_mem_stats *mem = &s_last_frames_memstats[frame_idx];
+    const struct perf_sched_stats *sched = &s_last_frames_schedstats[frame_idx];
+    double ts = trace_us(s_last_frames_begin_pc[frame_idx]);
+
+    trace_begin_event();
+    fprintf(s_trace_file, "{\"ph\":\"C\",\"name\":\"mimalloc\",\"pid\":1,\"ts\":%.3f,"
+        "\"args\":{\"malloc_current\":%lld,\"pages_current\":%lld,\"threads_current\":%lld}}",
+        ts, (long long)mem->mi_malloc_normal_current, (long long)mem->mi_pages_current,
+        (long long)mem->mi_threads_current);
+
+    trace_begin_event();
+    fprintf(s_trace_file, "{\"ph\":\"C\",\"name\":\"allocated per frame\",\"pid\":1,\"ts\":%.3f,"
+        "\"args\":{\"bytes\":%llu}}",
+        ts, (unsigned long long)(s_last_frames_allocd_bytes[frame_idx]
+                               - s_last_frames_allocd_bytes[positive_modulo(frame_idx - 1, NFRAMES_LOGGED)]));
+
+    trace_begin_event();
+    fprintf(s_trace_file, "{\"ph\":\"C\",\"name\":\"scheduler\",\"pid\":1,\"ts\":%.3f,"
+        "\"args\":{\"steals\":%llu,\"sleeps\":%llu,\"wakeups\":%llu,\"overflows\":%llu}}",
+        ts, (unsigned long long)sched->steals, (unsigned long long)sched->sleeps,
+        (unsigned long long)sched->wakeups, (unsigned long long)sched->overflows);
+
+    for(size_t i = 0; i < s_last_frames_ncounters[frame_idx]; i++) {
+
+        const struct perf_counter *counter = &s_last_frames_counters[frame_idx][i];
+        trace_begin_event();
+        if(counter->instant) {
+            fputs("{\"ph\":\"i\",\"s\":\"p\",\"name\":", s_trace_file);
+        }else{
+            fputs("{\"ph\":\"C\",\"name\":", s_trace_file);
+        }
+        trace_write_string(counter->name);
+        fprintf(s_trace_file, ",\"pid\":1,\"ts\":%.3f,\"args\":{", ts);
+
+        for(size_t j = 0; j < counter->nseries; j++) {
+            if(j > 0) {
+                fputc(',', s_trace_file);
+            }
+            trace_write_string(counter->keys[j]);
+            fprintf(s_trace_file, ":%g", counter->values[j]);
+        }
+        fputs("}}", s_trace_file);
+    }
+}
+
+static void gather_counters(int frame_idx)
+{
+    size_t ncounters = 0;
+    memset(s_last_frames_counters[frame_idx], 0, sizeof(s_last_frames_counters[frame_idx]));
+    for(size_t i = 0; i < s_ncounter_providers; i++) {
+        ncounters += s_counter_providers[i](MAX_FRAME_COUNTERS - ncounters, 
+            &s_last_frames_counters[frame_idx][ncounters]);
+    }
+    s_last_frames_ncounters[frame_idx] = ncounters;
+}
+
+static void trace_write_frame(void)
+{
+    int frame_idx = (s_last_idx + 1) % NFRAMES_LOGGED;
+    if(s_trace_origin_pc == 0) {
+        s_trace_origin_pc = s_last_frames_begin_pc[frame_idx];
+    }
+
+    for(khiter_t k = kh_begin(s_thread_state_table); k != kh_end(s_thread_state_table); k++) {
+
+        if(!kh_exist(s_thread_state_table, k))
+            continue;
+
+        struct perf_state *ps = &kh_val(s_thread_state_table, k);
+        if(!ps->rotated)
+            continue;
+
+        if(!ps->trace_named) {
+            trace_write_thread_name(ps);
+            ps->trace_named = true;
+        }
+
+        int read_idx = (ps->perf_tree_idx + 1) % NFRAMES_LOGGED;
+        if(kh_key(s_thread_state_table, k) == GPU_STATE_KEY) {
+            trace_write_gpu_tree(ps, &ps->perf_trees[read_idx]);
+        }else{
+            trace_write_cpu_tree(ps, &ps->perf_trees[read_idx]);
+        }
+    }
+
+    trace_write_counters(frame_idx);
+    if(--s_trace_frames_left == 0) {
+        Perf_TraceEnd();
+        Settings_Set("pf.debug.trace_frames", &(struct sval){
+            .type = ST_TYPE_INT,
+            .as_int = 0
+        });
+    }
+}
+
 static void perf_log_mem_stats(void)
 {
     int read_idx = (s_last_idx + 1) % NFRAMES_LOGGED;
@@ -503,6 +740,17 @@ static void perf_log_mem_stats(void)
         (unsigned long long)s->vm_rss_kb);
     fprintf(stdout, "[mem-stats]   vm_size                   %12llu kB\n",
         (unsigned long long)s->vm_size_kb);
+
+    struct perf_stack_usage usage[MAX_STACK_USAGE];
+    size_t nusage = Sched_GetStackUsage(MAX_STACK_USAGE, usage);
+    for(size_t i = 0; i < nusage; i++) {
+        fprintf(stdout, "[stack-usage] %-40s %10llu / %10llu bytes (%llu tasks, %llu unknown)\n",
+            usage[i].name,
+            (unsigned long long)usage[i].high_water,
+            (unsigned long long)usage[i].stack_size,
+            (unsigned long long)usage[i].ntasks,
+            (unsigned long long)usage[i].nunknown);
+    }
     fflush(stdout);
 }
 
@@ -525,6 +773,8 @@ bool Perf_Init(void)
 
 void Perf_Shutdown(void)
 {
+    Perf_TraceEnd();
+
     uint64_t key;
     struct perf_state curr;
     (void)key;
@@ -577,8 +827,10 @@ void Perf_Push(const char *name)
     const size_t ssize = vec_size(&ps->perf_stack);
     uint32_t parent_idx = ssize > 0 ? vec_AT(&ps->perf_stack, ssize-1) : PARENT_NONE;
 
+    uint64_t now = SDL_GetPerformanceCounter();
     vec_perf_push(&ps->perf_trees[ps->perf_tree_idx], (struct perf_entry){
-        .pc_delta = SDL_GetPerformanceCounter(),
+        .pc_delta = now,
+        .pc_begin = now,
         .parent_idx = parent_idx,
         .name_id = name_id_get(name, ps)
     });
@@ -691,6 +943,7 @@ void Perf_BeginTick(void)
 {
     ASSERT_IN_MAIN_THREAD();
     s_last_frames_ms[s_last_idx] = SDL_GetTicks();
+    s_last_frames_begin_pc[s_last_idx] = SDL_GetPerformanceCounter();
 
     R_PushCmd((struct rcmd){
         .func = R_GL_ReadVramStats,
@@ -777,16 +1030,22 @@ void Perf_FinishTick(void)
         /* A non-empty stack means the owning thread is mid-function;
          * advancing perf_tree_idx would invalidate the stack's indices. */
         struct perf_state *curr = &kh_val(s_thread_state_table, k);
+        curr->rotated = false;
         if(vec_size(&curr->perf_stack) > 0)
             continue;
 
+        curr->rotated = true;
         curr->perf_tree_idx = (curr->perf_tree_idx + 1) % NFRAMES_LOGGED;
         vec_perf_reset(&curr->perf_trees[curr->perf_tree_idx]);
         curr->last_read_size[curr->perf_tree_idx] = 0;
     }
 
     gather_mem_stats(&s_last_frames_memstats[s_last_idx]);
+    Sched_GetStats(&s_last_frames_schedstats[s_last_idx]);
     Mem_GetAccounting(&s_last_frames_accounting[s_last_idx]);
+    if(s_trace_file) {
+        gather_counters(s_last_idx);
+    }
     uint64_t prev_allocd = s_last_frames_allocd_bytes[positive_modulo(s_last_idx - 1, NFRAMES_LOGGED)];
     uint64_t curr_allocd = (uint64_t)s_last_frames_memstats[s_last_idx].mi_malloc_normal_total;
     s_last_frames_allocd_bytes[s_last_idx] = curr_allocd;
@@ -796,6 +1055,10 @@ void Perf_FinishTick(void)
     s_last_frames_ms[s_last_idx] = curr_time - last_ts;
     s_last_idx = (s_last_idx + 1) % NFRAMES_LOGGED;
 
+    if(s_trace_file) {
+        trace_write_frame();
+    }
+
     struct sval log_setting;
     if(Settings_Get("pf.debug.log_call_graphs", &log_setting) == SS_OKAY
     && log_setting.as_bool) {
@@ -818,6 +1081,91 @@ void Perf_FinishTick(void)
     }
 }
 
+bool Perf_TraceBegin(int nframes)
+{
+    ASSERT_IN_MAIN_THREAD();
+
+    if(nframes <= 0)
+        return false;
+    Perf_TraceEnd();
+
+    char path[512];
+    pf_snprintf(path, sizeof(path), "%s/trace_%llu.json", g_basepath, 
+        (unsigned long long)time(NULL));
+
+    s_trace_file = fopen(path, "w");
+    if(!s_trace_file) {
+        fprintf(stderr, "Failed to open trace file for writing: %s\n", path);
+        return false;
+    }
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", s_trace_file);
+    memset(s_last_frames_ncounters, 0, sizeof(s_last_frames_ncounters));
+    s_trace_frames_left = nframes;
+    s_trace_nevents = 0;
+    s_trace_origin_pc = 0;
+    s_trace_clock_gpu_ns = 0;
+    s_trace_clock_cpu_pc = 0;
+    SDL_AtomicSet(&s_trace_clock_ready, 0);
+
+    for(khiter_t k = kh_begin(s_thread_state_table); k != kh_end(s_thread_state_table); k++) {
+        if(!kh_exist(s_thread_state_table, k))
+            continue;
+        kh_val(s_thread_state_table, k).trace_named = false;
+    }
+
+    R_PushCmd((struct rcmd){
+        .func = R_GL_SampleClocks,
+        .nargs = 3,
+        .args = { &s_trace_clock_gpu_ns, &s_trace_clock_cpu_pc, &s_trace_clock_ready }
+    });
+
+    SDL_AtomicSet(&s_trace_active, 1);
+    printf("Capturing %d frames to trace file: %s\n", nframes, path);
+    return true;
+}
+
+void Perf_TraceEnd(void)
+{
+    if(!s_trace_file)
+        return;
+
+    SDL_AtomicSet(&s_trace_active, 0);
+    fputs("\n]}\n", s_trace_file);
+    fclose(s_trace_file);
+    s_trace_file = NULL;
+    s_trace_frames_left = 0;
+}
+
+bool Perf_TraceActive(void)
+{
+    return (SDL_AtomicGet(&s_trace_active) != 0);
+}
+
+bool Perf_RegisterCounterProvider(perf_counter_provider_t provider)
+{
+    ASSERT_IN_MAIN_THREAD();
+
+    if(s_ncounter_providers == MAX_COUNTER_PROVIDERS)
+        return false;
+    s_counter_providers[s_ncounter_providers++] = provider;
+    return true;
+}
+
+void Perf_UnregisterCounterProvider(perf_counter_provider_t provider)
+{
+    ASSERT_IN_MAIN_THREAD();
+
+    for(size_t i = 0; i < s_ncounter_providers; i++) {
+        if(s_counter_providers[i] != provider)
+            continue;
+        memmove(s_counter_providers + i, s_counter_providers + i + 1, 
+            (s_ncounter_providers - i - 1) * sizeof(perf_counter_provider_t));
+        s_ncounter_providers--;
+        return;
+    }
+}
+
 size_t Perf_Report(size_t maxout, struct perf_info **out)
 {
     size_t ret = 0;
@@ -904,6 +1252,12 @@ void Perf_GetGpuFrameStats(struct gpu_frame_stats *out)
     *out = s_gpu_frame_stats[read_idx];
 }
 
+void Perf_GetSchedStats(struct perf_sched_stats *out)
+{
+    int read_idx = (s_last_idx + 1) % NFRAMES_LOGGED;
+    *out = s_last_frames_schedstats[read_idx];
+}
+
 void Perf_GetMemoryAccounting(struct mem_accounting *out)
 {
     int read_idx = (s_last_idx + 1) % NFRAMES_LOGGED;
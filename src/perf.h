@@ -122,6 +122,49 @@ struct gpu_frame_stats{
 
 #define PERF_GPU_STAT_COUNT (6)
 
+#define PERF_COUNTER_MAX_SERIES (16)
+
+/* A named counter track with one or more series, as written to the trace. 
+ * The name and keys must be string literals (or otherwise outlive the 
+ * trace capture). An 'instant' entry is written as a one-off event at the 
+ * frame's timestamp instead, with the series as its' arguments. */
+struct perf_counter{
+    const char *name;
+    bool        instant;
+    size_t      nseries;
+    const char *keys[PERF_COUNTER_MAX_SERIES];
+    double      values[PERF_COUNTER_MAX_SERIES];
+};
+
+/* Fills 'out' with up to 'maxout' counters and returns how many were written. 
+ * It is invoked from the main thread at the end of every traced frame. */
+typedef size_t (*perf_counter_provider_t)(size_t maxout, struct perf_counter *out);
+
+/* Work distribution counters of the task scheduler, summed over all
+ * the threads for a single frame. */
+struct perf_sched_stats{
+    uint64_t local_pops;     /* tasks popped off the worker's own deque */
+    uint64_t inject_pops;    /* tasks popped off the worker's own inject queue */
+    uint64_t steals;         /* tasks taken from another worker's queues */
+    uint64_t steal_aborts;   /* steals lost to a concurrent pop or steal */
+    uint64_t lock_contended; /* inject queue try-locks that found the lock taken */
+    uint64_t sleeps;         /* times a worker ran out of work and went to sleep */
+    uint64_t wakeups;        /* times a sleeping worker had to be signalled */
+    uint64_t overflows;      /* pushes that spilled over from a full deque */
+};
+
+/* Deepest stack use seen for all the tasks sharing a name. In release 
+ * builds, the use of tasks that stayed within the part of the stack kept 
+ * resident from the previous task is not known, and is left out of the 
+ * high water mark. */
+struct perf_stack_usage{
+    char     name[64];
+    uint64_t stack_size;
+    uint64_t high_water;
+    uint64_t ntasks;
+    uint64_t nunknown;  /* tasks whose use is not known */
+};
+
 struct perf_info{
     char threadname[64];
     size_t nentries;
@@ -162,6 +205,7 @@ size_t   Perf_Report(size_t maxout, struct perf_info **out);
 void     Perf_GetMemoryStats(struct perf_mem_stats *out);
 void     Perf_GetVramStats(struct vram_stats *out);
 void     Perf_GetGpuFrameStats(struct gpu_frame_stats *out);
+void     Perf_GetSchedStats(struct perf_sched_stats *out);
 void     Perf_GetMemoryAccounting(struct mem_accounting *out);
 void     Perf_GetGpuMemoryAccounting(struct gpu_mem_accounting *out);
 uint32_t Perf_LastFrameMS(void);
@@ -176,5 +220,23 @@ bool     Perf_RegisterThread(SDL_threadID tid, const char *name);
 void     Perf_BeginTick(void);
 void     Perf_FinishTick(void);
 
+/* Stream the next 'nframes' frames to a Chrome trace-event JSON file 
+ * (viewable in chrome://tracing or ui.perfetto.dev) in the base directory. 
+ * The trace holds the call graphs of all threads, including the scheduler 
+ * task spans, the GPU ranges, the memory and scheduler counters and any 
+ * registered counter tracks. A 
+ * capture that is already in progress is ended first. Release builds 
+ * compile out the PERF_* spans, so their traces only hold the task spans, 
+ * the GPU ranges and the counters. Use a debug build for the call graphs. */
+bool     Perf_TraceBegin(int nframes);
+void     Perf_TraceEnd(void);
+/* May be called from any thread */
+bool     Perf_TraceActive(void);
+
+/* Add extra counter tracks to the trace captures. The counters are 
+ * sampled once per frame, but only while a capture is in progress. */
+bool     Perf_RegisterCounterProvider(perf_counter_provider_t provider);
+void     Perf_UnregisterCounterProvider(perf_counter_provider_t provider);
+
 #endif
 
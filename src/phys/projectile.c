@@ -77,7 +77,6 @@
 #define MIN(a, b)       ((a) < (b) ? (a) : (b))
 #define MAX(a, b)       ((a) > (b) ? (a) : (b))
 #define ARR_SIZE(a)     (sizeof(a)/sizeof(a[0]))
-#define MAX_PROJ_TASKS  (64)
 #define NEAR_TOLERANCE  (100.0f)
 
 #define CHK_TRUE_RET(_pred)             \
@@ -107,16 +106,8 @@ struct projectile{
     vec3_t                   prev_trail_pos;
 };
 
-struct proj_task_arg{
-    size_t begin_idx;
-    size_t end_idx;
-};
-
 struct proj_work{
     struct memstack mem;
-    size_t          ntasks;
-    struct future   futures[MAX_PROJ_TASKS];
-    uint32_t        tids[MAX_PROJ_TASKS];
 };
 
 VEC_TYPE(proj, struct projectile)
@@ -192,20 +183,11 @@ static void phys_proj_update(struct projectile *proj)
     PFM_Mat4x4_Mult4x4(&trans, &tmp, &proj->model);
 }
 
-static struct result phys_proj_task(void *arg)
+static void phys_proj_work(int begin_idx, int end_idx, void *arg)
 {
-    struct proj_task_arg *proj_arg = arg;
-    size_t ncomputed = 0;
-
-    for(int i = proj_arg->begin_idx; i <= proj_arg->end_idx; i++) {
-
+    for(int i = begin_idx; i < end_idx; i++) {
         phys_proj_update(&vec_AT(&s_back, i));
-
-        ncomputed++;
-        if(ncomputed % 64 == 0)
-            Task_Yield();
     }
-    return NULL_RESULT;
 }
 
 static void phys_show_impact_sprite(const struct projectile *curr)
@@ -228,20 +210,21 @@ static void phys_filter_out_of_bounds(void)
     }
 }
 
+static struct result phys_proj_task(void *arg)
+{
+    Sched_ParallelFor(0, vec_size(&s_back), 64, phys_proj_work, NULL, 0);
+    return NULL_RESULT;
+}
+
 static void phys_proj_join_work(void)
 {
-    for(int i = 0; i < s_work.ntasks; i++) {
-        while(!Sched_FutureIsReady(&s_work.futures[i])) {
-            Sched_RunSync(s_work.tids[i]);
-        }
-    }
+    Sched_GraphWait(SCHED_RES_PROJECTILES);
 }
 
 static void phys_proj_finish_work(void)
 {
     phys_proj_join_work();
     stalloc_clear(&s_work.mem);
-    s_work.ntasks = 0;
 
     vec_proj_subtract(&s_back, &s_deleted, phys_proj_equal);
     vec_proj_reset(&s_deleted);
@@ -367,31 +350,8 @@ static void on_30hz_tick(void *user, void *event)
     if(nwork == 0)
         goto done;
 
-    size_t ntasks = SDL_GetCPUCount();
-    if(nwork < 64)
-        ntasks = 1;
-    ntasks = MIN(ntasks, MAX_PROJ_TASKS);
-
-    for(int i = 0; i < ntasks; i++) {
-
-        struct proj_task_arg *arg = stalloc(&s_work.mem, sizeof(struct proj_task_arg));
-        size_t nitems = ceil((float)nwork / ntasks);
-
-        arg->begin_idx = nitems * i;
-        arg->end_idx = MIN(nitems * (i + 1) - 1, nwork-1);
-
-        SDL_AtomicSet(&s_work.futures[s_work.ntasks].status, FUTURE_INCOMPLETE);
-        s_work.tids[s_work.ntasks] = Sched_Create(4, phys_proj_task, arg, 
-            "phys_proj_task", &s_work.futures[s_work.ntasks], 0);
-
-        if(s_work.tids[s_work.ntasks] == NULL_TID) {
-            for(int j = arg->begin_idx; j <= arg->end_idx; j++) {
-                phys_proj_update(&vec_AT(&s_back, j));
-            }
-        }else{
-            s_work.ntasks++;
-        }
-    }
+    Sched_GraphSubmit(4, phys_proj_task, NULL, "phys_proj_task", 0,
+        0, SCHED_RES_PROJECTILES);
 
 done:
     s_last_tick = g_frame_idx;
@@ -914,7 +874,6 @@ bool P_Projectile_LoadState(struct SDL_RWops *stream)
 
 void P_Projectile_ClearState(void)
 {
-    s_work.ntasks = 0;
     stalloc_clear(&s_eventargs);
     stalloc_clear(&s_work.mem);
     vec_proj_reset(&s_front);
@@ -55,6 +55,7 @@
 #include "../lib/public/vec.h"
 #include "../lib/public/khash.h"
 #include "../lib/public/pf_string.h"
+#include "../lib/public/pf_rand.h"
 
 #include <string.h>
 #include <assert.h>
@@ -159,7 +160,9 @@ KHASH_MAP_INIT_INT64(coord, int)
 /* STATIC VARIABLES                                                          */
 /*****************************************************************************/
 
-static unsigned int s_seed;
+/* Zero means 'not seeded yet' and picks a seed from the wall clock on 
+ * the first quilting job. */
+static uint32_t s_seed;
 
 /* Wang tile combinations: each of the 8 output tiles is stitched from the 4
  * sample blocks (BLUE/RED/YELLOW/GREEN) in a fixed arrangement. */
@@ -172,17 +175,6 @@ static const int s_wang_combos[8][4] = {
 /* STATIC FUNCTIONS                                                          */
 /*****************************************************************************/
 
-static int pf_rand(unsigned *seed)
-{
-#ifdef _WIN32
-    unsigned int ret = 0;
-    rand_s(&ret);
-    return (ret % RAND_MAX);
-#else
-    return rand_r(seed);
-#endif
-}
-
 static uint64_t coord_to_key(struct coord coord)
 {
     return ((uint64_t)coord.r) << 32
@@ -361,8 +353,8 @@ static struct image_view random_block(struct image image)
 {
     int minx = OVERLAP_DIM, maxx = image.width - (BLOCK_DIM + OVERLAP_DIM);
     int miny = OVERLAP_DIM, maxy = image.height - (BLOCK_DIM + OVERLAP_DIM);
-    int x = pf_rand(&s_seed) % (maxx + 1 - minx) + minx;
-    int y = pf_rand(&s_seed) % (maxy + 1 - miny) + miny;
+    int x = pf_rand_next(&s_seed) % (maxx + 1 - minx) + minx;
+    int y = pf_rand_next(&s_seed) % (maxy + 1 - miny) + miny;
     return (struct image_view){x, y, BLOCK_DIM, BLOCK_DIM};
 }
 
@@ -710,7 +702,7 @@ static struct coord choose_sample(struct cost_image cost_image, const struct pha
     }
     assert(vec_size(&spread) > 0);
 
-    int idx = pf_rand(&s_seed) % vec_size(&spread);
+    int idx = pf_rand_next(&s_seed) % vec_size(&spread);
     struct coord ret = vec_AT(&spread, idx);
 
     vec_coord_destroy(&spread);
@@ -1684,7 +1676,7 @@ static bool make_tileset_impl(const char *diffuse_src, const char *normal_src,
 {
     ASSERT_IN_RENDER_THREAD();
     if(!s_seed) {
-        s_seed = time(NULL);
+        s_seed = pf_rand_seed(time(NULL));
     }
 
     bool ret = false;
@@ -1788,6 +1780,12 @@ bool R_GL_ImageQuilt_MakeTilesetN(const char *diffuse, const char *normal,
     return make_tileset_impl(diffuse, normal, out, out_norm, tunit, tunit_norm);
 }
 
+void R_GL_ImageQuiltSetSeed(const uint32_t *seed)
+{
+    ASSERT_IN_RENDER_THREAD();
+    s_seed = pf_rand_seed(*seed);
+}
+
 size_t R_GL_ImageQuilt_TilesetDim(void)
 {
     return round(TILE_DIM / 2.0 / cos(M_PI/4));
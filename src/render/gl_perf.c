@@ -210,6 +210,17 @@ void R_GL_ResolvePipelineStats(uint32_t *cookies, struct gpu_frame_stats *out)
     out->frag_invocations = vals[5];
 }
 
+void R_GL_SampleClocks(uint64_t *out_gpu_ns, uint64_t *out_cpu_ctr, SDL_atomic_t *out_ready)
+{
+    GLint64 gpu_ts = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpu_ts);
+    *out_cpu_ctr = SDL_GetPerformanceCounter();
+    *out_gpu_ns = gpu_ts;
+    /* Publish the samples to the main thread */
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(out_ready, 1);
+}
+
 void R_GL_PerfStallFrameReport(void)
 {
     if(g_trace_stalls) {
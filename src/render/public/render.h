@@ -311,6 +311,14 @@ void   R_GL_DrawCombinedHRVO(vec2_t *apexes, vec2_t *left_rays, vec2_t *right_ra
  */
 void   R_GL_TimestampForCookie(uint32_t *cookie, uint64_t *out);
 
+/* ---------------------------------------------------------------------------
+ * Sample the GPU timestamp clock and the CPU performance counter back to back,
+ * so that GPU timestamps can be placed on the CPU timeline. 'out_ready' is
+ * set once both samples have been written.
+ * ---------------------------------------------------------------------------
+ */
+void   R_GL_SampleClocks(uint64_t *out_gpu_ns, uint64_t *out_cpu_ctr, SDL_atomic_t *out_ready);
+
 /* ---------------------------------------------------------------------------
  * Read the GPU's VRAM usage counters (NVX_gpu_memory_info) into 'out', or
  * zeroes if the extension is unavailable.
@@ -464,6 +472,13 @@ void  R_GL_MapUpdateFog(void *buff, const size_t *size);
  */
 void  R_GL_MapInvalidate(void);
 
+/* ---------------------------------------------------------------------------
+ * Seed the random block selection used when quilting map tilesets, so that 
+ * the same map produces the same tiles from one run to the next.
+ * ---------------------------------------------------------------------------
+ */
+void  R_GL_ImageQuiltSetSeed(const uint32_t *seed);
+
 /* ---------------------------------------------------------------------------
  * Initialize the foliage rendering context. Sets up the shared mesh VAO and
  * allocates per-chunk VBO slots. 'priv' is the render_private of the cover
@@ -952,6 +952,8 @@ void R_InitAttributes(void)
 
 bool R_ComputeShaderSupported(void)
 {
+    if(Engine_Headless())
+        return false;
     return (GLEW_VERSION_4_3 
         || (GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object));
 }
@@ -49,8 +49,8 @@
 #include "lib/public/queue.h"
 #include "lib/public/khash.h"
 #include "lib/public/pf_string.h"
+#include "lib/public/pf_stack_pool.h"
 #include "mem.h"
-#include "lib/public/block_allocator.h"
 
 #include <SDL.h>
 #include <mimalloc-stats.h>
@@ -170,6 +170,10 @@ struct task{
     struct task   *prev, *next;
     void          *earg;
     void         (*erelease)(void*);
+    /* Non-zero while the task sits in a worker's deque. Whoever
+     * swaps it back to zero owns the task; a mismatching ticket
+     * marks a stale deque entry. */
+    SDL_atomic_t   ticket;
 #if defined(__SANITIZE_ADDRESS__)
     void          *fake_stack;   /* ASan fiber fake-stack save slot */
     void          *entry_code;   /* real task fn, invoked via the ASan entry shim */
@@ -185,9 +189,20 @@ __pragma(pack(pop));
 #define MAX_WORKER_THREADS      (64)
 #define STACK_SZ                (16 * 1024)
 #define BIG_STACK_SZ            (8 * 1024 * 1024)
+#define BIG_STACK_RETAIN        (256 * 1024)
+#define MAX_CACHED_STACKS       (1024)
+#define MIN_CACHED_BIG_STACKS   (8)
 #define SCHED_TICK_MS           (1.0f / CONFIG_SCHED_TARGET_FPS * 1000.0f)
 #define ALIGNED(val, align)     (((val) + ((align) - 1)) & ~((align) - 1))
 #define DELETED_MARKER          (((uint32_t)0x1) << 31)
+#define NUM_PRIO_BANDS          (4)
+#define DEQUE_SZ                (1024)
+#define STATS_SLOT_MAIN         (MAX_WORKER_THREADS)
+#define MAX_GRAPH_NODES         (64)
+#define NODE_IDX(_handle)       ((int)((_handle) & 0xff) - 1)
+#define NODE_GEN(_handle)       ((_handle) >> 8)
+#define MIN(a, b)               ((a) < (b) ? (a) : (b))
+#define MAX(a, b)               ((a) > (b) ? (a) : (b))
 
 PQUEUE_TYPE(task, struct task*)
 PQUEUE_IMPL(static, task, struct task*)
@@ -198,12 +213,71 @@ QUEUE_IMPL(static, tid, uint32_t)
 KHASH_MAP_INIT_INT64(tid, uint32_t)
 KHASH_MAP_INIT_INT(tqueue, queue_tid_t)
 
+struct stack_usage{
+    uint64_t stack_size;
+    uint64_t high_water;
+    uint64_t ntasks;
+    uint64_t nunknown;
+};
+
+KHASH_MAP_INIT_STR(stackuse, struct stack_usage)
+
 
 uint64_t    sched_switch_ctx(struct context *save, struct context *restore, uint64_t retval, void *arg);
 void        sched_task_exit_trampoline(void);
 void        sched_task_exit(struct result ret);
 static void sched_task_cleanup(const struct task *task);
 
+struct deque_entry{
+    struct task *task;
+    uint32_t     ticket;
+};
+
+/* A bounded work-stealing deque (Chase & Lev, 2005). Only the owning 
+ * worker pushes to and pops from the bottom end. Any other thread can 
+ * steal from the top end. The SDL atomics are all sequentially consistent, 
+ * which provides the store-load ordering required by 'pop' and 'steal'.
+ */
+struct ws_deque{
+    SDL_atomic_t       top;
+    char               __pad0[60];
+    SDL_atomic_t       bottom;
+    char               __pad1[60];
+    struct deque_entry buff[DEQUE_SZ];
+};
+
+/* A unit of simulation work in the frame graph. It is launched once all
+ * the in-flight nodes that it conflicts with have retired. Two nodes 
+ * conflict when one writes state that the other reads or writes.
+ */
+struct graph_node{
+    uint32_t     gen;      /* bumped whenever the node retires */
+    bool         launched;
+    task_func_t  code;
+    void        *arg;
+    const char  *name;
+    int          prio;
+    int          flags;
+    uint32_t     reads;
+    uint32_t     writes;
+    uint64_t     deps;     /* bitmask of the in-flight nodes it's waiting on */
+    uint32_t     tid;
+};
+
+struct worker_queues{
+    /* Tasks made ready by the worker's own thread, one deque per 
+     * priority band. */
+    struct ws_deque    local[NUM_PRIO_BANDS];
+    /* Tasks made ready outside of the worker pool (i.e. by the main 
+     * thread) are spread round-robin between the workers' inject
+     * queues so that the per-tick fan-outs don't all contend on the 
+     * same lock. 'inject_band' mirrors the band of the top task (or
+     * NUM_PRIO_BANDS when empty) and can be read without the lock. */
+    SDL_mutex         *inject_lock;
+    pq_task_t          inject;
+    SDL_atomic_t       inject_band;
+};
+
 /*****************************************************************************/
 /* STATIC VARIABLES                                                          */
 /*****************************************************************************/
@@ -219,8 +293,11 @@ static struct task            *s_freehead;
 static unsigned                s_nfree = MAX_TASKS;
 
 static struct task             s_tasks[MAX_TASKS];
-static char                    s_stacks[MAX_TASKS][STACK_SZ];
-static struct block_allocator  s_bigstacks;
+static struct pf_stack         s_task_stacks[MAX_TASKS];
+static struct pf_stack_pool   *s_stack_pool;
+static struct pf_stack_pool   *s_bigstack_pool;
+/* Deepest stack use seen per task name. Protected by the request lock. */
+static khash_t(stackuse)      *s_stack_usage;
 static queue_tid_t             s_msg_queues[MAX_TASKS];
 static bool                    s_parent_waiting[MAX_TASKS];
 static khash_t(tqueue)        *s_event_queues;
@@ -228,29 +305,43 @@ static khash_t(tqueue)        *s_event_queues;
 /* Lock used to serialzie the scheduler requests */
 static SDL_mutex              *s_request_lock;
 
-/* The active worker threads wait on the ready cond to be 
- * notified when the ready queue(s) becomes non-empty, so that
- * they can pop a task to execute. At the end of a frame, the 
- * ready condition variable is also used to notify the workers 
+/* The frame graph. The lock is always taken before the request lock. */
+static SDL_mutex              *s_graph_lock;
+static struct graph_node       s_graph_nodes[MAX_GRAPH_NODES];
+static uint64_t                s_graph_inflight;
+
+/* Workers that run out of work (in their own queues as well as 
+ * in those of their peers) go to sleep on the ready cond. They 
+ * get woken when a new task is made ready. At the end of a frame, 
+ * the ready condition variable is also used to notify the workers 
  * that the 'quiesce' flags has been set, instructing them to 
  * go back to waiting on a start/quit command. 
  * 
- * We have 2 diff. queues to allow only de-queuing tasks based
- * on the thread. The worker threads will not dequeue from the 
- * 'main' queues.
- *
- * All the queues are protected by the ready lock.
+ * The 'main' queue holds the tasks pinned to the main thread. The
+ * worker threads will not dequeue from it. It is protected by the 
+ * ready lock. All the other ready tasks live in the per-worker 
+ * queues.
  */
-static pq_task_t        s_ready_queue;
 static pq_task_t        s_ready_queue_main;
+static struct worker_queues s_worker_queues[MAX_WORKER_THREADS];
+static SDL_atomic_t     s_next_inject;
+static SDL_atomic_t     s_next_ticket;
 
 static SDL_mutex       *s_ready_lock;
 static SDL_cond        *s_ready_cond;
 static int              s_nwaiters;     /* protected by ready lock */
-static bool             s_quiesce;      /* protected by ready lock */
+static SDL_atomic_t     s_nsleeping;    /* mirrors s_nwaiters, readable without the lock */
+static SDL_atomic_t     s_quiesce;      /* written with the ready lock held */
 static int              s_idle_workers; /* protected by ready lock */
 
+/* Each slot is only written by its owning thread. The main thread
+ * reads them while the workers are quiesced. */
+static struct perf_sched_stats s_stats[MAX_WORKER_THREADS + 1];
+
 static size_t           s_nworkers;
+/* How long the main thread may keep running tasks for in a tick */
+static float            s_tick_ms = SCHED_TICK_MS;
+static bool             s_drain_main;
 static SDL_Thread      *s_worker_threads[MAX_WORKER_THREADS];
 static struct context   s_worker_contexts[MAX_WORKER_THREADS];
 
@@ -542,19 +633,291 @@ static void sched_task_free(struct task *task)
     s_nfree++;
 }
 
-static void sched_reactivate(struct task *task)
+static int tasks_compare(void *a, void *b)
 {
-    SDL_LockMutex(s_ready_lock); 
-    task->state = TASK_STATE_READY;
+    struct task *ta = *(struct task**)a;
+    struct task *tb = *(struct task**)b;
+    return ((uintptr_t)(ta) - (uintptr_t)(tb));
+}
+
+static int sched_curr_worker_or_none(void)
+{
+    uint64_t key = thread_id_to_key(SDL_ThreadID());
+    khiter_t k = kh_get(tid, s_thread_worker_id_map, key);
+    if(k == kh_end(s_thread_worker_id_map))
+        return -1;
+    return kh_val(s_thread_worker_id_map, k);
+}
 
-    if(task->flags & TASK_MAIN_THREAD_PINNED) {
-        pq_task_push(&s_ready_queue_main, task->prio, task);
+static int sched_stats_slot(int worker_id)
+{
+    return (worker_id < 0) ? STATS_SLOT_MAIN : worker_id;
+}
+
+/* Lower 'prio' values are scheduled first. Tasks are bucketed into 
+ * coarse bands so that the deques can remain simple FIFO/LIFO 
+ * structures while still having the higher-priority work be picked
+ * up (and stolen) first.
+ */
+static int prio_band(int prio)
+{
+    if(prio < 1)
+        return 0;
+    if(prio < 4)
+        return 1;
+    if(prio < 16)
+        return 2;
+    return 3;
+}
+
+static uint32_t sched_new_ticket(void)
+{
+    uint32_t ret;
+    do{
+        ret = ((uint32_t)SDL_AtomicAdd(&s_next_ticket, 1)) + 1;
+    }while(ret == 0);
+    return ret;
+}
+
+static bool sched_claim(struct deque_entry entry)
+{
+    return SDL_AtomicCAS(&entry.task->ticket, (int)entry.ticket, 0);
+}
+
+static void deque_reset(struct ws_deque *dq)
+{
+    SDL_AtomicSet(&dq->top, 0);
+    SDL_AtomicSet(&dq->bottom, 0);
+}
+
+static bool deque_empty(struct ws_deque *dq)
+{
+    return (SDL_AtomicGet(&dq->bottom) - SDL_AtomicGet(&dq->top) <= 0);
+}
+
+/* The following may only be called by the owner of the deque */
+
+static bool deque_push(struct ws_deque *dq, struct deque_entry entry)
+{
+    int b = SDL_AtomicGet(&dq->bottom);
+    int t = SDL_AtomicGet(&dq->top);
+    if(b - t >= DEQUE_SZ)
+        return false;
+
+    dq->buff[b & (DEQUE_SZ - 1)] = entry;
+    SDL_AtomicSet(&dq->bottom, b + 1);
+    return true;
+}
+
+static bool deque_pop(struct ws_deque *dq, struct deque_entry *out)
+{
+    int b = SDL_AtomicGet(&dq->bottom) - 1;
+    SDL_AtomicSet(&dq->bottom, b);
+    int t = SDL_AtomicGet(&dq->top);
+
+    int left = b - t;
+    if(left < 0) {
+        SDL_AtomicSet(&dq->bottom, t);
+        return false;
+    }
+
+    *out = dq->buff[b & (DEQUE_SZ - 1)];
+    if(left > 0)
+        return true;
+
+    /* This is the last entry - race the thieves for it */
+    bool won = SDL_AtomicCAS(&dq->top, t, t + 1);
+    SDL_AtomicSet(&dq->bottom, t + 1);
+    return won;
+}
+
+/* The following may be called by any thread */
+
+enum steal_result{
+    STEAL_EMPTY,
+    STEAL_ABORT,
+    STEAL_OK,
+};
+
+static enum steal_result deque_steal(struct ws_deque *dq, struct deque_entry *out)
+{
+    int t = SDL_AtomicGet(&dq->top);
+    int b = SDL_AtomicGet(&dq->bottom);
+    if(b - t <= 0)
+        return STEAL_EMPTY;
+
+    /* The entry may be torn if the owner has since wrapped around 
+     * to this slot, but then the CAS is guaranteed to fail. */
+    struct deque_entry entry = dq->buff[t & (DEQUE_SZ - 1)];
+    if(!SDL_AtomicCAS(&dq->top, t, t + 1))
+        return STEAL_ABORT;
+
+    *out = entry;
+    return STEAL_OK;
+}
+
+/* Must be called with the inject lock held */
+static void inject_update_band(struct worker_queues *wq)
+{
+    float prio;
+    int band = pq_task_top_prio(&wq->inject, &prio) ? prio_band((int)prio) : NUM_PRIO_BANDS;
+    SDL_AtomicSet(&wq->inject_band, band);
+}
+
+static bool inject_pop(int victim, int band, bool trylock, int slot, struct task **out)
+{
+    struct worker_queues *wq = &s_worker_queues[victim];
+    if(SDL_AtomicGet(&wq->inject_band) > band)
+        return false;
+
+    if(trylock) {
+        if(SDL_TryLockMutex(wq->inject_lock) != 0) {
+            s_stats[slot].lock_contended++;
+            return false;
+        }
     }else{
-        pq_task_push(&s_ready_queue, task->prio, task);
+        SDL_LockMutex(wq->inject_lock);
+    }
+
+    bool ret = pq_task_pop(&wq->inject, out);
+    inject_update_band(wq);
+    SDL_UnlockMutex(wq->inject_lock);
+    return ret;
+}
+
+static bool local_pop(int id, int band, struct task **out)
+{
+    struct deque_entry entry;
+    while(deque_pop(&s_worker_queues[id].local[band], &entry)) {
+        if(sched_claim(entry)) {
+            *out = entry.task;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool local_steal(int victim, int band, int slot, struct task **out)
+{
+    struct deque_entry entry;
+    while(true) {
+        switch(deque_steal(&s_worker_queues[victim].local[band], &entry)) {
+        case STEAL_EMPTY:
+            return false;
+        case STEAL_ABORT:
+            /* Somebody else got to it first - try the next victim */
+            s_stats[slot].steal_aborts++;
+            return false;
+        case STEAL_OK:
+            if(sched_claim(entry)) {
+                *out = entry.task;
+                return true;
+            }
+            break; /* stale entry */
+        }
     }
+}
+
+/* Find the highest-priority ready task that can be run on the calling
+ * thread. Workers (id >= 0) first look in their own queues and then 
+ * try to steal from their peers, a band at a time. The main thread 
+ * (id < 0) can only steal.
+ */
+static struct task *sched_find_task(int id)
+{
+    static SDL_atomic_t s_main_victim;
+
+    struct task *ret = NULL;
+    int slot = sched_stats_slot(id);
+    int start = (id >= 0) ? id + 1 : SDL_AtomicAdd(&s_main_victim, 1);
 
+    for(int band = 0; band < NUM_PRIO_BANDS; band++) {
+
+        if(id >= 0) {
+            if(inject_pop(id, band, false, slot, &ret)) {
+                s_stats[slot].inject_pops++;
+                return ret;
+            }
+            if(local_pop(id, band, &ret)) {
+                s_stats[slot].local_pops++;
+                return ret;
+            }
+        }
+
+        for(int i = 0; i < s_nworkers; i++) {
+
+            int victim = ((unsigned)(start + i)) % s_nworkers;
+            if(victim == id)
+                continue;
+
+            if(local_steal(victim, band, slot, &ret)
+            || inject_pop(victim, band, true, slot, &ret)) {
+                s_stats[slot].steals++;
+                return ret;
+            }
+        }
+    }
+    return NULL;
+}
+
+static bool sched_work_visible(void)
+{
+    for(int i = 0; i < s_nworkers; i++) {
+
+        struct worker_queues *wq = &s_worker_queues[i];
+        if(SDL_AtomicGet(&wq->inject_band) < NUM_PRIO_BANDS)
+            return true;
+
+        for(int band = 0; band < NUM_PRIO_BANDS; band++) {
+            if(!deque_empty(&wq->local[band]))
+                return true;
+        }
+    }
+    return false;
+}
+
+static void sched_wake_worker(int slot)
+{
+    if(SDL_AtomicGet(&s_nsleeping) == 0)
+        return;
+
+    SDL_LockMutex(s_ready_lock); 
     SDL_CondSignal(s_ready_cond);
     SDL_UnlockMutex(s_ready_lock);
+    s_stats[slot].wakeups++;
+}
+
+/* Remove a ready task from whichever queue is holding it */
+static bool sched_unqueue(struct task *task)
+{
+    bool found = false;
+
+    SDL_LockMutex(s_ready_lock);
+    found = pq_task_remove(&s_ready_queue_main, tasks_compare, task);
+    SDL_UnlockMutex(s_ready_lock);
+
+    if(found)
+        return true;
+
+    /* Entries can't be removed from the middle of a deque. Claiming 
+     * the ticket turns the entry into a stale one that will be skipped 
+     * when it's popped. */
+    int ticket = SDL_AtomicGet(&task->ticket);
+    if(ticket && SDL_AtomicCAS(&task->ticket, ticket, 0))
+        return true;
+
+    for(int i = 0; i < s_nworkers; i++) {
+
+        struct worker_queues *wq = &s_worker_queues[i];
+        SDL_LockMutex(wq->inject_lock);
+        found = pq_task_remove(&wq->inject, tasks_compare, task);
+        inject_update_band(wq);
+        SDL_UnlockMutex(wq->inject_lock);
+
+        if(found)
+            return true;
+    }
+    return false;
 }
 
 static void sched_reactivate_on_main(struct task *task)
@@ -566,6 +929,56 @@ static void sched_reactivate_on_main(struct task *task)
     SDL_UnlockMutex(s_ready_lock);
 }
 
+/* Make the task ready, placing it in one of the workers' shared inject 
+ * queues. This is the path taken for tasks made ready outside of the 
+ * worker pool, as well as for tasks that yielded and should let their 
+ * peers run.
+ */
+static void sched_reactivate_shared(struct task *task)
+{
+    if((task->flags & TASK_MAIN_THREAD_PINNED) || s_nworkers == 0) {
+        sched_reactivate_on_main(task);
+        return;
+    }
+
+    int id = ((unsigned)SDL_AtomicAdd(&s_next_inject, 1)) % s_nworkers;
+    struct worker_queues *wq = &s_worker_queues[id];
+
+    task->state = TASK_STATE_READY;
+    SDL_LockMutex(wq->inject_lock);
+    pq_task_push(&wq->inject, task->prio, task);
+    inject_update_band(wq);
+    SDL_UnlockMutex(wq->inject_lock);
+
+    sched_wake_worker(sched_stats_slot(sched_curr_worker_or_none()));
+}
+
+/* Make the task ready. When called from a worker thread, the task
+ * is pushed onto that worker's own deque without taking any locks.
+ */
+static void sched_reactivate(struct task *task)
+{
+    int id = sched_curr_worker_or_none();
+    if(id < 0 || (task->flags & TASK_MAIN_THREAD_PINNED)) {
+        sched_reactivate_shared(task);
+        return;
+    }
+
+    uint32_t ticket = sched_new_ticket();
+    struct ws_deque *dq = &s_worker_queues[id].local[prio_band(task->prio)];
+
+    task->state = TASK_STATE_READY;
+    SDL_AtomicSet(&task->ticket, (int)ticket);
+
+    if(!deque_push(dq, (struct deque_entry){task, ticket})) {
+        SDL_AtomicSet(&task->ticket, 0);
+        s_stats[id].overflows++;
+        sched_reactivate_shared(task);
+        return;
+    }
+    sched_wake_worker(id);
+}
+
 #ifndef _MSC_VER
 __attribute__((used)) 
 #endif
@@ -623,19 +1036,12 @@ static void sched_task_init(struct task *task, int prio, uint32_t flags,
     task->future = future;
     task->earg = NULL;
     task->erelease = NULL;
+    SDL_AtomicSet(&task->ticket, 0);
 
     if(task->future) {
         SDL_AtomicSet(&task->future->status, FUTURE_INCOMPLETE);    
     }
 
-    PERF_PUSH("stack alloc");
-    if(flags & TASK_BIG_STACK) {
-        task->stackmem = block_alloc(&s_bigstacks);
-    }else{
-        task->stackmem = s_stacks[task->tid - 1];
-    }
-    PERF_POP();
-
     sched_init_ctx(task, code);
     sched_reactivate(task);
 }
@@ -818,6 +1224,17 @@ static uint32_t sched_create(int prio, task_func_t code, void *arg, const char *
     if(!task)
         return NULL_TID;
 
+    PERF_PUSH("stack alloc");
+    struct pf_stack_pool *pool = (flags & TASK_BIG_STACK) ? s_bigstack_pool : s_stack_pool;
+    bool stack_ok = pf_stack_alloc(pool, &s_task_stacks[task->tid - 1]);
+    PERF_POP();
+
+    if(!stack_ok) {
+        sched_task_free(task);
+        return NULL_TID;
+    }
+    task->stackmem = s_task_stacks[task->tid - 1].lo;
+
     sched_task_init(task, prio, flags, code, arg, name, result, parent);
     return task->tid;
 }
@@ -851,9 +1268,18 @@ static void sched_task_run(struct task *task)
     task->state = TASK_STATE_ACTIVE;
     assert(stack_pointer_valid(task));
 
-    char name[64];
-    pf_snprintf(name, sizeof(name), "Task %03u [%s]", task->tid, task->name);
-    PERF_PUSH(name);
+#ifndef NDEBUG
+    bool span = true;
+#else
+    /* The task spans are kept for traced sessions in release builds, where 
+     * the rest of the PERF_* spans are compiled out. */
+    bool span = Perf_TraceActive();
+#endif
+    if(span) {
+        char name[64];
+        pf_snprintf(name, sizeof(name), "Task %03u [%s]", task->tid, task->name);
+        Perf_Push(name);
+    }
 
     if(SDL_ThreadID() == g_main_thread_id) {
         SCHED_SWITCH(&s_main_ctx, &task->ctx, task->retval, task->arg,
@@ -864,17 +1290,59 @@ static void sched_task_run(struct task *task)
             &s_worker_fake_stack[id], task->stackmem, SCHED_TASK_STACK_SZ(task));
     }
 
-    PERF_POP();
+    if(span) {
+        Perf_Pop(NULL);
+    }
     assert(stack_pointer_valid(task));
     sched_set_thread_tid(SDL_ThreadID(), NULL_TID);
 }
 
+static void sched_record_stack_usage(const char *name, size_t size, size_t used)
+{
+    if(!name)
+        return;
+
+    khiter_t k = kh_get(stackuse, s_stack_usage, name);
+    if(k == kh_end(s_stack_usage)) {
+
+        char *key = pf_strdup(name);
+        if(!key)
+            return;
+
+        int status;
+        k = kh_put(stackuse, s_stack_usage, key, &status);
+        if(status == -1) {
+            PF_FREE(key);
+            return;
+        }
+        kh_val(s_stack_usage, k) = (struct stack_usage){0};
+    }
+
+    struct stack_usage *usage = &kh_val(s_stack_usage, k);
+    usage->stack_size = MAX(usage->stack_size, size);
+    if(used == PF_STACK_USED_UNKNOWN) {
+        usage->nunknown++;
+    }else{
+        usage->high_water = MAX(usage->high_water, used);
+    }
+    usage->ntasks++;
+}
+
+static void sched_release_stack(struct task *task)
+{
+    struct pf_stack_pool *pool = (task->flags & TASK_BIG_STACK) ? s_bigstack_pool : s_stack_pool;
+    struct pf_stack *stack = &s_task_stacks[task->tid - 1];
+    size_t size = stack->size;
+
+    size_t used = pf_stack_free(pool, stack);
+    sched_record_stack_usage(task->name, size, used);
+    task->stackmem = NULL;
+}
+
 static void sched_task_shutdown(struct task *task)
 {
+    sched_release_stack(task);
     PF_FREE(task->name);
-    if(task->flags & TASK_BIG_STACK) {
-        block_free(&s_bigstacks, task->stackmem);
-    }
     if(task->flags & TASK_DETACHED) {
         sched_task_free(task);
     }else if(s_parent_waiting[task->tid - 1]) {
@@ -916,7 +1384,8 @@ static void sched_task_service_request(struct task *task)
         sched_reactivate(task);
         break;
     case SCHED_REQ_YIELD:
-        sched_reactivate(task);
+        /* Don't let the task be popped right back off the local deque */
+        sched_reactivate_shared(task);
         break;
     case SCHED_REQ_SEND:
         sched_send(
@@ -1049,13 +1518,13 @@ static void sched_quiesce_workers(void)
     PERF_ENTER();
 
     SDL_LockMutex(s_ready_lock);
-    s_quiesce = true;
+    SDL_AtomicSet(&s_quiesce, 1);
     SDL_CondBroadcast(s_ready_cond);
     SDL_UnlockMutex(s_ready_lock);
 
     sched_wait_workers_done();
 
-    s_quiesce = false;
+    SDL_AtomicSet(&s_quiesce, 0);
     PERF_RETURN_VOID();
 }
 
@@ -1076,31 +1545,44 @@ static void worker_notify_done(int id)
     SDL_UnlockMutex(s_ready_lock);
 }
 
-static struct task *worker_wait_task_or_quiesce(void)
+static struct task *worker_wait_task_or_quiesce(int id)
 {
     struct task *task = NULL;
 
-    SDL_LockMutex(s_ready_lock);
-    s_nwaiters++;
+    while(!SDL_AtomicGet(&s_quiesce)) {
 
-    if(s_nwaiters == s_nworkers) {
-        SDL_CondBroadcast(s_ready_cond);
-    }
+        if((task = sched_find_task(id)))
+            return task;
 
-    while(!s_quiesce && !pq_task_pop(&s_ready_queue, &task)) {
-        SDL_CondWait(s_ready_cond, s_ready_lock);
-    }
+        /* The sleeper count is bumped before checking the queues
+         * one last time, while a pusher bumps the queue before reading
+         * the sleeper count. Thus, at least one of the two always 
+         * sees the other and the wakeup can't be lost. */
+        SDL_LockMutex(s_ready_lock);
+        s_nwaiters++;
+        SDL_AtomicAdd(&s_nsleeping, 1);
+        s_stats[id].sleeps++;
 
-    s_nwaiters--;
-    SDL_UnlockMutex(s_ready_lock);
-    return task;
+        if(s_nwaiters == s_nworkers) {
+            SDL_CondBroadcast(s_ready_cond);
+        }
+
+        while(!SDL_AtomicGet(&s_quiesce) && !sched_work_visible()) {
+            SDL_CondWait(s_ready_cond, s_ready_lock);
+        }
+
+        SDL_AtomicAdd(&s_nsleeping, -1);
+        s_nwaiters--;
+        SDL_UnlockMutex(s_ready_lock);
+    }
+    return NULL;
 }
 
 static void worker_do_work(int id)
 {
     while(true) {
 
-        struct task *task = worker_wait_task_or_quiesce();
+        struct task *task = worker_wait_task_or_quiesce(id);
         if(!task)
             return;
 
@@ -1130,13 +1612,6 @@ static int worker_threadfn(void *arg)
     return 0;
 }
 
-static int tasks_compare(void *a, void *b)
-{
-    struct task *ta = *(struct task**)a;
-    struct task *tb = *(struct task**)b;
-    return ((uintptr_t)(ta) - (uintptr_t)(tb));
-}
-
 static bool do_run_sync(uint32_t tid, bool dequeue)
 {
     SDL_LockMutex(s_request_lock);
@@ -1149,13 +1624,7 @@ static bool do_run_sync(uint32_t tid, bool dequeue)
         if(!(task->flags & TASK_DETACHED))
             goto out;
 
-        bool found = false;
-        SDL_LockMutex(s_ready_lock);
-        found = pq_task_remove(&s_ready_queue, tasks_compare, task) 
-             || pq_task_remove(&s_ready_queue_main, tasks_compare, task);
-        SDL_UnlockMutex(s_ready_lock);
-
-        if(!found)
+        if(!sched_unqueue(task))
             goto out;
     }
 
@@ -1195,7 +1664,7 @@ static bool work_exists(void)
 {
     bool ret;
     SDL_LockMutex(s_ready_lock);
-    ret = pq_size(&s_ready_queue_main) || pq_size(&s_ready_queue);
+    ret = pq_size(&s_ready_queue_main) || sched_work_visible();
     SDL_UnlockMutex(s_ready_lock);
     return ret;
 }
@@ -1211,44 +1680,319 @@ static struct task *next_main_thread_task(void)
     struct task *ret = NULL;
     if(G_GetSimState() == G_RUNNING) {
 
+        /* Only the main thread can service the pinned tasks, so they 
+         * go first unless there's higher-priority work elsewhere. */
         SDL_LockMutex(s_ready_lock);
-        if(pq_size(&s_ready_queue_main) || pq_size(&s_ready_queue)) {
-
-            float prio_main = -1.0, prio_gen = -1.0;
-            pq_task_top_prio(&s_ready_queue_main, &prio_main);
-            pq_task_top_prio(&s_ready_queue, &prio_gen);
-
-            if(prio_gen > prio_main) {
-                pq_task_pop(&s_ready_queue, &ret);
-            }else {
-                pq_task_pop(&s_ready_queue_main, &ret);
-            }
+        float prio_main = -1.0;
+        bool pinned = pq_task_top_prio(&s_ready_queue_main, &prio_main);
+        if(pinned && prio_band((int)prio_main) == 0) {
+            pq_task_pop(&s_ready_queue_main, &ret);
         }
         SDL_UnlockMutex(s_ready_lock);
+
+        if(!ret) {
+            ret = sched_find_task(-1);
+        }
+        if(!ret && pinned) {
+            SDL_LockMutex(s_ready_lock);
+            pq_task_pop(&s_ready_queue_main, &ret);
+            SDL_UnlockMutex(s_ready_lock);
+        }
         return ret;
 
     }else{
         /* During a pause, only the tasks with the TASK_RUN_DURING_PAUSE
          * flag can run. */
         SDL_LockMutex(s_ready_lock);
+        pq_task_pop_matching(&s_ready_queue_main, &ret, can_run_during_pause);
+        SDL_UnlockMutex(s_ready_lock);
 
-        if(pq_size(&s_ready_queue_main) || pq_size(&s_ready_queue)) {
+        for(int i = 0; !ret && i < s_nworkers; i++) {
 
-            float prio_main = -1.0, prio_gen = -1.0;
-            pq_task_top_prio_of(&s_ready_queue_main, &prio_main, can_run_during_pause);
-            pq_task_top_prio_of(&s_ready_queue, &prio_gen, can_run_during_pause);
+            struct worker_queues *wq = &s_worker_queues[i];
+            if(SDL_AtomicGet(&wq->inject_band) == NUM_PRIO_BANDS)
+                continue;
 
-            if(prio_gen > prio_main) {
-                pq_task_pop_matching(&s_ready_queue, &ret, can_run_during_pause);
-            }else {
-                pq_task_pop_matching(&s_ready_queue_main, &ret, can_run_during_pause);
-            }
+            SDL_LockMutex(wq->inject_lock);
+            pq_task_pop_matching(&wq->inject, &ret, can_run_during_pause);
+            inject_update_band(wq);
+            SDL_UnlockMutex(wq->inject_lock);
         }
-        SDL_UnlockMutex(s_ready_lock);
         return ret;
     }
 }
 
+static bool worker_queues_init(struct worker_queues *wq)
+{
+    wq->inject_lock = SDL_CreateMutex();
+    if(!wq->inject_lock)
+        return false;
+
+    pq_task_init(&wq->inject);
+    if(!pq_task_reserve(&wq->inject, 512)) {
+        SDL_DestroyMutex(wq->inject_lock);
+        return false;
+    }
+
+    SDL_AtomicSet(&wq->inject_band, NUM_PRIO_BANDS);
+    for(int band = 0; band < NUM_PRIO_BANDS; band++) {
+        deque_reset(&wq->local[band]);
+    }
+    return true;
+}
+
+static void worker_queues_destroy(struct worker_queues *wq)
+{
+    pq_task_destroy(&wq->inject);
+    SDL_DestroyMutex(wq->inject_lock);
+}
+
+/* Must only be called when the workers are quiesced */
+static void worker_queues_clear(struct worker_queues *wq)
+{
+    struct task *curr = NULL;
+    while(pq_task_pop(&wq->inject, &curr)) {
+        sched_task_cleanup(curr);
+    }
+    inject_update_band(wq);
+
+    for(int band = 0; band < NUM_PRIO_BANDS; band++) {
+
+        struct deque_entry entry;
+        enum steal_result res;
+        while((res = deque_steal(&wq->local[band], &entry)) != STEAL_EMPTY) {
+            if(res == STEAL_OK && sched_claim(entry))
+                sched_task_cleanup(entry.task);
+        }
+        deque_reset(&wq->local[band]);
+    }
+}
+
+static uint32_t graph_handle(int idx)
+{
+    return ((s_graph_nodes[idx].gen & 0xffffff) << 8) | (idx + 1);
+}
+
+static bool graph_conflict(const struct graph_node *node, uint32_t reads, uint32_t writes)
+{
+    return (node->writes & (reads | writes)) || (node->reads & writes);
+}
+
+static void graph_retire(struct graph_node *node);
+
+static struct result graph_node_task(void *arg)
+{
+    struct graph_node *node = arg;
+    struct result ret = node->code(node->arg);
+    graph_retire(node);
+    return ret;
+}
+
+/* Must be called with the graph lock held. Should there not be a free 
+ * TID, the node stays unlaunched and is run by whoever waits on it. */
+static void graph_launch(struct graph_node *node)
+{
+    assert(node->deps == 0);
+    node->tid = Sched_Create(node->prio, graph_node_task, node, node->name, NULL, node->flags);
+    node->launched = (node->tid != NULL_TID);
+}
+
+/* Must be called with the graph lock held */
+static void graph_retire_locked(struct graph_node *node)
+{
+    int idx = node - s_graph_nodes;
+    uint64_t bit = ((uint64_t)1) << idx;
+
+    node->gen++;
+    s_graph_inflight &= ~bit;
+
+    for(int i = 0; i < MAX_GRAPH_NODES; i++) {
+
+        struct graph_node *curr = &s_graph_nodes[i];
+        if(!(s_graph_inflight & (((uint64_t)1) << i)))
+            continue;
+        if(!(curr->deps & bit))
+            continue;
+
+        curr->deps &= ~bit;
+        if(curr->deps == 0)
+            graph_launch(curr);
+    }
+}
+
+static void graph_retire(struct graph_node *node)
+{
+    SDL_LockMutex(s_graph_lock);
+    graph_retire_locked(node);
+    SDL_UnlockMutex(s_graph_lock);
+}
+
+/* Help the node along until it retires. The node's dependencies are 
+ * waited on first. When 'block' is false, give up as soon as a task 
+ * can't be run to completion by the caller (i.e. it is running on 
+ * another thread or is blocked). 
+ */
+static bool graph_wait_node(uint32_t handle, bool block)
+{
+    int idx = NODE_IDX(handle);
+    assert(idx >= 0 && idx < MAX_GRAPH_NODES);
+    struct graph_node *node = &s_graph_nodes[idx];
+
+    while(true) {
+
+        uint32_t deps[MAX_GRAPH_NODES];
+        size_t ndeps = 0;
+
+        SDL_LockMutex(s_graph_lock);
+        if((node->gen & 0xffffff) != NODE_GEN(handle)) {
+            SDL_UnlockMutex(s_graph_lock);
+            return true;
+        }
+        for(int i = 0; i < MAX_GRAPH_NODES; i++) {
+            if(node->deps & (((uint64_t)1) << i))
+                deps[ndeps++] = graph_handle(i);
+        }
+        bool stalled = !node->launched && (node->deps == 0);
+        if(stalled) {
+            node->launched = true;
+            node->tid = NULL_TID;
+        }
+        uint32_t tid = node->tid;
+        SDL_UnlockMutex(s_graph_lock);
+
+        if(ndeps > 0) {
+            for(int i = 0; i < ndeps; i++) {
+                if(!graph_wait_node(deps[i], block))
+                    return false;
+            }
+            continue;
+        }
+
+        if(stalled) {
+            graph_node_task(node);
+            continue;
+        }
+
+        /* The node never got a task and is being run inline by another 
+         * waiter. There is nothing to help along - just wait for it to 
+         * retire. 
+         */
+        if(tid == NULL_TID) {
+            if(!block)
+                return false;
+            Sched_TryYield();
+            continue;
+        }
+
+        if(!Sched_RunSync(tid)) {
+            if(!block)
+                return false;
+            Sched_TryYield();
+        }
+    }
+}
+
+static void graph_clear(void)
+{
+    SDL_LockMutex(s_graph_lock);
+    for(int i = 0; i < MAX_GRAPH_NODES; i++) {
+        if(s_graph_inflight & (((uint64_t)1) << i))
+            s_graph_nodes[i].gen++;
+    }
+    s_graph_inflight = 0;
+    SDL_UnlockMutex(s_graph_lock);
+}
+
+static bool pfor_take(struct pfor *pf, int self, int *out_begin, int *out_end)
+{
+    struct pfor_range *range = &pf->ranges[self];
+    bool ret = false;
+
+    SDL_AtomicLock(&range->lock);
+    if(range->begin < range->end) {
+        *out_begin = range->begin;
+        *out_end = MIN(range->begin + pf->grain, range->end);
+        range->begin = *out_end;
+        ret = true;
+    }
+    SDL_AtomicUnlock(&range->lock);
+    return ret;
+}
+
+/* Move the upper half of the largest remaining range into the caller's 
+ * own range. Ranges no bigger than the grain are taken whole. Returns
+ * false once all the other ranges have been drained.
+ */
+static bool pfor_split(struct pfor *pf, int self)
+{
+    while(true) {
+
+        int victim = -1;
+        int most = 0;
+
+        for(int i = 0; i <= pf->ntasks; i++) {
+            if(i == self)
+                continue;
+            struct pfor_range *curr = &pf->ranges[i];
+            SDL_AtomicLock(&curr->lock);
+            int left = curr->end - curr->begin;
+            SDL_AtomicUnlock(&curr->lock);
+            if(left > most) {
+                most = left;
+                victim = i;
+            }
+        }
+        if(victim < 0)
+            return false;
+
+        int begin = 0, end = 0;
+        struct pfor_range *range = &pf->ranges[victim];
+
+        SDL_AtomicLock(&range->lock);
+        int left = range->end - range->begin;
+        if(left > 0) {
+            begin = (left > pf->grain) ? range->end - left / 2 : range->begin;
+            end = range->end;
+            range->end = begin;
+        }
+        SDL_AtomicUnlock(&range->lock);
+
+        /* Raced with the owner or another thief - have another look */
+        if(left <= 0)
+            continue;
+
+        struct pfor_range *own = &pf->ranges[self];
+        SDL_AtomicLock(&own->lock);
+        own->begin = begin;
+        own->end = end;
+        SDL_AtomicUnlock(&own->lock);
+        return true;
+    }
+}
+
+static void pfor_run(struct pfor *pf, int self)
+{
+    int begin, end;
+    while(true) {
+
+        if(!pfor_take(pf, self, &begin, &end)) {
+            if(!pfor_split(pf, self))
+                break;
+            continue;
+        }
+        pf->fn(begin, end, pf->arg);
+        Sched_TryYield();
+    }
+}
+
+static struct result pfor_task(void *arg)
+{
+    struct pfor_range *range = arg;
+    struct pfor *pf = range->owner;
+    pfor_run(pf, range - pf->ranges);
+    return NULL_RESULT;
+}
+
 /*****************************************************************************/
 /* EXTERN FUNCTIONS                                                          */
 /*****************************************************************************/
@@ -1273,10 +2017,30 @@ bool Sched_Init(void)
     if(!s_request_lock)
         goto fail_req_lock;
 
+    s_graph_lock = SDL_CreateMutex();
+    if(!s_graph_lock)
+        goto fail_graph_lock;
+
     s_event_queues = kh_init(tqueue);
     if(!s_event_queues)
         goto fail_event_queue;
 
+    s_stack_pool = pf_stack_pool_create(STACK_SZ, STACK_SZ, MAX_CACHED_STACKS);
+    if(!s_stack_pool)
+        goto fail_stack_pool;
+
+    /* Parallel loops run a big-stack task per CPU at a time, and a few of 
+     * them may be in flight at once. Keep enough stacks around to not map 
+     * and fault in new ones every tick. */
+    size_t max_big = MAX(MIN_CACHED_BIG_STACKS, 2 * SDL_GetCPUCount());
+    s_bigstack_pool = pf_stack_pool_create(BIG_STACK_SZ, BIG_STACK_RETAIN, max_big);
+    if(!s_bigstack_pool)
+        goto fail_bigstack_pool;
+
+    s_stack_usage = kh_init(stackuse);
+    if(!s_stack_usage)
+        goto fail_stack_usage;
+
     s_ready_lock = SDL_CreateMutex();
     if(!s_ready_lock)
         goto fail_ready_lock;
@@ -1285,10 +2049,6 @@ bool Sched_Init(void)
     if(!s_ready_cond)
         goto fail_ready_cond;
 
-    pq_task_init(&s_ready_queue);
-    if(!pq_task_reserve(&s_ready_queue, MAX_TASKS))
-        goto fail_ready_queue;
-
     pq_task_init(&s_ready_queue_main);
     if(!pq_task_reserve(&s_ready_queue_main, MAX_TASKS))
         goto fail_ready_queue_main;
@@ -1304,7 +2064,6 @@ bool Sched_Init(void)
         s_tasks[i].prev = &s_tasks[i - 1];
     }
     s_freehead = s_tasks;
-    block_alloc_init(&s_bigstacks, BIG_STACK_SZ, 8);
 
     for(int i = 0; i < MAX_TASKS; i++) {
 
@@ -1331,6 +2090,15 @@ bool Sched_Init(void)
         s_worker_quit[i] = false;
     }
 
+    for(int i = 0; i < s_nworkers; i++) {
+        if(!worker_queues_init(&s_worker_queues[i])) {
+            for(int j = 0; j < i; j++)
+                worker_queues_destroy(&s_worker_queues[j]);
+            goto fail_worker_sync;
+        }
+    }
+    memset(s_stats, 0, sizeof(s_stats));
+
     for(int i = 0; i < s_nworkers; i++) {
 
         char threadname[128];
@@ -1356,6 +2124,9 @@ fail_workers:
         sched_signal_worker_quit(i);
         SDL_WaitThread(s_worker_threads[i], NULL);
     }
+    for(int i = 0; i < s_nworkers; i++) {
+        worker_queues_destroy(&s_worker_queues[i]);
+    }
 fail_worker_sync:
     for(int i = 0; i < s_nworkers; i++) {
         if(s_worker_locks[i])
@@ -1369,14 +2140,20 @@ fail_msg_queue:
     }
     pq_task_destroy(&s_ready_queue_main);
 fail_ready_queue_main:
-    pq_task_destroy(&s_ready_queue);
-fail_ready_queue:
     SDL_DestroyCond(s_ready_cond);
 fail_ready_cond:
     SDL_DestroyMutex(s_ready_lock);
 fail_ready_lock:
+    kh_destroy(stackuse, s_stack_usage);
+fail_stack_usage:
+    pf_stack_pool_destroy(s_bigstack_pool);
+fail_bigstack_pool:
+    pf_stack_pool_destroy(s_stack_pool);
+fail_stack_pool:
     kh_destroy(tqueue, s_event_queues);
 fail_event_queue:
+    SDL_DestroyMutex(s_graph_lock);
+fail_graph_lock:
     SDL_DestroyMutex(s_request_lock);
 fail_req_lock:
     kh_destroy(tid, s_thread_worker_id_map);
@@ -1399,13 +2176,22 @@ void Sched_Shutdown(void)
     });
     kh_destroy(tqueue, s_event_queues);
 
-    block_alloc_destroy(&s_bigstacks);
+    for(khiter_t k = kh_begin(s_stack_usage); k != kh_end(s_stack_usage); k++) {
+        if(!kh_exist(s_stack_usage, k))
+            continue;
+        char *name = (char*)kh_key(s_stack_usage, k);
+        PF_FREE(name);
+    }
+    kh_destroy(stackuse, s_stack_usage);
+
+    pf_stack_pool_destroy(s_bigstack_pool);
+    pf_stack_pool_destroy(s_stack_pool);
     SDL_DestroyCond(s_ready_cond);
     SDL_DestroyMutex(s_ready_lock);
     kh_destroy(tid, s_thread_tid_map);
     kh_destroy(tid, s_thread_worker_id_map);
+    SDL_DestroyMutex(s_graph_lock);
     SDL_DestroyMutex(s_request_lock);
-    pq_task_destroy(&s_ready_queue);
     pq_task_destroy(&s_ready_queue_main);
 
     for(int i = 0; i < s_nworkers; i++) {
@@ -1415,6 +2201,7 @@ void Sched_Shutdown(void)
     for(int i = 0; i < s_nworkers; i++) {
         SDL_DestroyMutex(s_worker_locks[i]);
         SDL_DestroyCond(s_worker_conds[i]);
+        worker_queues_destroy(&s_worker_queues[i]);
     }
     for(int i = 0; i < MAX_TASKS; i++) {
         queue_tid_destroy(s_msg_queues + i);
@@ -1511,18 +2298,18 @@ void Sched_Tick(void)
          * signal from racing the wait's enqueue and being lost. */
         SDL_LockMutex(s_ready_lock);
         while(pq_size(&s_ready_queue_main) == 0
-           && pq_size(&s_ready_queue) == 0
+           && !sched_work_visible()
            && ((nwaiters = s_nwaiters) < s_nworkers)
            && ((idle = s_idle_workers) < s_nworkers)
            && !s_flushing) {
 
-            size_t left = (Perf_CurrFrameMS() < SCHED_TICK_MS)
-                        ? SCHED_TICK_MS - Perf_CurrFrameMS()
+            size_t left = (Perf_CurrFrameMS() < s_tick_ms)
+                        ? s_tick_ms - Perf_CurrFrameMS()
                         : 0;
 
             SDL_CondWaitTimeout(s_ready_cond, s_ready_lock, left);
             if(left == 0) {
-                s_quiesce = true;
+                SDL_AtomicSet(&s_quiesce, 1);
                 SDL_CondBroadcast(s_ready_cond);
             }
         }
@@ -1542,12 +2329,48 @@ void Sched_Tick(void)
         sched_task_run(curr);
         sched_task_service_request(curr);
 
-    }while(Perf_CurrFrameMS() < SCHED_TICK_MS);
+    }while(Perf_CurrFrameMS() < s_tick_ms);
+
+    /* Don't let the time budget decide which of the ready main thread 
+     * tasks get to run on this tick. Only the tasks that are ready at 
+     * this point are drained: one that yields goes straight back onto 
+     * the queue and would otherwise keep the loop going forever. */
+    size_t ndrain = 0;
+    if(s_drain_main) {
+        SDL_LockMutex(s_ready_lock);
+        ndrain = pq_size(&s_ready_queue_main);
+        SDL_UnlockMutex(s_ready_lock);
+    }
+
+    for(; ndrain > 0 && G_GetSimState() == G_RUNNING; ndrain--) {
+
+        struct task *curr = NULL;
+        SDL_LockMutex(s_ready_lock);
+        pq_task_pop(&s_ready_queue_main, &curr);
+        SDL_UnlockMutex(s_ready_lock);
+
+        if(!curr)
+            break;
+        sched_task_run(curr);
+        sched_task_service_request(curr);
+    }
 
     sched_quiesce_workers();
     PERF_RETURN_VOID();
 }
 
+void Sched_SetTickBudget(float ms)
+{
+    ASSERT_IN_MAIN_THREAD();
+    s_tick_ms = ms;
+}
+
+void Sched_SetDrainMainTasks(bool on)
+{
+    ASSERT_IN_MAIN_THREAD();
+    s_drain_main = on;
+}
+
 uint32_t Sched_Create(int prio, task_func_t code, void *arg, const char *name, 
                       struct future *result, int flags)
 {
@@ -1563,19 +2386,199 @@ bool Sched_RunSync(uint32_t tid)
     return do_run_sync(tid, true);
 }
 
+void Sched_ParallelFor(int begin, int end, int grain, pfor_func_t fn, void *arg, int flags)
+{
+    /* Use the top priority since the caller is already waiting on it */
+    struct pfor pf;
+    Sched_ParallelForSubmit(&pf, 0, "sched::pfor", flags, begin, end, grain, fn, arg);
+    Sched_ParallelForJoin(&pf);
+}
+
+void Sched_ParallelForSubmit(struct pfor *pf, int prio, const char *name, int flags,
+                             int begin, int end, int grain, pfor_func_t fn, void *arg)
+{
+    assert(grain > 0);
+    assert(!(flags & TASK_MAIN_THREAD_PINNED));
+
+    int nitems = MAX(end - begin, 0);
+    int nchunks = (nitems + grain - 1) / grain;
+    int ntasks = MIN(MIN(SDL_GetCPUCount(), nchunks), SCHED_PFOR_MAX_TASKS);
+    int per_task = (ntasks > 0) ? (nitems + ntasks - 1) / ntasks : 0;
+
+    pf->fn = fn;
+    pf->arg = arg;
+    pf->grain = grain;
+    pf->flags = flags;
+    pf->ntasks = ntasks;
+
+    for(int i = 0; i <= ntasks; i++) {
+
+        struct pfor_range *range = &pf->ranges[i];
+        range->lock = 0;
+        range->owner = pf;
+        range->begin = MIN(begin + per_task * i, MAX(end, begin));
+        range->end = (i < ntasks) ? MIN(range->begin + per_task, end) : range->begin;
+    }
+
+    for(int i = 0; i < ntasks; i++) {
+
+        /* A range without a task still gets picked up by the others */
+        SDL_AtomicSet(&pf->futures[i].status, FUTURE_INCOMPLETE);
+        pf->tids[i] = Sched_Create(prio, pfor_task, &pf->ranges[i], name, 
+            &pf->futures[i], flags);
+    }
+}
+
+void Sched_ParallelForJoin(struct pfor *pf)
+{
+    bool orphaned = false;
+    for(int i = 0; i < pf->ntasks; i++) {
+        if(pf->tids[i] == NULL_TID)
+            orphaned = true;
+    }
+
+    /* Don't run the iterations on a smaller stack than they were 
+     * submitted with, unless nobody else is going to run them. */
+    if(orphaned || !(pf->flags & TASK_BIG_STACK) || Sched_UsingBigStack()) {
+        pfor_run(pf, pf->ntasks);
+    }
+
+    for(int i = 0; i < pf->ntasks; i++) {
+        if(pf->tids[i] == NULL_TID)
+            continue;
+        while(!Sched_FutureIsReady(&pf->futures[i])) {
+            Sched_RunSync(pf->tids[i]);
+            Sched_TryYield();
+        }
+    }
+    pf->ntasks = 0;
+}
+
+void Sched_ParallelForReset(struct pfor *pf)
+{
+    memset(pf, 0, sizeof(*pf));
+}
+
+uint32_t Sched_GraphSubmit(int prio, task_func_t code, void *arg, const char *name, 
+                           int flags, uint32_t reads, uint32_t writes)
+{
+    assert(!(flags & TASK_MAIN_THREAD_PINNED));
+    SDL_LockMutex(s_graph_lock);
+
+    /* Make room by helping the oldest slot along */
+    while(s_graph_inflight == ~((uint64_t)0)) {
+        uint32_t oldest = graph_handle(0);
+        SDL_UnlockMutex(s_graph_lock);
+        graph_wait_node(oldest, true);
+        SDL_LockMutex(s_graph_lock);
+    }
+
+    int idx = 0;
+    while(s_graph_inflight & (((uint64_t)1) << idx))
+        idx++;
+
+    uint64_t deps = 0;
+    for(int i = 0; i < MAX_GRAPH_NODES; i++) {
+        if(!(s_graph_inflight & (((uint64_t)1) << i)))
+            continue;
+        if(graph_conflict(&s_graph_nodes[i], reads, writes))
+            deps |= (((uint64_t)1) << i);
+    }
+
+    struct graph_node *node = &s_graph_nodes[idx];
+    node->launched = false;
+    node->code = code;
+    node->arg = arg;
+    node->name = name;
+    node->prio = prio;
+    node->flags = flags;
+    node->reads = reads;
+    node->writes = writes;
+    node->deps = deps;
+    node->tid = NULL_TID;
+    s_graph_inflight |= (((uint64_t)1) << idx);
+
+    if(deps == 0)
+        graph_launch(node);
+
+    uint32_t ret = graph_handle(idx);
+    SDL_UnlockMutex(s_graph_lock);
+    return ret;
+}
+
+void Sched_GraphWait(uint32_t resources)
+{
+    uint32_t pending[MAX_GRAPH_NODES];
+    size_t npending = 0;
+
+    SDL_LockMutex(s_graph_lock);
+    for(int i = 0; i < MAX_GRAPH_NODES; i++) {
+        if(!(s_graph_inflight & (((uint64_t)1) << i)))
+            continue;
+        if(graph_conflict(&s_graph_nodes[i], resources, resources))
+            pending[npending++] = graph_handle(i);
+    }
+    SDL_UnlockMutex(s_graph_lock);
+
+    for(int i = 0; i < npending; i++) {
+        graph_wait_node(pending[i], true);
+    }
+}
+
+bool Sched_GraphCancel(uint32_t handle)
+{
+    int idx = NODE_IDX(handle);
+    assert(idx >= 0 && idx < MAX_GRAPH_NODES);
+    struct graph_node *node = &s_graph_nodes[idx];
+
+    SDL_LockMutex(s_graph_lock);
+    if((node->gen & 0xffffff) != NODE_GEN(handle)) {
+        SDL_UnlockMutex(s_graph_lock);
+        return true;
+    }
+    /* Once it's out of flight, nothing will launch it anymore */
+    if(!node->launched) {
+        graph_retire_locked(node);
+        SDL_UnlockMutex(s_graph_lock);
+        return true;
+    }
+    uint32_t tid = node->tid;
+    SDL_UnlockMutex(s_graph_lock);
+
+    /* A node that is being run by a waiter has no TID of its own */
+    if(tid == NULL_TID || !Sched_TryCancel(tid))
+        return false;
+
+    graph_retire(node);
+    return true;
+}
+
+bool Sched_GraphTryWaitNode(uint32_t node)
+{
+    return graph_wait_node(node, false);
+}
+
+uint32_t Sched_GraphNodeTID(uint32_t node)
+{
+    int idx = NODE_IDX(node);
+    assert(idx >= 0 && idx < MAX_GRAPH_NODES);
+
+    SDL_LockMutex(s_graph_lock);
+    uint32_t ret = NULL_TID;
+    if((s_graph_nodes[idx].gen & 0xffffff) == NODE_GEN(node))
+        ret = s_graph_nodes[idx].tid;
+    SDL_UnlockMutex(s_graph_lock);
+    return ret;
+}
+
 void Sched_ClearState(void)
 {
     ASSERT_IN_MAIN_THREAD();
 
     sched_quiesce_workers();
+    graph_clear();
     SDL_LockMutex(s_ready_lock);
 
-    while(pq_size(&s_ready_queue)) {
-        struct task *curr = NULL;
-        pq_task_pop(&s_ready_queue, &curr);
-        sched_task_cleanup(curr);
-    }
-
     while(pq_size(&s_ready_queue_main)) {
         struct task *curr = NULL;
         pq_task_pop(&s_ready_queue_main, &curr);
@@ -1584,6 +2587,10 @@ void Sched_ClearState(void)
 
     SDL_UnlockMutex(s_ready_lock);
 
+    for(int i = 0; i < s_nworkers; i++) {
+        worker_queues_clear(&s_worker_queues[i]);
+    }
+
     for(khiter_t k = kh_begin(s_event_queues); k != kh_end(s_event_queues); k++) {
         if(!kh_exist(s_event_queues, k))
             continue;
@@ -1599,7 +2606,19 @@ void Sched_ClearState(void)
         }
         s_parent_waiting[i] = false;
         s_tasks[i].state = TASK_STATE_ACTIVE;
+        SDL_AtomicSet(&s_tasks[i].ticket, 0);
+    }
+
+    /* Give back the stacks of all the discarded tasks. The session 
+     * task is still running on its own. */
+    SDL_LockMutex(s_request_lock);
+    uint32_t active = Sched_ActiveTID();
+    for(int i = 0; i < MAX_TASKS; i++) {
+        if(!s_tasks[i].stackmem || s_tasks[i].tid == active)
+            continue;
+        sched_release_stack(&s_tasks[i]);
     }
+    SDL_UnlockMutex(s_request_lock);
 
     /* Reset the free list */
     s_tasks[0].prev = NULL;
@@ -1703,9 +2722,13 @@ uint32_t Sched_CreateBlocking(int prio, task_func_t code, void *arg, const char
         if(ret == NULL_TID) {
 
             SDL_LockMutex(s_ready_lock); 
-            status = pq_task_pop(&s_ready_queue_main, &task) || pq_task_pop(&s_ready_queue, &task);
+            status = pq_task_pop(&s_ready_queue_main, &task);
             SDL_UnlockMutex(s_ready_lock);
 
+            if(!status) {
+                status = ((task = sched_find_task(-1)) != NULL);
+            }
+
             if(status) {
                 sched_task_run(task);
                 sched_task_service_request(task);
@@ -1736,7 +2759,7 @@ void Sched_Flush(void)
     sched_quiesce_workers();
     struct task *curr;
 
-    while(pq_task_pop(&s_ready_queue, &curr)) {
+    while((curr = sched_find_task(-1))) {
         do_run_sync(curr->tid, false);
     }
     while(pq_task_pop(&s_ready_queue_main, &curr)) {
@@ -1745,12 +2768,56 @@ void Sched_Flush(void)
     s_flushing = false;
 }
 
+void Sched_GetStats(struct perf_sched_stats *out)
+{
+    ASSERT_IN_MAIN_THREAD();
+
+    memset(out, 0, sizeof(*out));
+    for(int i = 0; i < MAX_WORKER_THREADS + 1; i++) {
+
+        const struct perf_sched_stats *curr = &s_stats[i];
+        out->local_pops     += curr->local_pops;
+        out->inject_pops    += curr->inject_pops;
+        out->steals         += curr->steals;
+        out->steal_aborts   += curr->steal_aborts;
+        out->lock_contended += curr->lock_contended;
+        out->sleeps         += curr->sleeps;
+        out->wakeups        += curr->wakeups;
+        out->overflows      += curr->overflows;
+    }
+    memset(s_stats, 0, sizeof(s_stats));
+}
+
+size_t Sched_GetStackUsage(size_t maxout, struct perf_stack_usage *out)
+{
+    size_t ret = 0;
+    SDL_LockMutex(s_request_lock);
+
+    for(khiter_t k = kh_begin(s_stack_usage); k != kh_end(s_stack_usage); k++) {
+        if(!kh_exist(s_stack_usage, k))
+            continue;
+        if(ret == maxout)
+            break;
+
+        const struct stack_usage *usage = &kh_val(s_stack_usage, k);
+        struct perf_stack_usage *curr = &out[ret++];
+        pf_strlcpy(curr->name, kh_key(s_stack_usage, k), sizeof(curr->name));
+        curr->stack_size = usage->stack_size;
+        curr->high_water = usage->high_water;
+        curr->ntasks = usage->ntasks;
+        curr->nunknown = usage->nunknown;
+    }
+
+    SDL_UnlockMutex(s_request_lock);
+    return ret;
+}
+
 bool Sched_HasBlocked(void)
 {
     ASSERT_IN_MAIN_THREAD();
 
     SDL_LockMutex(s_ready_lock); 
-    bool ret = (pq_size(&s_ready_queue) > 0)
+    bool ret = sched_work_visible()
             || (pq_size(&s_ready_queue_main) > 0);
     SDL_UnlockMutex(s_ready_lock);
     return ret;
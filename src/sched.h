@@ -44,6 +44,7 @@
 
 
 #define NULL_TID (0)
+#define NULL_NODE (0)
 #define NULL_RESULT (struct result){0}
 
 #define ASSERT_IN_CTX(tid) \
@@ -89,6 +90,55 @@ enum{
 
 typedef struct result (*task_func_t)(void *);
 
+/* The simulation state which frame graph nodes declare reading or
+ * writing. Only state that is touched in place by the node's task 
+ * needs to be declared - not the snapshots taken before submitting. 
+ */
+enum{
+    SCHED_RES_POSITIONS   = (1 << 0),
+    SCHED_RES_FLAGS       = (1 << 1),
+    SCHED_RES_FOG         = (1 << 2),
+    SCHED_RES_NAV         = (1 << 3),
+    SCHED_RES_NAV_FIELDS  = (1 << 4),
+    SCHED_RES_MOVEMENT    = (1 << 5),
+    SCHED_RES_COMBAT      = (1 << 6),
+    SCHED_RES_PROJECTILES = (1 << 7),
+};
+
+#define SCHED_PFOR_MAX_TASKS (64)
+
+/* Processes the iterations in [begin, end) */
+typedef void (*pfor_func_t)(int begin, int end, void *arg);
+
+struct pfor_range{
+    SDL_SpinLock  lock;
+    int           begin;
+    int           end;
+    struct pfor  *owner;
+};
+
+/* Bookkeeping for a parallel loop. The iterations are initially split 
+ * evenly between the participating tasks, each of which consumes its 
+ * own range 'grain' iterations at a time. A participant that runs dry 
+ * splits off the upper half of the largest range that is still left, 
+ * so the partitioning adapts to uneven per-iteration costs. The last 
+ * range is reserved for the thread doing the join. The struct must 
+ * outlive the loop.
+ */
+struct pfor{
+    pfor_func_t       fn;
+    void             *arg;
+    int               grain;
+    int               flags;
+    size_t            ntasks;
+    struct pfor_range ranges[SCHED_PFOR_MAX_TASKS + 1];
+    uint32_t          tids[SCHED_PFOR_MAX_TASKS];
+    struct future     futures[SCHED_PFOR_MAX_TASKS];
+};
+
+struct perf_sched_stats;
+struct perf_stack_usage;
+
 /* The following may only be called from any context */
 
 bool     Sched_FutureIsReady(const struct future *future);
@@ -101,11 +151,46 @@ void     Sched_Shutdown(void);
 void     Sched_HandleEvent(int event, void *arg, int event_source, bool immediate);
 void     Sched_StartBackgroundTasks(void);
 void     Sched_Tick(void);
+/* Set the time (in milliseconds since the start of the frame) up to which 
+ * 'Sched_Tick' keeps running tasks. Defaults to the length of a frame at 
+ * CONFIG_SCHED_TARGET_FPS. */
+void     Sched_SetTickBudget(float ms);
+/* Keep running main thread tasks past the tick budget until none of 
+ * them are ready. */
+void     Sched_SetDrainMainTasks(bool on);
 uint32_t Sched_Create(int prio, task_func_t code, void *arg, const char *name,
                      struct future *result, int flags);
 uint32_t Sched_CreateBlocking(int prio, task_func_t code, void *arg, const char *name,
                               struct future *result, int flags);
 bool     Sched_RunSync(uint32_t tid);
+/* Fan the iterations [begin, end) out to up to one task per CPU. The 
+ * join takes on iterations itself while there are any left and only 
+ * then waits for the participants still running. 'Sched_ParallelFor' 
+ * does both in one go, keeping the bookkeeping on the caller's stack. 
+ * These may also be called from task context. */
+void     Sched_ParallelFor(int begin, int end, int grain, pfor_func_t fn, void *arg, int flags);
+void     Sched_ParallelForSubmit(struct pfor *pf, int prio, const char *name, int flags,
+                                 int begin, int end, int grain, pfor_func_t fn, void *arg);
+void     Sched_ParallelForJoin(struct pfor *pf);
+/* Forget an outstanding loop whose tasks were discarded by Sched_ClearState */
+void     Sched_ParallelForReset(struct pfor *pf);
+/* The frame graph. A submitted node starts running as soon as all the 
+ * previously submitted nodes that it conflicts with have finished, and
+ * stays in flight until its task returns. Before touching any declared 
+ * state, the main thread waits on the nodes using it. The waits run the 
+ * pending nodes (and their dependencies) on the calling thread when 
+ * they're not already running elsewhere. 'Sched_GraphTryWaitNode' gives 
+ * up as soon as that's not possible. */
+uint32_t Sched_GraphSubmit(int prio, task_func_t code, void *arg, const char *name, 
+                           int flags, uint32_t reads, uint32_t writes);
+void     Sched_GraphWait(uint32_t resources);
+bool     Sched_GraphTryWaitNode(uint32_t node);
+/* Kill off a node that hasn't been launched or whose task is blocked on an 
+ * event, releasing the nodes that depend on it. Returns false if the task 
+ * couldn't be cancelled, in which case the node retires once it returns. */
+bool     Sched_GraphCancel(uint32_t node);
+/* Returns NULL_TID when the node has retired or hasn't been launched yet */
+uint32_t Sched_GraphNodeTID(uint32_t node);
 void     Sched_ClearState(void);
 void     Sched_Flush(void);
 bool     Sched_HasBlocked(void);
@@ -113,6 +198,12 @@ bool     Sched_IsReady(uint32_t tid);
 bool     Sched_IsEventBlocked(uint32_t tid);
 bool     Sched_TryCancel(uint32_t tid);
 bool     Sched_AbortScriptBlocked(uint32_t tid);
+/* Returns the counters accumulated since the last call. May only 
+ * be called while the workers are quiesced. */
+void     Sched_GetStats(struct perf_sched_stats *out);
+/* Copies out up to 'maxout' per-name stack high-water marks. Returns 
+ * the number of entries written. */
+size_t   Sched_GetStackUsage(size_t maxout, struct perf_stack_usage *out);
 
 /* The following may only be called from task context 
  * (i.e. from the body of a task function) */
@@ -1897,6 +1897,10 @@ static PyObject *PyEntity_deselect(PyEntityObject *self)
 static PyObject *PyEntity_stop(PyEntityObject *self)
 {
     assert(self->ent != NULL_UID);
+    if(G_FlagsGet(self->ent) & (ENTITY_FLAG_HARVESTER | ENTITY_FLAG_BUILDER 
+                              | ENTITY_FLAG_GARRISON | ENTITY_FLAG_GARRISONABLE)) {
+        G_Journal_NoteUnjournaled("stop");
+    }
     G_StopEntity(self->ent, true, true);
     Py_RETURN_NONE;
 }
@@ -2313,6 +2317,10 @@ static PyObject *PyCombatableEntity_hold_position(PyCombatableEntityObject *self
         return NULL;
     }
 
+    if(G_FlagsGet(self->super.ent) & (ENTITY_FLAG_HARVESTER | ENTITY_FLAG_BUILDER 
+                                    | ENTITY_FLAG_GARRISON | ENTITY_FLAG_GARRISONABLE)) {
+        G_Journal_NoteUnjournaled("hold position");
+    }
     G_StopEntity(self->super.ent, true, true);
 
     assert(G_FlagsGet(self->super.ent) & ENTITY_FLAG_COMBATABLE);
@@ -3331,6 +3339,7 @@ static PyObject *PyBuilderEntity_build(PyBuilderEntityObject *self, PyObject *ar
         return NULL;
     }
 
+    G_Journal_NoteUnjournaled("build");
     G_Builder_Build(self->super.ent, ((PyBuildableEntityObject*)building)->super.ent);
     Py_RETURN_NONE;
 }
@@ -3730,6 +3739,7 @@ static PyObject *PyHarvesterEntity_gather(PyHarvesterEntityObject *self, PyObjec
         return NULL;
     }
 
+    G_Journal_NoteUnjournaled("gather");
     G_StopEntity(self->super.ent, true, true);
     if(!G_Harvester_Gather(self->super.ent, resource->super.ent)) {
         PyErr_SetString(PyExc_RuntimeError, "Unable to gather the specified resource.");
@@ -3752,6 +3762,7 @@ static PyObject *PyHarvesterEntity_drop_off(PyHarvesterEntityObject *self, PyObj
         return NULL;
     }
 
+    G_Journal_NoteUnjournaled("drop off");
     G_StopEntity(self->super.ent, true, true);
     if(!G_Harvester_DropOff(self->super.ent, storage->super.ent)) {
         PyErr_SetString(PyExc_RuntimeError, "Unable to drop off resource at the specified storage site.");
@@ -3774,6 +3785,7 @@ static PyObject *PyHarvesterEntity_transport(PyHarvesterEntityObject *self, PyOb
         return NULL;
     }
 
+    G_Journal_NoteUnjournaled("transport");
     G_StopEntity(self->super.ent, true, true);
     if(!G_Harvester_Transport(self->super.ent, storage->super.ent)) {
         PyErr_SetString(PyExc_RuntimeError, "Unable to transport resources to the specified storage site.");
@@ -4429,6 +4441,7 @@ static PyObject *PyGarrisonEntity_garrison(PyGarrisonEntityObject *self, PyObjec
         return NULL;
     }
 
+    G_Journal_NoteUnjournaled("garrison");
     if(!G_Garrison_Enter(self->super.ent, garrisonable->super.ent)) {
         PyErr_SetString(PyExc_TypeError, "Unable to garrison inside specified "
             "pf.GarrisonableEntity instance.");
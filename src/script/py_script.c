@@ -136,6 +136,8 @@ static PyObject *PyPf_prev_frame_perfstats(PyObject *self);
 static PyObject *PyPf_prev_frame_memstats(PyObject *self);
 static PyObject *PyPf_prev_frame_vramstats(PyObject *self);
 static PyObject *PyPf_prev_frame_gpu_stats(PyObject *self);
+static PyObject *PyPf_prev_frame_schedstats(PyObject *self);
+static PyObject *PyPf_get_stack_usage(PyObject *self);
 static PyObject *PyPf_prev_frame_mem_accounting(PyObject *self);
 static PyObject *PyPf_prev_frame_gpu_mem_accounting(PyObject *self);
 static PyObject *PyPf_mem_audit(PyObject *self);
@@ -143,6 +145,8 @@ static PyObject *PyPf_prev_frame_allocd_bytes(PyObject *self);
 static PyObject *PyPf_get_resolution(PyObject *self);
 static PyObject *PyPf_get_native_resolution(PyObject *self);
 static PyObject *PyPf_get_basedir(PyObject *self);
+static PyObject *PyPf_get_engine_arg(PyObject *self, PyObject *args);
+static PyObject *PyPf_quit(PyObject *self, PyObject *args);
 static PyObject *PyPf_get_render_info(PyObject *self);
 static PyObject *PyPf_get_nav_perfstats(PyObject *self);
 static PyObject *PyPf_get_mouse_pos(PyObject *self);
@@ -411,6 +415,16 @@ static PyMethodDef pf_module_methods[] = {
     "submitted, vertex/fragment-shader invocations, clipping input/output "
     "primitives) for the previous frame."},
 
+    {"prev_frame_schedstats",
+    (PyCFunction)PyPf_prev_frame_schedstats, METH_NOARGS,
+    "Get a dictionary of the task scheduler's work distribution counters (local pops, "
+    "steals, lock contention, worker sleeps/wakeups) for the previous frame."},
+
+    {"get_stack_usage",
+    (PyCFunction)PyPf_get_stack_usage, METH_NOARGS,
+    "Get a dictionary mapping task names to the deepest stack use (in bytes) seen "
+    "for tasks of that name, along with the stack size and the number of tasks sampled."},
+
     {"prev_frame_mem_accounting",
     (PyCFunction)PyPf_prev_frame_mem_accounting, METH_NOARGS,
     "Get a dictionary of per-system memory accounting for the previous frame. "
@@ -446,6 +460,15 @@ static PyMethodDef pf_module_methods[] = {
     (PyCFunction)PyPf_get_basedir, METH_NOARGS,
     "Get the path to the top-level game resource folder (parent of 'assets')."},
 
+    {"get_engine_arg", 
+    (PyCFunction)PyPf_get_engine_arg, METH_VARARGS,
+    "Get the value of a '--name=value' command-line argument passed to the engine, "
+    "or None if the argument was not given."},
+
+    {"quit", 
+    (PyCFunction)PyPf_quit, METH_VARARGS,
+    "Exit the engine at the end of the current frame, with an optional process exit status."},
+
     {"get_render_info", 
     (PyCFunction)PyPf_get_render_info, METH_NOARGS,
     "Returns a dictionary describing the renderer context. It will have the string keys "
@@ -1363,7 +1386,7 @@ static PyObject *PyPf_global_event(PyObject *self, PyObject *args)
 
 static PyObject *PyPf_get_ticks(PyObject *self)
 {
-    return PyInt_FromLong(SDL_GetTicks());
+    return PyInt_FromLong(G_Timer_Ticks());
 }
 
 static PyObject *PyPf_ticks_delta(PyObject *self, PyObject *args)
@@ -1475,6 +1498,59 @@ static PyObject *PyPf_prev_frame_gpu_stats(PyObject *self)
         "frag_invocations", (unsigned long long)stats.frag_invocations);
 }
 
+static PyObject *PyPf_prev_frame_schedstats(PyObject *self)
+{
+    struct perf_sched_stats stats = {0};
+    Perf_GetSchedStats(&stats);
+
+    return Py_BuildValue("{s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K}",
+        "local_pops",     (unsigned long long)stats.local_pops,
+        "inject_pops",    (unsigned long long)stats.inject_pops,
+        "steals",         (unsigned long long)stats.steals,
+        "steal_aborts",   (unsigned long long)stats.steal_aborts,
+        "lock_contended", (unsigned long long)stats.lock_contended,
+        "sleeps",         (unsigned long long)stats.sleeps,
+        "wakeups",        (unsigned long long)stats.wakeups,
+        "overflows",      (unsigned long long)stats.overflows);
+}
+
+static PyObject *PyPf_get_stack_usage(PyObject *self)
+{
+    enum{ MAX_ENTRIES = 512 };
+    struct perf_stack_usage *usage = PF_MALLOC(sizeof(struct perf_stack_usage) * MAX_ENTRIES);
+    if(!usage)
+        return PyErr_NoMemory();
+
+    size_t nusage = Sched_GetStackUsage(MAX_ENTRIES, usage);
+    PyObject *result = PyDict_New();
+    if(!result)
+        goto fail;
+
+    for(size_t i = 0; i < nusage; i++) {
+
+        PyObject *entry = Py_BuildValue("{s:K,s:K,s:K,s:K}",
+            "stack_size", (unsigned long long)usage[i].stack_size,
+            "high_water", (unsigned long long)usage[i].high_water,
+            "ntasks",     (unsigned long long)usage[i].ntasks,
+            "nunknown",   (unsigned long long)usage[i].nunknown);
+        if(!entry)
+            goto fail;
+
+        int status = PyDict_SetItemString(result, usage[i].name, entry);
+        Py_DECREF(entry);
+        if(status != 0)
+            goto fail;
+    }
+
+    PF_FREE(usage);
+    return result;
+
+fail:
+    Py_XDECREF(result);
+    PF_FREE(usage);
+    return NULL;
+}
+
 static PyObject *mem_accounting_to_dict(const struct mem_accounting *acc)
 {
     PyObject *result = PyDict_New();
@@ -1633,6 +1709,33 @@ static PyObject *PyPf_get_basedir(PyObject *self)
     return Py_BuildValue("s", g_basepath);
 }
 
+static PyObject *PyPf_get_engine_arg(PyObject *self, PyObject *args)
+{
+    const char *name;
+    if(!PyArg_ParseTuple(args, "s", &name)) {
+        PyErr_SetString(PyExc_TypeError, "Argument must be a string (name of the argument).");
+        return NULL;
+    }
+
+    char value[512];
+    if(!Engine_GetArg(name, sizeof(value), value)) {
+        Py_RETURN_NONE;
+    }
+    return PyString_FromString(value);
+}
+
+static PyObject *PyPf_quit(PyObject *self, PyObject *args)
+{
+    int exit_code = 0;
+    if(!PyArg_ParseTuple(args, "|i", &exit_code)) {
+        PyErr_SetString(PyExc_TypeError, "Argument must be an integer (process exit status).");
+        return NULL;
+    }
+
+    Engine_Quit(exit_code);
+    Py_RETURN_NONE;
+}
+
 static PyObject *PyPf_get_render_info(PyObject *self)
 {
     PyObject *ret = PyDict_New();
@@ -1669,6 +1772,7 @@ static PyObject *PyPf_get_nav_perfstats(PyObject *self)
     rval |= PyDict_SetItemString(ret, "flow_max",           Py_BuildValue("i", stats.flow_max));
     rval |= PyDict_SetItemString(ret, "flow_hit_rate",      Py_BuildValue("f", stats.flow_hit_rate));
     rval |= PyDict_SetItemString(ret, "flow_invalidated",   Py_BuildValue("i", stats.flow_invalidated));
+    rval |= PyDict_SetItemString(ret, "flow_repaired",      Py_BuildValue("i", stats.flow_repaired));
     rval |= PyDict_SetItemString(ret, "ffid_used",          Py_BuildValue("i", stats.ffid_used));
     rval |= PyDict_SetItemString(ret, "ffid_max",           Py_BuildValue("i", stats.ffid_max));
     rval |= PyDict_SetItemString(ret, "ffid_hit_rate",      Py_BuildValue("f", stats.ffid_hit_rate));
@@ -3295,8 +3399,7 @@ static PyObject *PyPf_rand(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "Argument must be a single integer.");
         return NULL;
     }
-    int raw = rand();
-    int ret = ((float)raw) / RAND_MAX * max;
+    int ret = G_RandFloat() * max;
     assert(ret >= 0 && ret <= max);
     return PyInt_FromLong(ret);
 }
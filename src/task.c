@@ -40,6 +40,7 @@
 #include "sched.h"
 #include "event.h"
 #include "main.h"
+#include "game/public/game.h"
 #include "lib/public/pf_string.h"
 #include "lib/public/pqueue.h"
 #include "lib/public/queue.h"
@@ -139,7 +140,7 @@ static struct result timeserver_task(void *arg)
         int reply = 0;
 
         Task_Receive(&tid, &request, sizeof(request));
-        uint32_t curr_tick = SDL_GetTicks();
+        uint32_t curr_tick = G_Timer_Ticks();
 
         switch(request.type) {
         case TS_REQ_NOTIFY:
@@ -743,3 +743,8 @@ void UI_LoadingScreenTick(void)
     ui_render((void*)(uintptr_t)UI_RENDER_MODE_LOADING_SCREEN, NULL);
 }
 
+void UI_ClearFrame(void)
+{
+    nk_clear(&s_ctx);
+}
+
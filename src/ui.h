@@ -78,6 +78,8 @@ void               UI_HandleEvent(SDL_Event *evt);
 void               UI_DrawText(const char *text, struct rect rect, struct rgba rgba);
 vec2_t             UI_GetTextVres(void);
 void               UI_LoadingScreenTick(void);
+/* Discard the UI that was built during this frame without drawing it */
+void               UI_ClearFrame(void);
 
 /* Returns a trimmed version of the virtual resolution when the aspect ratio of the window is 
  * different than the virtual resolution aspect ratio. The adjusted resolution has the same
@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+#
+#  This file is part of Permafrost Engine.
+#  Copyright (C) 2026 Eduard Permyakov
+#
+#  Permafrost Engine is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  Permafrost Engine is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+#
+#  Headless benchmark runner: runs each scenario in scripts/bench/scenarios.py in its own
+#  engine process, aggregates the per-tick records into frame time percentiles, per-system
+#  timings and allocation volume, and compares them against the stored baselines. Exits with
+#  a non-zero status when any tracked value regresses by more than the allowed percentage.
+#
+#  Run: python3 tools/benchmark/run_benchmarks.py [--scenario NAME ...] [--update-baselines]
+#
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+SCENARIOS = ["mass_move", "siege", "harvest", "fog", "projectiles", "save_load"]
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.normpath(os.path.join(HERE, "..", ".."))
+
+
+def percentile(values, pct):
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    idx = min(len(ordered) - 1, int(round(pct / 100.0 * (len(ordered) - 1))))
+    return ordered[idx]
+
+
+def mean(values):
+    return sum(values) / len(values) if values else 0.0
+
+
+def summarize(records, frame_only):
+    frame_ms = [r["frame_ms"] for r in records]
+
+    allocd = None
+    systems = {}
+    if not frame_only:
+        samples = [r["allocd_bytes"] for r in records]
+        allocd = {"mean": mean(samples), "max": max(samples)}
+
+        names = set()
+        for r in records:
+            names.update(r["systems"].keys())
+
+        for name in sorted(names):
+            # Systems that didn't run on a tick count as 0ms for that tick
+            samples = [r["systems"].get(name, 0.0) for r in records]
+            systems[name] = {"mean": mean(samples), "p99": percentile(samples, 99)}
+
+    return {
+        "ticks": len(records),
+        "frame_only": frame_only,
+        "frame_ms": {
+            "mean": mean(frame_ms),
+            "p50": percentile(frame_ms, 50),
+            "p99": percentile(frame_ms, 99),
+            "max": max(frame_ms) if frame_ms else 0.0,
+        },
+        "allocd_bytes": allocd,
+        "systems": systems,
+    }
+
+
+def run_scenario(args, name):
+    out_path = os.path.abspath(os.path.join(args.out_dir, name + ".jsonl"))
+    for stale in (out_path, out_path + ".loaded", out_path + ".pfsave"):
+        if os.path.exists(stale):
+            os.remove(stale)
+
+    cmd = [args.bin, args.basedir, os.path.join(args.basedir, "scripts", "bench", "main.py"),
+           "--headless", "--seed=%d" % args.seed, "--scenario=" + name, "--bench_out=" + out_path]
+    if args.frame_only:
+        cmd.append("--bench_frame_only=1")
+    print("==> " + " ".join(cmd), flush=True)
+    try:
+        proc = subprocess.run(cmd, timeout=args.timeout)
+    except subprocess.TimeoutExpired:
+        print("Scenario '%s' timed out after %ds" % (name, args.timeout))
+        return None
+    if proc.returncode != 0:
+        print("Scenario '%s' failed with exit status %d" % (name, proc.returncode))
+        return None
+
+    with open(out_path) as f:
+        records = [json.loads(line) for line in f if line.strip()]
+    if not records:
+        print("Scenario '%s' produced no records" % name)
+        return None
+    return summarize(records, args.frame_only)
+
+
+def compare(name, summary, baseline, threshold_pct, min_ms):
+    """ Returns a list of human-readable regressions """
+    limit = 1.0 + threshold_pct / 100.0
+    regressions = []
+
+    # A frame-only (release) run can't be compared to a full (debug) 
+    # baseline or vice versa - neither the metrics nor the timings match.
+    if baseline.get("frame_only", False) != summary["frame_only"]:
+        return ["%s: the baseline was recorded %s --frame-only, this run %s"
+                % (name, "with" if baseline.get("frame_only", False) else "without",
+                   "with" if summary["frame_only"] else "without")]
+
+    def check(label, curr, base, floor):
+        if base < floor:
+            return
+        if curr > base * limit:
+            regressions.append("%s/%s: %.3f -> %.3f (+%.1f%%)"
+                               % (name, label, base, curr, (curr / base - 1.0) * 100.0))
+
+    for key in ("p50", "p99"):
+        check("frame_ms." + key, summary["frame_ms"][key], baseline["frame_ms"][key], min_ms)
+    if not summary["frame_only"]:
+        check("allocd_bytes.mean", summary["allocd_bytes"]["mean"],
+              baseline["allocd_bytes"]["mean"], 1024.0)
+    for sysname, base in baseline["systems"].items():
+        curr = summary["systems"].get(sysname, {"mean": 0.0})
+        check(sysname + ".mean", curr["mean"], base["mean"], min_ms)
+    return regressions
+
+
+def print_summary(name, summary):
+    frame = summary["frame_ms"]
+    line = ("%-12s %5d ticks  frame p50 %7.3fms  p99 %7.3fms  max %7.3fms"
+            % (name, summary["ticks"], frame["p50"], frame["p99"], frame["max"]))
+    if not summary["frame_only"]:
+        line += "  alloc/tick %10.0fB" % summary["allocd_bytes"]["mean"]
+    print(line)
+    top = sorted(summary["systems"].items(), key=lambda kv: kv[1]["mean"], reverse=True)[:8]
+    for sysname, stats in top:
+        print("    %-48s mean %7.3fms  p99 %7.3fms" % (sysname, stats["mean"], stats["p99"]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run the headless benchmark scenarios.")
+    parser.add_argument("--bin", default=os.path.join(ROOT, "bin", "pf"))
+    parser.add_argument("--basedir", default=ROOT)
+    parser.add_argument("--scenario", action="append", choices=SCENARIOS,
+                        help="scenario to run (repeatable, default: all)")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--baselines", default=os.path.join(HERE, "baselines.json"))
+    parser.add_argument("--threshold", type=float, default=None,
+                        help="allowed regression in percent (overrides the baselines file)")
+    parser.add_argument("--min-ms", type=float, default=0.05,
+                        help="ignore timings whose baseline is below this many ms")
+    parser.add_argument("--out-dir", default=os.path.join(ROOT, "bench_out"))
+    parser.add_argument("--timeout", type=int, default=600)
+    parser.add_argument("--frame-only", action="store_true",
+                        help="only record the frame times (for release builds, which "
+                             "don't report per-system timings or allocations)")
+    parser.add_argument("--update-baselines", action="store_true",
+                        help="store this run's results as the new baselines")
+    args = parser.parse_args()
+
+    os.makedirs(args.out_dir, exist_ok=True)
+    with open(args.baselines) as f:
+        baselines = json.load(f)
+
+    results = {}
+    failed = []
+    for name in (args.scenario or SCENARIOS):
+        summary = run_scenario(args, name)
+        if summary is None:
+            failed.append(name)
+            continue
+        results[name] = summary
+        print_summary(name, summary)
+
+    with open(os.path.join(args.out_dir, "results.json"), "w") as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+
+    if args.update_baselines:
+        stored = baselines.setdefault("scenarios", {})
+        for name, summary in results.items():
+            if "threshold_pct" in stored.get(name, {}):
+                summary["threshold_pct"] = stored[name]["threshold_pct"]
+            stored[name] = summary
+        with open(args.baselines, "w") as f:
+            json.dump(baselines, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("Updated baselines for: " + ", ".join(sorted(results)))
+        return 1 if failed else 0
+
+    regressions = []
+    for name, summary in results.items():
+        baseline = baselines.get("scenarios", {}).get(name)
+        if baseline is None:
+            print("No baseline for scenario '%s', skipping comparison" % name)
+            continue
+        threshold = args.threshold
+        if threshold is None:
+            threshold = baseline.get("threshold_pct", baselines.get("threshold_pct", 10.0))
+        regressions += compare(name, summary, baseline, threshold, args.min_ms)
+
+    for line in regressions:
+        print("REGRESSION: " + line)
+    for name in failed:
+        print("FAILED: " + name)
+    return 1 if (regressions or failed) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())